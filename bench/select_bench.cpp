@@ -0,0 +1,154 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "select_kernels.hpp"
+
+using namespace car_sales;
+
+// Synthetic columns shaped like a loaded ColumnStore
+struct BenchColumns {
+    std::vector<uint16_t> brand;   // 40 brands
+    std::vector<uint16_t> country; // 30 countries
+    std::vector<uint16_t> year;    // 2020..2025
+    std::vector<int64_t> cents;    // 0 .. 100000.00 USD
+    std::vector<uint8_t> european;
+};
+
+static BenchColumns makeColumns(size_t rows) {
+    BenchColumns columns;
+    std::mt19937_64 rng(42);
+    columns.brand.reserve(rows);
+    columns.country.reserve(rows);
+    columns.year.reserve(rows);
+    columns.cents.reserve(rows);
+    for (size_t i = 0; i < rows; ++i) {
+        columns.brand.push_back(static_cast<uint16_t>(rng() % 40));
+        columns.country.push_back(static_cast<uint16_t>(rng() % 30));
+        columns.year.push_back(static_cast<uint16_t>(2020 + rng() % 6));
+        columns.cents.push_back(static_cast<int64_t>(rng() % 10000000));
+    }
+    for (int code = 0; code < 30; ++code) {
+        columns.european.push_back(code % 3 == 0);
+    }
+    return columns;
+}
+
+// Best of several runs, in milliseconds; result keeps the work observable
+static double timeBest(const std::function<size_t()> &run, size_t &result) {
+    double best = 1e300;
+    for (int repeat = 0; repeat < 7; ++repeat) {
+        auto start = std::chrono::steady_clock::now();
+        result = run();
+        std::chrono::duration<double, std::milli> elapsed =
+            std::chrono::steady_clock::now() - start;
+        best = std::min(best, elapsed.count());
+    }
+    return best;
+}
+
+static void report(const char *kernel, const SelectKernels &kernels,
+                   const std::string &detail, size_t rows, size_t result,
+                   double ms) {
+    std::printf("%-18s %-7s %-22s %12zu %9.3f %9.1f\n", kernel,
+                selectIsaName(kernels.isa), detail.c_str(), result, ms,
+                static_cast<double>(rows) / (ms * 1000.0));
+}
+
+int main(int argc, char *argv[]) {
+    size_t rows = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 10000000;
+    if (rows == 0 || rows > UINT32_MAX) {
+        std::fprintf(stderr, "Usage: %s [rows (1..2^32-1), default 10000000]\n",
+                     argv[0]);
+        return 1;
+    }
+    BenchColumns columns = makeColumns(rows);
+    std::vector<uint32_t> selection(rows);
+    std::vector<uint32_t> refined(rows);
+
+    std::printf("%zu rows; Mrows/s counts every input row of the step\n", rows);
+    std::printf("%-18s %-7s %-22s %12s %9s %9s\n", "kernel", "isa", "filter",
+                "result", "ms", "Mrows/s");
+
+    for (SelectIsa isa : {SelectIsa::Scalar, SelectIsa::Avx2}) {
+        if (!selectIsaAvailable(isa)) {
+            std::printf("%-18s %-7s (not available on this build or CPU)\n",
+                        "-", selectIsaName(isa));
+            continue;
+        }
+        const SelectKernels &kernels = selectKernels(isa);
+        size_t result = 0;
+
+        double ms = timeBest([&] {
+            return kernels.select_eq_u16(columns.brand.data(), rows, 7,
+                                         selection.data());
+        }, result);
+        report("select_eq_u16", kernels, "brand (2.5%)", rows, result, ms);
+        size_t brand_rows = result;
+
+        ms = timeBest([&] {
+            return kernels.select_eq_u16(columns.year.data(), rows, 2025,
+                                         refined.data());
+        }, result);
+        report("select_eq_u16", kernels, "year (17%)", rows, result, ms);
+
+        // Refines read only the brand's rows
+        ms = timeBest([&] {
+            return kernels.refine_eq_u16(columns.year.data(), rows,
+                                         selection.data(), brand_rows, 2025,
+                                         refined.data());
+        }, result);
+        report("refine_eq_u16", kernels, "brand then year", brand_rows, result,
+               ms);
+        size_t brand_year_rows = result;
+
+        ms = timeBest([&] {
+            return kernels.refine_lookup_u16(columns.country.data(), rows,
+                                             selection.data(), brand_rows,
+                                             columns.european.data(),
+                                             refined.data());
+        }, result);
+        report("refine_lookup_u16", kernels, "brand then europe", brand_rows,
+               result, ms);
+
+        for (int percent : {1, 10, 50, 90}) {
+            int64_t high = 10000000LL * percent / 100 - 1;
+            ms = timeBest([&] {
+                return kernels.select_range_i64(columns.cents.data(), rows, 0,
+                                                high, refined.data());
+            }, result);
+            report("select_range_i64", kernels,
+                   "price (" + std::to_string(percent) + "%)", rows, result,
+                   ms);
+        }
+
+        ms = timeBest([&] {
+            return kernels.refine_range_i64(columns.cents.data(), rows,
+                                            selection.data(), brand_rows, 0,
+                                            4999999, refined.data());
+        }, result);
+        report("refine_range_i64", kernels, "brand then price", brand_rows,
+               result, ms);
+
+        kernels.refine_eq_u16(columns.year.data(), rows, selection.data(),
+                              brand_rows, 2025, refined.data());
+        int64_t sum = 0;
+        ms = timeBest([&] {
+            sum = kernels.sum_selected_i64(columns.cents.data(), rows,
+                                           refined.data(), brand_year_rows);
+            return brand_year_rows;
+        }, result);
+        report("sum_selected_i64", kernels, "brand and year", brand_year_rows,
+               result, ms);
+        if (sum == 0) {
+            std::printf("(empty selection)\n");
+        }
+    }
+    return 0;
+}
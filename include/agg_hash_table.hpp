@@ -0,0 +1,132 @@
+#ifndef agg_hash_table_HPP
+#define agg_hash_table_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+#include <vector>
+
+#include "hash.hpp"
+
+namespace car_sales {
+
+/**
+ * @brief Open-addressing hash table of per-key aggregates (count, cents)
+ *
+ * Slots are 32-byte PODs in one flat array (two per cache line). Keys of up
+ * to INLINE_KEY_BYTES (dealer, salesperson and most model ids) live inside
+ * the slot, so a hit touches a single cache line; longer keys are appended to
+ * one byte pool and only read when the stored hash matches. Linear probing
+ * keeps collisions in the same or the next cache line, and growth rehashes
+ * from the stored hashes without rereading keys. Not thread-safe: each worker
+ * owns its own tables.
+ */
+class AggHashTable {
+public:
+  /**
+   * @brief One aggregated key, as seen by forEach()
+   */
+  struct Entry {
+    std::string_view key; // valid until the table is modified
+    int64_t count;
+    int64_t revenue_cents;
+  };
+
+  explicit AggHashTable(size_t initial_capacity = 16);
+
+  static constexpr size_t INLINE_KEY_BYTES = 8;
+
+  /**
+   * @brief Add count and revenue to key (precomputed hashBytes(key))
+   */
+  void add(std::string_view key, uint64_t hash, int64_t count,
+           int64_t revenue_cents);
+
+  /**
+   * @brief Add count and revenue to key
+   */
+  void add(std::string_view key, int64_t count, int64_t revenue_cents) {
+    add(key, hashBytes(key), count, revenue_cents);
+  }
+
+  /**
+   * @brief Look up a key
+   * @return false if the key is absent (out is left untouched)
+   */
+  bool find(std::string_view key, Entry &out) const;
+
+  /**
+   * @brief Fold every entry of other into this table
+   */
+  void merge(const AggHashTable &other);
+
+  /**
+   * @brief Visit every entry in slot order
+   */
+  template <typename Visitor> void forEach(Visitor &&visit) const {
+    for (const Slot &slot : slots_) {
+      if (slot.key_length != EMPTY) {
+        visit(entryOf(slot));
+      }
+    }
+  }
+
+  /**
+   * @brief Remove all entries but keep the allocated memory
+   */
+  void clear();
+
+  /**
+   * @brief Remove all entries and return the memory
+   */
+  void release();
+
+  size_t size() const { return size_; }
+  bool empty() const { return size_ == 0; }
+  size_t capacity() const { return slots_.size(); }
+
+  /**
+   * @brief Bytes held by the slot array and the key pool
+   */
+  size_t memoryBytes() const {
+    return slots_.capacity() * sizeof(Slot) + keys_.capacity();
+  }
+
+private:
+  struct Slot {
+    uint32_t hash;       // low half of hashBytes(key); enough to rehash
+    uint32_t key_length; // EMPTY marks an unused slot
+    union {
+      char inline_key[INLINE_KEY_BYTES]; // key_length <= INLINE_KEY_BYTES
+      uint32_t key_offset;               // otherwise, offset into keys_
+    };
+    int64_t count;
+    int64_t revenue_cents;
+  };
+  static_assert(sizeof(Slot) == 32, "two slots per cache line");
+
+  static constexpr uint32_t EMPTY = UINT32_MAX;
+
+  std::vector<Slot> slots_;
+  std::vector<char> keys_;
+  size_t size_;
+  size_t mask_;
+
+  std::string_view keyOf(const Slot &slot) const {
+    const char *data = slot.key_length <= INLINE_KEY_BYTES
+                           ? slot.inline_key
+                           : keys_.data() + slot.key_offset;
+    return std::string_view(data, slot.key_length);
+  }
+
+  Entry entryOf(const Slot &slot) const {
+    return Entry{keyOf(slot), slot.count, slot.revenue_cents};
+  }
+
+  static Slot emptySlot();
+  void grow();
+};
+
+} // namespace car_sales
+
+#endif // agg_hash_table_HPP
@@ -0,0 +1,96 @@
+#ifndef arena_HPP
+#define arena_HPP
+
+#include <cstddef>
+#include <memory>
+#include <string_view>
+#include <vector>
+
+namespace car_sales {
+
+/**
+ * @brief Bump allocator whose memory is recycled rather than freed
+ *
+ * Allocations are carved sequentially out of large blocks and are never
+ * freed individually. reset() makes the whole arena reusable in O(1) while
+ * keeping its blocks, so a worker that resets between chunks stops touching
+ * the system allocator once it has seen its largest chunk. Not thread-safe:
+ * each worker owns its own arena.
+ */
+class Arena {
+public:
+  static constexpr size_t DEFAULT_BLOCK_SIZE = 64 * 1024;
+
+  explicit Arena(size_t block_size = DEFAULT_BLOCK_SIZE);
+  ~Arena() = default;
+
+  Arena(const Arena &) = delete;
+  Arena &operator=(const Arena &) = delete;
+  Arena(Arena &&) = default;
+  Arena &operator=(Arena &&) = default;
+
+  /**
+   * @brief Allocate uninitialised memory valid until the next reset()
+   */
+  void *allocate(size_t bytes, size_t alignment = alignof(std::max_align_t));
+
+  /**
+   * @brief Allocate an uninitialised array of trivially destructible T
+   */
+  template <typename T> T *allocateArray(size_t count) {
+    return static_cast<T *>(allocate(sizeof(T) * count, alignof(T)));
+  }
+
+  /**
+   * @brief Copy text into the arena and return a view of the copy
+   */
+  std::string_view copy(std::string_view text);
+
+  /**
+   * @brief Invalidate all allocations but keep the memory for reuse
+   *
+   * If the last cycle spilled into several blocks they are coalesced into one
+   * block large enough for the whole cycle, so steady state is one block.
+   */
+  void reset();
+
+  /**
+   * @brief Return all memory to the system allocator
+   */
+  void release();
+
+  /**
+   * @brief Bytes handed out since the last reset
+   */
+  size_t bytesUsed() const { return used_before_current_ + offset_; }
+
+  /**
+   * @brief Bytes currently held from the system allocator
+   */
+  size_t bytesReserved() const { return reserved_; }
+
+  /**
+   * @brief Number of blocks requested from the system allocator so far
+   */
+  size_t blockAllocations() const { return block_allocations_; }
+
+private:
+  struct Block {
+    std::unique_ptr<char[]> data;
+    size_t size;
+  };
+
+  std::vector<Block> blocks_;
+  size_t block_size_;
+  size_t current_;
+  size_t offset_;
+  size_t used_before_current_;
+  size_t reserved_;
+  size_t block_allocations_;
+
+  void addBlock(size_t min_size);
+};
+
+} // namespace car_sales
+
+#endif // arena_HPP
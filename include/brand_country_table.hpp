@@ -0,0 +1,121 @@
+#ifndef brand_country_table_HPP
+#define brand_country_table_HPP
+
+#include <algorithm>
+#include <cstddef>
+#include <map>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace car_sales {
+
+/**
+ * @brief One Summary per (manufacturer, country) pair
+ *
+ * The shared storage behind DistinctCounter and PriceQuantiles. Summary is
+ * a mergeable sketch: copyable, with merge(const Summary &). Workers each
+ * fill their own table and merge() them pair by pair at the end.
+ */
+template <typename Summary> class BrandCountryTable {
+public:
+  /**
+   * @brief The summary of (brand, country), made by make() on first use
+   */
+  template <typename Make>
+  Summary &find(std::string_view brand, std::string_view country,
+                Make &&make) {
+    // assign() reuses the scratch key's capacity, so lookups do not allocate
+    scratch_key_.assign(brand);
+    scratch_key_.push_back(KEY_SEPARATOR);
+    scratch_key_.append(country);
+    auto found = summaries_.find(scratch_key_);
+    if (found == summaries_.end()) {
+      found = summaries_.emplace(scratch_key_, make()).first;
+    }
+    return found->second;
+  }
+
+  void merge(const BrandCountryTable &other) {
+    for (const auto &[key, summary] : other.summaries_) {
+      auto found = summaries_.find(key);
+      if (found == summaries_.end()) {
+        summaries_.emplace(key, summary);
+      } else {
+        found->second.merge(summary);
+      }
+    }
+  }
+
+  /**
+   * @brief Call visit(brand, country, summary) for every pair, in hash order
+   */
+  template <typename Visit> void forEach(Visit &&visit) const {
+    for (const auto &[key, summary] : summaries_) {
+      size_t split = key.find(KEY_SEPARATOR);
+      visit(key.substr(0, split), key.substr(split + 1), summary);
+    }
+  }
+
+  /**
+   * @brief Per-brand merge of the pairs whose country include() accepts
+   *
+   * Pairs are merged in key order, so the result never depends on hash
+   * order, even for summaries whose merge is not commutative.
+   */
+  template <typename Include>
+  std::map<std::string, Summary> rollUp(Include &&include) const {
+    std::vector<const std::string *> keys;
+    keys.reserve(summaries_.size());
+    for (const auto &entry : summaries_) {
+      keys.push_back(&entry.first);
+    }
+    std::sort(keys.begin(), keys.end(),
+              [](const std::string *a, const std::string *b) {
+                return *a < *b;
+              });
+
+    std::map<std::string, Summary> brands;
+    for (const std::string *key : keys) {
+      size_t split = key->find(KEY_SEPARATOR);
+      if (!include(std::string_view(*key).substr(split + 1))) {
+        continue;
+      }
+      const Summary &summary = summaries_.at(*key);
+      std::string brand = key->substr(0, split);
+      auto found = brands.find(brand);
+      if (found == brands.end()) {
+        brands.emplace(std::move(brand), summary);
+      } else {
+        found->second.merge(summary);
+      }
+    }
+    return brands;
+  }
+
+  size_t size() const { return summaries_.size(); }
+
+  /**
+   * @brief Bytes held by the keys (the summaries report their own)
+   */
+  size_t keyBytes() const {
+    size_t total = 0;
+    for (const auto &entry : summaries_) {
+      total += entry.first.capacity();
+    }
+    return total;
+  }
+
+private:
+  // Keyed by brand + KEY_SEPARATOR + country
+  std::unordered_map<std::string, Summary> summaries_;
+  std::string scratch_key_;
+
+  static constexpr char KEY_SEPARATOR = '\x1f';
+};
+
+} // namespace car_sales
+
+#endif // brand_country_table_HPP
@@ -0,0 +1,132 @@
+#ifndef column_store_HPP
+#define column_store_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include "data_parser.hpp"
+
+namespace car_sales {
+
+/**
+ * @brief Column a resident query groups by
+ */
+enum class StoreKey { Brand, Country, Year, Month };
+
+/**
+ * @brief Parse a query key name: brand, country, year or month
+ */
+bool parseStoreKey(std::string_view name, StoreKey &key);
+
+/**
+ * @brief Row filter of a resident query; empty/zero fields match every row
+ */
+struct StoreFilter {
+  std::string brand;
+  std::string country;
+  int year = 0;
+  bool europe = false; // only European countries
+  int64_t min_cents = INT64_MIN; // sale price range, inclusive
+  int64_t max_cents = INT64_MAX;
+};
+
+/**
+ * @brief Headline metrics of a dataset, as printed by a normal run
+ */
+struct StoreSummary {
+  int64_t rows = 0;
+  int64_t audi_china_year_sales = 0;
+  int64_t bmw_year_revenue_cents = 0;
+  std::vector<GroupTotal> bmw_europe; // highest revenue first
+};
+
+/**
+ * @brief A parsed dataset held in memory as columns
+ *
+ * Each accepted row contributes one entry to every column. Manufacturer and
+ * country are dictionary-encoded as small integers, the sale date is kept as
+ * year and month bucket, and revenue as exact cents, so a query
+ * is a scan over a few dense arrays with no string work per row. Filters
+ * run as SIMD kernels (select_kernels.hpp) that narrow a selection vector,
+ * most selective first, and aggregation then touches only the surviving
+ * rows. A store is immutable once loaded and may be queried from any number
+ * of threads.
+ */
+class ColumnStore {
+public:
+  /**
+   * @brief Parse filename and append its rows
+   * @return false (with error set) if the file cannot be read
+   */
+  bool loadFile(const std::string &filename, std::string &error,
+                size_t chunk_size = CsvParser::DEFAULT_CHUNK_SIZE);
+
+  /**
+   * @brief Append parsed records (sale_day must have been decoded)
+   */
+  void append(const CarSaleRecord *begin, const CarSaleRecord *end);
+
+  size_t rows() const { return cents_.size(); }
+  size_t failedRows() const { return failed_rows_; }
+  size_t memoryBytes() const;
+
+  /**
+   * @brief Units and revenue per key over the rows matching filter; brands
+   * and countries by revenue (highest first), years and months in time order
+   */
+  std::vector<GroupTotal> groupBy(StoreKey key, const StoreFilter &filter) const;
+
+  /**
+   * @brief Units and revenue over all rows matching filter (key is empty)
+   */
+  GroupTotal total(const StoreFilter &filter) const;
+
+  /**
+   * @brief Audi/China sales and BMW revenue for year
+   */
+  StoreSummary summary(int year = 2025) const;
+
+private:
+  static constexpr uint16_t NO_CODE = UINT16_MAX;
+
+  std::vector<uint16_t> brand_;
+  std::vector<uint16_t> country_;
+  std::vector<int16_t> year_;
+  std::vector<int32_t> month_; // year * 12 + month - 1, INVALID_DAY if undated
+  std::vector<int64_t> cents_;
+
+  std::vector<std::string> brands_;
+  std::vector<std::string> countries_;
+  std::vector<uint8_t> european_; // per country code
+  std::vector<size_t> brand_rows_;  // per brand code
+  std::vector<size_t> country_rows_; // per country code
+  std::map<int16_t, size_t> year_rows_;
+  std::unordered_map<std::string, uint16_t> brand_codes_;
+  std::unordered_map<std::string, uint16_t> country_codes_;
+  int16_t min_year_ = INT16_MAX;
+  int16_t max_year_ = INT16_MIN;
+  int32_t min_month_ = INT32_MAX;
+  int32_t max_month_ = INT32_MIN;
+  size_t failed_rows_ = 0;
+
+  uint16_t encode(std::unordered_map<std::string, uint16_t> &codes,
+                  std::vector<std::string> &names, const std::string &value);
+  static uint16_t lookup(const std::unordered_map<std::string, uint16_t> &codes,
+                         const std::string &value);
+
+  /**
+   * @brief Rows matching filter, as a selection vector
+   * @return false if filter restricts nothing; every row matches and
+   * selection is left empty
+   */
+  bool select(const StoreFilter &filter, std::vector<uint32_t> &selection) const;
+};
+
+} // namespace car_sales
+
+#endif // column_store_HPP
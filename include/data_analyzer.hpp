@@ -5,12 +5,16 @@
 #include <set>
 #include <string>
 #include <unordered_map>
+#include <utility>
 #include <vector>
 
 #include "data_parser.hpp"
+#include "rolling_window.hpp"
 
 namespace car_sales {
 
+class ResultCache;
+
 /**
  * @brief Analysis result containing all computed metrics
  */
@@ -18,22 +22,94 @@ struct AnalysisResult {
   // Audi sales in China 2025
   int audi_china_year_sales;
 
-  // BMW total revenue 2025
+  // BMW total revenue 2025 (exact cents, and in dollars for display)
+  int64_t bmw_year_total_revenue_cents;
   double bmw_year_total_revenue;
 
   // BMW revenue by European country (sorted highest to lowest)
   std::vector<std::pair<std::string, double>> _bmw_europe_revenuedistribution;
 
+  // Group-by results: the highest-revenue groups and the distinct key count
+  GroupColumn group_by_column;
+  std::vector<GroupTotal> top_groups;
+  size_t group_count;
+  uint64_t group_spill_bytes; // 0 unless --max-memory forced a spill
+
+  // Approximate top keys from the Space-Saving sketch; each estimate is at
+  // most heavy_hitter_max_error above the truth (see HeavyHitter::error)
+  GroupColumn heavy_hitter_column;
+  HeavyHitterMetric heavy_hitter_metric;
+  std::vector<HeavyHitter> heavy_hitters;
+  int64_t heavy_hitter_total;
+  int64_t heavy_hitter_max_error;
+
+  // HyperLogLog distinct counts per manufacturer and country, and per
+  // manufacturer across all European countries; each estimate has a relative
+  // standard error of about distinct_relative_error
+  GroupColumn distinct_column;
+  unsigned distinct_precision;
+  double distinct_relative_error;
+  std::vector<DistinctGroup> distinct_groups;
+  std::vector<DistinctGroup> distinct_europe;
+
+  // KLL sale price sketches per manufacturer and country, and per
+  // manufacturer across Europe; query any quantile with sketch.quantile(q).
+  // Returned ranks are within price_quantile_rank_error of the truth
+  std::vector<QuantileGroup> price_quantile_groups;
+  std::vector<QuantileGroup> price_quantiles_europe;
+  double price_quantile_rank_error;
+
+  // Units and revenue per brand and bucket, ready for charting; rows whose
+  // sale_date has no valid day/month are left out and counted
+  TimeBucket time_bucket;
+  std::vector<SeriesPoint> time_series;
+  int64_t undated_rows;
+
+  // BMW revenue per European country per day with the trailing window sums
+  // (window_cents follows rolling_windows), across every sale year
+  std::vector<uint32_t> rolling_windows;
+  std::vector<RollingPoint> rolling_revenue;
+
+  // Units and revenue per occupied grid cell (in cell order); rows without
+  // valid coordinates are left out and counted
+  double geo_cell_degrees;
+  std::vector<GeoCell> geo_cells;
+  int64_t unlocated_rows;
+
+  // Set by analyzeSample(): the Audi/BMW fields above are then scaled-up
+  // estimates and sample holds their confidence intervals
+  bool approximate;
+  SampleReport sample;
+
   // Processing statistics
   size_t total_records_processed;
   size_t total_records_failed;
+  size_t total_records_filtered; // outside the bounding box
   bool analysis_complete;
   std::vector<std::string> errors;
 
+  // Rejected rows; format with formatParseError() when displaying
+  std::vector<ParseError> parse_errors;
+
+  // Per-stage timings (populated when profiling is enabled)
+  StageProfile profile;
+
+  // Set when analyzeFile() answered from its ResultCache
+  bool from_cache;
+
   AnalysisResult()
-      : audi_china_year_sales(0), bmw_year_total_revenue(0.0),
-        total_records_processed(0), total_records_failed(0),
-        analysis_complete(false) {}
+      : audi_china_year_sales(0), bmw_year_total_revenue_cents(0),
+        bmw_year_total_revenue(0.0), group_by_column(GroupColumn::None),
+        group_count(0), group_spill_bytes(0),
+        heavy_hitter_column(GroupColumn::None),
+        heavy_hitter_metric(HeavyHitterMetric::Units), heavy_hitter_total(0),
+        heavy_hitter_max_error(0), distinct_column(GroupColumn::None),
+        distinct_precision(0), distinct_relative_error(0.0),
+        price_quantile_rank_error(0.0), time_bucket(TimeBucket::None),
+        undated_rows(0), geo_cell_degrees(0.0), unlocated_rows(0),
+        approximate(false), total_records_processed(0),
+        total_records_failed(0), total_records_filtered(0),
+        analysis_complete(false), from_cache(false) {}
 };
 
 /**
@@ -62,6 +138,17 @@ public:
                              bool use_concurrent = true,
                              size_t num_threads = 0);
 
+  /**
+   * @brief Estimate the Audi/BMW metrics from a random sample of blocks
+   * @param filename Path to the CSV file
+   * @param options Sample size, stopping rule and block size
+   * @param num_threads Blocks read in parallel (0 = auto-detect)
+   * @return Scaled-up estimates with approximate set and sample filled in
+   */
+  AnalysisResult analyzeSample(const std::string &filename,
+                               const SampleOptions &options = SampleOptions(),
+                               size_t num_threads = 0);
+
   /**
    * @brief Analyze CSV content from a string (for testing)
    * @param content CSV content as a string
@@ -89,20 +176,166 @@ public:
   /**
    * @brief Get Audi sales count in China for year 2025
    */
-  int getAudiChinaSales2025() const { return _audi_china_year_sales; }
+  int getAudiChinaSales2025() const {
+    return _aggregates.audi_china_year_sales;
+  }
 
   /**
    * @brief Get BMW total revenue for year 2025
    */
-  double getBmw2025Revenue() const { return _bmw_2025_revenue; }
+  double getBmw2025Revenue() const {
+    return centsToDollars(_aggregates.bmw_2025_revenue_cents);
+  }
+
+  /**
+   * @brief Get BMW total revenue for year 2025 in exact cents
+   */
+  int64_t getBmw2025RevenueCents() const {
+    return _aggregates.bmw_2025_revenue_cents;
+  }
 
   /**
    * @brief Get BMW revenue distribution across European countries
-   * @return Vector of country-revenue pairs sorted by revenue (descending)
+   * @return Vector of country-revenue pairs sorted by revenue (descending,
+   * ties by country name so the order is deterministic)
    */
   std::vector<std::pair<std::string, double>>
   getBmwEuropeRevenueDistribution() const;
 
+  /**
+   * @brief Enable per-stage timing for subsequent analyze calls
+   */
+  void setProfilingEnabled(bool enabled) {
+    _parser->setProfilingEnabled(enabled);
+  }
+
+  /**
+   * @brief Sample hardware counters per worker thread for subsequent runs
+   */
+  void setHardwareCountersEnabled(bool enabled) {
+    _parser->setHardwareCountersEnabled(enabled);
+  }
+
+  /**
+   * @brief Stream rejected raw rows to a file (empty path disables)
+   */
+  void setRejectFile(const std::string &path) { _parser->setRejectFile(path); }
+
+  /**
+   * @brief Aggregate count and revenue per value of a column
+   */
+  void setGroupBy(GroupColumn column) { _parser->setGroupBy(column); }
+
+  /**
+   * @brief Number of entries reported in AnalysisResult::top_groups and
+   * AnalysisResult::heavy_hitters
+   */
+  void setGroupByLimit(size_t limit) { _group_limit = limit; }
+
+  /**
+   * @brief Spill group-by state to temp files beyond this many bytes
+   */
+  void setMaxMemory(size_t bytes) { _parser->setMaxMemory(bytes); }
+
+  /**
+   * @brief Estimate the heaviest values of a column in bounded memory
+   */
+  void setHeavyHitters(GroupColumn column, HeavyHitterMetric metric,
+                       size_t capacity = SpaceSavingSketch::DEFAULT_CAPACITY) {
+    _parser->setHeavyHitters(column, metric, capacity);
+  }
+
+  /**
+   * @brief Estimate distinct values of a column (buyer_id, vin, ...) per
+   * manufacturer and country
+   */
+  void setDistinct(GroupColumn column,
+                   unsigned precision = HLL_DEFAULT_PRECISION) {
+    _parser->setDistinct(column, precision);
+  }
+
+  /**
+   * @brief Sketch sale price distributions per manufacturer and country
+   * (k = 0 disables; larger k is more accurate)
+   */
+  void setPriceQuantiles(uint32_t k = KllSketch::DEFAULT_K) {
+    _parser->setPriceQuantiles(k);
+  }
+
+  /**
+   * @brief Build a per-brand series of units and revenue per month or ISO
+   * week
+   */
+  void setTimeSeries(TimeBucket bucket) { _parser->setTimeSeries(bucket); }
+
+  /**
+   * @brief Compute trailing revenue windows of the given widths in days for
+   * BMW in each European country (an empty list disables)
+   */
+  void setRollingWindows(std::vector<uint32_t> windows) {
+    _parser->setRollingRevenue(!windows.empty());
+    _rolling_windows = std::move(windows);
+  }
+
+  /**
+   * @brief Sum units and revenue per latitude/longitude cell of the given
+   * size in degrees (0 disables)
+   */
+  void setGeoGrid(double cell_degrees) { _parser->setGeoGrid(cell_degrees); }
+
+  /**
+   * @brief Analyse only rows located inside box; other rows are dropped
+   * while parsing and reported in total_records_filtered
+   */
+  void setBoundingBox(const BoundingBox &box) { _parser->setBoundingBox(box); }
+
+  /**
+   * @brief Block size, ring depth and O_DIRECT for sequential reads
+   */
+  void setReadAhead(const ReadAheadOptions &options) {
+    _parser->setReadAhead(options);
+  }
+
+  /**
+   * @brief Live per-worker counters the parser publishes to while it runs
+   */
+  void setProgress(std::shared_ptr<ProgressTracker> tracker) {
+    _parser->setProgress(std::move(tracker));
+  }
+
+  /**
+   * @brief Pin concurrent workers to CPUs, optionally NUMA-node-locally
+   */
+  void setWorkerPlacement(WorkerPlacement placement) {
+    _parser->setWorkerPlacement(placement);
+  }
+
+  /**
+   * @brief Topology workers are placed on (empty until a placement is set)
+   */
+  const NumaTopology &getTopology() const { return _parser->getTopology(); }
+
+  /**
+   * @brief Answer analyzeFile() from cache when the file and query match a
+   * stored result, and store complete results (nullptr disables)
+   *
+   * Runs that profile, write a reject file or sketch price quantiles always
+   * parse the file: their side effects or outputs are not cached.
+   */
+  void setResultCache(std::shared_ptr<ResultCache> cache) {
+    _cache = std::move(cache);
+  }
+
+  /**
+   * @brief Hash of every setting that affects AnalysisResult
+   */
+  uint64_t queryFingerprint() const;
+
+  /**
+   * @brief Check if a cache may be used with the current settings
+   */
+  bool cacheable() const;
+
   /**
    * @brief Check if a country is in Europe
    */
@@ -111,17 +344,29 @@ public:
 private:
   std::unique_ptr<CsvParser> _parser;
 
-  // Accumulated metrics
-  int _audi_china_year_sales;
-  double _bmw_2025_revenue;
-  std::unordered_map<std::string, double> _bmw_europe_revenue;
+  // Accumulated metrics, shared with the parser's chunk analysis
+  ChunkResult _aggregates;
+  size_t _group_limit;
+  std::vector<uint32_t> _rolling_windows;
+  std::shared_ptr<ResultCache> _cache;
 
   // Statistics
   size_t _total_records_processed;
   size_t _total_records_failed;
   std::vector<std::string> _errors;
+  std::vector<ParseError> _parse_errors;
+  StageProfile _profile;
 
-  void processRecord(const CarSaleRecord &record);
+  /**
+   * @brief Build the final result, charging the finalisation to Merge
+   */
+  AnalysisResult finalizeResults(const ChunkResult &parse_result);
+
+  /**
+   * @brief analyzeFile() without the cache
+   */
+  AnalysisResult parseAndAnalyze(const std::string &filename,
+                                 bool use_concurrent, size_t num_threads);
 };
 
 } // namespace car_sales
@@ -1,6 +1,9 @@
 #ifndef data__parserH
 #define data__parserH
 
+#include <cmath>
+#include <cstdint>
+#include <limits>
 #include <string>
 #include <vector>
 #include <functional>
@@ -13,6 +16,25 @@
 #include <mutex>
 #include <atomic>
 #include <unordered_map>
+#include <string_view>
+
+#include "arena.hpp"
+#include "fixed_point.hpp"
+#include "geo_grid.hpp"
+#include "group_by.hpp"
+#include "heavy_hitters.hpp"
+#include "hyperloglog.hpp"
+#include "numa_topology.hpp"
+#include "parse_error.hpp"
+#include "progress.hpp"
+#include "quantile_sketch.hpp"
+#include "read_ahead.hpp"
+#include "reject_writer.hpp"
+#include "sampling.hpp"
+#include "schema.hpp"
+#include "stage_profiler.hpp"
+#include "stream_input.hpp"
+#include "time_series.hpp"
 
 namespace car_sales {
 
@@ -25,13 +47,90 @@ struct CarSaleRecord {
   std::string country; // country column
   int year;            // extracted from sale_date (DD-MM-YYYY)
   int quantity;        // 1 per row (each row is one sale)
-  double revenue;      // sale_price_usd column
+  double revenue;      // sale_price_usd column (derived from revenue_cents)
+  int64_t revenue_cents; // sale_price_usd parsed exactly; used for all sums
+  std::string group_key; // value of the group-by column (empty if disabled)
+  std::string heavy_hitter_key; // value of the heavy-hitter column
+  uint64_t distinct_hash; // hash of the distinct-count column
+  int32_t sale_day; // days since 1970-01-01, only decoded for date series
+  double latitude;  // NaN unless decoded for the grid or bounding box
+  double longitude;
 
-  CarSaleRecord() : year(0), quantity(1), revenue(0.0) {}
+  CarSaleRecord()
+      : year(0), quantity(1), revenue(0.0), revenue_cents(0),
+        distinct_hash(0), sale_day(INVALID_DAY),
+        latitude(std::numeric_limits<double>::quiet_NaN()),
+        longitude(std::numeric_limits<double>::quiet_NaN()) {}
   CarSaleRecord(const std::string &_brand, const std::string &_country,
                 int _year, int _quantity, double _revenue)
       : brand(_brand), country(_country), year(_year), quantity(_quantity),
-        revenue(_revenue) {}
+        revenue(_revenue),
+        revenue_cents(static_cast<int64_t>(std::llround(_revenue * 100.0))),
+        distinct_hash(0), sale_day(INVALID_DAY),
+        latitude(std::numeric_limits<double>::quiet_NaN()),
+        longitude(std::numeric_limits<double>::quiet_NaN()) {}
+};
+
+/**
+ * @brief Reusable batch of records
+ *
+ * clear() only resets the count: the CarSaleRecord objects (and the capacity
+ * of their strings) stay alive and are overwritten by the next chunk, so
+ * refilling a batch does not allocate once it has reached chunk size.
+ */
+class RecordBatch {
+public:
+  /**
+   * @brief Slot for the next record (contents are whatever was there before)
+   */
+  CarSaleRecord &next() {
+    if (size_ == records_.size()) {
+      records_.emplace_back();
+    }
+    return records_[size_++];
+  }
+
+  /**
+   * @brief Give back the slot returned by the last next() call
+   */
+  void discardLast() { --size_; }
+
+  void clear() { size_ = 0; }
+  void reserve(size_t n) { records_.reserve(n); }
+  size_t size() const { return size_; }
+  bool empty() const { return size_ == 0; }
+
+  const CarSaleRecord *begin() const { return records_.data(); }
+  const CarSaleRecord *end() const { return records_.data() + size_; }
+
+  /**
+   * @brief The records as a vector, for a ChunkProcessor
+   *
+   * Spare slots past size() are dropped first. A full batch has none, so
+   * only the final, partial chunk of a parse gives up any capacity.
+   */
+  const std::vector<CarSaleRecord> &records() {
+    records_.resize(size_);
+    return records_;
+  }
+
+private:
+  std::vector<CarSaleRecord> records_;
+  size_t size_ = 0;
+};
+
+/**
+ * @brief Per-worker scratch state reused across chunks and parse calls
+ *
+ * Tokenized fields are views into the input line; fields that need
+ * unquoting are materialised in the arena. The arena is reset between
+ * chunks, never freed, so allocator traffic disappears after warm-up.
+ */
+struct ParseWorkspace {
+  Arena arena;
+  std::vector<std::string_view> fields;
+  RecordBatch batch;
+  std::string input; // the worker's own byte range (WorkerPlacement::Numa)
 };
 
 /**
@@ -54,17 +153,51 @@ private:
 struct ChunkResult {
   size_t records_processed;
   size_t records_failed;
+  size_t records_filtered; // dropped by the bounding box, not failures
   std::vector<std::string> errors;
   bool success;
 
-  // Partial aggregation results for concurrent processing
+  // Structured detail for rejected rows (capped at MAX_STORED_PARSE_ERRORS)
+  std::vector<ParseError> parse_errors;
+
+  // Physical lines consumed, used to rebase line numbers of parallel ranges
+  size_t lines_scanned;
+
+  // Partial aggregation results for concurrent processing. Revenue is kept
+  // in integer cents so totals do not depend on how rows were split
   int audi_china_year_sales;
-  double bmw_2025_revenue;
-  std::unordered_map<std::string, double> bmw_europe_revenue;
+  int64_t bmw_2025_revenue_cents;
+  std::unordered_map<std::string, int64_t> bmw_europe_revenue_cents;
+
+  // Per-key aggregates when a group-by column is configured
+  GroupByAggregator group_by;
+
+  // Approximate top-K keys when heavy hitters are configured
+  SpaceSavingSketch heavy_hitters;
+  HeavyHitterMetric heavy_hitter_metric = HeavyHitterMetric::Units;
+
+  // Distinct values per manufacturer and country when configured
+  DistinctCounter distinct;
+
+  // Sale price distribution per manufacturer and country when configured
+  PriceQuantiles price_quantiles;
+
+  // Units and revenue per brand and time bucket when configured
+  TimeSeriesAggregator time_series;
+
+  // Daily BMW revenue per European country, the input of rolling windows
+  TimeSeriesAggregator rolling_daily;
+
+  // Units and revenue per latitude/longitude cell when configured
+  GeoGrid geo_grid;
+
+  // Per-stage timings (only populated when profiling is enabled)
+  StageProfile profile;
 
   ChunkResult()
-      : records_processed(0), records_failed(0), success(true),
-        audi_china_year_sales(0), bmw_2025_revenue(0.0) {}
+      : records_processed(0), records_failed(0), records_filtered(0),
+        success(true),
+        lines_scanned(0), audi_china_year_sales(0), bmw_2025_revenue_cents(0) {}
 };
 
 /**
@@ -83,6 +216,16 @@ class CsvParser {
 public:
   static constexpr size_t DEFAULT_CHUNK_SIZE = 10000;
 
+  /**
+   * @brief Bump whenever the same input and options can parse differently;
+   * cached results carry it and are discarded on a mismatch
+   *
+   * 2: quoted fields may span lines and "" is a literal quote
+   * 3: columns are bound by header name
+   * 4: sale dates outside MIN_SALE_YEAR..MAX_SALE_YEAR are undated
+   */
+  static constexpr uint64_t PARSE_SEMANTICS_VERSION = 4;
+
   explicit CsvParser(size_t chunk_size = DEFAULT_CHUNK_SIZE,
                      char delimiter = '\t');
   ~CsvParser() = default;
@@ -113,6 +256,41 @@ public:
   ChunkResult parseFileConcurrent(const std::string &filename,
                                   size_t num_threads = 0);
 
+  /**
+   * @brief parseFile() over an open descriptor, e.g. stdin or a pipe; fd is
+   * not closed. parseFile() itself also reads "-" as stdin.
+   */
+  ChunkResult parseDescriptor(int fd, ChunkProcessor processor);
+
+  /**
+   * @brief parseFileConcurrent() over an open descriptor (not closed)
+   *
+   * The input is read once, front to back, and never spooled: it is cut
+   * into record-aligned segments as it arrives and whichever worker is
+   * free parses the next one, with a bounded number of segments in flight.
+   * parseFileConcurrent() takes this path for "-" and for names that are
+   * not regular files (pipes, FIFOs, /dev/fd/N).
+   */
+  ChunkResult parseDescriptorConcurrent(int fd, size_t num_threads = 0);
+
+  /**
+   * @brief Estimate the Audi/BMW metrics from a random sample of the file
+   *
+   * The input is cut into options.block_bytes blocks, each aligned to
+   * newlines, and blocks are read in a seeded random order (num_threads at a
+   * time) until the confidence intervals of the Audi sales and BMW revenue
+   * totals reach options.target_error or options.max_fraction of the blocks
+   * has been read. Blocks are consumed in sampling order, so where the run
+   * stops does not depend on the thread count.
+   *
+   * @return Scaled-up estimates in the usual fields; records_processed and
+   * records_failed count the sampled rows only. Other configured aggregates
+   * (group-by, sketches) are not estimated.
+   */
+  ChunkResult sampleFile(const std::string &filename,
+                         const SampleOptions &options, SampleReport &report,
+                         size_t num_threads = 0);
+
   /**
    * @brief Parse a single line into a CarSaleRecord
    * @param line The CSV line to parse
@@ -153,30 +331,424 @@ public:
    */
   size_t getTotalRecordsProcessed() const { return _total_records_processed; }
 
+  /**
+   * @brief Enable per-stage timing; results land in ChunkResult::profile
+   */
+  void setProfilingEnabled(bool enabled) { profiling_enabled_ = enabled; }
+
+  /**
+   * @brief Check whether per-stage timing is enabled
+   */
+  bool isProfilingEnabled() const { return profiling_enabled_; }
+
+  /**
+   * @brief Sample hardware counters (perf_event_open) per thread and stage;
+   * results land in ChunkResult::profile.hardware
+   */
+  void setHardwareCountersEnabled(bool enabled) {
+    hardware_counters_enabled_ = enabled;
+  }
+
+  /**
+   * @brief Check whether hardware counter sampling is enabled
+   */
+  bool isHardwareCountersEnabled() const { return hardware_counters_enabled_; }
+
+  /**
+   * @brief Stream every rejected raw line to this file (empty = disabled)
+   *
+   * The file starts with the input's header line, so it can be fixed up and
+   * fed back in. Writing happens on a background thread.
+   */
+  void setRejectFile(const std::string &path) { reject_file_path_ = path; }
+
+  /**
+   * @brief Get the configured reject file path
+   */
+  const std::string &getRejectFile() const { return reject_file_path_; }
+
+  /**
+   * @brief Aggregate count and revenue per value of this column
+   * (GroupColumn::None disables); results land in ChunkResult::group_by
+   */
+  void setGroupBy(GroupColumn column) { group_by_ = column; }
+
+  /**
+   * @brief Get the configured group-by column
+   */
+  GroupColumn getGroupBy() const { return group_by_; }
+
+  /**
+   * @brief Bound group-by table memory (bytes, 0 = unbounded)
+   *
+   * The budget is split evenly between workers. A worker over its share
+   * spills its partitions to temp files; they are re-aggregated partition
+   * by partition when the result is summarised.
+   */
+  void setMaxMemory(size_t bytes) { max_memory_ = bytes; }
+
+  /**
+   * @brief Get the group-by memory budget
+   */
+  size_t getMaxMemory() const { return max_memory_; }
+
+  /**
+   * @brief Track the heaviest values of a column in a Space-Saving sketch
+   * of capacity counters per worker (GroupColumn::None disables)
+   */
+  void setHeavyHitters(GroupColumn column, HeavyHitterMetric metric,
+                       size_t capacity = SpaceSavingSketch::DEFAULT_CAPACITY) {
+    heavy_hitter_column_ = column;
+    heavy_hitter_metric_ = metric;
+    heavy_hitter_capacity_ = capacity;
+  }
+
+  GroupColumn getHeavyHitterColumn() const { return heavy_hitter_column_; }
+  HeavyHitterMetric getHeavyHitterMetric() const {
+    return heavy_hitter_metric_;
+  }
+  size_t getHeavyHitterCapacity() const { return heavy_hitter_capacity_; }
+
+  /**
+   * @brief Empty sketch configured like this parser's workers use
+   */
+  SpaceSavingSketch makeHeavyHitterSketch() const;
+
+  /**
+   * @brief Estimate distinct values of a column per manufacturer and
+   * country with HyperLogLog sketches of 2^precision registers
+   * (GroupColumn::None disables)
+   */
+  void setDistinct(GroupColumn column,
+                   unsigned precision = HLL_DEFAULT_PRECISION) {
+    distinct_column_ = column;
+    distinct_precision_ = precision;
+  }
+
+  GroupColumn getDistinctColumn() const { return distinct_column_; }
+  unsigned getDistinctPrecision() const { return distinct_precision_; }
+
+  /**
+   * @brief Empty distinct counter configured like this parser's workers use
+   */
+  DistinctCounter makeDistinctCounter() const;
+
+  /**
+   * @brief Sketch sale prices per manufacturer and country with KLL
+   * sketches of parameter k (0 disables)
+   */
+  void setPriceQuantiles(uint32_t k) { price_quantile_k_ = k; }
+
+  uint32_t getPriceQuantileK() const { return price_quantile_k_; }
+
+  /**
+   * @brief Empty price aggregator configured like this parser's workers use
+   */
+  PriceQuantiles makePriceQuantiles() const;
+
+  /**
+   * @brief Accumulate units and revenue per brand and month or ISO week
+   * (TimeBucket::None disables); results land in ChunkResult::time_series
+   */
+  void setTimeSeries(TimeBucket bucket) { time_bucket_ = bucket; }
+
+  TimeBucket getTimeSeries() const { return time_bucket_; }
+
+  /**
+   * @brief Accumulate daily BMW revenue per European country for rolling
+   * windows; results land in ChunkResult::rolling_daily
+   */
+  void setRollingRevenue(bool enabled) { rolling_revenue_ = enabled; }
+
+  bool getRollingRevenue() const { return rolling_revenue_; }
+
+  /**
+   * @brief Decode CarSaleRecord::sale_day for every row even when no date
+   * series is configured (for callers that keep the records)
+   */
+  void setDecodeSaleDay(bool enabled) { decode_sale_day_ = enabled; }
+
+  /**
+   * @brief Sum units and revenue per grid cell of the given size in degrees
+   * (0 disables); results land in ChunkResult::geo_grid
+   */
+  void setGeoGrid(double cell_degrees) { geo_cell_degrees_ = cell_degrees; }
+
+  double getGeoGrid() const { return geo_cell_degrees_; }
+
+  /**
+   * @brief Empty grid configured like this parser's workers use
+   * @throws std::invalid_argument for a size GeoGrid does not accept
+   */
+  GeoGrid makeGeoGrid() const;
+
+  /**
+   * @brief Keep only rows whose latitude/longitude lie inside box
+   *
+   * The test runs right after a row is split, before any other field is
+   * validated or copied, so rows outside the box (or without coordinates)
+   * cost no more than tokenising. They are counted in records_filtered and
+   * affect no metric.
+   */
+  void setBoundingBox(const BoundingBox &box) {
+    bounding_box_ = box;
+    has_bounding_box_ = true;
+  }
+
+  void clearBoundingBox() { has_bounding_box_ = false; }
+
+  bool hasBoundingBox() const { return has_bounding_box_; }
+  const BoundingBox &getBoundingBox() const { return bounding_box_; }
+
+  /**
+   * @brief Block size, ring depth and O_DIRECT for parseFile()
+   */
+  void setReadAhead(const ReadAheadOptions &options) { read_ahead_ = options; }
+
+  const ReadAheadOptions &getReadAhead() const { return read_ahead_; }
+
+  /**
+   * @brief Publish live bytes, rows and failures to tracker while parsing
+   *
+   * parseFileConcurrent() worker i writes slot i, the sequential path slot
+   * 0; workers beyond the tracker's slots do not report. nullptr disables.
+   */
+  void setProgress(std::shared_ptr<ProgressTracker> tracker) {
+    progress_ = std::move(tracker);
+  }
+
+  const std::shared_ptr<ProgressTracker> &getProgress() const {
+    return progress_;
+  }
+
+  /**
+   * @brief Pin parseFileConcurrent() workers to CPUs, optionally keeping
+   * their input and merge work on their NUMA node
+   *
+   * The topology is discovered on first use unless setTopology() gave one.
+   * Results are the same for every placement.
+   */
+  void setWorkerPlacement(WorkerPlacement placement) {
+    placement_ = placement;
+    if (placement_ != WorkerPlacement::None && topology_.empty()) {
+      topology_ = NumaTopology::discover();
+    }
+  }
+
+  WorkerPlacement getWorkerPlacement() const { return placement_; }
+
+  /**
+   * @brief Use this topology instead of the discovered one
+   */
+  void setTopology(NumaTopology topology) { topology_ = std::move(topology); }
+
+  const NumaTopology &getTopology() const { return topology_; }
+
+  /**
+   * @brief Column positions rows are read with
+   *
+   * Bound from the header row at the start of every parse (see
+   * Schema::fromHeader); a parse fails up front if the header lacks a
+   * column the configured analysis needs. parseLine() uses the last schema
+   * bound, initially the data.csv layout.
+   */
+  const Schema &getSchema() const { return schema_; }
+
+  /**
+   * @brief Accumulate the analysis metrics of records [begin, end)
+   *
+   * Revenue is summed in integer cents with branch-free masked adds. On
+   * int64 overflow the result is marked failed rather than wrapping. Group-by
+   * state is spilled afterwards if it has outgrown its budget.
+   */
+  static void processChunkAnalysis(const CarSaleRecord *begin,
+                                   const CarSaleRecord *end,
+                                   ChunkResult &result);
+
 private:
   size_t chunk_size_;
   size_t _total_records_processed;
   char delimiter_;
+  bool profiling_enabled_;
+  bool hardware_counters_enabled_;
+  std::string reject_file_path_;
+  GroupColumn group_by_;
+  size_t max_memory_;
+  GroupColumn heavy_hitter_column_;
+  HeavyHitterMetric heavy_hitter_metric_;
+  size_t heavy_hitter_capacity_;
+  GroupColumn distinct_column_;
+  unsigned distinct_precision_;
+  uint32_t price_quantile_k_;
+  TimeBucket time_bucket_;
+  bool rolling_revenue_;
+  bool decode_sale_day_;
+  double geo_cell_degrees_;
+  BoundingBox bounding_box_;
+  bool has_bounding_box_;
+  WorkerPlacement placement_;
+  NumaTopology topology_;
+  ReadAheadOptions read_ahead_;
+  std::shared_ptr<ProgressTracker> progress_;
+
+  // Row layout bound from the header (see applySchema)
+  Schema schema_;
+  bool standard_layout_; // schema_.isStandard(): use the compile-time parser
+  size_t min_fields_;    // rows with fewer fields are rejected
+  size_t max_fields_;    // tokenising stops after this many fields
+  int group_key_index_;  // field of each key column, -1 if disabled
+  int heavy_hitter_key_index_;
+  int distinct_key_index_;
 
-  std::vector<std::string> splitLine(const std::string &line, char delimiter);
-  std::string trim(const std::string &str);
-  bool isNumeric(const std::string &str);
+  /**
+   * @brief A newline-aligned slice of the input handed to one worker
+   */
+  struct RangeTask {
+    std::string_view data;
+    uint64_t base_offset; // offset of data[0] in the whole input
+    size_t thread_index;
+    size_t group_budget; // this worker's share of max_memory_
+    std::shared_ptr<GroupSpill> spill;
+  };
+
+  /**
+   * @brief Shared chunk loop behind parseFile and parseString
+   */
+  void parseStream(LineReader &in, ChunkProcessor &processor,
+                   ChunkResult &overall_result, bool detailed_errors);
+
+
+  // Worker scratch state, kept across calls (index 0 is the sequential path)
+  std::vector<std::unique_ptr<ParseWorkspace>> workspaces_;
+  std::unique_ptr<ParseWorkspace> line_workspace_;
+
+  // Whole-file buffer for the concurrent path, reused across calls
+  std::string input_buffer_;
+
+  /**
+   * @brief Get (creating on first use) the workspace for a worker
+   */
+  ParseWorkspace &workspace(size_t index);
+
+  /**
+   * @brief Split a line into ws.fields (views; unquoted copies in ws.arena),
+   * stopping after max_fields fields
+   */
+  static void splitLine(std::string_view line, char delimiter,
+                        ParseWorkspace &ws,
+                        size_t max_fields = std::numeric_limits<size_t>::max());
+  static std::string_view trim(std::string_view str);
 
   /**
    * @brief Extract year from date string in DD-MM-YYYY format
    */
-  int extractYearFromDate(const std::string &date_str);
+  static int extractYearFromDate(std::string_view date_str);
 
   /**
-   * @brief Process a single chunk and update partial results
+   * @brief Parse one line into an existing record slot
+   * @param tick_scale The row's StageProfile::rowTickScale()
+   * @return ParseErrorCode::None on success, otherwise why it was rejected
    */
-  static void processChunkAnalysis(const std::vector<CarSaleRecord> &chunk,
-                                   ChunkResult &result);
+  ParseErrorCode parseRecordInto(std::string_view line, ParseWorkspace &ws,
+                                 CarSaleRecord &record, StageProfile *profile,
+                                 uint64_t tick_scale) const;
+
+  /**
+   * @brief Fill a record from split fields at the positions Layout gives;
+   * instantiated for the compile-time data.csv layout and for a bound one
+   */
+  template <class Layout>
+  ParseErrorCode bindFields(const Layout &layout,
+                            const std::vector<std::string_view> &fields,
+                            CarSaleRecord &record) const;
+
+  /**
+   * @brief Bind the schema named by a header row
+   * @return false (with result failed) if a needed column is missing
+   */
+  bool bindSchema(std::string_view header, ChunkResult &result);
+
+  /**
+   * @brief Make schema current and derive the field positions the
+   * configured analysis reads
+   */
+  void applySchema(const Schema &schema);
+
+  /**
+   * @brief Error record whose column follows the bound schema
+   */
+  ParseError rowError(uint64_t byte_offset, uint64_t line,
+                      ParseErrorCode code) const;
+
+  /**
+   * @brief Open the reject file writer if one is configured
+   */
+  std::unique_ptr<RejectFileWriter> openRejectFile(ChunkResult &result) const;
+
+  /**
+   * @brief Lines and stored errors of one stream segment, so its line
+   * numbers can be rebased once every earlier segment is counted
+   */
+  struct SegmentLines {
+    size_t index;
+    uint64_t lines;
+    size_t first_error; // its errors in the worker's parse_errors
+    size_t errors;
+  };
+
+  /**
+   * @brief Parse and analyse one byte range on a worker thread or, given
+   * segments, every stream segment the worker pops from the queue
+   */
+  ChunkResult parseRange(const RangeTask &task, ParseWorkspace &ws,
+                         RejectFileWriter *rejects,
+                         StreamSegmentQueue *segments = nullptr,
+                         std::vector<SegmentLines> *segment_lines = nullptr) const;
+
+  /**
+   * @brief Sequential parse of an opened reader (parseFile and
+   * parseDescriptor); name labels errors
+   */
+  ChunkResult parseReader(ReadAheadReader &reader, ChunkProcessor &processor,
+                          const std::string &name);
+
+  /**
+   * @brief Concurrent parse of a stream (parseDescriptorConcurrent)
+   */
+  ChunkResult parseStreamConcurrent(ReadAheadReader &reader,
+                                    const std::string &name,
+                                    size_t num_threads);
 
   /**
    * @brief Merge partial results from multiple threads
    */
   static void mergeResults(ChunkResult &target, const ChunkResult &source);
+
+  /**
+   * @brief Merge per-range partials with a fixed-shape pairwise tree
+   *
+   * The tree depends only on the number of partials, never on completion
+   * order, so the merged result is reproducible run to run.
+   */
+  static void reducePartials(std::vector<ChunkResult> &partials,
+                             ChunkResult &target, StageProfile *profile);
+
+  /**
+   * @brief Merge the group-by partitions of all partials into the first
+   *
+   * Partitions are independent, so they are spread over num_threads workers
+   * with no locking; within a partition, partials are folded in range order.
+   */
+  static void mergeGroupPartitions(std::vector<ChunkResult> &partials,
+                                   size_t num_threads, StageProfile *profile);
+
+  /**
+   * @brief Merge each node's contiguous run of partials on that node,
+   * leaving one partial per node (in node order) for the global merge
+   */
+  static void mergeByNode(std::vector<ChunkResult> &partials,
+                          const std::vector<CpuSlot> &slots,
+                          const NumaTopology &topology);
 };
 
 } // namespace car_sales
@@ -0,0 +1,116 @@
+#ifndef fixed_point_HPP
+#define fixed_point_HPP
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+namespace car_sales {
+
+/**
+ * @brief Largest accepted sale price in cents (USD 10 billion)
+ *
+ * Bounding single values keeps block sums of up to CENTS_BLOCK_ROWS rows far
+ * inside int64, so the inner accumulation loop needs no overflow checks.
+ */
+constexpr int64_t MAX_PRICE_CENTS = 1000000000000LL;
+
+/**
+ * @brief Rows summed in plain int64 before a checked add into the total
+ */
+constexpr size_t CENTS_BLOCK_ROWS = 1024;
+
+/**
+ * @brief Parse a decimal string ("-123.456", "+7", ".5") into whole cents
+ *
+ * Digits past the second decimal are rounded half away from zero. Returns
+ * false for anything that is not a plain decimal number or whose magnitude
+ * exceeds MAX_PRICE_CENTS.
+ */
+inline bool parseCents(std::string_view text, int64_t &cents) {
+  size_t i = 0;
+  bool negative = false;
+  if (i < text.size() && (text[i] == '-' || text[i] == '+')) {
+    negative = text[i] == '-';
+    ++i;
+  }
+
+  int64_t whole = 0;
+  size_t digits = 0;
+  for (; i < text.size() && text[i] >= '0' && text[i] <= '9'; ++i, ++digits) {
+    whole = whole * 10 + (text[i] - '0');
+    if (whole > MAX_PRICE_CENTS / 100) {
+      return false;
+    }
+  }
+
+  int64_t fraction = 0;
+  if (i < text.size() && text[i] == '.') {
+    ++i;
+    size_t fraction_digits = 0;
+    bool round_up = false;
+    for (; i < text.size() && text[i] >= '0' && text[i] <= '9'; ++i) {
+      if (fraction_digits < 2) {
+        fraction = fraction * 10 + (text[i] - '0');
+      } else if (fraction_digits == 2) {
+        round_up = text[i] >= '5';
+      }
+      ++fraction_digits;
+    }
+    if (fraction_digits == 1) {
+      fraction *= 10;
+    }
+    fraction += round_up ? 1 : 0;
+    digits += fraction_digits;
+  }
+
+  if (i != text.size() || digits == 0) {
+    return false;
+  }
+
+  int64_t value = whole * 100 + fraction;
+  if (value > MAX_PRICE_CENTS) {
+    return false;
+  }
+  cents = negative ? -value : value;
+  return true;
+}
+
+/**
+ * @brief Convert cents to dollars (exact for |cents| < 2^53)
+ */
+inline double centsToDollars(int64_t cents) {
+  return static_cast<double>(cents) / 100.0;
+}
+
+/**
+ * @brief Add with overflow detection
+ * @return false (leaving total unchanged) if the sum does not fit in int64
+ */
+inline bool addCents(int64_t &total, int64_t value) {
+  int64_t sum;
+  if (__builtin_add_overflow(total, value, &sum)) {
+    return false;
+  }
+  total = sum;
+  return true;
+}
+
+/**
+ * @brief Exact "1234.56" rendering of a cents amount
+ */
+inline std::string formatCents(int64_t cents) {
+  bool negative = cents < 0;
+  uint64_t magnitude = negative ? 0 - static_cast<uint64_t>(cents)
+                                : static_cast<uint64_t>(cents);
+  std::string text = std::to_string(magnitude / 100);
+  uint64_t fraction = magnitude % 100;
+  text += '.';
+  text += static_cast<char>('0' + fraction / 10);
+  text += static_cast<char>('0' + fraction % 10);
+  return negative ? "-" + text : text;
+}
+
+} // namespace car_sales
+
+#endif // fixed_point_HPP
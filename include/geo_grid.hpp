@@ -0,0 +1,115 @@
+#ifndef geo_grid_HPP
+#define geo_grid_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace car_sales {
+
+/**
+ * @brief Parse a latitude or longitude field
+ * @return false unless the whole text is a number within +/- limit
+ */
+bool parseCoordinate(std::string_view text, double limit, double &value);
+
+/**
+ * @brief Latitude/longitude rectangle, edges included
+ */
+struct BoundingBox {
+  double min_lat = -90.0;
+  double min_lon = -180.0;
+  double max_lat = 90.0;
+  double max_lon = 180.0;
+
+  bool contains(double lat, double lon) const {
+    return lat >= min_lat && lat <= max_lat && lon >= min_lon &&
+           lon <= max_lon;
+  }
+};
+
+/**
+ * @brief Parse "min_lat,min_lon,max_lat,max_lon"
+ */
+bool parseBoundingBox(std::string_view text, BoundingBox &box);
+
+/**
+ * @brief Sales and revenue of one grid cell; lat/lon is its south-west
+ * corner
+ */
+struct GeoCell {
+  uint32_t cell;
+  double lat;
+  double lon;
+  int64_t units;
+  int64_t revenue_cents;
+};
+
+/**
+ * @brief Units and revenue per cell of a fixed latitude/longitude grid
+ *
+ * Cells are cell_degrees on each side, numbered row-major from (-90, -180).
+ * cellsOf() maps a block of coordinates to cell numbers in one branch-free
+ * loop the compiler can vectorise; the per-cell sums live in a sparse map,
+ * so only occupied cells cost memory and merging adds matching cells.
+ * A default-constructed grid is disabled.
+ */
+class GeoGrid {
+public:
+  static constexpr double MIN_CELL_DEGREES = 0.01;
+  static constexpr double MAX_CELL_DEGREES = 90.0;
+
+  GeoGrid() = default;
+
+  /**
+   * @throws std::invalid_argument unless cell_degrees is within
+   * [MIN_CELL_DEGREES, MAX_CELL_DEGREES]
+   */
+  explicit GeoGrid(double cell_degrees);
+
+  bool enabled() const { return cell_degrees_ > 0.0; }
+  double cellDegrees() const { return cell_degrees_; }
+
+  /**
+   * @brief Cell numbers of n coordinates, which must lie within +/-90 and
+   * +/-180 degrees
+   */
+  void cellsOf(const double *lat, const double *lon, size_t n,
+               uint32_t *cells) const;
+
+  void add(uint32_t cell, int64_t units, int64_t revenue_cents);
+
+  /**
+   * @brief Count a row without usable coordinates
+   */
+  void addUnlocated() { ++unlocated_rows_; }
+
+  void merge(const GeoGrid &other);
+
+  /**
+   * @brief Occupied cells in cell order
+   */
+  std::vector<GeoCell> cells() const;
+
+  size_t occupiedCells() const { return cells_.size(); }
+  int64_t unlocatedRows() const { return unlocated_rows_; }
+
+private:
+  struct Totals {
+    int64_t units = 0;
+    int64_t revenue_cents = 0;
+  };
+
+  double cell_degrees_ = 0.0;
+  double inverse_ = 0.0; // cells per degree
+  uint32_t rows_ = 0;
+  uint32_t columns_ = 0;
+  std::unordered_map<uint32_t, Totals> cells_;
+  int64_t unlocated_rows_ = 0;
+};
+
+} // namespace car_sales
+
+#endif // geo_grid_HPP
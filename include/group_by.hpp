@@ -0,0 +1,169 @@
+#ifndef group_by_HPP
+#define group_by_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "agg_hash_table.hpp"
+#include "group_spill.hpp"
+
+namespace car_sales {
+
+/**
+ * @brief Columns that can be used as a group-by key
+ */
+enum class GroupColumn {
+  None,
+  Country,
+  Manufacturer,
+  Model,
+  DealershipId,
+  SalespersonId,
+  BuyerId,
+  Vin
+};
+
+/**
+ * @brief Command-line name of a column ("dealership_id", ...)
+ */
+const char *groupColumnName(GroupColumn column);
+
+/**
+ * @brief 0-based field index of a column in the data file (-1 for None)
+ */
+int groupColumnIndex(GroupColumn column);
+
+/**
+ * @brief Parse a command-line column name
+ * @return false if the name is not a supported group-by column
+ */
+bool parseGroupColumn(std::string_view name, GroupColumn &column);
+
+/**
+ * @brief Final aggregate of one group
+ */
+struct GroupTotal {
+  std::string key;
+  int64_t count;
+  int64_t revenue_cents;
+};
+
+/**
+ * @brief log2 of the number of radix partitions
+ */
+constexpr size_t GROUP_RADIX_BITS = 6;
+constexpr size_t GROUP_PARTITIONS = size_t(1) << GROUP_RADIX_BITS;
+static_assert(GROUP_PARTITIONS == SPILL_PARTITIONS,
+              "spill files map one-to-one onto partitions");
+
+/**
+ * @brief Final group-by output: the top groups and the distinct key count
+ */
+struct GroupSummary {
+  std::vector<GroupTotal> top;
+  size_t distinct_keys = 0;
+  uint64_t spilled_bytes = 0;
+};
+
+/**
+ * @brief Per-thread group-by state, radix-partitioned by key hash
+ *
+ * A key's partition is the top GROUP_RADIX_BITS of its hash, so the same key
+ * lands in the same partition on every thread. Partition p of all threads
+ * can then be merged independently of every other partition, which lets the
+ * final merge run in parallel with no shared state. Each partition is small
+ * enough to stay cache resident while it is being built or merged.
+ *
+ * With a memory budget, partitions are written to a GroupSpill and emptied
+ * whenever the tables outgrow the budget; summarize() then re-aggregates one
+ * partition at a time, so peak memory is bounded by the largest partition
+ * rather than by the number of distinct keys.
+ *
+ * A default-constructed aggregator is disabled and costs nothing to copy.
+ */
+class GroupByAggregator {
+public:
+  GroupByAggregator() = default;
+
+  /**
+   * @brief Allocate the partitions; add() may only be called afterwards
+   * @param memory_budget Bytes of table memory before spilling (0 = none)
+   * @param spill Where to spill; required when memory_budget is set
+   */
+  void enable(size_t memory_budget = 0,
+              std::shared_ptr<GroupSpill> spill = nullptr);
+
+  bool enabled() const { return !partitions_.empty(); }
+
+  static size_t partitionOf(uint64_t hash) {
+    return static_cast<size_t>(hash >> (64 - GROUP_RADIX_BITS));
+  }
+
+  /**
+   * @brief Add one row's count and revenue to its group
+   */
+  void add(std::string_view key, int64_t count, int64_t revenue_cents) {
+    uint64_t hash = hashBytes(key);
+    partitions_[partitionOf(hash)].add(key, hash, count, revenue_cents);
+  }
+
+  AggHashTable &partition(size_t index) { return partitions_[index]; }
+  const AggHashTable &partition(size_t index) const {
+    return partitions_[index];
+  }
+
+  /**
+   * @brief Spill every partition and free the tables if over budget
+   * @return true if a spill happened
+   */
+  bool spillIfOverBudget();
+
+  /**
+   * @brief Fold other into this aggregator, partition by partition
+   */
+  void merge(const GroupByAggregator &other);
+
+  /**
+   * @brief Whether any state lives in spill files
+   */
+  bool spilled() const { return spill_ && spill_->spillCount() > 0; }
+
+  const std::shared_ptr<GroupSpill> &spillStore() const { return spill_; }
+
+  /**
+   * @brief Number of distinct keys across all partitions
+   */
+  size_t distinctKeys() const;
+
+  /**
+   * @brief Bytes held by all partitions
+   */
+  size_t memoryBytes() const;
+
+  /**
+   * @brief The limit groups with the highest revenue (ties by key), from
+   * in-memory state only
+   */
+  std::vector<GroupTotal> top(size_t limit) const;
+
+  /**
+   * @brief Top groups and distinct count including spilled state
+   *
+   * Spilled partitions are rebuilt one at a time on up to num_threads
+   * workers; only each partition's top candidates are kept.
+   */
+  GroupSummary summarize(size_t limit, size_t num_threads) const;
+
+private:
+  std::vector<AggHashTable> partitions_;
+  size_t memory_budget_ = 0;
+  std::shared_ptr<GroupSpill> spill_;
+};
+
+} // namespace car_sales
+
+#endif // group_by_HPP
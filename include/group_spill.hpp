@@ -0,0 +1,94 @@
+#ifndef group_spill_HPP
+#define group_spill_HPP
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string>
+
+#include "agg_hash_table.hpp"
+
+namespace car_sales {
+
+/**
+ * @brief Number of spill files; matches GroupByAggregator's partitions
+ */
+constexpr size_t SPILL_PARTITIONS = 64;
+
+/**
+ * @brief Parse a byte count such as "1048576", "512K", "64M" or "4G"
+ *
+ * Used for --max-memory and the other size options. Rejects signs, zero
+ * and sizes that do not fit in size_t.
+ * @return false on bad input (bytes is then unchanged)
+ */
+bool parseByteSize(const std::string &text, size_t &bytes);
+
+/**
+ * @brief Temp-file backing store for group-by partitions that exceed the
+ * memory budget
+ *
+ * One file per partition, shared by all workers (appends are serialised per
+ * partition, so workers only contend when they spill the same partition at
+ * the same moment). Files are unlinked as soon as they are created, so they
+ * disappear with the process even if it crashes. Each record is
+ * [u32 key length][key][i64 count][i64 revenue cents]; the same key may
+ * appear in many records and is re-aggregated by readInto().
+ *
+ * I/O failures throw std::runtime_error.
+ */
+class GroupSpill {
+public:
+  /**
+   * @param directory Where to create spill files (empty = system temp dir)
+   */
+  explicit GroupSpill(std::string directory = "");
+  ~GroupSpill();
+
+  GroupSpill(const GroupSpill &) = delete;
+  GroupSpill &operator=(const GroupSpill &) = delete;
+
+  /**
+   * @brief Append every entry of table to partition's file (thread-safe)
+   */
+  void write(size_t partition, const AggHashTable &table);
+
+  /**
+   * @brief Fold every record spilled to partition into table
+   *
+   * Must not run concurrently with write() to the same partition.
+   */
+  void readInto(size_t partition, AggHashTable &table) const;
+
+  /**
+   * @brief Total bytes written to all spill files
+   */
+  uint64_t bytesWritten() const { return bytes_written_.load(); }
+
+  /**
+   * @brief Number of write() calls so far
+   */
+  size_t spillCount() const { return spill_count_.load(); }
+
+  const std::string &directory() const { return directory_; }
+
+private:
+  struct Partition {
+    int fd = -1;
+    uint64_t size = 0;
+    std::mutex mutex;
+  };
+
+  std::string directory_;
+  std::array<Partition, SPILL_PARTITIONS> partitions_;
+  std::atomic<uint64_t> bytes_written_;
+  std::atomic<size_t> spill_count_;
+
+  int openFile();
+};
+
+} // namespace car_sales
+
+#endif // group_spill_HPP
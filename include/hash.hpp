@@ -0,0 +1,50 @@
+#ifndef hash_HPP
+#define hash_HPP
+
+#include <cstdint>
+#include <cstring>
+#include <string_view>
+
+namespace car_sales {
+
+/**
+ * @brief splitmix64 finaliser: spreads every input bit over the whole word
+ */
+inline uint64_t mixHash(uint64_t h) {
+  h ^= h >> 30;
+  h *= 0xBF58476D1CE4E5B9ULL;
+  h ^= h >> 27;
+  h *= 0x94D049BB133111EBULL;
+  h ^= h >> 31;
+  return h;
+}
+
+/**
+ * @brief Fast non-cryptographic 64-bit hash of a byte string
+ *
+ * Folds the input eight bytes at a time and finishes with mixHash(), so both
+ * the high bits (used for radix partitioning) and the low bits (used for
+ * bucket selection) are well distributed.
+ */
+inline uint64_t hashBytes(std::string_view bytes) {
+  constexpr uint64_t MULTIPLIER = 0x9E3779B97F4A7C15ULL;
+  uint64_t h = static_cast<uint64_t>(bytes.size()) * MULTIPLIER;
+  size_t i = 0;
+  for (; i + 8 <= bytes.size(); i += 8) {
+    uint64_t word;
+    std::memcpy(&word, bytes.data() + i, 8);
+    h = (h ^ word) * MULTIPLIER;
+    h ^= h >> 32;
+  }
+  if (i < bytes.size()) {
+    uint64_t word = 0;
+    std::memcpy(&word, bytes.data() + i, bytes.size() - i);
+    h = (h ^ word) * MULTIPLIER;
+    h ^= h >> 32;
+  }
+  return mixHash(h);
+}
+
+} // namespace car_sales
+
+#endif // hash_HPP
@@ -0,0 +1,116 @@
+#ifndef heavy_hitters_HPP
+#define heavy_hitters_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace car_sales {
+
+/**
+ * @brief What a heavy-hitter sketch ranks keys by
+ */
+enum class HeavyHitterMetric { Units, Revenue };
+
+/**
+ * @brief Command-line name of a metric ("units" or "revenue")
+ */
+const char *heavyHitterMetricName(HeavyHitterMetric metric);
+
+/**
+ * @brief Parse a command-line metric name
+ */
+bool parseHeavyHitterMetric(std::string_view name, HeavyHitterMetric &metric);
+
+/**
+ * @brief One reported heavy hitter
+ *
+ * The true weight lies in [estimate - error, estimate].
+ */
+struct HeavyHitter {
+  std::string key;
+  int64_t estimate;
+  int64_t error;
+
+  /**
+   * @brief Lower bound on the key's true weight
+   */
+  int64_t guaranteed() const { return estimate - error; }
+};
+
+/**
+ * @brief Weighted Space-Saving sketch for top-K keys in bounded memory
+ *
+ * Keeps at most capacity() counters. An unseen key evicts the counter with
+ * the smallest weight and inherits that weight as its error, so estimates
+ * never undercount. With total weight N and capacity k, every estimate is at
+ * most N/k too high and every key whose true weight exceeds N/k is present.
+ *
+ * Sketches merge with the mergeable-summaries rule: a key absent from a full
+ * sketch is charged that sketch's minimum weight, and the combined counters
+ * are cut back to capacity(). The bounds above then hold for the merged
+ * stream. Weights must be non-negative.
+ *
+ * A default-constructed sketch is disabled (capacity 0) and ignores add().
+ */
+class SpaceSavingSketch {
+public:
+  static constexpr size_t DEFAULT_CAPACITY = 256;
+
+  SpaceSavingSketch() = default;
+  explicit SpaceSavingSketch(size_t capacity);
+
+  bool enabled() const { return capacity_ > 0; }
+  size_t capacity() const { return capacity_; }
+  size_t size() const { return counters_.size(); }
+
+  /**
+   * @brief Add weight to key (weight < 0 is treated as 0)
+   */
+  void add(std::string_view key, int64_t weight);
+
+  /**
+   * @brief Fold another sketch of the same capacity into this one
+   */
+  void merge(const SpaceSavingSketch &other);
+
+  /**
+   * @brief Sum of all weights added, including through merge()
+   */
+  int64_t totalWeight() const { return total_weight_; }
+
+  /**
+   * @brief Largest possible overestimate of any reported key
+   *
+   * The smallest counter once the sketch is full, otherwise 0 (exact).
+   */
+  int64_t maxError() const;
+
+  /**
+   * @brief The limit largest estimates (ties by key)
+   */
+  std::vector<HeavyHitter> top(size_t limit) const;
+
+private:
+  struct Counter {
+    std::string key;
+    int64_t weight;
+    int64_t error;
+  };
+
+  size_t capacity_ = 0;
+  int64_t total_weight_ = 0;
+  std::vector<Counter> counters_;                  // min-heap on weight
+  std::unordered_map<std::string, size_t> index_; // key -> heap position
+
+  void siftDown(size_t position);
+  void swapCounters(size_t a, size_t b);
+  void rebuild(std::vector<Counter> counters);
+};
+
+} // namespace car_sales
+
+#endif // heavy_hitters_HPP
@@ -0,0 +1,154 @@
+#ifndef hyperloglog_HPP
+#define hyperloglog_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "brand_country_table.hpp"
+#include "hash.hpp"
+
+namespace car_sales {
+
+/**
+ * @brief Supported HyperLogLog precisions (log2 of the register count)
+ */
+constexpr unsigned HLL_MIN_PRECISION = 4;
+constexpr unsigned HLL_MAX_PRECISION = 18;
+constexpr unsigned HLL_DEFAULT_PRECISION = 12;
+
+/**
+ * @brief HyperLogLog distinct-count sketch
+ *
+ * 2^precision one-byte registers, each holding the longest run of leading
+ * zeros seen among the hashes routed to it. The standard error of
+ * estimate() is about 1.04 / sqrt(2^precision): 1.6% at the default
+ * precision of 12, which costs 4 KiB per sketch.
+ *
+ * Merging is a register-wise max, so it is exact (merging sketches gives the
+ * same registers as sketching the combined input), commutative and
+ * independent of how rows were split between workers.
+ */
+class HyperLogLog {
+public:
+  /**
+   * @throws std::invalid_argument if precision is outside
+   * [HLL_MIN_PRECISION, HLL_MAX_PRECISION]
+   */
+  explicit HyperLogLog(unsigned precision = HLL_DEFAULT_PRECISION);
+
+  /**
+   * @brief Throw as the constructor would, without allocating registers
+   */
+  static void checkPrecision(unsigned precision);
+
+  unsigned precision() const { return precision_; }
+  size_t registerCount() const { return registers_.size(); }
+
+  /**
+   * @brief Record one already-hashed value
+   */
+  void addHash(uint64_t hash) {
+    size_t index = static_cast<size_t>(hash >> (64 - precision_));
+    // The sentinel bit caps the rank at 64 - precision + 1
+    uint64_t rest = (hash << precision_) | (uint64_t(1) << (precision_ - 1));
+    uint8_t rank = static_cast<uint8_t>(__builtin_clzll(rest) + 1);
+    if (rank > registers_[index]) {
+      registers_[index] = rank;
+    }
+  }
+
+  void add(std::string_view value) { addHash(hashBytes(value)); }
+
+  /**
+   * @brief Fold another sketch into this one (register-wise max)
+   * @throws std::invalid_argument if the precisions differ
+   */
+  void merge(const HyperLogLog &other);
+
+  /**
+   * @brief Estimated number of distinct values added
+   *
+   * Uses linear counting while many registers are still empty, where the
+   * raw HyperLogLog estimate is biased.
+   */
+  double estimate() const;
+
+  /**
+   * @brief Expected relative standard error of estimate()
+   */
+  double relativeError() const;
+
+  size_t memoryBytes() const { return registers_.capacity(); }
+
+private:
+  unsigned precision_;
+  std::vector<uint8_t> registers_;
+};
+
+/**
+ * @brief Distinct-count estimate for one manufacturer and country (or
+ * region, for rolled-up results)
+ */
+struct DistinctGroup {
+  std::string brand;
+  std::string country;
+  uint64_t estimate;
+};
+
+/**
+ * @brief One HyperLogLog per (manufacturer, country) pair
+ *
+ * Workers each keep their own counter and merge them at the end; because
+ * HyperLogLog merging is exact, the result is identical for every thread
+ * count. Memory is 2^precision bytes per pair seen.
+ *
+ * A default-constructed counter is disabled and ignores add().
+ */
+class DistinctCounter {
+public:
+  DistinctCounter() = default;
+  explicit DistinctCounter(unsigned precision);
+
+  bool enabled() const { return precision_ > 0; }
+  unsigned precision() const { return precision_; }
+
+  /**
+   * @brief Record a hashed value under (brand, country)
+   */
+  void add(std::string_view brand, std::string_view country, uint64_t hash);
+
+  /**
+   * @brief Fold other into this counter, pair by pair
+   */
+  void merge(const DistinctCounter &other);
+
+  /**
+   * @brief Estimate for every pair, largest first (ties by brand, country)
+   */
+  std::vector<DistinctGroup> groups() const;
+
+  /**
+   * @brief Per-brand estimates over the union of the countries accepted by
+   * include, reported under the country name label
+   *
+   * Sketches are merged before estimating, so a value seen in several
+   * countries is counted once.
+   */
+  std::vector<DistinctGroup>
+  rollUp(const std::function<bool(std::string_view)> &include,
+         const std::string &label) const;
+
+  size_t memoryBytes() const;
+
+private:
+  unsigned precision_ = 0;
+  BrandCountryTable<HyperLogLog> sketches_;
+};
+
+} // namespace car_sales
+
+#endif // hyperloglog_HPP
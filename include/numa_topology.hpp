@@ -0,0 +1,109 @@
+#ifndef numa_topology_HPP
+#define numa_topology_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace car_sales {
+
+/**
+ * @brief Where concurrent parse workers run and where their memory lives
+ *
+ * - None:  threads float wherever the scheduler puts them (default)
+ * - Cores: each worker is pinned to one CPU; the input is still read into
+ *          one shared buffer
+ * - Numa:  workers are pinned and grouped by node; each reads its own byte
+ *          range into a buffer it touches first, so the pages land on its
+ *          node, and partial results are merged per node before globally
+ */
+enum class WorkerPlacement { None, Cores, Numa };
+
+/**
+ * @brief Parse a placement name: none, cores or numa
+ */
+bool parseWorkerPlacement(std::string_view name, WorkerPlacement &placement);
+
+const char *workerPlacementName(WorkerPlacement placement);
+
+/**
+ * @brief Parse a kernel CPU list such as "0-3,8,10-11"
+ * @return false on malformed input (cpus is then unspecified)
+ */
+bool parseCpuList(std::string_view text, std::vector<int> &cpus);
+
+/**
+ * @brief Format CPUs (ascending) as a kernel CPU list
+ */
+std::string formatCpuList(const std::vector<int> &cpus);
+
+/**
+ * @brief A memory node and the CPUs this process may run on there
+ */
+struct NumaNode {
+  int id;
+  std::vector<int> cpus; // ascending
+  uint64_t memory_bytes; // 0 if unknown
+};
+
+/**
+ * @brief CPU a worker is pinned to
+ */
+struct CpuSlot {
+  size_t node; // index into NumaTopology::nodes()
+  int cpu;
+};
+
+/**
+ * @brief The machine's NUMA nodes as seen from this process
+ */
+class NumaTopology {
+public:
+  static constexpr const char *DEFAULT_SYSFS_ROOT = "/sys/devices/system/node";
+
+  NumaTopology() = default;
+  explicit NumaTopology(std::vector<NumaNode> nodes);
+
+  /**
+   * @brief Read node CPU lists and memory sizes from sysfs
+   *
+   * CPUs outside the process affinity mask (taskset, cgroups) are dropped,
+   * as are nodes left without CPUs (memory-only nodes). Without NUMA
+   * information the result is one node holding every allowed CPU.
+   */
+  static NumaTopology discover(const std::string &sysfs_root = DEFAULT_SYSFS_ROOT);
+
+  const std::vector<NumaNode> &nodes() const { return nodes_; }
+  bool empty() const { return nodes_.empty(); }
+  size_t cpuCount() const;
+
+  /**
+   * @brief CPUs for workers 0..workers-1
+   *
+   * Workers are spread evenly over all CPUs in node order, so consecutive
+   * workers (which parse consecutive byte ranges) share a node and each
+   * node's workers form one contiguous run. With more workers than CPUs,
+   * CPUs are shared.
+   */
+  std::vector<CpuSlot> assign(size_t workers) const;
+
+  /**
+   * @brief One-line summary, e.g. "2 nodes: node0 cpus 0-15 (64.0 GiB), ..."
+   */
+  std::string describe() const;
+
+private:
+  std::vector<NumaNode> nodes_;
+};
+
+/**
+ * @brief Restrict the calling thread (and threads it starts later) to cpus
+ * @return false if the platform or the kernel refuses
+ */
+bool pinCurrentThread(const std::vector<int> &cpus);
+
+} // namespace car_sales
+
+#endif // numa_topology_HPP
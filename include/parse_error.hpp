@@ -0,0 +1,69 @@
+#ifndef parse_error_HPP
+#define parse_error_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace car_sales {
+
+/**
+ * @brief Why a row was rejected
+ */
+enum class ParseErrorCode : uint8_t {
+  None = 0,
+  TooFewFields,
+  MissingBrand,
+  MissingCountry,
+  InvalidDate,
+  YearOutOfRange,
+  InvalidPrice,
+  // Not an error: the row failed a filter pushed down into the parser and
+  // is dropped without being counted as processed or failed
+  Filtered
+};
+
+/**
+ * @brief Short description of an error code
+ */
+const char *parseErrorReason(ParseErrorCode code);
+
+/**
+ * @brief 1-based column of the field an error code refers to (0 = whole row)
+ */
+uint32_t parseErrorColumn(ParseErrorCode code);
+
+/**
+ * @brief Compact record of a rejected row
+ *
+ * Cheap to create on the hot path; turn it into text with
+ * formatParseError() only when it is actually shown.
+ */
+struct ParseError {
+  uint64_t byte_offset; // offset of the row's first byte in the input
+  uint64_t line;        // 1-based physical line number (0 = unknown)
+  uint32_t column;      // 1-based column of the offending field (0 = row)
+  ParseErrorCode code;
+
+  ParseError() : byte_offset(0), line(0), column(0), code(ParseErrorCode::None) {}
+  ParseError(uint64_t _byte_offset, uint64_t _line, ParseErrorCode _code)
+      : byte_offset(_byte_offset), line(_line),
+        column(parseErrorColumn(_code)), code(_code) {}
+};
+
+/**
+ * @brief Maximum number of ParseError records kept per run
+ *
+ * Every failure is still counted in records_failed (and written to the reject
+ * file when one is configured); only the stored detail is capped.
+ */
+constexpr size_t MAX_STORED_PARSE_ERRORS = 10000;
+
+/**
+ * @brief Human-readable message for an error record
+ */
+std::string formatParseError(const ParseError &error);
+
+} // namespace car_sales
+
+#endif // parse_error_HPP
@@ -0,0 +1,197 @@
+#ifndef perf_counters_HPP
+#define perf_counters_HPP
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+// Set to 0 (CMake: -DCAR_SALES_ENABLE_PERF_COUNTERS=OFF) to build without the
+// perf_event_open backend; counters then always report as unavailable.
+#ifndef CAR_SALES_PERF_COUNTERS
+#define CAR_SALES_PERF_COUNTERS 1
+#endif
+
+namespace car_sales {
+
+/**
+ * @brief Hardware events sampled per thread
+ */
+enum class HwCounter : size_t {
+  Cycles = 0,
+  Instructions,
+  CacheMisses,
+  BranchMisses,
+  Count
+};
+
+constexpr size_t HW_COUNTER_COUNT = static_cast<size_t>(HwCounter::Count);
+
+/**
+ * @brief Pipeline stages hardware counters are attributed to
+ *
+ * Coarser than Stage: I/O, tokenizing and numeric parsing interleave per row,
+ * and reading counters costs a syscall, so they are sampled per chunk.
+ */
+enum class HwStage : size_t { Parse = 0, Aggregate, Count };
+
+constexpr size_t HW_STAGE_COUNT = static_cast<size_t>(HwStage::Count);
+
+/**
+ * @brief Human readable names
+ */
+const char *hwCounterName(HwCounter counter);
+const char *hwStageName(HwStage stage);
+
+/**
+ * @brief Counter totals for one stage
+ */
+struct HwStageCounters {
+  std::array<uint64_t, HW_COUNTER_COUNT> values;
+  uint64_t rows;
+
+  HwStageCounters() : values{}, rows(0) {}
+
+  uint64_t operator[](HwCounter counter) const {
+    return values[static_cast<size_t>(counter)];
+  }
+
+  /**
+   * @brief Instructions per cycle (0 when cycles were not counted)
+   */
+  double ipc() const;
+
+  /**
+   * @brief Instructions retired per row (0 when no rows were attributed)
+   */
+  double instructionsPerRow() const;
+};
+
+/**
+ * @brief Hardware counters aggregated across all threads of one run
+ */
+struct HwCounterReport {
+  std::array<HwStageCounters, HW_STAGE_COUNT> stages;
+
+  // Which events the kernel accepted; missing ones read as zero
+  std::array<bool, HW_COUNTER_COUNT> supported;
+
+  // Number of threads whose counters contributed
+  size_t threads;
+
+  bool requested;
+  bool available;
+  std::string unavailable_reason;
+
+  HwCounterReport()
+      : supported{}, threads(0), requested(false), available(false) {}
+
+  HwStageCounters &operator[](HwStage stage) {
+    return stages[static_cast<size_t>(stage)];
+  }
+  const HwStageCounters &operator[](HwStage stage) const {
+    return stages[static_cast<size_t>(stage)];
+  }
+
+  /**
+   * @brief Add another thread's (or run's) counters to this report
+   */
+  void merge(const HwCounterReport &other);
+};
+
+/**
+ * @brief One unscaled read of a counter group
+ *
+ * The kernel multiplexes groups that do not fit the PMU; counts only advance
+ * while the group is running. Raw counts and both times are monotonic, so
+ * differences between two samples never wrap, unlike differences between
+ * two separately scaled totals.
+ */
+struct PerfCounterSample {
+  std::array<uint64_t, HW_COUNTER_COUNT> raw;
+  uint64_t time_enabled;
+  uint64_t time_running;
+
+  PerfCounterSample() : raw{}, time_enabled(0), time_running(0) {}
+
+  /**
+   * @brief Counts between before and this sample, scaled by the share of
+   * that interval the group was actually running
+   */
+  std::array<uint64_t, HW_COUNTER_COUNT>
+  deltaSince(const PerfCounterSample &before) const;
+};
+
+/**
+ * @brief A perf_event_open counter group bound to the calling thread
+ *
+ * Opening never throws: when the platform, kernel or permissions do not
+ * allow counting, valid() is false and error() says why.
+ */
+class PerfCounterGroup {
+public:
+  PerfCounterGroup();
+  ~PerfCounterGroup();
+
+  PerfCounterGroup(const PerfCounterGroup &) = delete;
+  PerfCounterGroup &operator=(const PerfCounterGroup &) = delete;
+
+  bool valid() const { return leader_fd_ >= 0; }
+  const std::string &error() const { return error_; }
+
+  /**
+   * @brief Which events were accepted by the kernel
+   */
+  const std::array<bool, HW_COUNTER_COUNT> &supported() const {
+    return supported_;
+  }
+
+  /**
+   * @brief Read current counter values and times, unscaled
+   * @return false if the group is invalid or the read failed
+   */
+  bool read(PerfCounterSample &sample) const;
+
+  /**
+   * @brief Read current counter totals (scaled for multiplexing)
+   * @return false if the group is invalid or the read failed
+   */
+  bool read(std::array<uint64_t, HW_COUNTER_COUNT> &values) const;
+
+private:
+  int leader_fd_;
+  std::array<int, HW_COUNTER_COUNT> fds_;
+  std::array<bool, HW_COUNTER_COUNT> supported_;
+  std::string error_;
+};
+
+/**
+ * @brief Charges counter deltas to whichever stage is currently active
+ *
+ * Typical use in a chunk loop: enter(Parse) while reading rows,
+ * enter(Aggregate) around the chunk processor, then stop(). Each transition
+ * costs one read() syscall. A tracker whose report is null does nothing.
+ */
+class HwStageTracker {
+public:
+  HwStageTracker(const PerfCounterGroup *group, HwCounterReport *report);
+  ~HwStageTracker() { stop(); }
+
+  HwStageTracker(const HwStageTracker &) = delete;
+  HwStageTracker &operator=(const HwStageTracker &) = delete;
+
+  void enter(HwStage stage);
+  void addRows(HwStage stage, uint64_t rows);
+  void stop();
+
+private:
+  const PerfCounterGroup *group_;
+  HwCounterReport *report_;
+  PerfCounterSample last_;
+  HwStage current_;
+  bool running_;
+};
+
+} // namespace car_sales
+
+#endif // perf_counters_HPP
@@ -0,0 +1,142 @@
+#ifndef progress_HPP
+#define progress_HPP
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <thread>
+#include <vector>
+
+namespace car_sales {
+
+/**
+ * @brief One worker's live counters, alone on a cache line
+ *
+ * Only the owning worker writes a slot, so publishing is a plain relaxed
+ * store of its running totals: no lock, no read-modify-write, and no line
+ * shared with another writer. The reporter reads the slots concurrently
+ * and may see a slightly stale total, never a torn one.
+ */
+struct alignas(64) WorkerProgress {
+  std::atomic<uint64_t> bytes{0};   // input bytes parsed
+  std::atomic<uint64_t> rows{0};    // rows accepted
+  std::atomic<uint64_t> failed{0};  // rows rejected
+  std::atomic<uint64_t> busy_ns{0}; // time spent parsing, not waiting
+
+  void publish(uint64_t total_bytes, uint64_t total_rows,
+               uint64_t total_failed, uint64_t total_busy_ns) {
+    bytes.store(total_bytes, std::memory_order_relaxed);
+    rows.store(total_rows, std::memory_order_relaxed);
+    failed.store(total_failed, std::memory_order_relaxed);
+    busy_ns.store(total_busy_ns, std::memory_order_relaxed);
+  }
+};
+
+static_assert(sizeof(WorkerProgress) == 64, "one slot per cache line");
+
+/**
+ * @brief Totals across workers at one instant
+ */
+struct ProgressSnapshot {
+  double elapsed_s = 0.0;
+  uint64_t total_bytes = 0; // size of the input, 0 if unknown (a stream)
+  uint64_t bytes = 0;
+  uint64_t rows = 0;
+  uint64_t failed = 0;
+  std::vector<uint64_t> busy_ns; // per worker
+};
+
+/**
+ * @brief The counters a run publishes to, one slot per worker
+ *
+ * Slots are allocated up front and never move, so workers and the
+ * reporter can use them without coordination. A worker index beyond the
+ * slots gets no slot and simply does not report.
+ */
+class ProgressTracker {
+public:
+  /**
+   * @param workers slots to allocate (at least 1)
+   * @param total_bytes input size for percent and ETA, 0 if unknown
+   */
+  explicit ProgressTracker(size_t workers, uint64_t total_bytes = 0);
+
+  /**
+   * @brief The slot of worker index, or nullptr if there is none
+   */
+  WorkerProgress *worker(size_t index) {
+    return index < workers_ ? &slots_[index] : nullptr;
+  }
+
+  size_t workers() const { return workers_; }
+  uint64_t totalBytes() const { return total_bytes_; }
+
+  ProgressSnapshot snapshot() const;
+
+  /**
+   * @brief Monotonic nanoseconds, the clock busy_ns is measured on
+   */
+  static uint64_t nowNs();
+
+private:
+  size_t workers_;
+  uint64_t total_bytes_;
+  std::chrono::steady_clock::time_point start_;
+  std::unique_ptr<WorkerProgress[]> slots_;
+};
+
+/**
+ * @brief Where and how often a ProgressReporter writes
+ */
+struct ProgressOptions {
+  std::chrono::milliseconds interval{1000};
+  std::ostream *human = nullptr;   // one status line per tick
+  std::ostream *machine = nullptr; // one JSON object per line per tick
+};
+
+/**
+ * @brief Background thread printing rate, ETA and per-worker utilization
+ *
+ * Each tick compares a snapshot with the previous one: rates and
+ * utilization (busy time over wall time, per worker) cover the last
+ * interval, the ETA extrapolates the average rate so far. The JSON lines
+ * carry the same figures, plus "done": true on the final one written by
+ * stop().
+ */
+class ProgressReporter {
+public:
+  ProgressReporter(const ProgressTracker &tracker,
+                   const ProgressOptions &options);
+  ~ProgressReporter();
+
+  ProgressReporter(const ProgressReporter &) = delete;
+  ProgressReporter &operator=(const ProgressReporter &) = delete;
+
+  /**
+   * @brief Write a final report and stop the thread (idempotent)
+   */
+  void stop();
+
+private:
+  const ProgressTracker &tracker_;
+  ProgressOptions options_;
+  ProgressSnapshot last_;
+
+  std::mutex mutex_; // the reporter's own wake-up; workers never take it
+  std::condition_variable wake_;
+  bool stopping_ = false;
+  bool stopped_ = false;
+  std::thread thread_;
+
+  void run();
+  void report(bool done);
+};
+
+} // namespace car_sales
+
+#endif // progress_HPP
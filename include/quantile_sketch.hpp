@@ -0,0 +1,157 @@
+#ifndef quantile_sketch_HPP
+#define quantile_sketch_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "brand_country_table.hpp"
+
+namespace car_sales {
+
+/**
+ * @brief KLL quantile sketch over int64 values (sale prices in cents)
+ *
+ * Values go into a stack of compactors. Level h holds items of weight 2^h;
+ * when the sketch is full, the lowest over-capacity level is sorted and every
+ * other item (starting at a pseudo-random offset) is promoted to level h + 1.
+ * Level capacities shrink geometrically (by 2/3) towards the bottom, so the
+ * sketch keeps O(k) items however many values it sees.
+ *
+ * With parameter k, the rank of a returned quantile is within
+ * rankError() * count() of the requested rank with 99% confidence (about
+ * 1.3% of n at the default k = 200). Until the first compaction every value
+ * is kept and answers are exact. min() and max() are always exact.
+ *
+ * Sketches merge level by level, so per-thread sketches combine into one
+ * with the same error guarantee. The offset generator is seeded, so the same
+ * input in the same order always gives the same answers.
+ *
+ * A default-constructed sketch is disabled (k = 0) and ignores add().
+ */
+class KllSketch {
+public:
+  static constexpr uint32_t DEFAULT_K = 200;
+  static constexpr uint32_t MIN_K = 8;
+
+  KllSketch() = default;
+
+  /**
+   * @throws std::invalid_argument if k < MIN_K
+   */
+  explicit KllSketch(uint32_t k);
+
+  /**
+   * @brief Throw as the constructor would, without building a sketch
+   */
+  static void checkK(uint32_t k);
+
+  bool enabled() const { return k_ > 0; }
+  uint32_t k() const { return k_; }
+
+  void add(int64_t value);
+
+  /**
+   * @brief Fold another sketch into this one
+   * @throws std::invalid_argument if the two sketches use different k
+   */
+  void merge(const KllSketch &other);
+
+  /**
+   * @brief Number of values added, including through merge()
+   */
+  uint64_t count() const { return count_; }
+
+  int64_t min() const { return min_; }
+  int64_t max() const { return max_; }
+
+  /**
+   * @brief Value at normalised rank q in [0, 1] (0 = min, 1 = max)
+   *
+   * Returns 0 for an empty sketch; q is clamped into [0, 1].
+   */
+  int64_t quantile(double q) const;
+
+  /**
+   * @brief Normalised rank error bound (99% confidence) for this k
+   */
+  double rankError() const;
+
+  /**
+   * @brief Items currently retained across all levels
+   */
+  size_t retained() const;
+
+private:
+  uint32_t k_ = 0;
+  uint64_t count_ = 0;
+  int64_t min_ = 0;
+  int64_t max_ = 0;
+  size_t retained_ = 0;
+  size_t max_retained_ = 0;
+  uint64_t random_state_ = 0;
+  std::vector<std::vector<int64_t>> levels_;
+
+  size_t levelCapacity(size_t level) const;
+  void addLevel();
+  void compress();
+};
+
+/**
+ * @brief Price distribution of one manufacturer and country (or region,
+ * for rolled-up results)
+ */
+struct QuantileGroup {
+  std::string brand;
+  std::string country;
+  KllSketch sketch;
+};
+
+/**
+ * @brief One KLL sketch of sale prices per (manufacturer, country) pair
+ *
+ * Lives in the per-chunk analysis path like DistinctCounter: each worker
+ * keeps its own and they are merged pair by pair at the end.
+ *
+ * A default-constructed aggregator is disabled and ignores add().
+ */
+class PriceQuantiles {
+public:
+  PriceQuantiles() = default;
+  explicit PriceQuantiles(uint32_t k);
+
+  bool enabled() const { return k_ > 0; }
+  uint32_t k() const { return k_; }
+
+  void add(std::string_view brand, std::string_view country,
+           int64_t price_cents);
+
+  /**
+   * @brief Fold other into this aggregator, pair by pair
+   */
+  void merge(const PriceQuantiles &other);
+
+  /**
+   * @brief Every pair, most sales first (ties by brand, country)
+   */
+  std::vector<QuantileGroup> groups() const;
+
+  /**
+   * @brief Per-brand sketches merged over the countries accepted by
+   * include, reported under the country name label
+   */
+  std::vector<QuantileGroup>
+  rollUp(const std::function<bool(std::string_view)> &include,
+         const std::string &label) const;
+
+private:
+  uint32_t k_ = 0;
+  BrandCountryTable<KllSketch> sketches_;
+};
+
+} // namespace car_sales
+
+#endif // quantile_sketch_HPP
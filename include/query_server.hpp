@@ -0,0 +1,122 @@
+#ifndef query_server_HPP
+#define query_server_HPP
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "column_store.hpp"
+
+namespace car_sales {
+
+/**
+ * @brief Latency totals over every query a server has answered
+ */
+struct LatencyStats {
+  uint64_t queries = 0;
+  uint64_t total_us = 0;
+  uint64_t max_us = 0;
+};
+
+/**
+ * @brief Resident server answering queries over datasets loaded once
+ *
+ * Datasets are parsed into ColumnStores at load time and shared read-only by
+ * every connection, so a query only scans columns. Clients connect to a Unix
+ * domain socket and send one request per line, fields separated by tabs:
+ *
+ *   PING
+ *   DATASETS
+ *   LOAD <name> <csv path>
+ *   SUMMARY <dataset> [year]
+ *   GROUP <dataset> <brand|country|year|month> [brand=<b>] [country=<c>]
+ *         [year=<y>] [region=europe] [min_price=<usd>] [max_price=<usd>]
+ *   STATS
+ *   SHUTDOWN
+ *
+ * Prices are decimal dollars (e.g. 25000 or 25000.50); min_price and
+ * max_price keep sales priced within them, both bounds inclusive.
+ *
+ * Each answer is either "OK <rows> <latency_us>" followed by exactly <rows>
+ * tab-separated lines, or a single "ERR <message>" line. latency_us is the
+ * server-side time from the request arriving to the answer being ready.
+ */
+class QueryServer {
+public:
+  explicit QueryServer(std::string socket_path);
+  ~QueryServer();
+
+  QueryServer(const QueryServer &) = delete;
+  QueryServer &operator=(const QueryServer &) = delete;
+
+  /**
+   * @brief Load (or replace) a dataset; queries already running keep the
+   * version they started with
+   */
+  bool addDataset(const std::string &name, const std::string &filename,
+                  std::string &error);
+
+  /**
+   * @brief Bind the socket and start accepting clients in the background
+   */
+  bool start(std::string &error);
+
+  /**
+   * @brief Block until stop() is called or a client sends SHUTDOWN, then
+   * close every connection
+   */
+  void wait();
+
+  /**
+   * @brief Stop accepting, close all connections and remove the socket
+   */
+  void stop();
+
+  /**
+   * @brief Answer one request line (without its newline)
+   */
+  std::string handle(const std::string &request);
+
+  LatencyStats latency() const;
+
+private:
+  struct Client {
+    std::thread thread;
+    int fd;
+    std::shared_ptr<std::atomic<bool>> done;
+  };
+
+  std::string socket_path_;
+  int listen_fd_ = -1;
+  std::atomic<bool> stopping_{false};
+  std::thread acceptor_;
+
+  mutable std::mutex mutex_; // guards everything below
+  std::condition_variable stop_requested_;
+  std::map<std::string, std::shared_ptr<const ColumnStore>> datasets_;
+  std::vector<Client> clients_;
+  LatencyStats stats_;
+
+  void acceptLoop();
+  void serve(int fd, std::shared_ptr<std::atomic<bool>> done);
+  void reapClients();
+  std::string execute(const std::vector<std::string> &fields, size_t &rows);
+  std::shared_ptr<const ColumnStore> dataset(const std::string &name) const;
+};
+
+/**
+ * @brief Send one request to a server and return the full answer
+ * @throws std::runtime_error if the server cannot be reached or hangs up
+ */
+std::string sendQuery(const std::string &socket_path,
+                      const std::string &request);
+
+} // namespace car_sales
+
+#endif // query_server_HPP
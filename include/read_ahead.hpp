@@ -0,0 +1,143 @@
+#ifndef read_ahead_HPP
+#define read_ahead_HPP
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+namespace car_sales {
+
+/**
+ * @brief How ReadAheadReader reads a file
+ */
+struct ReadAheadOptions {
+  // A 1 MiB ring: refills are rare, yet a block is usually still in L2 when
+  // the parser reaches it (multi-MiB rings measured slower to tokenise)
+  static constexpr size_t DEFAULT_BLOCK_BYTES = size_t(256) << 10;
+  static constexpr size_t DEFAULT_DEPTH = 4;
+  static constexpr size_t ALIGNMENT = 4096; // O_DIRECT buffer/size alignment
+
+  // Stream input (stdin, pipes) is parsed concurrently in segments of
+  // about this many bytes, one per worker at a time
+  static constexpr size_t DEFAULT_SEGMENT_BYTES = size_t(4) << 20;
+
+  size_t block_bytes = DEFAULT_BLOCK_BYTES; // rounded up to ALIGNMENT
+  size_t depth = DEFAULT_DEPTH; // buffers in the ring (2 = double buffering)
+  bool direct = false; // O_DIRECT; silently buffered where unsupported
+  size_t segment_bytes = DEFAULT_SEGMENT_BYTES;
+};
+
+/**
+ * @brief Sequential reader that fills a ring of aligned blocks on an I/O
+ * thread
+ *
+ * While the caller parses one block the I/O thread is already reading the
+ * next depth - 1, so a cold-cache run waits on the disk rather than on
+ * one syscall per refill. The file is opened with POSIX_FADV_SEQUENTIAL so
+ * the kernel reads ahead aggressively too. Works on pipes as well as files.
+ */
+class ReadAheadReader {
+public:
+  explicit ReadAheadReader(const ReadAheadOptions &options = ReadAheadOptions());
+  ~ReadAheadReader();
+
+  ReadAheadReader(const ReadAheadReader &) = delete;
+  ReadAheadReader &operator=(const ReadAheadReader &) = delete;
+
+  /**
+   * @brief Open filename and start reading ahead; "-" reads stdin
+   * @return false (with error set) if it cannot be opened
+   */
+  bool open(const std::string &filename, std::string &error);
+
+  /**
+   * @brief Read ahead from an already open descriptor (not closed here)
+   */
+  void attach(int fd);
+
+  /**
+   * @brief The next block; empty at end of input or after a read error.
+   * The view stays valid until the following call.
+   */
+  std::string_view next();
+
+  /**
+   * @brief Read error that ended the input early (empty if none)
+   */
+  std::string error() const;
+
+  /**
+   * @brief Whether O_DIRECT ended up in effect
+   */
+  bool direct() const { return direct_; }
+
+private:
+  struct FreeDeleter {
+    void operator()(char *p) const;
+  };
+
+  ReadAheadOptions options_;
+  int fd_ = -1;
+  bool owns_fd_ = false;
+  bool direct_ = false;
+  std::unique_ptr<char, FreeDeleter> memory_; // depth aligned blocks
+  std::vector<size_t> sizes_;                 // bytes held per block
+
+  mutable std::mutex mutex_; // guards everything below
+  std::condition_variable filled_;
+  std::condition_variable drained_;
+  uint64_t produced_ = 0; // blocks filled so far
+  uint64_t consumed_ = 0; // blocks the caller has finished with
+  bool holding_ = false;  // the caller holds block consumed_ % depth
+  bool eof_ = false;
+  bool stop_ = false;
+  std::string error_;
+  std::thread thread_;
+
+  void start();
+  void readLoop();
+  bool readBlock(char *data, size_t &size, std::string &error);
+};
+
+/**
+ * @brief Splits input into lines without copying
+ *
+ * Lines are views into the reader's blocks; only a line that spans two
+ * blocks (or a record spanning several lines) is assembled in a small
+ * buffer. Like std::getline, the newline is dropped and a final line
+ * without one is still returned.
+ */
+class LineReader {
+public:
+  explicit LineReader(ReadAheadReader &blocks) : blocks_(&blocks) {}
+  explicit LineReader(std::string_view data) : block_(data) {}
+
+  /**
+   * @return false at end of input; line is valid until the next call
+   */
+  bool next(std::string_view &line);
+
+  /**
+   * @brief Like next, but joins lines while a quoted field is open, so a
+   * field holding newlines stays in one record (RFC 4180)
+   * @param lines set to the physical lines the record spans
+   */
+  bool nextRecord(std::string_view &record, size_t &lines);
+
+private:
+  ReadAheadReader *blocks_ = nullptr;
+  std::string_view block_; // unread part of the current block
+  std::string carry_;
+  bool carry_returned_ = false;
+  std::string record_; // a record assembled from several lines
+};
+
+} // namespace car_sales
+
+#endif // read_ahead_HPP
@@ -0,0 +1,80 @@
+#ifndef record_boundaries_HPP
+#define record_boundaries_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+#include <vector>
+
+namespace car_sales {
+
+/**
+ * RFC 4180 record boundaries. A quoted field may hold delimiters and
+ * newlines, so a record ends at the first newline outside quotes. Every '"'
+ * toggles the quoted state (an escaped "" toggles twice), which makes the
+ * state at any offset the parity of the quotes before it.
+ */
+
+/**
+ * @brief Whether text holds an odd number of quotes, i.e. leaves a quoted
+ * field open
+ */
+bool hasOpenQuote(std::string_view text);
+
+/**
+ * @brief End of the record starting at pos: its first newline outside
+ * quotes, or data.size()
+ * @param embedded_newlines set to the quoted newlines inside the record
+ */
+size_t recordEnd(std::string_view data, size_t pos, size_t &embedded_newlines);
+
+/**
+ * @brief Offset just past the last record-ending newline of data, which
+ * must start at a record start; 0 if no record ends in it
+ *
+ * Cuts a stream read block by block, handing out whole records only.
+ */
+size_t lastRecordEnd(std::string_view data);
+
+/**
+ * @brief What a chunk of input looks like under both quote-state hypotheses
+ *
+ * A worker dropped at an arbitrary byte cannot tell whether it is inside a
+ * quoted field, so it records where the first record would start either
+ * way. Once the quote parity of every earlier chunk is known the right
+ * hypothesis is a prefix XOR away.
+ */
+struct QuoteScan {
+  bool odd_quotes = false; // quote parity of the whole chunk
+  // Offset just past the first record-ending newline, assuming the chunk
+  // starts outside [0] or inside [1] quotes; npos if none ends in it
+  size_t first_start[2] = {std::string_view::npos, std::string_view::npos};
+};
+
+QuoteScan scanQuotes(std::string_view chunk);
+
+/**
+ * @brief Pick each chunk's record start with a prefix pass over the scans
+ *
+ * Chunk c covers [cuts[c], cuts[c + 1]) and the data starts outside quotes
+ * at cuts[0]. Returns scans.size() + 1 offsets: starts[0] = cuts[0], the
+ * last is end, and worker c owns the records in [starts[c], starts[c + 1]).
+ * A chunk lying wholly inside one record starts none, so its range is
+ * empty and the worker before it takes the bytes.
+ */
+std::vector<uint64_t> resolveRecordStarts(const std::vector<QuoteScan> &scans,
+                                          const std::vector<uint64_t> &cuts,
+                                          uint64_t end);
+
+/**
+ * @brief Split data into about `parts` pieces of whole records
+ *
+ * The quote scans of the equal-sized byte chunks run in parallel, so the
+ * split stays correct for quoted newlines without a serial pass over the
+ * data.
+ */
+std::vector<std::string_view> splitRecords(std::string_view data, size_t parts);
+
+} // namespace car_sales
+
+#endif // record_boundaries_HPP
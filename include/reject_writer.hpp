@@ -0,0 +1,102 @@
+#ifndef reject_writer_HPP
+#define reject_writer_HPP
+
+#include <condition_variable>
+#include <cstdio>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+namespace car_sales {
+
+/**
+ * @brief Streams rejected raw rows to a file on a background thread
+ *
+ * Parse workers never write to the file themselves: each collects rejected
+ * lines in a private RejectBuffer and hands over whole blocks. Handing over
+ * is a move under a briefly held mutex, and emptied blocks are recycled back
+ * to the workers, so a dirty feed costs the workers a memcpy per bad row.
+ */
+class RejectFileWriter {
+public:
+  static constexpr size_t BLOCK_SIZE = 64 * 1024;
+
+  /**
+   * @brief Open (truncate) the reject file and start the writer thread
+   *
+   * Check isOpen() afterwards; a writer that failed to open ignores input.
+   */
+  explicit RejectFileWriter(const std::string &path);
+  ~RejectFileWriter();
+
+  RejectFileWriter(const RejectFileWriter &) = delete;
+  RejectFileWriter &operator=(const RejectFileWriter &) = delete;
+
+  bool isOpen() const { return file_ != nullptr; }
+  const std::string &path() const { return path_; }
+
+  /**
+   * @brief Queue a block of newline-terminated rows for writing
+   */
+  void submit(std::string &&block);
+
+  /**
+   * @brief Get an empty block, recycled from the writer when possible
+   */
+  std::string acquireBlock();
+
+  /**
+   * @brief Write everything queued, stop the thread and close the file
+   * @return false if any write failed
+   */
+  bool close();
+
+  /**
+   * @brief Rows written so far (counted by newline)
+   */
+  size_t rowsWritten() const;
+
+private:
+  std::string path_;
+  std::FILE *file_;
+
+  mutable std::mutex mutex_;
+  std::condition_variable cv_;
+  std::deque<std::string> pending_;
+  std::vector<std::string> free_blocks_;
+  bool stopping_;
+  bool write_failed_;
+  size_t rows_written_;
+
+  std::thread thread_;
+
+  void run();
+};
+
+/**
+ * @brief Per-worker staging buffer in front of a RejectFileWriter
+ *
+ * A null writer makes every call a no-op.
+ */
+class RejectBuffer {
+public:
+  explicit RejectBuffer(RejectFileWriter *writer);
+  ~RejectBuffer() { flush(); }
+
+  RejectBuffer(const RejectBuffer &) = delete;
+  RejectBuffer &operator=(const RejectBuffer &) = delete;
+
+  void add(std::string_view line);
+  void flush();
+
+private:
+  RejectFileWriter *writer_;
+  std::string block_;
+};
+
+} // namespace car_sales
+
+#endif // reject_writer_HPP
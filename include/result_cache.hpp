@@ -0,0 +1,117 @@
+#ifndef result_cache_HPP
+#define result_cache_HPP
+
+#include <cstdint>
+#include <mutex>
+#include <string>
+
+#include "data_analyzer.hpp"
+
+namespace car_sales {
+
+/**
+ * @brief What identifies one version of an input file
+ *
+ * Besides the stat() fields, the first and last CONTENT_SAMPLE_BYTES are
+ * hashed, which catches rewrites that keep the size and restore the mtime
+ * (e.g. cp -p) without reading the whole file.
+ */
+struct FileIdentity {
+  static constexpr size_t CONTENT_SAMPLE_BYTES = 64 * 1024;
+
+  std::string path; // absolute
+  uint64_t device = 0;
+  uint64_t inode = 0;
+  uint64_t size = 0;
+  int64_t mtime_ns = 0;
+  uint64_t content_hash = 0;
+
+  bool operator==(const FileIdentity &other) const {
+    return path == other.path && device == other.device &&
+           inode == other.inode && size == other.size &&
+           mtime_ns == other.mtime_ns && content_hash == other.content_hash;
+  }
+
+  /**
+   * @return false if the file cannot be stat()ed or read
+   */
+  static bool of(const std::string &filename, FileIdentity &identity);
+};
+
+/**
+ * @brief Lifetime counters of a cache directory
+ */
+struct CacheStats {
+  uint64_t hits = 0;
+  uint64_t misses = 0;
+  uint64_t stores = 0;
+  uint64_t evictions = 0;
+  uint64_t invalidations = 0; // entries dropped because their file changed
+};
+
+/**
+ * @brief Persistent on-disk cache of analysis results
+ *
+ * Each (file path, query fingerprint) pair owns one entry file in the
+ * directory. The entry records the FileIdentity it was computed from, so a
+ * lookup after the input changed finds a stale identity, deletes the entry
+ * and misses: invalidation needs no index and no explicit flush. Entries
+ * are written to a temporary name and renamed into place, so readers never
+ * see a half-written result.
+ *
+ * The directory is capped at max_bytes. Hits refresh an entry's mtime and
+ * stores evict the least recently used entries until the cap holds.
+ * Statistics persist across runs in a small text file next to the entries;
+ * concurrent processes may lose an increment, never an entry.
+ */
+class ResultCache {
+public:
+  static constexpr uint64_t DEFAULT_MAX_BYTES = uint64_t(256) << 20;
+
+  explicit ResultCache(std::string directory,
+                       uint64_t max_bytes = DEFAULT_MAX_BYTES);
+
+  /**
+   * @brief Fill result from the cache
+   * @return false on a miss (result is untouched)
+   */
+  bool lookup(const FileIdentity &file, uint64_t query, AnalysisResult &result);
+
+  /**
+   * @brief Save result for later lookups, then evict down to the size cap
+   */
+  void store(const FileIdentity &file, uint64_t query,
+             const AnalysisResult &result);
+
+  CacheStats stats() const;
+  const std::string &directory() const { return directory_; }
+  uint64_t maxBytes() const { return max_bytes_; }
+
+  /**
+   * @brief Bytes currently held by entries
+   */
+  uint64_t sizeBytes() const;
+
+  /**
+   * @brief Serialised form of the cacheable fields of result
+   */
+  static std::string serialize(const AnalysisResult &result);
+
+  /**
+   * @return false if data is truncated or malformed
+   */
+  static bool deserialize(const std::string &data, AnalysisResult &result);
+
+private:
+  std::string directory_;
+  uint64_t max_bytes_;
+  mutable std::mutex mutex_; // serialises this process's stats updates
+
+  std::string entryPath(const FileIdentity &file, uint64_t query) const;
+  void count(uint64_t CacheStats::*counter, uint64_t amount = 1);
+  void evict();
+};
+
+} // namespace car_sales
+
+#endif // result_cache_HPP
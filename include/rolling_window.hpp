@@ -0,0 +1,44 @@
+#ifndef rolling_window_HPP
+#define rolling_window_HPP
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "time_series.hpp"
+
+namespace car_sales {
+
+/**
+ * @brief Longest rolling window accepted, in days
+ */
+constexpr uint32_t MAX_ROLLING_WINDOW = 3660;
+
+/**
+ * @brief Revenue of one country on one day and over the trailing windows
+ * ending that day
+ */
+struct RollingPoint {
+  std::string country;
+  int32_t day;
+  std::string date;
+  int64_t day_cents;
+  std::vector<int64_t> window_cents; // one per window, in the order asked
+};
+
+/**
+ * @brief Slide trailing windows over daily revenue series
+ *
+ * daily must hold consecutive day buckets per key, as
+ * TimeSeriesAggregator::points() returns them for TimeBucket::Day. Each
+ * window keeps a running sum that gains the new day and drops the day that
+ * falls out, so every step is O(1) per window however wide it is. Windows
+ * at the start of a series cover only the days seen so far, and a window of
+ * 0 days accumulates from the first day.
+ */
+std::vector<RollingPoint> rollingWindows(const std::vector<SeriesPoint> &daily,
+                                         const std::vector<uint32_t> &windows);
+
+} // namespace car_sales
+
+#endif // rolling_window_HPP
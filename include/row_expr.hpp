@@ -0,0 +1,290 @@
+#ifndef row_expr_HPP
+#define row_expr_HPP
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+
+#include "data_parser.hpp"
+
+namespace car_sales {
+
+/**
+ * Expression templates over CarSaleRecord rows.
+ *
+ * Filters and aggregates are written as expressions, e.g.
+ *
+ *   auto bmw_2025 = col<Manufacturer> == "BMW" && col<Year> == 2025;
+ *   auto [units, cents] = sumRows(rows, n, sumIf(audi_china, col<Quantity>),
+ *                                 sumIf(bmw_2025, col<RevenueCents>));
+ *
+ * An eachIf() action can join the same pass for work a sum cannot express.
+ *
+ * Every node is a distinct type, so a kernel instantiated from an
+ * expression is one fully inlined loop, the same code as writing it by
+ * hand. Cheap conditions are combined with & and |, not && and ||, so a
+ * row's predicate costs no branches beyond the comparisons themselves.
+ */
+namespace expr {
+
+// Columns, each read straight from the record
+struct Manufacturer {
+  static const std::string &get(const CarSaleRecord &row) { return row.brand; }
+};
+struct Country {
+  static const std::string &get(const CarSaleRecord &row) {
+    return row.country;
+  }
+};
+struct Year {
+  static int get(const CarSaleRecord &row) { return row.year; }
+};
+struct Quantity {
+  static int64_t get(const CarSaleRecord &row) { return row.quantity; }
+};
+struct RevenueCents {
+  static int64_t get(const CarSaleRecord &row) { return row.revenue_cents; }
+};
+
+/**
+ * @brief Base of every node; operators only apply to expressions
+ *
+ * A node is cheap when evaluating it needs no call out of line, so it can
+ * be evaluated unconditionally instead of behind a short-circuit.
+ */
+template <class Derived> struct Expr {
+  const Derived &self() const { return static_cast<const Derived &>(*this); }
+};
+
+template <class Column> struct Col : Expr<Col<Column>> {
+  static constexpr bool cheap = true;
+  decltype(auto) operator()(const CarSaleRecord &row) const {
+    return Column::get(row);
+  }
+};
+
+/**
+ * @brief A column as an expression: col<Year> == 2025
+ */
+template <class Column> constexpr Col<Column> col{};
+
+template <class T> struct Lit : Expr<Lit<T>> {
+  static constexpr bool cheap = true;
+  T value;
+  explicit constexpr Lit(T v) : value(v) {}
+  T operator()(const CarSaleRecord &) const { return value; }
+};
+
+// String literals compare as views; anything else by value
+template <class T> constexpr auto literal(const T &value) {
+  if constexpr (std::is_convertible_v<const T &, std::string_view>) {
+    return Lit<std::string_view>(value);
+  } else {
+    return Lit<T>(value);
+  }
+}
+
+template <class T> constexpr const T &asExpr(const Expr<T> &e) {
+  return e.self();
+}
+template <class T, class = std::enable_if_t<!std::is_base_of_v<Expr<T>, T>>>
+constexpr auto asExpr(const T &value) {
+  return literal(value);
+}
+
+template <class L, class R, class Op> struct Compare : Expr<Compare<L, R, Op>> {
+  static constexpr bool cheap = L::cheap && R::cheap;
+  L left;
+  R right;
+  constexpr Compare(L l, R r) : left(l), right(r) {}
+  bool operator()(const CarSaleRecord &row) const {
+    return Op()(left(row), right(row));
+  }
+};
+
+template <class L, class R> struct And : Expr<And<L, R>> {
+  static constexpr bool cheap = L::cheap && R::cheap;
+  L left;
+  R right;
+  constexpr And(L l, R r) : left(l), right(r) {}
+  bool operator()(const CarSaleRecord &row) const {
+    if constexpr (R::cheap) {
+      return static_cast<bool>(left(row)) & static_cast<bool>(right(row));
+    } else {
+      return left(row) && right(row); // only pay for right when needed
+    }
+  }
+};
+
+template <class L, class R> struct Or : Expr<Or<L, R>> {
+  static constexpr bool cheap = L::cheap && R::cheap;
+  L left;
+  R right;
+  constexpr Or(L l, R r) : left(l), right(r) {}
+  bool operator()(const CarSaleRecord &row) const {
+    if constexpr (R::cheap) {
+      return static_cast<bool>(left(row)) | static_cast<bool>(right(row));
+    } else {
+      return left(row) || right(row);
+    }
+  }
+};
+
+template <class E> struct Not : Expr<Not<E>> {
+  static constexpr bool cheap = E::cheap;
+  E operand;
+  constexpr explicit Not(E e) : operand(e) {}
+  bool operator()(const CarSaleRecord &row) const { return !operand(row); }
+};
+
+/**
+ * @brief fn applied to an expression's value; never cheap, so it runs only
+ * for rows the conditions before it let through
+ */
+template <class E, class Fn> struct Call : Expr<Call<E, Fn>> {
+  static constexpr bool cheap = false;
+  E operand;
+  Fn fn;
+  constexpr Call(E e, Fn f) : operand(e), fn(f) {}
+  bool operator()(const CarSaleRecord &row) const { return fn(operand(row)); }
+};
+
+template <class E, class Fn> constexpr auto call(const Expr<E> &e, Fn fn) {
+  return Call<E, Fn>(e.self(), fn);
+}
+
+template <class Op, class L, class R>
+constexpr auto compare(const L &l, const R &r) {
+  auto left = asExpr(l);
+  auto right = asExpr(r);
+  return Compare<decltype(left), decltype(right), Op>(left, right);
+}
+
+// Comparison operators apply when either side is an expression
+template <class L, class R>
+using IfExpr = std::enable_if_t<std::is_base_of_v<Expr<L>, L> ||
+                                    std::is_base_of_v<Expr<R>, R>,
+                                int>;
+
+template <class L, class R, IfExpr<L, R> = 0>
+constexpr auto operator==(const L &l, const R &r) {
+  return compare<std::equal_to<>>(l, r);
+}
+template <class L, class R, IfExpr<L, R> = 0>
+constexpr auto operator!=(const L &l, const R &r) {
+  return compare<std::not_equal_to<>>(l, r);
+}
+template <class L, class R, IfExpr<L, R> = 0>
+constexpr auto operator<(const L &l, const R &r) {
+  return compare<std::less<>>(l, r);
+}
+template <class L, class R, IfExpr<L, R> = 0>
+constexpr auto operator<=(const L &l, const R &r) {
+  return compare<std::less_equal<>>(l, r);
+}
+template <class L, class R, IfExpr<L, R> = 0>
+constexpr auto operator>(const L &l, const R &r) {
+  return compare<std::greater<>>(l, r);
+}
+template <class L, class R, IfExpr<L, R> = 0>
+constexpr auto operator>=(const L &l, const R &r) {
+  return compare<std::greater_equal<>>(l, r);
+}
+
+template <class L, class R>
+constexpr auto operator&&(const Expr<L> &l, const Expr<R> &r) {
+  return And<L, R>(l.self(), r.self());
+}
+
+template <class L, class R>
+constexpr auto operator||(const Expr<L> &l, const Expr<R> &r) {
+  return Or<L, R>(l.self(), r.self());
+}
+
+template <class E> constexpr auto operator!(const Expr<E> &e) {
+  return Not<E>(e.self());
+}
+
+/**
+ * @brief Aggregate: value summed over the rows where pred holds, as a
+ * masked add rather than a branch
+ */
+template <class Pred, class Value> struct SumIf {
+  Pred pred;
+  Value value;
+  int64_t operator()(const CarSaleRecord &row) const {
+    int64_t mask = -static_cast<int64_t>(static_cast<bool>(pred(row)));
+    return static_cast<int64_t>(value(row)) & mask;
+  }
+};
+
+template <class Pred, class Value>
+constexpr SumIf<Pred, Value> sumIf(const Expr<Pred> &pred,
+                                   const Expr<Value> &value) {
+  return SumIf<Pred, Value>{pred.self(), value.self()};
+}
+
+/**
+ * @brief Action: fn(row) for the rows where pred holds (a branch, for the
+ * rare rows that need more than a sum); contributes 0 to sumRows
+ */
+template <class Pred, class Fn> struct EachIf {
+  Pred pred;
+  Fn fn;
+  int64_t operator()(const CarSaleRecord &row) const {
+    if (pred(row)) {
+      fn(row);
+    }
+    return 0;
+  }
+};
+
+template <class Pred, class Fn>
+constexpr EachIf<Pred, Fn> eachIf(const Expr<Pred> &pred, Fn fn) {
+  return EachIf<Pred, Fn>{pred.self(), fn};
+}
+
+/**
+ * @brief Evaluate several aggregates and actions over rows in one fused
+ * pass, so each row is loaded once
+ *
+ * Each aggregate still evaluates its own predicate: a condition that
+ * appears in two of them is tested twice per row.
+ * @return One sum per argument, in argument order
+ */
+template <class... Aggregates>
+std::array<int64_t, sizeof...(Aggregates)>
+sumRows(const CarSaleRecord *rows, size_t count,
+        const Aggregates &...aggregates) {
+  std::array<int64_t, sizeof...(Aggregates)> sums{};
+  for (size_t i = 0; i < count; ++i) {
+    size_t k = 0;
+    ((sums[k++] += aggregates(rows[i])), ...);
+  }
+  return sums;
+}
+
+/**
+ * @brief Call fn(row) for each of rows[0, count) where pred holds
+ */
+template <class Pred, class Fn>
+void forEachWhere(const CarSaleRecord *rows, size_t count,
+                  const Expr<Pred> &pred, Fn &&fn) {
+  const Pred &test = pred.self();
+  for (size_t i = 0; i < count; ++i) {
+    if (test(rows[i])) {
+      fn(rows[i]);
+    }
+  }
+}
+
+} // namespace expr
+
+} // namespace car_sales
+
+#endif // row_expr_HPP
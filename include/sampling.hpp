@@ -0,0 +1,131 @@
+#ifndef sampling_HPP
+#define sampling_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <istream>
+#include <map>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace car_sales {
+
+/**
+ * @brief How an approximate (sampled) run reads the input
+ */
+struct SampleOptions {
+  // Never read more than this share of the blocks
+  double max_fraction = 0.1;
+  // Stop once every headline metric's confidence interval is within this
+  // relative half-width (0 = always read max_fraction)
+  double target_error = 0.01;
+  // Size of the byte-range blocks the input is cut into
+  size_t block_bytes = size_t(1) << 20;
+  // Blocks read before the stopping rule is first checked
+  size_t min_blocks = 16;
+  // Seed for the block order; the same seed reads the same blocks
+  uint64_t seed = 1;
+  // Normal quantile of the reported intervals (1.96 = 95%)
+  double z = 1.96;
+};
+
+/**
+ * @brief Point estimate with a symmetric confidence interval
+ */
+struct SampleInterval {
+  double estimate = 0.0;
+  double half_width = 0.0;
+
+  /**
+   * @brief half_width / |estimate|; infinite for a zero estimate unless the
+   * interval is exact, so an unseen metric never counts as converged
+   */
+  double relativeError() const;
+};
+
+/**
+ * @brief Running sum and sum of squares of per-block totals
+ *
+ * Blocks where a metric did not occur simply contribute nothing; the number
+ * of sampled blocks is tracked by the caller.
+ */
+struct BlockSums {
+  double sum = 0.0;
+  double sum_sq = 0.0;
+
+  void add(double value) {
+    sum += value;
+    sum_sq += value * value;
+  }
+};
+
+/**
+ * @brief Estimate a population total from a simple random sample of blocks
+ *
+ * Expansion estimator N * mean with a finite-population-corrected variance,
+ * so the interval shrinks to zero once every block has been read.
+ *
+ * A metric no sampled block contained is estimated as 0 with a one-sided
+ * upper bound as its half-width: unit times the Poisson bound on
+ * occurrences (see unseenUpperBound), 0 only once every block was read.
+ *
+ * @param sums Per-block totals of the sampled blocks
+ * @param sampled Number of blocks sampled (n)
+ * @param population Number of blocks in the input (N)
+ * @param z Normal quantile for the interval
+ * @param unit Most one occurrence can add to the total (INFINITY if it has
+ * no natural bound, such as revenue)
+ */
+SampleInterval estimateTotal(const BlockSums &sums, size_t sampled,
+                             size_t population, double z, double unit = 1.0);
+
+/**
+ * @brief Upper bound on the occurrences in the population of something
+ * seen in none of sampled blocks, at the confidence z gives
+ */
+double unseenUpperBound(size_t sampled, size_t population, double z);
+
+/**
+ * @brief Reproducible random permutation of [0, blocks)
+ *
+ * Uses its own generator rather than std::shuffle, whose output differs
+ * between standard libraries.
+ */
+std::vector<size_t> samplingOrder(size_t blocks, uint64_t seed);
+
+/**
+ * @brief Read the lines that start inside [block_start, block_end)
+ *
+ * A line belongs to the block holding its first byte, so every line of the
+ * data region [data_start, file_size) is read by exactly one block. The
+ * result views buffer and ends just after a newline (or at end of file).
+ * A random block cannot know the quote state before it, so a quoted field
+ * with newlines that straddles a block edge reads as malformed rows.
+ */
+std::string_view readAlignedBlock(std::istream &in, uint64_t data_start,
+                                  uint64_t file_size, uint64_t block_start,
+                                  uint64_t block_end, std::string &buffer);
+
+/**
+ * @brief What a sampled run read and how precise its answers are
+ *
+ * The analysis results themselves hold the scaled-up point estimates; the
+ * intervals here use the same units (sales, dollars).
+ */
+struct SampleReport {
+  size_t blocks_total = 0;
+  size_t blocks_sampled = 0;
+  uint64_t bytes_sampled = 0;
+  size_t rows_sampled = 0;
+  double z = 0.0;
+  bool target_reached = false;
+
+  SampleInterval audi_china_year_sales;
+  SampleInterval bmw_year_total_revenue;
+  std::map<std::string, SampleInterval> bmw_europe_revenue;
+};
+
+} // namespace car_sales
+
+#endif // sampling_HPP
@@ -0,0 +1,106 @@
+#ifndef schema_HPP
+#define schema_HPP
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+#include "group_by.hpp"
+#include "parse_error.hpp"
+
+namespace car_sales {
+
+/**
+ * @brief Columns the row parser reads
+ *
+ * Each one is found by its header name and parsed by what it holds: a
+ * DD-MM-YYYY date, exact decimal cents, a coordinate or plain text.
+ */
+enum class SchemaColumn : uint8_t {
+  SaleDate,
+  Country,
+  Latitude,
+  Longitude,
+  DealershipId,
+  Manufacturer,
+  Model,
+  Vin,
+  SalePrice,
+  BuyerId,
+  SalespersonId
+};
+
+constexpr size_t SCHEMA_COLUMNS = 11;
+
+/**
+ * @brief Header name of a column ("sale_price_usd", ...)
+ */
+const char *schemaColumnName(SchemaColumn column);
+
+/**
+ * @brief The schema column holding a group-by column's values
+ */
+SchemaColumn schemaColumnFor(GroupColumn column);
+
+/**
+ * @brief 0-based positions of the columns in the 43-column data.csv layout
+ */
+constexpr std::array<int, SCHEMA_COLUMNS> STANDARD_COLUMN_INDEX = {
+    1, 2, 4, 5, 6, 8, 9, 16, 20, 25, 29};
+
+/**
+ * @brief Where each column sits in a row of one input
+ */
+class Schema {
+public:
+  static constexpr int MISSING = -1;
+
+  /**
+   * @brief The data.csv layout
+   */
+  static Schema standard();
+
+  /**
+   * @brief Bind columns by the names in a header row
+   *
+   * Names are matched exactly after trimming spaces, quotes and a UTF-8
+   * byte order mark. A first row naming none of the known columns is not a
+   * header of this format; the input is then read with the data.csv layout,
+   * as before schemas existed.
+   */
+  static Schema fromHeader(std::string_view header, char delimiter);
+
+  int index(SchemaColumn column) const {
+    return index_[static_cast<size_t>(column)];
+  }
+
+  bool has(SchemaColumn column) const { return index(column) != MISSING; }
+
+  const std::array<int, SCHEMA_COLUMNS> &indices() const { return index_; }
+
+  /**
+   * @brief Whether every column sits where data.csv has it, so the
+   * compile-time row parser applies
+   */
+  bool isStandard() const { return index_ == STANDARD_COLUMN_INDEX; }
+
+  /**
+   * @brief Whether the positions came from header names
+   */
+  bool fromHeaderNames() const { return from_header_; }
+
+  /**
+   * @brief 1-based column of the field an error code refers to (0 = row)
+   */
+  uint32_t errorColumn(ParseErrorCode code) const;
+
+private:
+  std::array<int, SCHEMA_COLUMNS> index_{};
+  bool from_header_ = false;
+};
+
+} // namespace car_sales
+
+#endif // schema_HPP
@@ -0,0 +1,78 @@
+#ifndef select_kernels_HPP
+#define select_kernels_HPP
+
+#include <cstddef>
+#include <cstdint>
+
+namespace car_sales {
+
+/**
+ * @brief Instruction set a filter kernel runs on
+ */
+enum class SelectIsa { Scalar, Avx2 };
+
+const char *selectIsaName(SelectIsa isa);
+
+/**
+ * @brief Whether isa was compiled in and the running CPU supports it
+ */
+bool selectIsaAvailable(SelectIsa isa);
+
+/**
+ * @brief Filter and aggregation kernels over dense columns
+ *
+ * A selection vector holds the ascending indices of the rows that pass a
+ * filter. select* kernels scan a whole column of rows entries and write
+ * one; refine* kernels read only the selected rows and keep those that
+ * also pass, so every filter after the first costs per survivor rather
+ * than per row. out needs room for as many indices as are read, and may be
+ * the input selection itself. Row indices must fit in 32 bits.
+ *
+ * The AVX2 kernels compare 8 rows per step and compact the passing lanes
+ * with one permute; refines and sums gather the selected entries. Every
+ * table returns identical results.
+ */
+struct SelectKernels {
+  SelectIsa isa;
+
+  // column[i] == value
+  size_t (*select_eq_u16)(const uint16_t *column, size_t rows, uint16_t value,
+                          uint32_t *out);
+  size_t (*refine_eq_u16)(const uint16_t *column, size_t rows,
+                          const uint32_t *selection, size_t selected,
+                          uint16_t value, uint32_t *out);
+
+  // lo <= column[i] <= hi
+  size_t (*select_range_i64)(const int64_t *column, size_t rows, int64_t lo,
+                             int64_t hi, uint32_t *out);
+  size_t (*refine_range_i64)(const int64_t *column, size_t rows,
+                             const uint32_t *selection, size_t selected,
+                             int64_t lo, int64_t hi, uint32_t *out);
+
+  // table[column[i]] != 0, e.g. "country code is European"
+  size_t (*refine_lookup_u16)(const uint16_t *column, size_t rows,
+                              const uint32_t *selection, size_t selected,
+                              const uint8_t *table, uint32_t *out);
+
+  // Sum of column over the selected rows
+  int64_t (*sum_selected_i64)(const int64_t *column, size_t rows,
+                              const uint32_t *selection, size_t selected);
+};
+
+/**
+ * @brief Kernels for isa; one the build or CPU lacks falls back to scalar
+ */
+const SelectKernels &selectKernels(SelectIsa isa);
+
+/**
+ * @brief Kernels for the best instruction set of the running CPU, chosen
+ * once on first use
+ */
+const SelectKernels &activeSelectKernels();
+
+// The AVX2 table, from select_kernels_avx2.cpp; only built with CAR_SALES_AVX2
+const SelectKernels &avx2SelectKernels();
+
+} // namespace car_sales
+
+#endif // select_kernels_HPP
@@ -0,0 +1,220 @@
+#ifndef stage_profiler_HPP
+#define stage_profiler_HPP
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "perf_counters.hpp"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+// Set to 0 (CMake: -DCAR_SALES_ENABLE_PROFILING=OFF) to compile every timer
+// down to nothing.
+#ifndef CAR_SALES_PROFILING
+#define CAR_SALES_PROFILING 1
+#endif
+
+namespace car_sales {
+
+/**
+ * @brief Pipeline stages tracked by the profiler
+ */
+enum class Stage : size_t {
+  Io = 0,       // reading lines from the input
+  Tokenize,     // splitting a line into fields
+  NumericParse, // date/price conversion and validation
+  Aggregate,    // per-chunk analysis
+  Merge,        // combining partial results
+  Count
+};
+
+constexpr size_t STAGE_COUNT = static_cast<size_t>(Stage::Count);
+
+/**
+ * @brief Human readable stage name
+ */
+const char *stageName(Stage stage);
+
+namespace profiling {
+
+constexpr bool COMPILED_IN = CAR_SALES_PROFILING != 0;
+
+/**
+ * @brief Read the cheapest monotonic tick counter available
+ *
+ * Uses the TSC on x86 and steady_clock nanoseconds elsewhere. Ticks are only
+ * meaningful relative to the wall interval of the owning StageProfile.
+ */
+inline uint64_t ticks() {
+#if CAR_SALES_PROFILING
+#if defined(__x86_64__) || defined(__i386__)
+  return __rdtsc();
+#else
+  return static_cast<uint64_t>(
+      std::chrono::duration_cast<std::chrono::nanoseconds>(
+          std::chrono::steady_clock::now().time_since_epoch())
+          .count());
+#endif
+#else
+  return 0;
+#endif
+}
+
+} // namespace profiling
+
+/**
+ * @brief Time, bytes and rows attributed to one stage
+ */
+struct StageStats {
+  uint64_t ticks;
+  uint64_t bytes;
+  uint64_t rows;
+
+  StageStats() : ticks(0), bytes(0), rows(0) {}
+};
+
+/**
+ * @brief Busy/idle split for one worker thread
+ */
+struct ThreadUtilization {
+  size_t thread_index;
+  uint64_t busy_ticks;
+  uint64_t idle_ticks;
+  uint64_t rows;
+
+  ThreadUtilization()
+      : thread_index(0), busy_ticks(0), idle_ticks(0), rows(0) {}
+};
+
+/**
+ * @brief Per-stage counters collected during one parse/analysis run
+ *
+ * Stage ticks are summed over all threads, so they measure CPU time spent in
+ * each stage. begin()/end() record the wall interval in both ticks and
+ * nanoseconds, which is what converts ticks to time without a calibration
+ * loop.
+ */
+struct StageProfile {
+  // Per-row stages time one row in this many; see rowTickScale()
+  static constexpr uint64_t ROW_SAMPLE_PERIOD = 64;
+
+  std::array<StageStats, STAGE_COUNT> stages;
+  std::vector<ThreadUtilization> threads;
+  HwCounterReport hardware;
+  uint64_t wall_ticks;
+  uint64_t wall_ns;
+  bool enabled;
+
+  StageProfile() : wall_ticks(0), wall_ns(0), enabled(false) {}
+
+  StageStats &operator[](Stage stage) {
+    return stages[static_cast<size_t>(stage)];
+  }
+  const StageStats &operator[](Stage stage) const {
+    return stages[static_cast<size_t>(stage)];
+  }
+
+  void add(Stage stage, uint64_t ticks, uint64_t bytes = 0,
+           uint64_t rows = 0) {
+    StageStats &s = (*this)[stage];
+    s.ticks += ticks;
+    s.bytes += bytes;
+    s.rows += rows;
+  }
+
+  /**
+   * @brief Tick multiplier for the next row's per-row stage timers
+   *
+   * Reading the clock around every stage of every row costs as much as
+   * parsing a short row, so only one row in ROW_SAMPLE_PERIOD is timed and
+   * its ticks stand for the whole period. Returns 0 for the other rows:
+   * their timers still count bytes and rows but never read the clock.
+   */
+  uint64_t rowTickScale() {
+    return row_sample_++ % ROW_SAMPLE_PERIOD == 0 ? ROW_SAMPLE_PERIOD : 0;
+  }
+
+  /**
+   * @brief Mark the start of the wall interval
+   */
+  void begin();
+
+  /**
+   * @brief Mark the end of the wall interval
+   */
+  void end();
+
+  /**
+   * @brief Add another profile's stage and thread counters to this one
+   *
+   * The wall interval is left untouched; it belongs to the outer run.
+   */
+  void merge(const StageProfile &other);
+
+  /**
+   * @brief Convert ticks to nanoseconds using the recorded wall interval
+   */
+  double toNanoseconds(uint64_t ticks) const;
+
+  /**
+   * @brief Clear all counters
+   */
+  void reset();
+
+private:
+  uint64_t row_sample_ = 0;
+  uint64_t begin_ticks_ = 0;
+  std::chrono::steady_clock::time_point begin_time_;
+};
+
+/**
+ * @brief RAII timer that charges its lifetime to one stage
+ *
+ * A null profile disables the timer at runtime; with CAR_SALES_PROFILING=0 it
+ * has no state and no code. Ticks are multiplied by tick_scale; a scale of 0
+ * (an unsampled row, see StageProfile::rowTickScale) only counts bytes and
+ * rows.
+ */
+class ScopedStageTimer {
+public:
+#if CAR_SALES_PROFILING
+  ScopedStageTimer(StageProfile *profile, Stage stage, uint64_t bytes = 0,
+                   uint64_t rows = 0, uint64_t tick_scale = 1)
+      : profile_(profile), stage_(stage), bytes_(bytes), rows_(rows),
+        tick_scale_(tick_scale),
+        start_(profile && tick_scale ? profiling::ticks() : 0) {}
+
+  ~ScopedStageTimer() {
+    if (profile_) {
+      uint64_t ticks =
+          tick_scale_ ? (profiling::ticks() - start_) * tick_scale_ : 0;
+      profile_->add(stage_, ticks, bytes_, rows_);
+    }
+  }
+#else
+  ScopedStageTimer(StageProfile *, Stage, uint64_t = 0, uint64_t = 0,
+                   uint64_t = 1) {}
+#endif
+
+  ScopedStageTimer(const ScopedStageTimer &) = delete;
+  ScopedStageTimer &operator=(const ScopedStageTimer &) = delete;
+
+#if CAR_SALES_PROFILING
+private:
+  StageProfile *profile_;
+  Stage stage_;
+  uint64_t bytes_;
+  uint64_t rows_;
+  uint64_t tick_scale_;
+  uint64_t start_;
+#endif
+};
+
+} // namespace car_sales
+
+#endif // stage_profiler_HPP
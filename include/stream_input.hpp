@@ -0,0 +1,125 @@
+#ifndef stream_input_HPP
+#define stream_input_HPP
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "read_ahead.hpp"
+
+namespace car_sales {
+
+/**
+ * @brief Name that reads standard input
+ */
+constexpr const char *STDIN_INPUT = "-";
+
+/**
+ * @brief Whether name can only be read once, front to back: "-" (stdin)
+ * or anything other than a regular file, such as a pipe, a FIFO or the
+ * /dev/fd/N of a shell process substitution
+ */
+bool isStreamInput(const std::string &name);
+
+/**
+ * @brief A run of whole records from a stream, parsed by one worker
+ */
+struct StreamSegment {
+  std::string data;
+  uint64_t base_offset = 0; // offset of data[0] in the stream
+  size_t index = 0;         // 0, 1, ... in stream order
+};
+
+/**
+ * @brief Cuts a stream into segments of whole records as it arrives
+ *
+ * Blocks from the read-ahead ring are copied into a segment until it holds
+ * about segment_bytes; it is then cut after its last complete record
+ * (quote-aware) and the remainder starts the next one. A record longer
+ * than a segment simply makes that segment longer.
+ */
+class StreamSplitter {
+public:
+  StreamSplitter(ReadAheadReader &reader, size_t segment_bytes);
+
+  /**
+   * @brief Read the first record (the header row)
+   * @param lines set to the physical lines it spans
+   * @return false if the stream is empty
+   */
+  bool header(std::string &header, size_t &lines);
+
+  /**
+   * @brief Fill segment with the next records, reusing its buffer
+   * @return false at end of stream
+   */
+  bool next(StreamSegment &segment);
+
+  /**
+   * @brief Segments handed out so far
+   */
+  size_t segments() const { return next_index_; }
+
+private:
+  ReadAheadReader &reader_;
+  size_t segment_bytes_;
+  std::string carry_; // start of a record the last segment did not finish
+  uint64_t offset_ = 0;
+  size_t next_index_ = 0;
+  bool eof_ = false;
+
+  bool readBlock(std::string &data);
+};
+
+/**
+ * @brief Bounded hand-off of segments from the reader to the workers
+ *
+ * Holds a fixed pool of segment buffers. The reader acquires an empty one,
+ * fills and pushes it; a worker pops it and releases it once parsed. When
+ * every buffer is in use the reader waits, so a slow consumer throttles
+ * the producer instead of letting the stream pile up in memory.
+ */
+class StreamSegmentQueue {
+public:
+  explicit StreamSegmentQueue(size_t buffers);
+
+  StreamSegmentQueue(const StreamSegmentQueue &) = delete;
+  StreamSegmentQueue &operator=(const StreamSegmentQueue &) = delete;
+
+  /**
+   * @brief An empty segment buffer; waits until one is free
+   */
+  StreamSegment *acquire();
+
+  void push(StreamSegment *segment);
+
+  /**
+   * @brief Next full segment; false once closed and drained
+   */
+  bool pop(StreamSegment *&segment);
+
+  void release(StreamSegment *segment);
+
+  /**
+   * @brief No more segments will be pushed
+   */
+  void close();
+
+private:
+  std::vector<StreamSegment> storage_;
+
+  std::mutex mutex_;
+  std::condition_variable ready_;
+  std::condition_variable freed_;
+  std::deque<StreamSegment *> full_;
+  std::vector<StreamSegment *> free_;
+  bool closed_ = false;
+};
+
+} // namespace car_sales
+
+#endif // stream_input_HPP
@@ -0,0 +1,143 @@
+#ifndef time_series_HPP
+#define time_series_HPP
+
+#include <climits>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace car_sales {
+
+/**
+ * @brief Marks a sale_date that could not be decoded into a day
+ */
+constexpr int32_t INVALID_DAY = INT32_MIN;
+
+/**
+ * @brief Sale years the parser accepts; dates outside decode as INVALID_DAY
+ */
+constexpr int MIN_SALE_YEAR = 1900;
+constexpr int MAX_SALE_YEAR = 2100;
+
+/**
+ * @brief Days since 1970-01-01 of a proleptic Gregorian date
+ */
+int32_t daysFromCivil(int year, unsigned month, unsigned day);
+
+/**
+ * @brief Inverse of daysFromCivil()
+ */
+void civilFromDays(int32_t days, int &year, unsigned &month, unsigned &day);
+
+/**
+ * @brief Decode a DD-MM-YYYY sale_date into a day number
+ * @return INVALID_DAY if the text is not a valid calendar date between
+ * MIN_SALE_YEAR and MAX_SALE_YEAR
+ */
+int32_t parseSaleDay(std::string_view date);
+
+/**
+ * @brief Width of the buckets of a time series
+ */
+enum class TimeBucket { None, Month, IsoWeek, Day };
+
+/**
+ * @brief Command-line name of a bucket width ("month", "week" or "day")
+ */
+const char *timeBucketName(TimeBucket bucket);
+
+/**
+ * @brief Parse a command-line bucket width
+ */
+bool parseTimeBucket(std::string_view name, TimeBucket &bucket);
+
+/**
+ * @brief Absolute bucket index of a day: months since year 0, ISO weeks
+ * since the week of 1970-01-01, or the day number itself
+ */
+int32_t bucketOf(TimeBucket bucket, int32_t day);
+
+/**
+ * @brief Display label of a bucket index: "2025-03", "2025-W07" (ISO
+ * week-numbering year) or "2025-03-09"
+ */
+std::string bucketLabel(TimeBucket bucket, int32_t index);
+
+/**
+ * @brief Units and revenue of one brand in one bucket
+ */
+struct SeriesPoint {
+  std::string brand;
+  int32_t bucket;
+  std::string label;
+  int64_t units;
+  int64_t revenue_cents;
+};
+
+/**
+ * @brief Per-brand units and revenue in dense arrays of time buckets
+ *
+ * The key is normally the brand, but any small set of names works (the
+ * rolling windows key daily buckets by country). Each key owns two contiguous arrays indexed by bucket - first_bucket, so
+ * adding a row is two array increments and merging two aggregators is plain
+ * vector addition. The arrays grow (by doubling) in whichever direction a
+ * new date falls. Brands are a small closed set and are found by a linear
+ * scan that starts at the previous hit.
+ *
+ * Sums are integers, so merged series are identical for every thread count.
+ * A default-constructed aggregator is disabled and ignores add().
+ */
+class TimeSeriesAggregator {
+public:
+  TimeSeriesAggregator() = default;
+  explicit TimeSeriesAggregator(TimeBucket bucket) : bucket_(bucket) {}
+
+  bool enabled() const { return bucket_ != TimeBucket::None; }
+  TimeBucket bucket() const { return bucket_; }
+
+  /**
+   * @brief Add one row (rows with day == INVALID_DAY are only counted)
+   */
+  void add(std::string_view brand, int32_t day, int64_t units,
+           int64_t revenue_cents);
+
+  /**
+   * @brief Fold other into this aggregator by vector addition
+   */
+  void merge(const TimeSeriesAggregator &other);
+
+  /**
+   * @brief Every brand's series, brands by name, buckets ascending with
+   * empty buckets between a brand's first and last sale included as zeros
+   */
+  std::vector<SeriesPoint> points() const;
+
+  /**
+   * @brief Rows whose sale_date had no valid day and month
+   */
+  int64_t undatedRows() const { return undated_rows_; }
+
+private:
+  struct Series {
+    std::string brand;
+    int32_t first_bucket = 0; // bucket of units[0]
+    int32_t low = 0;          // first and last bucket actually used
+    int32_t high = -1;
+    std::vector<int64_t> units;
+    std::vector<int64_t> revenue_cents;
+  };
+
+  TimeBucket bucket_ = TimeBucket::None;
+  std::vector<Series> series_;
+  size_t last_series_ = 0;
+  int64_t undated_rows_ = 0;
+
+  Series &seriesFor(std::string_view brand);
+  static void cover(Series &series, int32_t low, int32_t high);
+};
+
+} // namespace car_sales
+
+#endif // time_series_HPP
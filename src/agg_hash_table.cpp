@@ -0,0 +1,126 @@
+#include <cstring>
+#include <stdexcept>
+
+#include "agg_hash_table.hpp"
+
+namespace car_sales {
+
+// Round up to a power of two (at least 16) so bucket selection is a mask
+static size_t tableCapacity(size_t requested) {
+  size_t capacity = 16;
+  while (capacity < requested) {
+    capacity *= 2;
+  }
+  return capacity;
+}
+
+AggHashTable::Slot AggHashTable::emptySlot() {
+  Slot slot;
+  std::memset(&slot, 0, sizeof(slot));
+  slot.key_length = EMPTY;
+  return slot;
+}
+
+AggHashTable::AggHashTable(size_t initial_capacity)
+    : slots_(tableCapacity(initial_capacity), emptySlot()), size_(0),
+      mask_(slots_.size() - 1) {}
+
+void AggHashTable::add(std::string_view key, uint64_t hash, int64_t count,
+                       int64_t revenue_cents) {
+  // Keep the load factor at or below 3/4 so probe runs stay short
+  if ((size_ + 1) * 4 > slots_.size() * 3) {
+    grow();
+  }
+
+  uint32_t tag = static_cast<uint32_t>(hash);
+  size_t index = hash & mask_;
+  while (true) {
+    Slot &slot = slots_[index];
+    if (slot.key_length == EMPTY) {
+      slot.hash = tag;
+      slot.key_length = static_cast<uint32_t>(key.size());
+      if (key.size() <= INLINE_KEY_BYTES) {
+        std::memcpy(slot.inline_key, key.data(), key.size());
+      } else {
+        if (keys_.size() + key.size() >= EMPTY) {
+          throw std::length_error("AggHashTable key pool exceeds 4 GiB");
+        }
+        slot.key_offset = static_cast<uint32_t>(keys_.size());
+        keys_.insert(keys_.end(), key.begin(), key.end());
+      }
+      slot.count = count;
+      slot.revenue_cents = revenue_cents;
+      ++size_;
+      return;
+    }
+    if (slot.hash == tag && slot.key_length == key.size() &&
+        keyOf(slot) == key) {
+      slot.count += count;
+      slot.revenue_cents += revenue_cents;
+      return;
+    }
+    index = (index + 1) & mask_;
+  }
+}
+
+bool AggHashTable::find(std::string_view key, Entry &out) const {
+  uint64_t hash = hashBytes(key);
+  uint32_t tag = static_cast<uint32_t>(hash);
+  size_t index = hash & mask_;
+  while (true) {
+    const Slot &slot = slots_[index];
+    if (slot.key_length == EMPTY) {
+      return false;
+    }
+    if (slot.hash == tag && slot.key_length == key.size() &&
+        keyOf(slot) == key) {
+      out = entryOf(slot);
+      return true;
+    }
+    index = (index + 1) & mask_;
+  }
+}
+
+void AggHashTable::merge(const AggHashTable &other) {
+  // Slots only keep the low half of the hash, so rehash the key; it is
+  // being read for the comparison anyway
+  other.forEach([this](const Entry &entry) {
+    add(entry.key, entry.count, entry.revenue_cents);
+  });
+}
+
+void AggHashTable::grow() {
+  std::vector<Slot> old_slots(slots_.size() * 2, emptySlot());
+  old_slots.swap(slots_);
+  mask_ = slots_.size() - 1;
+
+  // Bucket bits come from the stored low hash half, so rehashing is a pure
+  // slot shuffle
+  for (const Slot &slot : old_slots) {
+    if (slot.key_length == EMPTY) {
+      continue;
+    }
+    size_t index = slot.hash & mask_;
+    while (slots_[index].key_length != EMPTY) {
+      index = (index + 1) & mask_;
+    }
+    slots_[index] = slot;
+  }
+}
+
+void AggHashTable::clear() {
+  for (Slot &slot : slots_) {
+    slot.key_length = EMPTY;
+  }
+  keys_.clear();
+  size_ = 0;
+}
+
+void AggHashTable::release() {
+  std::vector<Slot>(16, emptySlot()).swap(slots_);
+  std::vector<char>().swap(keys_);
+  size_ = 0;
+  mask_ = slots_.size() - 1;
+}
+
+} // namespace car_sales
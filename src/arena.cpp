@@ -0,0 +1,73 @@
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+
+#include "arena.hpp"
+
+namespace car_sales {
+
+Arena::Arena(size_t block_size)
+    : block_size_(block_size == 0 ? DEFAULT_BLOCK_SIZE : block_size),
+      current_(0), offset_(0), used_before_current_(0), reserved_(0),
+      block_allocations_(0) {}
+
+void Arena::addBlock(size_t min_size) {
+  size_t size = std::max(block_size_, min_size);
+  blocks_.push_back(Block{std::make_unique<char[]>(size), size});
+  reserved_ += size;
+  ++block_allocations_;
+}
+
+void *Arena::allocate(size_t bytes, size_t alignment) {
+  while (true) {
+    if (current_ < blocks_.size()) {
+      Block &block = blocks_[current_];
+      auto base = reinterpret_cast<uintptr_t>(block.data.get());
+      uintptr_t aligned = (base + offset_ + alignment - 1) & ~(alignment - 1);
+      size_t start = aligned - base;
+      if (start + bytes <= block.size) {
+        offset_ = start + bytes;
+        return block.data.get() + start;
+      }
+      // Move on to the next retained block, if any
+      used_before_current_ += offset_;
+      ++current_;
+      offset_ = 0;
+      continue;
+    }
+    addBlock(bytes + alignment);
+  }
+}
+
+std::string_view Arena::copy(std::string_view text) {
+  if (text.empty()) {
+    return std::string_view();
+  }
+  char *dest = static_cast<char *>(allocate(text.size(), 1));
+  std::memcpy(dest, text.data(), text.size());
+  return std::string_view(dest, text.size());
+}
+
+void Arena::reset() {
+  if (blocks_.size() > 1) {
+    // Replace the spilled blocks with one that fits the whole cycle
+    size_t needed = reserved_;
+    blocks_.clear();
+    reserved_ = 0;
+    addBlock(needed);
+  }
+  current_ = 0;
+  offset_ = 0;
+  used_before_current_ = 0;
+}
+
+void Arena::release() {
+  blocks_.clear();
+  blocks_.shrink_to_fit();
+  current_ = 0;
+  offset_ = 0;
+  used_before_current_ = 0;
+  reserved_ = 0;
+}
+
+} // namespace car_sales
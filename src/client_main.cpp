@@ -0,0 +1,41 @@
+#include <iostream>
+#include <string>
+#include "query_server.hpp"
+
+using namespace car_sales;
+
+void printUsage(const char* program_name) {
+    std::cout << "Usage: " << program_name << " <socket> <command> [args...]\n";
+    std::cout << "\nSends one request to a data_analyzer --serve process and prints the answer.\n";
+    std::cout << "Arguments are joined with tabs, so values may contain spaces.\n";
+    std::cout << "\nCommands:\n";
+    std::cout << "  PING | DATASETS | STATS | SHUTDOWN\n";
+    std::cout << "  LOAD <name> <csv path>\n";
+    std::cout << "  SUMMARY <dataset> [year]\n";
+    std::cout << "  GROUP <dataset> <brand|country|year|month> [brand=<b>] [country=<c>]\n";
+    std::cout << "        [year=<y>] [region=europe] [min_price=<usd>] [max_price=<usd>]\n";
+    std::cout << "\nExample:\n";
+    std::cout << "  " << program_name << " /tmp/analyzer.sock GROUP default country brand=BMW region=europe\n";
+}
+
+int main(int argc, char* argv[]) {
+    if (argc < 3) {
+        printUsage(argv[0]);
+        return 1;
+    }
+
+    std::string request = argv[2];
+    for (int i = 3; i < argc; ++i) {
+        request += '\t';
+        request += argv[i];
+    }
+
+    try {
+        std::string answer = sendQuery(argv[1], request);
+        std::cout << answer;
+        return answer.compare(0, 3, "OK ") == 0 ? 0 : 1;
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << "\n";
+        return 1;
+    }
+}
@@ -0,0 +1,335 @@
+#include <algorithm>
+#include <numeric>
+#include <stdexcept>
+
+#include "column_store.hpp"
+#include "data_analyzer.hpp"
+#include "select_kernels.hpp"
+
+namespace car_sales {
+
+bool parseStoreKey(std::string_view name, StoreKey &key) {
+  if (name == "brand" || name == "manufacturer") {
+    key = StoreKey::Brand;
+  } else if (name == "country") {
+    key = StoreKey::Country;
+  } else if (name == "year") {
+    key = StoreKey::Year;
+  } else if (name == "month") {
+    key = StoreKey::Month;
+  } else {
+    return false;
+  }
+  return true;
+}
+
+bool ColumnStore::loadFile(const std::string &filename, std::string &error,
+                           size_t chunk_size) {
+  CsvParser parser(chunk_size);
+  parser.setDecodeSaleDay(true);
+  ChunkResult result = parser.parseFile(
+      filename, [this](const std::vector<CarSaleRecord> &chunk, ChunkResult &) {
+        append(chunk.data(), chunk.data() + chunk.size());
+        return true;
+      });
+  failed_rows_ += result.records_failed;
+  if (!result.success) {
+    error = result.errors.empty() ? "Failed to load " + filename
+                                  : result.errors.front();
+    return false;
+  }
+  return true;
+}
+
+uint16_t ColumnStore::encode(std::unordered_map<std::string, uint16_t> &codes,
+                             std::vector<std::string> &names,
+                             const std::string &value) {
+  auto it = codes.find(value);
+  if (it != codes.end()) {
+    return it->second;
+  }
+  if (names.size() >= NO_CODE) {
+    throw std::length_error("Too many distinct values to encode: " + value);
+  }
+  uint16_t code = static_cast<uint16_t>(names.size());
+  names.push_back(value);
+  codes.emplace(value, code);
+  return code;
+}
+
+uint16_t
+ColumnStore::lookup(const std::unordered_map<std::string, uint16_t> &codes,
+                    const std::string &value) {
+  auto it = codes.find(value);
+  return it == codes.end() ? NO_CODE : it->second;
+}
+
+void ColumnStore::append(const CarSaleRecord *begin, const CarSaleRecord *end) {
+  size_t n = static_cast<size_t>(end - begin);
+  if (rows() + n > UINT32_MAX) {
+    throw std::length_error("Too many rows for 32-bit row selections");
+  }
+  brand_.reserve(brand_.size() + n);
+  country_.reserve(country_.size() + n);
+  year_.reserve(year_.size() + n);
+  month_.reserve(month_.size() + n);
+  cents_.reserve(cents_.size() + n);
+
+  for (const CarSaleRecord *it = begin; it != end; ++it) {
+    uint16_t brand = encode(brand_codes_, brands_, it->brand);
+    if (brand_rows_.size() < brands_.size()) {
+      brand_rows_.push_back(0);
+    }
+    ++brand_rows_[brand];
+    brand_.push_back(brand);
+
+    uint16_t country = encode(country_codes_, countries_, it->country);
+    if (country_rows_.size() < countries_.size()) {
+      european_.push_back(CarSalesAnalyzer::isEuropeanCountry(it->country));
+      country_rows_.push_back(0);
+    }
+    ++country_rows_[country];
+    country_.push_back(country);
+
+    int16_t year = static_cast<int16_t>(it->year);
+    ++year_rows_[year];
+    year_.push_back(year);
+    min_year_ = std::min(min_year_, year);
+    max_year_ = std::max(max_year_, year);
+
+    int32_t month = it->sale_day == INVALID_DAY
+                        ? INVALID_DAY
+                        : bucketOf(TimeBucket::Month, it->sale_day);
+    if (month != INVALID_DAY) {
+      min_month_ = std::min(min_month_, month);
+      max_month_ = std::max(max_month_, month);
+    }
+    month_.push_back(month);
+    cents_.push_back(it->revenue_cents);
+  }
+}
+
+size_t ColumnStore::memoryBytes() const {
+  return brand_.capacity() * sizeof(uint16_t) +
+         country_.capacity() * sizeof(uint16_t) +
+         year_.capacity() * sizeof(int16_t) +
+         month_.capacity() * sizeof(int32_t) +
+         cents_.capacity() * sizeof(int64_t);
+}
+
+bool ColumnStore::select(const StoreFilter &filter,
+                         std::vector<uint32_t> &selection) const {
+  selection.clear();
+
+  // Equality filters with the rows each keeps, known exactly from load
+  struct Equal {
+    const uint16_t *column;
+    uint16_t value;
+    size_t rows;
+  };
+  Equal equal[3];
+  size_t equals = 0;
+  if (!filter.brand.empty()) {
+    uint16_t brand = lookup(brand_codes_, filter.brand);
+    if (brand == NO_CODE) {
+      return true;
+    }
+    equal[equals++] = {brand_.data(), brand, brand_rows_[brand]};
+  }
+  if (!filter.country.empty()) {
+    uint16_t country = lookup(country_codes_, filter.country);
+    if (country == NO_CODE) {
+      return true;
+    }
+    equal[equals++] = {country_.data(), country, country_rows_[country]};
+  }
+  if (filter.year != 0) {
+    auto year = filter.year < INT16_MIN || filter.year > INT16_MAX
+                    ? year_rows_.end()
+                    : year_rows_.find(static_cast<int16_t>(filter.year));
+    if (year == year_rows_.end()) {
+      return true;
+    }
+    // Same bits as the int16_t column, compared as unsigned
+    equal[equals++] = {reinterpret_cast<const uint16_t *>(year_.data()),
+                       static_cast<uint16_t>(year->first), year->second};
+  }
+  bool priced = filter.min_cents != INT64_MIN || filter.max_cents != INT64_MAX;
+  if (equals == 0 && !priced && !filter.europe) {
+    return false;
+  }
+
+  // The first filter scans every row; the rest see only what it kept.
+  // At most three filters, so an insertion pass orders them by rows
+  for (size_t f = 1; f < equals; ++f) {
+    for (size_t g = f; g > 0 && equal[g].rows < equal[g - 1].rows; --g) {
+      std::swap(equal[g], equal[g - 1]);
+    }
+  }
+  const SelectKernels &kernels = activeSelectKernels();
+  selection.resize(rows());
+  uint32_t *out = selection.data();
+  size_t selected = 0;
+  bool scanned = false;
+  for (size_t f = 0; f < equals; ++f) {
+    selected = scanned ? kernels.refine_eq_u16(equal[f].column, rows(), out,
+                                               selected, equal[f].value, out)
+                       : kernels.select_eq_u16(equal[f].column, rows(),
+                                               equal[f].value, out);
+    scanned = true;
+  }
+  if (priced) {
+    selected = scanned
+                   ? kernels.refine_range_i64(cents_.data(), rows(), out,
+                                              selected, filter.min_cents,
+                                              filter.max_cents, out)
+                   : kernels.select_range_i64(cents_.data(), rows(),
+                                              filter.min_cents,
+                                              filter.max_cents, out);
+    scanned = true;
+  }
+  if (filter.europe) {
+    if (!scanned) {
+      std::iota(selection.begin(), selection.end(), 0u);
+      selected = rows();
+    }
+    selected = kernels.refine_lookup_u16(country_.data(), rows(), out,
+                                         selected, european_.data(), out);
+  }
+  selection.resize(selected);
+  return true;
+}
+
+std::vector<GroupTotal> ColumnStore::groupBy(StoreKey key,
+                                             const StoreFilter &filter) const {
+  std::vector<uint32_t> selection;
+  bool filtered = select(filter, selection);
+  if (rows() == 0 || (filtered && selection.empty())) {
+    return {};
+  }
+
+  // Every key maps onto a dense slot range: dictionary codes directly,
+  // years and months as offsets from the smallest one loaded
+  size_t slots = 0;
+  switch (key) {
+  case StoreKey::Brand:
+    slots = brands_.size();
+    break;
+  case StoreKey::Country:
+    slots = countries_.size();
+    break;
+  case StoreKey::Year:
+    slots = static_cast<size_t>(max_year_ - min_year_) + 1;
+    break;
+  case StoreKey::Month:
+    slots = min_month_ <= max_month_
+                ? static_cast<size_t>(max_month_ - min_month_) + 1
+                : 0;
+    break;
+  }
+  std::vector<int64_t> counts(slots, 0);
+  std::vector<int64_t> cents(slots, 0);
+
+  auto add = [&](size_t i) {
+    size_t slot;
+    switch (key) {
+    case StoreKey::Brand:
+      slot = brand_[i];
+      break;
+    case StoreKey::Country:
+      slot = country_[i];
+      break;
+    case StoreKey::Year:
+      slot = static_cast<size_t>(year_[i] - min_year_);
+      break;
+    default:
+      if (month_[i] == INVALID_DAY) {
+        return;
+      }
+      slot = static_cast<size_t>(month_[i] - min_month_);
+      break;
+    }
+    ++counts[slot];
+    cents[slot] += cents_[i];
+  };
+  if (filtered) {
+    for (uint32_t i : selection) {
+      add(i);
+    }
+  } else {
+    for (size_t i = 0; i < rows(); ++i) {
+      add(i);
+    }
+  }
+
+  std::vector<GroupTotal> totals;
+  for (size_t slot = 0; slot < slots; ++slot) {
+    if (counts[slot] == 0) {
+      continue;
+    }
+    std::string name;
+    switch (key) {
+    case StoreKey::Brand:
+      name = brands_[slot];
+      break;
+    case StoreKey::Country:
+      name = countries_[slot];
+      break;
+    case StoreKey::Year:
+      name = std::to_string(min_year_ + static_cast<int>(slot));
+      break;
+    case StoreKey::Month:
+      name = bucketLabel(TimeBucket::Month,
+                         min_month_ + static_cast<int32_t>(slot));
+      break;
+    }
+    totals.push_back(GroupTotal{std::move(name), counts[slot], cents[slot]});
+  }
+
+  if (key == StoreKey::Brand || key == StoreKey::Country) {
+    std::sort(totals.begin(), totals.end(),
+              [](const GroupTotal &a, const GroupTotal &b) {
+                if (a.revenue_cents != b.revenue_cents) {
+                  return a.revenue_cents > b.revenue_cents;
+                }
+                return a.key < b.key;
+              });
+  }
+  return totals;
+}
+
+GroupTotal ColumnStore::total(const StoreFilter &filter) const {
+  GroupTotal total;
+  std::vector<uint32_t> selection;
+  if (!select(filter, selection)) {
+    total.count = static_cast<int64_t>(rows());
+    total.revenue_cents = std::accumulate(cents_.begin(), cents_.end(),
+                                          static_cast<int64_t>(0));
+    return total;
+  }
+  total.count = static_cast<int64_t>(selection.size());
+  total.revenue_cents = activeSelectKernels().sum_selected_i64(
+      cents_.data(), rows(), selection.data(), selection.size());
+  return total;
+}
+
+StoreSummary ColumnStore::summary(int year) const {
+  StoreSummary summary;
+  summary.rows = static_cast<int64_t>(rows());
+
+  StoreFilter audi_china;
+  audi_china.brand = "Audi";
+  audi_china.country = "China";
+  audi_china.year = year;
+  summary.audi_china_year_sales = total(audi_china).count;
+
+  StoreFilter bmw;
+  bmw.brand = "BMW";
+  bmw.year = year;
+  summary.bmw_year_revenue_cents = total(bmw).revenue_cents;
+  bmw.europe = true;
+  summary.bmw_europe = groupBy(StoreKey::Country, bmw);
+  return summary;
+}
+
+} // namespace car_sales
@@ -1,6 +1,10 @@
+#include <algorithm>
 #include <cctype>
+#include <sstream>
 
 #include "data_analyzer.hpp"
+#include "hash.hpp"
+#include "result_cache.hpp"
 
 namespace car_sales {
 
@@ -49,8 +53,7 @@ const std::set<std::string> CarSalesAnalyzer::EUROPEAN_COUNTRIES = {
     "Russia"};
 
 CarSalesAnalyzer::CarSalesAnalyzer(size_t chunk_size)
-    : _parser(std::make_unique<CsvParser>(chunk_size)),
-      _audi_china_year_sales(0), _bmw_2025_revenue(0.0),
+    : _parser(std::make_unique<CsvParser>(chunk_size)), _group_limit(10),
       _total_records_processed(0), _total_records_failed(0) {}
 
 bool CarSalesAnalyzer::isEuropeanCountry(const std::string &country) {
@@ -58,67 +61,199 @@ bool CarSalesAnalyzer::isEuropeanCountry(const std::string &country) {
 }
 
 void CarSalesAnalyzer::reset() {
-  _audi_china_year_sales = 0;
-  _bmw_2025_revenue = 0.0;
-  _bmw_europe_revenue.clear();
+  _aggregates = ChunkResult();
+  if (_parser->getGroupBy() != GroupColumn::None) {
+    size_t budget = _parser->getMaxMemory();
+    _aggregates.group_by.enable(
+        budget, budget > 0 ? std::make_shared<GroupSpill>() : nullptr);
+  }
+  _aggregates.heavy_hitters = _parser->makeHeavyHitterSketch();
+  _aggregates.heavy_hitter_metric = _parser->getHeavyHitterMetric();
+  _aggregates.distinct = _parser->makeDistinctCounter();
+  _aggregates.price_quantiles = _parser->makePriceQuantiles();
+  _aggregates.time_series = TimeSeriesAggregator(_parser->getTimeSeries());
+  _aggregates.rolling_daily = TimeSeriesAggregator(
+      _parser->getRollingRevenue() ? TimeBucket::Day : TimeBucket::None);
+  _aggregates.geo_grid = _parser->makeGeoGrid();
   _total_records_processed = 0;
   _total_records_failed = 0;
   _errors.clear();
-}
-
-void CarSalesAnalyzer::processRecord(const CarSaleRecord &record) {
-  // Task 1: Count Audi cars sold in China in 2025
-  if (record.brand == "Audi" && record.country == "China" &&
-      record.year == 2025) {
-    _audi_china_year_sales += record.quantity;
-  }
-
-  // Task 2 & 3: BMW analysis for 2025
-  if (record.brand == "BMW" && record.year == 2025) {
-    // Total BMW revenue in 2025
-    _bmw_2025_revenue += record.revenue;
-
-    // BMW revenue in European countries
-    if (isEuropeanCountry(record.country)) {
-      _bmw_europe_revenue[record.country] += record.revenue;
-    }
-  }
+  _parse_errors.clear();
+  _profile.reset();
 }
 
 void CarSalesAnalyzer::processChunk(const std::vector<CarSaleRecord> &records) {
-  for (const auto &record : records) {
-    processRecord(record);
-  }
+  CsvParser::processChunkAnalysis(records.data(),
+                                  records.data() + records.size(), _aggregates);
   _total_records_processed += records.size();
 }
 
 std::vector<std::pair<std::string, double>>
 CarSalesAnalyzer::getBmwEuropeRevenueDistribution() const {
-  std::vector<std::pair<std::string, double>> distribution(
-      _bmw_europe_revenue.begin(), _bmw_europe_revenue.end());
+  std::vector<std::pair<std::string, int64_t>> cents(
+      _aggregates.bmw_europe_revenue_cents.begin(),
+      _aggregates.bmw_europe_revenue_cents.end());
 
-  // Sort by revenue in descending order
-  std::sort(distribution.begin(), distribution.end(),
-            [](const auto &a, const auto &b) { return a.second > b.second; });
+  // Sort by revenue in descending order; equal revenues fall back to the
+  // country name so hash map iteration order never leaks into the output
+  std::sort(cents.begin(), cents.end(), [](const auto &a, const auto &b) {
+    if (a.second != b.second) {
+      return a.second > b.second;
+    }
+    return a.first < b.first;
+  });
 
+  std::vector<std::pair<std::string, double>> distribution;
+  distribution.reserve(cents.size());
+  for (const auto &[country, amount] : cents) {
+    distribution.emplace_back(country, centsToDollars(amount));
+  }
   return distribution;
 }
 
 AnalysisResult CarSalesAnalyzer::getResults() const {
   AnalysisResult result;
-  result.audi_china_year_sales = _audi_china_year_sales;
-  result.bmw_year_total_revenue = _bmw_2025_revenue;
+  result.audi_china_year_sales = _aggregates.audi_china_year_sales;
+  result.bmw_year_total_revenue_cents = _aggregates.bmw_2025_revenue_cents;
+  result.bmw_year_total_revenue =
+      centsToDollars(_aggregates.bmw_2025_revenue_cents);
   result._bmw_europe_revenuedistribution = getBmwEuropeRevenueDistribution();
+  if (_aggregates.group_by.enabled()) {
+    size_t threads = std::max(1u, std::thread::hardware_concurrency());
+    GroupSummary summary = _aggregates.group_by.summarize(_group_limit, threads);
+    result.group_by_column = _parser->getGroupBy();
+    result.top_groups = std::move(summary.top);
+    result.group_count = summary.distinct_keys;
+    result.group_spill_bytes = summary.spilled_bytes;
+  }
+  if (_aggregates.heavy_hitters.enabled()) {
+    result.heavy_hitter_column = _parser->getHeavyHitterColumn();
+    result.heavy_hitter_metric = _aggregates.heavy_hitter_metric;
+    result.heavy_hitters = _aggregates.heavy_hitters.top(_group_limit);
+    result.heavy_hitter_total = _aggregates.heavy_hitters.totalWeight();
+    result.heavy_hitter_max_error = _aggregates.heavy_hitters.maxError();
+  }
+  if (_aggregates.distinct.enabled()) {
+    result.distinct_column = _parser->getDistinctColumn();
+    result.distinct_precision = _aggregates.distinct.precision();
+    result.distinct_relative_error =
+        HyperLogLog(result.distinct_precision).relativeError();
+    result.distinct_groups = _aggregates.distinct.groups();
+    result.distinct_europe = _aggregates.distinct.rollUp(
+        [](std::string_view country) {
+          return isEuropeanCountry(std::string(country));
+        },
+        "Europe");
+  }
+  if (_aggregates.price_quantiles.enabled()) {
+    result.price_quantile_rank_error =
+        KllSketch(_aggregates.price_quantiles.k()).rankError();
+    result.price_quantile_groups = _aggregates.price_quantiles.groups();
+    result.price_quantiles_europe = _aggregates.price_quantiles.rollUp(
+        [](std::string_view country) {
+          return isEuropeanCountry(std::string(country));
+        },
+        "Europe");
+  }
+  if (_aggregates.time_series.enabled()) {
+    result.time_bucket = _aggregates.time_series.bucket();
+    result.time_series = _aggregates.time_series.points();
+    result.undated_rows = _aggregates.time_series.undatedRows();
+  }
+  if (_aggregates.rolling_daily.enabled()) {
+    result.rolling_windows = _rolling_windows;
+    result.rolling_revenue =
+        rollingWindows(_aggregates.rolling_daily.points(), _rolling_windows);
+  }
+  if (_aggregates.geo_grid.enabled()) {
+    result.geo_cell_degrees = _aggregates.geo_grid.cellDegrees();
+    result.geo_cells = _aggregates.geo_grid.cells();
+    result.unlocated_rows = _aggregates.geo_grid.unlocatedRows();
+  }
   result.total_records_processed = _total_records_processed;
   result.total_records_failed = _total_records_failed;
   result.errors = _errors;
+  result.errors.insert(result.errors.end(), _aggregates.errors.begin(),
+                       _aggregates.errors.end());
+  result.parse_errors = _parse_errors;
+  result.profile = _profile;
   result.analysis_complete = true;
   return result;
 }
 
+AnalysisResult
+CarSalesAnalyzer::finalizeResults(const ChunkResult &parse_result) {
+  _parse_errors = parse_result.parse_errors;
+  _profile = parse_result.profile;
+  StageProfile *profile = _profile.enabled ? &_profile : nullptr;
+
+  AnalysisResult result;
+  {
+    ScopedStageTimer timer(profile, Stage::Merge);
+    result = getResults();
+  }
+  result.profile = _profile;
+  result.total_records_filtered = parse_result.records_filtered;
+  result.analysis_complete = parse_result.success && _aggregates.success;
+  return result;
+}
+
+uint64_t CarSalesAnalyzer::queryFingerprint() const {
+  std::ostringstream query;
+  query.precision(17);
+  query << "delimiter " << static_cast<int>(_parser->getDelimiter())
+        << "\ngroup " << static_cast<int>(_parser->getGroupBy()) << ' '
+        << _group_limit << ' ' << _parser->getMaxMemory() << "\nheavy "
+        << static_cast<int>(_parser->getHeavyHitterColumn()) << ' '
+        << static_cast<int>(_parser->getHeavyHitterMetric()) << ' '
+        << _parser->getHeavyHitterCapacity() << "\ndistinct "
+        << static_cast<int>(_parser->getDistinctColumn()) << ' '
+        << _parser->getDistinctPrecision() << "\nseries "
+        << static_cast<int>(_parser->getTimeSeries()) << "\nrolling";
+  for (uint32_t days : _rolling_windows) {
+    query << ' ' << days;
+  }
+  query << "\ngeo " << _parser->getGeoGrid();
+  if (_parser->hasBoundingBox()) {
+    const BoundingBox &box = _parser->getBoundingBox();
+    query << "\nbbox " << box.min_lat << ' ' << box.min_lon << ' '
+          << box.max_lat << ' ' << box.max_lon;
+  }
+  return hashBytes(query.str());
+}
+
+bool CarSalesAnalyzer::cacheable() const {
+  return !_parser->isProfilingEnabled() &&
+         !_parser->isHardwareCountersEnabled() &&
+         _parser->getRejectFile().empty() && _parser->getPriceQuantileK() == 0;
+}
+
 AnalysisResult CarSalesAnalyzer::analyzeFile(const std::string &filename,
                                              bool use_concurrent,
                                              size_t num_threads) {
+  FileIdentity identity;
+  // A stream has no identity to key the cache on
+  if (!_cache || !cacheable() || isStreamInput(filename) ||
+      !FileIdentity::of(filename, identity)) {
+    return parseAndAnalyze(filename, use_concurrent, num_threads);
+  }
+
+  uint64_t query = queryFingerprint();
+  AnalysisResult result;
+  if (_cache->lookup(identity, query, result)) {
+    result.from_cache = true;
+    return result;
+  }
+  result = parseAndAnalyze(filename, use_concurrent, num_threads);
+  if (result.analysis_complete) {
+    _cache->store(identity, query, result);
+  }
+  return result;
+}
+
+AnalysisResult CarSalesAnalyzer::parseAndAnalyze(const std::string &filename,
+                                                 bool use_concurrent,
+                                                 size_t num_threads) {
   reset();
 
   if (use_concurrent) {
@@ -127,20 +262,36 @@ AnalysisResult CarSalesAnalyzer::analyzeFile(const std::string &filename,
         _parser->parseFileConcurrent(filename, num_threads);
 
     // Transfer results from concurrent processing
-    _audi_china_year_sales = parse_result.audi_china_year_sales;
-    _bmw_2025_revenue = parse_result.bmw_2025_revenue;
-    _bmw_europe_revenue = parse_result.bmw_europe_revenue;
+    _aggregates.audi_china_year_sales = parse_result.audi_china_year_sales;
+    _aggregates.bmw_2025_revenue_cents = parse_result.bmw_2025_revenue_cents;
+    _aggregates.bmw_europe_revenue_cents =
+        parse_result.bmw_europe_revenue_cents;
+    if (parse_result.group_by.enabled()) {
+      _aggregates.group_by = std::move(parse_result.group_by);
+    }
+    if (parse_result.heavy_hitters.enabled()) {
+      _aggregates.heavy_hitters = std::move(parse_result.heavy_hitters);
+    }
+    if (parse_result.distinct.enabled()) {
+      _aggregates.distinct = std::move(parse_result.distinct);
+    }
+    if (parse_result.price_quantiles.enabled()) {
+      _aggregates.price_quantiles = std::move(parse_result.price_quantiles);
+    }
+    if (parse_result.time_series.enabled()) {
+      _aggregates.time_series = std::move(parse_result.time_series);
+    }
+    if (parse_result.rolling_daily.enabled()) {
+      _aggregates.rolling_daily = std::move(parse_result.rolling_daily);
+    }
+    if (parse_result.geo_grid.enabled()) {
+      _aggregates.geo_grid = std::move(parse_result.geo_grid);
+    }
     _total_records_processed = parse_result.records_processed;
     _total_records_failed = parse_result.records_failed;
     _errors = parse_result.errors;
 
-    if (!parse_result.success) {
-      AnalysisResult result = getResults();
-      result.analysis_complete = false;
-      return result;
-    }
-
-    return getResults();
+    return finalizeResults(parse_result);
   }
 
   // Sequential processing
@@ -163,13 +314,29 @@ AnalysisResult CarSalesAnalyzer::analyzeFile(const std::string &filename,
   _total_records_failed = parse_result.records_failed;
   _errors = parse_result.errors;
 
-  if (!parse_result.success) {
-    AnalysisResult result = getResults();
-    result.analysis_complete = false;
-    return result;
-  }
+  return finalizeResults(parse_result);
+}
+
+AnalysisResult CarSalesAnalyzer::analyzeSample(const std::string &filename,
+                                               const SampleOptions &options,
+                                               size_t num_threads) {
+  reset();
+
+  SampleReport report;
+  ChunkResult parse_result =
+      _parser->sampleFile(filename, options, report, num_threads);
 
-  return getResults();
+  _aggregates.audi_china_year_sales = parse_result.audi_china_year_sales;
+  _aggregates.bmw_2025_revenue_cents = parse_result.bmw_2025_revenue_cents;
+  _aggregates.bmw_europe_revenue_cents = parse_result.bmw_europe_revenue_cents;
+  _total_records_processed = parse_result.records_processed;
+  _total_records_failed = parse_result.records_failed;
+  _errors = parse_result.errors;
+
+  AnalysisResult result = finalizeResults(parse_result);
+  result.approximate = true;
+  result.sample = std::move(report);
+  return result;
 }
 
 AnalysisResult CarSalesAnalyzer::analyzeString(const std::string &content) {
@@ -194,13 +361,7 @@ AnalysisResult CarSalesAnalyzer::analyzeString(const std::string &content) {
   _total_records_failed = parse_result.records_failed;
   _errors = parse_result.errors;
 
-  if (!parse_result.success) {
-    AnalysisResult result = getResults();
-    result.analysis_complete = false;
-    return result;
-  }
-
-  return getResults();
+  return finalizeResults(parse_result);
 }
 
 } // namespace car_sales
\ No newline at end of file
@@ -1,7 +1,13 @@
+#include <algorithm>
 #include <cctype>
+#include <charconv>
+#include <iterator>
 #include <set>
+#include <utility>
 
 #include "data_parser.hpp"
+#include "record_boundaries.hpp"
+#include "row_expr.hpp"
 
 namespace car_sales {
 
@@ -53,15 +59,62 @@ static bool isEuropeanCountry(const std::string &country) {
   return EUROPEAN_COUNTRIES.find(country) != EUROPEAN_COUNTRIES.end();
 }
 
+// Start the wall interval of result.profile and return it, or nullptr when
+// profiling is disabled (at runtime or at compile time)
+static StageProfile *startProfile(bool enabled, ChunkResult &result) {
+  if (!profiling::COMPILED_IN || !enabled) {
+    return nullptr;
+  }
+  result.profile.begin();
+  return &result.profile;
+}
+
+// LineReader::nextRecord with the read (and any wait for a block) charged
+// to the I/O stage. tick_scale receives the record's rowTickScale(), which
+// its later per-row stages are timed with
+static bool readRecord(LineReader &in, std::string_view &record, size_t &lines,
+                       StageProfile *profile, uint64_t &tick_scale) {
+  if (!profile) {
+    tick_scale = 0;
+    return in.nextRecord(record, lines);
+  }
+  tick_scale = profile->rowTickScale();
+  uint64_t start = tick_scale ? profiling::ticks() : 0;
+  if (!in.nextRecord(record, lines)) {
+    return false;
+  }
+  uint64_t ticks = tick_scale ? (profiling::ticks() - start) * tick_scale : 0;
+  profile->add(Stage::Io, ticks, record.size() + 1, 1);
+  return true;
+}
+
 CsvParser::CsvParser(size_t chunk_size, char delimiter)
     : chunk_size_(chunk_size), _total_records_processed(0),
-      delimiter_(delimiter) {
+      delimiter_(delimiter), profiling_enabled_(false),
+      hardware_counters_enabled_(false), group_by_(GroupColumn::None),
+      max_memory_(0), heavy_hitter_column_(GroupColumn::None),
+      heavy_hitter_metric_(HeavyHitterMetric::Units),
+      heavy_hitter_capacity_(SpaceSavingSketch::DEFAULT_CAPACITY),
+      distinct_column_(GroupColumn::None),
+      distinct_precision_(HLL_DEFAULT_PRECISION), price_quantile_k_(0),
+      time_bucket_(TimeBucket::None), rolling_revenue_(false),
+      decode_sale_day_(false),
+      geo_cell_degrees_(0.0), has_bounding_box_(false),
+      placement_(WorkerPlacement::None) {
   if (chunk_size_ == 0) {
     chunk_size_ = DEFAULT_CHUNK_SIZE;
   }
+  applySchema(Schema::standard());
+}
+
+ParseWorkspace &CsvParser::workspace(size_t index) {
+  while (workspaces_.size() <= index) {
+    workspaces_.push_back(std::make_unique<ParseWorkspace>());
+  }
+  return *workspaces_[index];
 }
 
-int CsvParser::extractYearFromDate(const std::string &date_str) {
+int CsvParser::extractYearFromDate(std::string_view date_str) {
   // Format: DD-MM-YYYY
   if (date_str.length() < 10) {
     return 0;
@@ -69,19 +122,22 @@ int CsvParser::extractYearFromDate(const std::string &date_str) {
 
   // Find the last dash and extract year after it
   size_t last_dash = date_str.rfind('-');
-  if (last_dash == std::string::npos || last_dash + 1 >= date_str.length()) {
+  if (last_dash == std::string_view::npos ||
+      last_dash + 1 >= date_str.length()) {
     return 0;
   }
 
-  try {
-    std::string year_str = date_str.substr(last_dash + 1, 4);
-    return std::stoi(year_str);
-  } catch (...) {
+  std::string_view year_str = date_str.substr(last_dash + 1, 4);
+  int year = 0;
+  auto [ptr, ec] =
+      std::from_chars(year_str.data(), year_str.data() + year_str.size(), year);
+  if (ec != std::errc() || ptr == year_str.data()) {
     return 0;
   }
+  return year;
 }
 
-std::string CsvParser::trim(const std::string &str) {
+std::string_view CsvParser::trim(std::string_view str) {
   size_t start = 0;
   size_t end = str.length();
 
@@ -97,124 +153,441 @@ std::string CsvParser::trim(const std::string &str) {
   return str.substr(start, end - start);
 }
 
-std::vector<std::string> CsvParser::splitLine(const std::string &line,
-                                              char delimiter) {
-  std::vector<std::string> fields;
-  std::string field;
+void CsvParser::splitLine(std::string_view line, char delimiter,
+                          ParseWorkspace &ws, size_t max_fields) {
+  ws.fields.clear();
+
+  size_t field_start = 0;
   bool in_quotes = false;
+  bool has_quotes = false;
+
+  auto emit = [&](size_t field_end) {
+    std::string_view raw = line.substr(field_start, field_end - field_start);
+    if (!has_quotes) {
+      ws.fields.push_back(trim(raw));
+      return;
+    }
+    // Quote characters are dropped, except that "" inside quotes is a
+    // literal quote (RFC 4180); the rest is copied into the arena
+    char *dest = static_cast<char *>(ws.arena.allocate(raw.size(), 1));
+    size_t n = 0;
+    bool quoted = false;
+    for (size_t i = 0; i < raw.size(); ++i) {
+      if (raw[i] != '"') {
+        dest[n++] = raw[i];
+      } else if (quoted && i + 1 < raw.size() && raw[i + 1] == '"') {
+        dest[n++] = '"';
+        ++i;
+      } else {
+        quoted = !quoted;
+      }
+    }
+    ws.fields.push_back(trim(std::string_view(dest, n)));
+  };
 
   for (size_t i = 0; i < line.length(); ++i) {
     char c = line[i];
 
     if (c == '"') {
       in_quotes = !in_quotes;
+      has_quotes = true;
     } else if (c == delimiter && !in_quotes) {
-      fields.push_back(trim(field));
-      field.clear();
-    } else {
-      field += c;
+      emit(i);
+      if (ws.fields.size() == max_fields) {
+        return; // nothing further along is read
+      }
+      field_start = i + 1;
+      has_quotes = false;
     }
   }
 
   // Don't forget the last field
-  fields.push_back(trim(field));
+  emit(line.length());
+}
+
+std::optional<CarSaleRecord> CsvParser::parseLine(const std::string &line) {
+  if (!line_workspace_) {
+    line_workspace_ = std::make_unique<ParseWorkspace>();
+  }
+  line_workspace_->arena.reset();
+  // Pick up analysis settings changed since the schema was bound
+  applySchema(schema_);
 
-  return fields;
+  CarSaleRecord record;
+  if (parseRecordInto(line, *line_workspace_, record, nullptr, 0) !=
+      ParseErrorCode::None) {
+    return std::nullopt;
+  }
+  return record;
 }
 
-bool CsvParser::isNumeric(const std::string &str) {
-  if (str.empty())
-    return false;
+namespace {
 
-  size_t start = 0;
-  if (str[0] == '-' || str[0] == '+') {
-    start = 1;
+// Columns every row must have
+constexpr SchemaColumn REQUIRED_COLUMNS[] = {
+    SchemaColumn::SaleDate, SchemaColumn::Country, SchemaColumn::Manufacturer,
+    SchemaColumn::SalePrice};
+
+constexpr size_t requiredFieldCount(const std::array<int, SCHEMA_COLUMNS> &index) {
+  size_t count = 0;
+  for (SchemaColumn column : REQUIRED_COLUMNS) {
+    count = std::max(count, static_cast<size_t>(
+                                index[static_cast<size_t>(column)]) + 1);
+  }
+  return count;
+}
+
+// The data.csv layout: every position is a compile-time constant, so the
+// row parser compiles to fixed field offsets as if written by hand
+struct StandardLayout {
+  static constexpr size_t at(SchemaColumn column) {
+    return static_cast<size_t>(
+        STANDARD_COLUMN_INDEX[static_cast<size_t>(column)]);
   }
+  static constexpr size_t min_fields = requiredFieldCount(STANDARD_COLUMN_INDEX);
+};
+
+// Positions bound from a header at run time (a missing column maps past
+// any row)
+struct BoundLayout {
+  const Schema &schema;
+  size_t min_fields;
+  size_t at(SchemaColumn column) const {
+    return static_cast<size_t>(schema.index(column));
+  }
+};
+
+} // namespace
+
+void CsvParser::applySchema(const Schema &schema) {
+  schema_ = schema;
+  standard_layout_ = schema.isStandard();
+  auto key_index = [&schema](GroupColumn column) {
+    return column == GroupColumn::None
+               ? -1
+               : schema.index(schemaColumnFor(column));
+  };
+  group_key_index_ = key_index(group_by_);
+  heavy_hitter_key_index_ = key_index(heavy_hitter_column_);
+  distinct_key_index_ = key_index(distinct_column_);
+
+  // Split only as far as the last column anything reads
+  min_fields_ = requiredFieldCount(schema.indices());
+  max_fields_ = min_fields_;
+  int last = std::max({group_key_index_, heavy_hitter_key_index_,
+                       distinct_key_index_});
+  if (geo_cell_degrees_ > 0.0 || has_bounding_box_) {
+    last = std::max({last, schema.index(SchemaColumn::Latitude),
+                     schema.index(SchemaColumn::Longitude)});
+  }
+  max_fields_ = std::max(max_fields_, static_cast<size_t>(last + 1));
+}
 
-  bool has_dot = false;
-  for (size_t i = start; i < str.length(); ++i) {
-    if (str[i] == '.') {
-      if (has_dot)
-        return false;
-      has_dot = true;
-    } else if (!std::isdigit(static_cast<unsigned char>(str[i]))) {
-      return false;
+bool CsvParser::bindSchema(std::string_view header, ChunkResult &result) {
+  Schema schema = Schema::fromHeader(header, delimiter_);
+
+  std::vector<SchemaColumn> needed(std::begin(REQUIRED_COLUMNS),
+                                   std::end(REQUIRED_COLUMNS));
+  if (geo_cell_degrees_ > 0.0 || has_bounding_box_) {
+    needed.push_back(SchemaColumn::Latitude);
+    needed.push_back(SchemaColumn::Longitude);
+  }
+  for (GroupColumn column : {group_by_, heavy_hitter_column_, distinct_column_}) {
+    if (column != GroupColumn::None) {
+      needed.push_back(schemaColumnFor(column));
     }
   }
 
-  return start < str.length();
+  std::string missing;
+  for (SchemaColumn column : needed) {
+    if (!schema.has(column) &&
+        missing.find(schemaColumnName(column)) == std::string::npos) {
+      missing += missing.empty() ? "" : ", ";
+      missing += schemaColumnName(column);
+    }
+  }
+  if (!missing.empty()) {
+    result.success = false;
+    result.errors.push_back("Header has no column named " + missing);
+    return false;
+  }
+  applySchema(schema);
+  return true;
 }
 
-std::optional<CarSaleRecord> CsvParser::parseLine(const std::string &line) {
+ParseError CsvParser::rowError(uint64_t byte_offset, uint64_t line,
+                               ParseErrorCode code) const {
+  ParseError error(byte_offset, line, code);
+  error.column = schema_.errorColumn(code);
+  return error;
+}
+
+ParseErrorCode CsvParser::parseRecordInto(std::string_view line,
+                                          ParseWorkspace &ws,
+                                          CarSaleRecord &record,
+                                          StageProfile *profile,
+                                          uint64_t tick_scale) const {
   if (line.empty()) {
-    return std::nullopt;
+    return ParseErrorCode::TooFewFields;
   }
 
-  auto fields = splitLine(line, delimiter_);
-
-  // data.csv format (tab-separated, 42+ columns):
-  // 0: sale_id, 1: sale_date (DD-MM-YYYY), 2: country, 3: region, ...
-  // 8: manufacturer, 9: model, 10: vehicle_year, ...
-  // 20: sale_price_usd, ...
+  {
+    ScopedStageTimer timer(profile, Stage::Tokenize, line.size(), 1,
+                           tick_scale);
+    splitLine(line, delimiter_, ws, max_fields_);
+  }
+  ScopedStageTimer timer(profile, Stage::NumericParse, 0, 1, tick_scale);
 
-  if (fields.size() < 21) {
-    return std::nullopt;
+  if (standard_layout_) {
+    return bindFields(StandardLayout(), ws.fields, record);
   }
+  return bindFields(BoundLayout{schema_, min_fields_}, ws.fields, record);
+}
 
-  try {
-    CarSaleRecord record;
-    record.brand = fields[8];                     // manufacturer
-    record.country = fields[2];                   // country
-    record.year = extractYearFromDate(fields[1]); // sale_date
-    record.quantity = 1;                          // each row is one sale
+template <class Layout>
+ParseErrorCode CsvParser::bindFields(const Layout &layout,
+                                     const std::vector<std::string_view> &fields,
+                                     CarSaleRecord &record) const {
+  if (fields.size() < layout.min_fields) {
+    return ParseErrorCode::TooFewFields;
+  }
 
-    // Parse sale_price_usd
-    if (!isNumeric(fields[20])) {
-      return std::nullopt;
+  // Latitude and longitude. The bounding box is tested before anything
+  // else is parsed
+  if (geo_cell_degrees_ > 0.0 || has_bounding_box_) {
+    size_t latitude = layout.at(SchemaColumn::Latitude);
+    size_t longitude = layout.at(SchemaColumn::Longitude);
+    if (latitude >= fields.size() || longitude >= fields.size() ||
+        !parseCoordinate(fields[latitude], 90.0, record.latitude) ||
+        !parseCoordinate(fields[longitude], 180.0, record.longitude)) {
+      record.latitude = std::numeric_limits<double>::quiet_NaN();
+      record.longitude = std::numeric_limits<double>::quiet_NaN();
     }
-    record.revenue = std::stod(fields[20]);
-
-    // Basic validation
-    if (record.brand.empty() || record.country.empty()) {
-      return std::nullopt;
+    if (has_bounding_box_ &&
+        !bounding_box_.contains(record.latitude, record.longitude)) {
+      return ParseErrorCode::Filtered;
     }
+  }
 
-    if (record.year < 1900 || record.year > 2100) {
-      return std::nullopt;
-    }
+  std::string_view brand = fields[layout.at(SchemaColumn::Manufacturer)];
+  std::string_view country = fields[layout.at(SchemaColumn::Country)];
+  std::string_view sale_date = fields[layout.at(SchemaColumn::SaleDate)];
+
+  // Basic validation
+  if (brand.empty()) {
+    return ParseErrorCode::MissingBrand;
+  }
+  if (country.empty()) {
+    return ParseErrorCode::MissingCountry;
+  }
 
-    return record;
+  record.year = extractYearFromDate(sale_date);
+  if (record.year == 0) {
+    return ParseErrorCode::InvalidDate;
+  }
+  if (record.year < MIN_SALE_YEAR || record.year > MAX_SALE_YEAR) {
+    return ParseErrorCode::YearOutOfRange;
+  }
 
-  } catch (const std::exception &) {
-    return std::nullopt;
+  // Parse sale_price_usd exactly into cents; the double is derived from it
+  if (!parseCents(fields[layout.at(SchemaColumn::SalePrice)],
+                  record.revenue_cents)) {
+    return ParseErrorCode::InvalidPrice;
+  }
+  record.revenue = centsToDollars(record.revenue_cents);
+
+  // assign() reuses the slot's existing string capacity
+  record.brand.assign(brand);
+  record.country.assign(country);
+  record.quantity = 1; // each row is one sale
+  if (time_bucket_ != TimeBucket::None || rolling_revenue_ ||
+      decode_sale_day_) {
+    // Rows with a bad day or month still count everywhere else
+    record.sale_day = parseSaleDay(sale_date);
+  }
+
+  // Optional key columns; rows too short to have one group under ""
+  auto column_value = [&fields](int index) {
+    return static_cast<size_t>(index) < fields.size() ? fields[index]
+                                                      : std::string_view();
+  };
+  if (group_by_ != GroupColumn::None) {
+    record.group_key.assign(column_value(group_key_index_));
+  }
+  if (heavy_hitter_column_ != GroupColumn::None) {
+    record.heavy_hitter_key.assign(column_value(heavy_hitter_key_index_));
+  }
+  if (distinct_column_ != GroupColumn::None) {
+    // Only the hash is needed, so the value is never copied
+    record.distinct_hash = hashBytes(column_value(distinct_key_index_));
+  }
+  return ParseErrorCode::None;
+}
+
+std::unique_ptr<RejectFileWriter>
+CsvParser::openRejectFile(ChunkResult &result) const {
+  if (reject_file_path_.empty()) {
+    return nullptr;
+  }
+  auto writer = std::make_unique<RejectFileWriter>(reject_file_path_);
+  if (!writer->isOpen()) {
+    result.errors.push_back("Failed to open reject file: " +
+                            reject_file_path_);
+    return nullptr;
+  }
+  return writer;
+}
+
+// Record a rejected row, keeping at most MAX_STORED_PARSE_ERRORS details
+static void recordParseError(ChunkResult &result, const ParseError &error) {
+  result.records_failed++;
+  if (result.parse_errors.size() < MAX_STORED_PARSE_ERRORS) {
+    result.parse_errors.push_back(error);
+  }
+}
+
+// Close the reject writer and surface write failures
+static void closeRejectFile(std::unique_ptr<RejectFileWriter> &writer,
+                            ChunkResult &result) {
+  if (writer && !writer->close()) {
+    result.errors.push_back("Failed writing reject file: " + writer->path());
   }
 }
 
 ChunkResult CsvParser::parseFile(const std::string &filename,
                                  ChunkProcessor processor) {
+  ReadAheadReader reader(read_ahead_);
+  std::string error;
+  if (!reader.open(filename, error)) {
+    ChunkResult overall_result;
+    _total_records_processed = 0;
+    overall_result.success = false;
+    overall_result.errors.push_back("Failed to open file: " + filename);
+    return overall_result;
+  }
+  return parseReader(reader, processor, filename);
+}
+
+// Read-ahead settings for a descriptor: O_DIRECT does not apply to pipes
+static ReadAheadOptions streamOptions(ReadAheadOptions options) {
+  options.direct = false;
+  return options;
+}
+
+ChunkResult CsvParser::parseDescriptor(int fd, ChunkProcessor processor) {
+  ReadAheadReader reader(streamOptions(read_ahead_));
+  reader.attach(fd);
+  return parseReader(reader, processor, "descriptor " + std::to_string(fd));
+}
+
+ChunkResult CsvParser::parseReader(ReadAheadReader &reader,
+                                   ChunkProcessor &processor,
+                                   const std::string &name) {
   ChunkResult overall_result;
   _total_records_processed = 0;
 
-  std::ifstream file(filename);
-  if (!file.is_open()) {
+  LineReader lines(reader);
+  parseStream(lines, processor, overall_result, true);
+  std::string error = reader.error();
+  if (!error.empty()) {
     overall_result.success = false;
-    overall_result.errors.push_back("Failed to open file: " + filename);
-    return overall_result;
+    overall_result.errors.push_back(error + ": " + name);
+  }
+  return overall_result;
+}
+
+ChunkResult CsvParser::parseString(const std::string &content,
+                                   ChunkProcessor processor) {
+  ChunkResult overall_result;
+  _total_records_processed = 0;
+
+  LineReader lines(content);
+  parseStream(lines, processor, overall_result, false);
+  return overall_result;
+}
+
+void CsvParser::parseStream(LineReader &in, ChunkProcessor &processor,
+                            ChunkResult &overall_result,
+                            bool detailed_errors) {
+  StageProfile *profile = startProfile(profiling_enabled_, overall_result);
+
+  std::unique_ptr<PerfCounterGroup> counters;
+  if (hardware_counters_enabled_) {
+    counters = std::make_unique<PerfCounterGroup>();
   }
+  HwStageTracker hw(counters.get(),
+                    counters ? &overall_result.profile.hardware : nullptr);
+  hw.enter(HwStage::Parse);
+
+  ParseWorkspace &ws = workspace(0);
+  ws.arena.reset();
 
-  std::string line;
-  std::vector<CarSaleRecord> chunk;
+  std::unique_ptr<RejectFileWriter> rejects = openRejectFile(overall_result);
+  RejectBuffer reject_buffer(rejects.get());
+
+  // Records are rebuilt in place in the workspace batch, as on the
+  // concurrent path, so their strings keep their capacity across chunks
+  std::string_view line;
+  RecordBatch &chunk = ws.batch;
+  chunk.clear();
   chunk.reserve(chunk_size_);
 
   size_t line_number = 0;
+  uint64_t byte_offset = 0;
   bool is_header = true;
 
-  while (std::getline(file, line)) {
+  // Live progress: the sequential path is worker 0, busy throughout
+  WorkerProgress *progress = progress_ ? progress_->worker(0) : nullptr;
+  uint64_t progress_start = progress ? ProgressTracker::nowNs() : 0;
+
+  // Hand the current chunk to the processor and account for it
+  auto flush_chunk = [&](bool final_chunk) {
+    ChunkResult chunk_result;
+    bool ok;
+    hw.enter(HwStage::Aggregate);
+    {
+      ScopedStageTimer timer(profile, Stage::Aggregate, 0, chunk.size());
+      ok = processor(chunk.records(), chunk_result);
+    }
+    hw.addRows(HwStage::Aggregate, chunk.size());
+    hw.enter(HwStage::Parse);
+    if (!ok) {
+      overall_result.success = false;
+      if (detailed_errors) {
+        overall_result.errors.push_back(
+            final_chunk ? std::string("Final chunk processing failed")
+                        : "Chunk processing failed at line " +
+                              std::to_string(line_number));
+      }
+    }
+    overall_result.records_processed += chunk.size();
+    _total_records_processed += chunk.size();
+    chunk.clear();
+    ws.arena.reset();
+    if (progress) {
+      progress->publish(byte_offset, overall_result.records_processed,
+                        overall_result.records_failed,
+                        ProgressTracker::nowNs() - progress_start);
+    }
+  };
+
+  size_t physical_lines;
+  uint64_t tick_scale;
+  while (readRecord(in, line, physical_lines, profile, tick_scale)) {
+    // A record with quoted newlines is numbered by its first line
     ++line_number;
+    size_t record_line = line_number;
+    line_number += physical_lines - 1;
+    uint64_t line_offset = byte_offset;
+    byte_offset += line.size() + 1;
 
     // Skip header line
     if (is_header) {
       is_header = false;
+      reject_buffer.add(line);
+      if (!bindSchema(line, overall_result)) {
+        break;
+      }
       continue;
     }
 
@@ -223,146 +596,512 @@ ChunkResult CsvParser::parseFile(const std::string &filename,
       continue;
     }
 
-    auto record = parseLine(line);
-    if (record) {
-      chunk.push_back(*record);
-    } else {
-      overall_result.records_failed++;
-      if (overall_result.errors.size() < 100) { // Limit error messages
-        overall_result.errors.push_back(
-            "Failed to parse line " + std::to_string(line_number) + ": " +
-            (line.length() > 50 ? line.substr(0, 50) + "..." : line));
-      }
+    hw.addRows(HwStage::Parse, 1);
+    CarSaleRecord &record = chunk.next();
+    ParseErrorCode code =
+        parseRecordInto(line, ws, record, profile, tick_scale);
+    if (code == ParseErrorCode::Filtered) {
+      chunk.discardLast();
+      ++overall_result.records_filtered;
+    } else if (code != ParseErrorCode::None) {
+      chunk.discardLast();
+      recordParseError(overall_result,
+                       rowError(line_offset, record_line, code));
+      reject_buffer.add(line);
     }
 
     // Process chunk when full
     if (chunk.size() >= chunk_size_) {
-      ChunkResult chunk_result;
-      if (!processor(chunk, chunk_result)) {
-        overall_result.success = false;
-        overall_result.errors.push_back("Chunk processing failed at line " +
-                                        std::to_string(line_number));
-      }
-      overall_result.records_processed += chunk.size();
-      _total_records_processed += chunk.size();
-      chunk.clear();
+      flush_chunk(false);
     }
   }
 
   // Process remaining records
   if (!chunk.empty()) {
-    ChunkResult chunk_result;
-    if (!processor(chunk, chunk_result)) {
-      overall_result.success = false;
-      overall_result.errors.push_back("Final chunk processing failed");
-    }
-    overall_result.records_processed += chunk.size();
-    _total_records_processed += chunk.size();
+    flush_chunk(true);
   }
 
-  file.close();
-  return overall_result;
+  hw.stop();
+  reject_buffer.flush();
+  closeRejectFile(rejects, overall_result);
+  overall_result.lines_scanned = line_number;
+  if (profile) {
+    profile->end();
+  }
 }
 
-ChunkResult CsvParser::parseString(const std::string &content,
-                                   ChunkProcessor processor) {
-  ChunkResult overall_result;
-  _total_records_processed = 0;
+SpaceSavingSketch CsvParser::makeHeavyHitterSketch() const {
+  if (heavy_hitter_column_ == GroupColumn::None) {
+    return SpaceSavingSketch();
+  }
+  return SpaceSavingSketch(std::max<size_t>(1, heavy_hitter_capacity_));
+}
 
-  std::istringstream stream(content);
-  std::string line;
-  std::vector<CarSaleRecord> chunk;
-  chunk.reserve(chunk_size_);
+DistinctCounter CsvParser::makeDistinctCounter() const {
+  if (distinct_column_ == GroupColumn::None) {
+    return DistinctCounter();
+  }
+  return DistinctCounter(distinct_precision_);
+}
 
-  size_t line_number = 0;
-  bool is_header = true;
+PriceQuantiles CsvParser::makePriceQuantiles() const {
+  if (price_quantile_k_ == 0) {
+    return PriceQuantiles();
+  }
+  return PriceQuantiles(price_quantile_k_);
+}
 
-  while (std::getline(stream, line)) {
-    ++line_number;
+GeoGrid CsvParser::makeGeoGrid() const {
+  if (geo_cell_degrees_ <= 0.0) {
+    return GeoGrid();
+  }
+  return GeoGrid(geo_cell_degrees_);
+}
 
-    // Skip header line
-    if (is_header) {
-      is_header = false;
-      continue;
-    }
+// Flag a revenue total that no longer fits in int64 cents
+static void markRevenueOverflow(ChunkResult &result) {
+  if (result.success) {
+    result.errors.push_back("Revenue total exceeds the int64 cents range");
+  }
+  result.success = false;
+}
 
-    // Skip empty lines
-    if (trim(line).empty()) {
-      continue;
+void CsvParser::processChunkAnalysis(const CarSaleRecord *begin,
+                                     const CarSaleRecord *end,
+                                     ChunkResult &result) {
+  using namespace expr;
+
+  // The three tasks as expressions. Per block, sumRows fuses them into one
+  // pass of masked adds; only BMW 2025 rows reach the country lookup. A
+  // block sum is bounded by CENTS_BLOCK_ROWS * MAX_PRICE_CENTS, so only the
+  // per-block add into the running total needs an overflow check.
+  const auto year_2025 = col<Year> == 2025;
+  const auto audi_china =
+      year_2025 && col<Manufacturer> == "Audi" && col<Country> == "China";
+  const auto bmw_2025 = year_2025 && col<Manufacturer> == "BMW";
+  const auto bmw_europe = bmw_2025 && call(col<Country>, isEuropeanCountry);
+  auto add_europe = [&result](const CarSaleRecord &row) {
+    if (!addCents(result.bmw_europe_revenue_cents[row.country],
+                  row.revenue_cents)) {
+      markRevenueOverflow(result);
     }
-
-    auto record = parseLine(line);
-    if (record) {
-      chunk.push_back(*record);
-    } else {
-      overall_result.records_failed++;
-      if (overall_result.errors.size() < 100) {
-        overall_result.errors.push_back("Failed to parse line " +
-                                        std::to_string(line_number));
-      }
+  };
+
+  for (const CarSaleRecord *block = begin; block != end;) {
+    size_t count =
+        std::min(CENTS_BLOCK_ROWS, static_cast<size_t>(end - block));
+    // Audi units, BMW cents (the action adds nothing)
+    std::array<int64_t, 3> sums =
+        sumRows(block, count, sumIf(audi_china, col<Quantity>),
+                sumIf(bmw_2025, col<RevenueCents>),
+                eachIf(bmw_europe, add_europe));
+
+    result.audi_china_year_sales += static_cast<int>(sums[0]);
+    if (!addCents(result.bmw_2025_revenue_cents, sums[1])) {
+      markRevenueOverflow(result);
     }
+    block += count;
+  }
 
-    // Process chunk when full
-    if (chunk.size() >= chunk_size_) {
-      ChunkResult chunk_result;
-      if (!processor(chunk, chunk_result)) {
-        overall_result.success = false;
-      }
-      overall_result.records_processed += chunk.size();
-      _total_records_processed += chunk.size();
-      chunk.clear();
+  if (result.group_by.enabled()) {
+    for (const CarSaleRecord *it = begin; it != end; ++it) {
+      result.group_by.add(it->group_key, it->quantity, it->revenue_cents);
     }
+    result.group_by.spillIfOverBudget();
   }
 
-  // Process remaining records
-  if (!chunk.empty()) {
-    ChunkResult chunk_result;
-    if (!processor(chunk, chunk_result)) {
-      overall_result.success = false;
+  if (result.heavy_hitters.enabled()) {
+    bool by_revenue = result.heavy_hitter_metric == HeavyHitterMetric::Revenue;
+    for (const CarSaleRecord *it = begin; it != end; ++it) {
+      result.heavy_hitters.add(it->heavy_hitter_key,
+                               by_revenue ? it->revenue_cents : it->quantity);
     }
-    overall_result.records_processed += chunk.size();
-    _total_records_processed += chunk.size();
   }
 
-  return overall_result;
-}
+  if (result.distinct.enabled()) {
+    for (const CarSaleRecord *it = begin; it != end; ++it) {
+      result.distinct.add(it->brand, it->country, it->distinct_hash);
+    }
+  }
 
-void CsvParser::processChunkAnalysis(const std::vector<CarSaleRecord> &chunk,
-                                     ChunkResult &result) {
-  for (const auto &record : chunk) {
-    // Task 1: Count Audi cars sold in China in 2025
-    if (record.brand == "Audi" && record.country == "China" &&
-        record.year == 2025) {
-      result.audi_china_year_sales += record.quantity;
+  if (result.price_quantiles.enabled()) {
+    for (const CarSaleRecord *it = begin; it != end; ++it) {
+      result.price_quantiles.add(it->brand, it->country, it->revenue_cents);
     }
+  }
 
-    // Task 2 & 3: BMW analysis for 2025
-    if (record.brand == "BMW" && record.year == 2025) {
-      result.bmw_2025_revenue += record.revenue;
+  if (result.time_series.enabled()) {
+    for (const CarSaleRecord *it = begin; it != end; ++it) {
+      result.time_series.add(it->brand, it->sale_day, it->quantity,
+                             it->revenue_cents);
+    }
+  }
 
-      if (isEuropeanCountry(record.country)) {
-        result.bmw_europe_revenue[record.country] += record.revenue;
+  if (result.geo_grid.enabled()) {
+    // Gather located rows into coordinate columns, map a block of them to
+    // cells in one vectorisable pass, then add the sums
+    double lat[CENTS_BLOCK_ROWS];
+    double lon[CENTS_BLOCK_ROWS];
+    uint32_t cells[CENTS_BLOCK_ROWS];
+    const CarSaleRecord *located[CENTS_BLOCK_ROWS];
+    for (const CarSaleRecord *block = begin; block != end;) {
+      size_t count =
+          std::min(CENTS_BLOCK_ROWS, static_cast<size_t>(end - block));
+      size_t n = 0;
+      for (size_t i = 0; i < count; ++i) {
+        const CarSaleRecord &record = block[i];
+        if (std::isnan(record.latitude)) {
+          result.geo_grid.addUnlocated();
+          continue;
+        }
+        lat[n] = record.latitude;
+        lon[n] = record.longitude;
+        located[n++] = &record;
       }
+      result.geo_grid.cellsOf(lat, lon, n, cells);
+      for (size_t i = 0; i < n; ++i) {
+        result.geo_grid.add(cells[i], located[i]->quantity,
+                            located[i]->revenue_cents);
+      }
+      block += count;
     }
   }
-  result.records_processed = chunk.size();
+
+  if (result.rolling_daily.enabled()) {
+    forEachWhere(begin, static_cast<size_t>(end - begin),
+                 col<Manufacturer> == "BMW" &&
+                     call(col<Country>, isEuropeanCountry),
+                 [&result](const CarSaleRecord &row) {
+                   result.rolling_daily.add(row.country, row.sale_day,
+                                            row.quantity, row.revenue_cents);
+                 });
+  }
+  result.records_processed += static_cast<size_t>(end - begin);
 }
 
 void CsvParser::mergeResults(ChunkResult &target, const ChunkResult &source) {
   target.audi_china_year_sales += source.audi_china_year_sales;
-  target.bmw_2025_revenue += source.bmw_2025_revenue;
   target.records_processed += source.records_processed;
   target.records_failed += source.records_failed;
+  target.records_filtered += source.records_filtered;
 
-  for (const auto &[country, revenue] : source.bmw_europe_revenue) {
-    target.bmw_europe_revenue[country] += revenue;
+  if (!addCents(target.bmw_2025_revenue_cents,
+                source.bmw_2025_revenue_cents)) {
+    markRevenueOverflow(target);
   }
+  for (const auto &[country, cents] : source.bmw_europe_revenue_cents) {
+    if (!addCents(target.bmw_europe_revenue_cents[country], cents)) {
+      markRevenueOverflow(target);
+    }
+  }
+
+  target.group_by.merge(source.group_by);
+  if (source.heavy_hitters.enabled()) {
+    target.heavy_hitter_metric = source.heavy_hitter_metric;
+    target.heavy_hitters.merge(source.heavy_hitters);
+  }
+  target.distinct.merge(source.distinct);
+  target.price_quantiles.merge(source.price_quantiles);
+  target.time_series.merge(source.time_series);
+  target.rolling_daily.merge(source.rolling_daily);
+  target.geo_grid.merge(source.geo_grid);
+
+  target.errors.insert(target.errors.end(), source.errors.begin(),
+                       source.errors.end());
+
+  for (const auto &error : source.parse_errors) {
+    if (target.parse_errors.size() >= MAX_STORED_PARSE_ERRORS) {
+      break;
+    }
+    target.parse_errors.push_back(error);
+  }
+
+  target.profile.merge(source.profile);
 
   if (!source.success) {
     target.success = false;
   }
 }
 
+void CsvParser::reducePartials(std::vector<ChunkResult> &partials,
+                               ChunkResult &target, StageProfile *profile) {
+  // Level by level, partial i absorbs partial i + stride. Each merge keeps
+  // the left operand first, so range order is preserved all the way up.
+  for (size_t stride = 1; stride < partials.size(); stride *= 2) {
+    for (size_t i = 0; i + stride < partials.size(); i += 2 * stride) {
+      ScopedStageTimer timer(profile, Stage::Merge, 0,
+                             partials[i + stride].records_processed);
+      mergeResults(partials[i], partials[i + stride]);
+      partials[i + stride] = ChunkResult();
+    }
+  }
+  if (!partials.empty()) {
+    ScopedStageTimer timer(profile, Stage::Merge, 0,
+                           partials.front().records_processed);
+    // Adopt the merged aggregates rather than copying them. The source is
+    // left disabled so mergeResults() below does not count it twice
+    ChunkResult &front = partials.front();
+    if (!target.group_by.enabled()) {
+      target.group_by = std::exchange(front.group_by, GroupByAggregator());
+    }
+    if (!target.distinct.enabled()) {
+      target.distinct = std::exchange(front.distinct, DistinctCounter());
+    }
+    if (!target.price_quantiles.enabled()) {
+      target.price_quantiles =
+          std::exchange(front.price_quantiles, PriceQuantiles());
+    }
+    if (!target.time_series.enabled()) {
+      target.time_series =
+          std::exchange(front.time_series, TimeSeriesAggregator());
+    }
+    if (!target.rolling_daily.enabled()) {
+      target.rolling_daily =
+          std::exchange(front.rolling_daily, TimeSeriesAggregator());
+    }
+    if (!target.geo_grid.enabled()) {
+      target.geo_grid = std::exchange(front.geo_grid, GeoGrid());
+    }
+    mergeResults(target, front);
+  }
+}
+
+void CsvParser::mergeGroupPartitions(std::vector<ChunkResult> &partials,
+                                     size_t num_threads,
+                                     StageProfile *profile) {
+  if (partials.size() < 2 || !partials.front().group_by.enabled()) {
+    return;
+  }
+  ScopedStageTimer timer(profile, Stage::Merge);
+
+  num_threads = std::max<size_t>(1, std::min(num_threads, GROUP_PARTITIONS));
+  GroupByAggregator &target = partials.front().group_by;
+  auto merge_stripe = [&partials, &target, num_threads](size_t stripe) {
+    for (size_t p = stripe; p < GROUP_PARTITIONS; p += num_threads) {
+      AggHashTable &table = target.partition(p);
+      for (size_t t = 1; t < partials.size(); ++t) {
+        if (!partials[t].group_by.enabled()) {
+          continue; // the worker for this range failed
+        }
+        AggHashTable &source = partials[t].group_by.partition(p);
+        table.merge(source);
+        source.release();
+      }
+    }
+  };
+
+  std::vector<std::future<void>> stripes;
+  for (size_t w = 1; w < num_threads; ++w) {
+    stripes.push_back(std::async(std::launch::async, merge_stripe, w));
+  }
+  merge_stripe(0);
+  for (auto &stripe : stripes) {
+    stripe.get();
+  }
+
+  for (size_t t = 1; t < partials.size(); ++t) {
+    partials[t].group_by = GroupByAggregator();
+  }
+}
+
+void CsvParser::mergeByNode(std::vector<ChunkResult> &partials,
+                            const std::vector<CpuSlot> &slots,
+                            const NumaTopology &topology) {
+  // [begin, end) runs of consecutive workers that ran on one node
+  std::vector<std::pair<size_t, size_t>> runs;
+  for (size_t t = 0; t < partials.size() && t < slots.size(); ++t) {
+    if (t == 0 || slots[t].node != slots[t - 1].node) {
+      runs.emplace_back(t, t);
+    }
+    runs.back().second = t + 1;
+  }
+  if (runs.size() < 2 || runs.back().second != partials.size()) {
+    return;
+  }
+
+  std::vector<ChunkResult> merged(runs.size());
+  auto merge_run = [&](size_t r) {
+    auto [begin, end] = runs[r];
+    // Threads started below inherit the node's CPUs
+    pinCurrentThread(topology.nodes()[slots[begin].node].cpus);
+    std::vector<ChunkResult> run(
+        std::make_move_iterator(partials.begin() + begin),
+        std::make_move_iterator(partials.begin() + end));
+    mergeGroupPartitions(run, end - begin, nullptr);
+    reducePartials(run, merged[r], nullptr);
+  };
+
+  std::vector<std::future<void>> nodes;
+  for (size_t r = 0; r < runs.size(); ++r) {
+    nodes.push_back(std::async(std::launch::async, merge_run, r));
+  }
+  for (auto &node : nodes) {
+    node.get();
+  }
+  partials = std::move(merged);
+}
+
+// Extra capacity for a node-local worker's buffer beyond its span
+static constexpr uint64_t SPAN_SLACK = 64 * 1024;
+
+// Append bytes [begin, end) of the file to buffer (fewer at end of file)
+static void appendFileSpan(std::ifstream &in, uint64_t begin, uint64_t end,
+                           std::string &buffer) {
+  size_t old_size = buffer.size();
+  buffer.resize(old_size + static_cast<size_t>(end - begin));
+  in.clear();
+  in.seekg(static_cast<std::streamoff>(begin));
+  in.read(&buffer[old_size], static_cast<std::streamsize>(end - begin));
+  buffer.resize(old_size + static_cast<size_t>(in.gcount()));
+}
+
+ChunkResult CsvParser::parseRange(const RangeTask &task, ParseWorkspace &ws,
+                                  RejectFileWriter *rejects,
+                                  StreamSegmentQueue *segments,
+                                  std::vector<SegmentLines> *segment_lines) const {
+  ChunkResult result;
+  StageProfile *profile = startProfile(profiling_enabled_, result);
+  uint64_t busy_start = profile ? profiling::ticks() : 0;
+  RejectBuffer reject_buffer(rejects);
+
+  // Counters must be opened on the thread they measure
+  std::unique_ptr<PerfCounterGroup> counters;
+  if (hardware_counters_enabled_) {
+    counters = std::make_unique<PerfCounterGroup>();
+  }
+  HwStageTracker hw(counters.get(),
+                    counters ? &result.profile.hardware : nullptr);
+  hw.enter(HwStage::Parse);
+
+  if (group_by_ != GroupColumn::None) {
+    result.group_by.enable(task.group_budget, task.spill);
+  }
+  result.heavy_hitters = makeHeavyHitterSketch();
+  result.heavy_hitter_metric = heavy_hitter_metric_;
+  result.distinct = makeDistinctCounter();
+  result.price_quantiles = makePriceQuantiles();
+  result.time_series = TimeSeriesAggregator(time_bucket_);
+  result.rolling_daily = TimeSeriesAggregator(
+      rolling_revenue_ ? TimeBucket::Day : TimeBucket::None);
+  result.geo_grid = makeGeoGrid();
+
+  RecordBatch &batch = ws.batch;
+  batch.clear();
+  ws.arena.reset();
+
+  // Live progress, published to this worker's own slot after each batch
+  WorkerProgress *progress =
+      progress_ ? progress_->worker(task.thread_index) : nullptr;
+  uint64_t busy_ns = 0;
+  uint64_t busy_mark = progress ? ProgressTracker::nowNs() : 0;
+  uint64_t bytes_done = 0; // of earlier ranges (stream segments)
+  auto publish = [&](uint64_t bytes) {
+    if (progress) {
+      uint64_t now = ProgressTracker::nowNs();
+      busy_ns += now - busy_mark;
+      busy_mark = now;
+      progress->publish(bytes, result.records_processed,
+                        result.records_failed, busy_ns);
+    }
+  };
+
+  auto flush_batch = [&]() {
+    hw.enter(HwStage::Aggregate);
+    {
+      ScopedStageTimer timer(profile, Stage::Aggregate, 0, batch.size());
+      processChunkAnalysis(batch.begin(), batch.end(), result);
+    }
+    hw.addRows(HwStage::Aggregate, batch.size());
+    hw.enter(HwStage::Parse);
+    batch.clear();
+    ws.arena.reset();
+  };
+
+  // Lines are numbered from 1 within each range while parsing; the caller
+  // rebases them once every range's line count is known. A record with
+  // quoted newlines spans several lines and is numbered by its first.
+  auto parse_records = [&](std::string_view range, uint64_t base_offset) {
+    uint64_t local_line = 0;
+    size_t pos = 0;
+    while (pos < range.size()) {
+      size_t embedded_newlines;
+      size_t eol = recordEnd(range, pos, embedded_newlines);
+      std::string_view line = range.substr(pos, eol - pos);
+      uint64_t line_offset = base_offset + pos;
+      pos = eol + 1;
+      uint64_t record_line = local_line + 1;
+      local_line += 1 + embedded_newlines;
+
+      // Skip empty lines
+      if (trim(line).empty()) {
+        continue;
+      }
+
+      hw.addRows(HwStage::Parse, 1);
+      CarSaleRecord &record = batch.next();
+      ParseErrorCode code = parseRecordInto(
+          line, ws, record, profile, profile ? profile->rowTickScale() : 0);
+      if (code == ParseErrorCode::Filtered) {
+        batch.discardLast();
+        ++result.records_filtered;
+        continue;
+      }
+      if (code != ParseErrorCode::None) {
+        batch.discardLast();
+        recordParseError(result, rowError(line_offset, record_line, code));
+        reject_buffer.add(line);
+        continue;
+      }
+
+      if (batch.size() >= chunk_size_) {
+        flush_batch();
+        publish(bytes_done + pos);
+      }
+    }
+    bytes_done += range.size();
+    return local_line;
+  };
+
+  uint64_t lines_scanned = 0;
+  if (segments) {
+    // Stream segments arrive in any order across workers; each one's lines
+    // are reported so the caller can number them in stream order
+    StreamSegment *segment;
+    while (segments->pop(segment)) {
+      if (progress) {
+        busy_mark = ProgressTracker::nowNs(); // waiting is not busy
+      }
+      size_t first_error = result.parse_errors.size();
+      uint64_t lines = parse_records(segment->data, segment->base_offset);
+      segment_lines->push_back(SegmentLines{segment->index, lines, first_error,
+                                            result.parse_errors.size() -
+                                                first_error});
+      segments->release(segment);
+      lines_scanned += lines;
+      publish(bytes_done);
+    }
+  } else {
+    lines_scanned = parse_records(task.data, task.base_offset);
+  }
+
+  if (!batch.empty()) {
+    flush_batch();
+  }
+  publish(bytes_done);
+  hw.stop();
+  reject_buffer.flush();
+  result.lines_scanned = lines_scanned;
+
+  if (profile) {
+    ThreadUtilization usage;
+    usage.thread_index = task.thread_index;
+    usage.busy_ticks = profiling::ticks() - busy_start;
+    usage.rows = result.records_processed + result.records_failed;
+    profile->threads.push_back(usage);
+  }
+  return result;
+}
+
 ChunkResult CsvParser::parseFileConcurrent(const std::string &filename,
                                            size_t num_threads) {
   ChunkResult overall_result;
@@ -375,99 +1114,615 @@ ChunkResult CsvParser::parseFileConcurrent(const std::string &filename,
       num_threads = 4; // Default fallback
   }
 
-  std::ifstream file(filename);
+  // A stream cannot be measured or re-read, so it is parsed as it arrives
+  if (isStreamInput(filename)) {
+    ReadAheadReader reader(streamOptions(read_ahead_));
+    std::string error;
+    if (!reader.open(filename, error)) {
+      overall_result.success = false;
+      overall_result.errors.push_back("Failed to open file: " + filename);
+      return overall_result;
+    }
+    return parseStreamConcurrent(reader, filename, num_threads);
+  }
+
+  std::ifstream file(filename, std::ios::binary);
   if (!file.is_open()) {
     overall_result.success = false;
     overall_result.errors.push_back("Failed to open file: " + filename);
     return overall_result;
   }
 
-  // Read all lines first (for large files, this could be optimized further)
-  std::vector<std::string> all_lines;
-  std::string line;
-  bool is_header = true;
-
-  while (std::getline(file, line)) {
-    if (is_header) {
-      is_header = false;
-      continue;
+  StageProfile *profile = startProfile(profiling_enabled_, overall_result);
+  bool node_local = placement_ == WorkerPlacement::Numa;
+
+  std::string_view data;
+  std::string header;
+  uint64_t data_start = 0;
+  uint64_t file_size = 0;
+  // Per worker: its lines as a view of the shared buffer or, node-local,
+  // the [begin, end) byte span whose lines it reads itself
+  std::vector<std::string_view> ranges;
+  std::vector<std::pair<uint64_t, uint64_t>> spans;
+
+  if (node_local) {
+    // Only the header is read here; each worker reads its own span after
+    // pinning, so its pages are first touched (and placed) on its node
+    std::getline(file, header);
+    if (file.eof()) {
+      overall_result.success = true;
+      if (profile) {
+        profile->end();
+      }
+      return overall_result;
+    }
+    data_start = static_cast<uint64_t>(header.size()) + 1;
+    file.seekg(0, std::ios::end);
+    file_size = static_cast<uint64_t>(std::max<std::streamoff>(0, file.tellg()));
+    for (size_t t = 0; t < num_threads && data_start < file_size; ++t) {
+      uint64_t span = file_size - data_start;
+      uint64_t begin = data_start + span * t / num_threads;
+      uint64_t end = data_start + span * (t + 1) / num_threads;
+      if (end > begin) {
+        spans.emplace_back(begin, end);
+      }
     }
-    if (!trim(line).empty()) {
-      all_lines.push_back(std::move(line));
+  } else {
+    // Read the whole file into the reusable buffer; workers parse straight
+    // out of it, so no per-line strings or record copies are made
+    {
+      file.seekg(0, std::ios::end);
+      std::streamoff size = file.tellg();
+      file.seekg(0, std::ios::beg);
+      ScopedStageTimer timer(profile, Stage::Io,
+                             size > 0 ? static_cast<uint64_t>(size) : 0);
+      input_buffer_.resize(size > 0 ? static_cast<size_t>(size) : 0);
+      if (!input_buffer_.empty()) {
+        file.read(&input_buffer_[0],
+                  static_cast<std::streamsize>(input_buffer_.size()));
+        input_buffer_.resize(static_cast<size_t>(file.gcount()));
+      }
     }
+
+    // Skip header line
+    data = input_buffer_;
+    size_t header_end = data.find('\n');
+    if (header_end == std::string_view::npos) {
+      overall_result.success = true;
+      if (profile) {
+        profile->end();
+      }
+      return overall_result;
+    }
+    header = std::string(data.substr(0, header_end));
+    ranges = splitRecords(data.substr(header_end + 1), num_threads);
   }
   file.close();
-
-  if (all_lines.empty()) {
-    overall_result.success = true;
+  if (!bindSchema(header, overall_result)) {
+    if (profile) {
+      profile->end();
+    }
     return overall_result;
   }
+  size_t workers = node_local ? spans.size() : ranges.size();
 
-  // Parse all lines into records
-  std::vector<CarSaleRecord> all_records;
-  all_records.reserve(all_lines.size());
+  std::unique_ptr<RejectFileWriter> rejects = openRejectFile(overall_result);
+  if (rejects) {
+    rejects->submit(header + "\n");
+  }
 
-  for (size_t i = 0; i < all_lines.size(); ++i) {
-    auto record = parseLine(all_lines[i]);
-    if (record) {
-      all_records.push_back(*record);
-    } else {
-      overall_result.records_failed++;
-    }
+  // Workspaces must exist before the workers start
+  for (size_t t = 0; t < workers; ++t) {
+    workspace(t);
   }
 
-  // Clear lines to free memory
-  all_lines.clear();
-  all_lines.shrink_to_fit();
+  // All workers spill into one shared store, one file per partition
+  std::shared_ptr<GroupSpill> spill;
+  size_t group_budget = 0;
+  if (group_by_ != GroupColumn::None && max_memory_ > 0 && workers > 0) {
+    spill = std::make_shared<GroupSpill>();
+    group_budget = std::max<size_t>(1, max_memory_ / workers);
+  }
 
-  if (all_records.empty()) {
-    overall_result.success = true;
-    return overall_result;
+  std::vector<CpuSlot> slots;
+  if (placement_ != WorkerPlacement::None) {
+    slots = topology_.assign(workers);
   }
 
-  // Divide records into chunks for parallel processing
-  size_t total_records = all_records.size();
-  size_t records_per_thread = (total_records + num_threads - 1) / num_threads;
+  uint64_t phase_start = profile ? profiling::ticks() : 0;
+
+  // Node-local workers only see their own spans, so record boundaries are
+  // settled in two rounds: each reads its span and scans its quotes under
+  // both hypotheses, a prefix pass over the scans picks every worker's
+  // first record, and each then reads on to where the next one starts
+  std::vector<uint64_t> starts;
+  std::vector<uint64_t> io_ticks(workers, 0);
+  if (node_local) {
+    std::vector<std::future<QuoteScan>> scan_futures;
+    for (size_t t = 0; t < workers; ++t) {
+      ParseWorkspace *ws = workspaces_[t].get();
+      int cpu = slots[t].cpu;
+      std::pair<uint64_t, uint64_t> span = spans[t];
+      uint64_t *ticks = &io_ticks[t];
+      scan_futures.push_back(std::async(
+          std::launch::async, [this, ws, cpu, span, ticks, &filename]() {
+            pinCurrentThread({cpu});
+            uint64_t io_start = profiling_enabled_ ? profiling::ticks() : 0;
+            std::ifstream in(filename, std::ios::binary);
+            if (!in.is_open()) {
+              throw std::runtime_error("Failed to open file: " + filename);
+            }
+            // Room for the record straddling the end, so extending the
+            // span later rarely moves it
+            ws->input.clear();
+            ws->input.reserve(span.second - span.first + SPAN_SLACK);
+            appendFileSpan(in, span.first, span.second, ws->input);
+            *ticks = profiling_enabled_ ? profiling::ticks() - io_start : 0;
+            return scanQuotes(ws->input);
+          }));
+    }
+    std::vector<QuoteScan> scans(workers);
+    std::vector<uint64_t> cuts;
+    for (size_t t = 0; t < workers; ++t) {
+      // A worker that cannot read fails again below and is reported there
+      try {
+        scans[t] = scan_futures[t].get();
+      } catch (const std::exception &) {
+      }
+      cuts.push_back(spans[t].first);
+    }
+    starts = resolveRecordStarts(scans, cuts, file_size);
+  }
 
   std::vector<std::future<ChunkResult>> futures;
-  futures.reserve(num_threads);
-
-  for (size_t t = 0; t < num_threads; ++t) {
-    size_t start_idx = t * records_per_thread;
-    if (start_idx >= total_records)
-      break;
-
-    size_t end_idx = std::min(start_idx + records_per_thread, total_records);
-
-    // Create a chunk for this thread
-    std::vector<CarSaleRecord> chunk(all_records.begin() + start_idx,
-                                     all_records.begin() + end_idx);
+  futures.reserve(workers);
+
+  for (size_t t = 0; t < workers; ++t) {
+    ParseWorkspace *ws = workspaces_[t].get();
+    RangeTask task{std::string_view(), 0, t, group_budget, spill};
+    std::pair<uint64_t, uint64_t> span;
+    std::pair<uint64_t, uint64_t> owned;
+    if (node_local) {
+      span = spans[t];
+      owned = {starts[t], starts[t + 1]};
+    } else {
+      task.data = ranges[t];
+      task.base_offset = static_cast<uint64_t>(ranges[t].data() - data.data());
+    }
+    RejectFileWriter *sink = rejects.get();
+    int cpu = slots.empty() ? -1 : slots[t].cpu;
+    uint64_t ticks = io_ticks[t];
 
     // Launch async task
-    futures.push_back(
-        std::async(std::launch::async, [chunk = std::move(chunk)]() mutable {
-          ChunkResult result;
-          processChunkAnalysis(chunk, result);
-          result.success = true;
+    futures.push_back(std::async(
+        std::launch::async,
+        [this, task, ws, sink, cpu, span, owned, ticks, &filename]() mutable {
+          if (cpu >= 0) {
+            pinCurrentThread({cpu});
+          }
+          if (owned.second > owned.first) {
+            // The buffer holds the span; the owned records start inside it
+            // and end at or past its end
+            uint64_t io_start = profiling_enabled_ ? profiling::ticks() : 0;
+            if (owned.second > span.second) {
+              std::ifstream in(filename, std::ios::binary);
+              if (!in.is_open()) {
+                throw std::runtime_error("Failed to open file: " + filename);
+              }
+              appendFileSpan(in, span.second, owned.second, ws->input);
+            }
+            task.data = std::string_view(ws->input)
+                            .substr(static_cast<size_t>(owned.first - span.first));
+            task.base_offset = owned.first;
+            ticks += profiling_enabled_ ? profiling::ticks() - io_start : 0;
+          }
+          ChunkResult result = parseRange(task, *ws, sink);
+          if (result.profile.enabled) {
+            result.profile.add(Stage::Io, ticks, task.data.size(), 0);
+          }
           return result;
         }));
   }
 
   // Collect results from all threads
-  for (auto &future : futures) {
+  std::vector<ChunkResult> partials(futures.size());
+  for (size_t t = 0; t < futures.size(); ++t) {
     try {
-      ChunkResult partial = future.get();
-      mergeResults(overall_result, partial);
+      partials[t] = futures[t].get();
     } catch (const std::exception &e) {
       overall_result.success = false;
       overall_result.errors.push_back(std::string("Thread error: ") + e.what());
+      // Still needed for the line numbers of the ranges that follow (a
+      // node-local worker may have failed before reading its span)
+      if (!node_local) {
+        partials[t].lines_scanned = static_cast<size_t>(
+            std::count(ranges[t].begin(), ranges[t].end(), '\n'));
+      }
     }
   }
 
-  _total_records_processed = overall_result.records_processed;
-  overall_result.success = true;
+  // Exclusive prefix sum over per-range line counts turns range-local line
+  // numbers into file line numbers (the header is line 1)
+  size_t lines_before = 1;
+  for (auto &partial : partials) {
+    for (auto &error : partial.parse_errors) {
+      error.line += lines_before;
+    }
+    lines_before += partial.lines_scanned;
+  }
 
+  if (node_local) {
+    ScopedStageTimer timer(profile, Stage::Merge);
+    mergeByNode(partials, slots, topology_);
+  }
+  mergeGroupPartitions(partials, num_threads, profile);
+  reducePartials(partials, overall_result, profile);
+  overall_result.lines_scanned = lines_before;
+
+  closeRejectFile(rejects, overall_result);
+
+  if (profile) {
+    // Anything a worker did not spend busy inside the parallel phase is idle
+    uint64_t phase_ticks = profiling::ticks() - phase_start;
+    for (auto &usage : profile->threads) {
+      usage.idle_ticks =
+          phase_ticks > usage.busy_ticks ? phase_ticks - usage.busy_ticks : 0;
+    }
+    profile->end();
+  }
+
+  _total_records_processed = overall_result.records_processed;
   return overall_result;
 }
 
-} // namespace car_sales
\ No newline at end of file
+ChunkResult CsvParser::parseDescriptorConcurrent(int fd,
+                                                 size_t num_threads) {
+  if (num_threads == 0) {
+    num_threads = std::thread::hardware_concurrency();
+    if (num_threads == 0)
+      num_threads = 4; // Default fallback
+  }
+  ReadAheadReader reader(streamOptions(read_ahead_));
+  reader.attach(fd);
+  return parseStreamConcurrent(reader, "descriptor " + std::to_string(fd),
+                               num_threads);
+}
+
+ChunkResult CsvParser::parseStreamConcurrent(ReadAheadReader &reader,
+                                             const std::string &name,
+                                             size_t num_threads) {
+  ChunkResult overall_result;
+  _total_records_processed = 0;
+  StageProfile *profile = startProfile(profiling_enabled_, overall_result);
+
+  auto finish = [&]() {
+    std::string error = reader.error();
+    if (!error.empty()) {
+      overall_result.success = false;
+      overall_result.errors.push_back(error + ": " + name);
+    }
+    if (profile) {
+      profile->end();
+    }
+    _total_records_processed = overall_result.records_processed;
+    return overall_result;
+  };
+
+  StreamSplitter splitter(reader, read_ahead_.segment_bytes);
+  std::string header;
+  size_t header_lines = 0;
+  bool has_header;
+  {
+    ScopedStageTimer timer(profile, Stage::Io);
+    has_header = splitter.header(header, header_lines);
+  }
+  if (!has_header) {
+    overall_result.success = true;
+    return finish();
+  }
+  if (!bindSchema(header, overall_result)) {
+    return finish();
+  }
+
+  std::unique_ptr<RejectFileWriter> rejects = openRejectFile(overall_result);
+  if (rejects) {
+    rejects->submit(header + "\n");
+  }
+
+  size_t workers = num_threads;
+  for (size_t t = 0; t < workers; ++t) {
+    workspace(t);
+  }
+  std::shared_ptr<GroupSpill> spill;
+  size_t group_budget = 0;
+  if (group_by_ != GroupColumn::None && max_memory_ > 0) {
+    spill = std::make_shared<GroupSpill>();
+    group_budget = std::max<size_t>(1, max_memory_ / workers);
+  }
+  // Workers are pinned as asked; with nothing to split up front there are
+  // no node-local spans to read
+  std::vector<CpuSlot> slots;
+  if (placement_ != WorkerPlacement::None) {
+    slots = topology_.assign(workers);
+  }
+
+  uint64_t phase_start = profile ? profiling::ticks() : 0;
+
+  // Two segments per worker: one being parsed, one waiting
+  StreamSegmentQueue queue(2 * workers);
+  std::vector<std::vector<SegmentLines>> segment_lines(workers);
+  std::vector<std::future<ChunkResult>> futures;
+  futures.reserve(workers);
+  for (size_t t = 0; t < workers; ++t) {
+    ParseWorkspace *ws = workspaces_[t].get();
+    RangeTask task{std::string_view(), 0, t, group_budget, spill};
+    RejectFileWriter *sink = rejects.get();
+    int cpu = slots.empty() ? -1 : slots[t].cpu;
+    std::vector<SegmentLines> *lines = &segment_lines[t];
+    futures.push_back(std::async(
+        std::launch::async, [this, task, ws, sink, cpu, lines, &queue]() {
+          if (cpu >= 0) {
+            pinCurrentThread({cpu});
+          }
+          try {
+            return parseRange(task, *ws, sink, &queue, lines);
+          } catch (...) {
+            // Keep the buffers cycling so the reader is never left waiting
+            StreamSegment *segment;
+            while (queue.pop(segment)) {
+              queue.release(segment);
+            }
+            throw;
+          }
+        }));
+  }
+
+  // This thread reads and cuts while the workers parse
+  while (true) {
+    StreamSegment *segment = queue.acquire();
+    uint64_t io_start = profile ? profiling::ticks() : 0;
+    bool more = splitter.next(*segment);
+    if (profile) {
+      profile->add(Stage::Io, profiling::ticks() - io_start,
+                   more ? segment->data.size() : 0);
+    }
+    if (!more) {
+      queue.release(segment);
+      break;
+    }
+    queue.push(segment);
+  }
+  queue.close();
+
+  std::vector<ChunkResult> partials(workers);
+  for (size_t t = 0; t < workers; ++t) {
+    try {
+      partials[t] = futures[t].get();
+    } catch (const std::exception &e) {
+      overall_result.success = false;
+      overall_result.errors.push_back(std::string("Thread error: ") + e.what());
+    }
+  }
+
+  // Segment line counts in stream order give each segment's first line
+  std::vector<uint64_t> lines_before(splitter.segments() + 1, 0);
+  for (const auto &worker_lines : segment_lines) {
+    for (const SegmentLines &segment : worker_lines) {
+      lines_before[segment.index + 1] = segment.lines;
+    }
+  }
+  lines_before[0] = header_lines;
+  for (size_t i = 1; i < lines_before.size(); ++i) {
+    lines_before[i] += lines_before[i - 1];
+  }
+  // Each worker kept its first errors, in stream order, so the earliest
+  // overall are among them
+  std::vector<ParseError> parse_errors;
+  for (size_t t = 0; t < workers; ++t) {
+    for (const SegmentLines &segment : segment_lines[t]) {
+      for (size_t e = 0; e < segment.errors; ++e) {
+        ParseError error = partials[t].parse_errors[segment.first_error + e];
+        error.line += lines_before[segment.index];
+        parse_errors.push_back(error);
+      }
+    }
+    partials[t].parse_errors.clear();
+  }
+  std::sort(parse_errors.begin(), parse_errors.end(),
+            [](const ParseError &a, const ParseError &b) {
+              return a.line < b.line;
+            });
+  if (parse_errors.size() > MAX_STORED_PARSE_ERRORS) {
+    parse_errors.resize(MAX_STORED_PARSE_ERRORS);
+  }
+  if (!partials.empty()) {
+    partials.front().parse_errors = std::move(parse_errors);
+  }
+
+  mergeGroupPartitions(partials, num_threads, profile);
+  reducePartials(partials, overall_result, profile);
+  overall_result.lines_scanned = lines_before.back();
+  closeRejectFile(rejects, overall_result);
+
+  if (profile) {
+    uint64_t phase_ticks = profiling::ticks() - phase_start;
+    for (auto &usage : profile->threads) {
+      usage.idle_ticks =
+          phase_ticks > usage.busy_ticks ? phase_ticks - usage.busy_ticks : 0;
+    }
+  }
+  return finish();
+}
+
+ChunkResult CsvParser::sampleFile(const std::string &filename,
+                                  const SampleOptions &options,
+                                  SampleReport &report, size_t num_threads) {
+  ChunkResult result;
+  report = SampleReport();
+  report.z = options.z;
+  _total_records_processed = 0;
+
+  if (num_threads == 0) {
+    num_threads = std::thread::hardware_concurrency();
+    if (num_threads == 0)
+      num_threads = 4; // Default fallback
+  }
+
+  if (isStreamInput(filename)) {
+    // Blocks are read in random order, which a stream cannot do
+    result.success = false;
+    result.errors.push_back("Sampling needs a seekable file: " + filename);
+    return result;
+  }
+  std::ifstream probe(filename, std::ios::binary);
+  if (!probe.is_open()) {
+    result.success = false;
+    result.errors.push_back("Failed to open file: " + filename);
+    return result;
+  }
+  std::string header;
+  std::getline(probe, header);
+  if (!bindSchema(header, result)) {
+    return result;
+  }
+  uint64_t data_start = static_cast<uint64_t>(header.size()) + 1;
+  probe.clear();
+  probe.seekg(0, std::ios::end);
+  uint64_t file_size = static_cast<uint64_t>(std::max<std::streamoff>(
+      0, probe.tellg()));
+  probe.close();
+
+  uint64_t block_bytes = std::max<size_t>(1, options.block_bytes);
+  size_t blocks = file_size > data_start
+                      ? static_cast<size_t>((file_size - data_start +
+                                             block_bytes - 1) / block_bytes)
+                      : 0;
+  report.blocks_total = blocks;
+  if (blocks == 0) {
+    return result;
+  }
+
+  std::vector<size_t> order = samplingOrder(blocks, options.seed);
+  double fraction = std::min(1.0, std::max(0.0, options.max_fraction));
+  size_t limit = static_cast<size_t>(std::ceil(fraction * blocks));
+  limit = std::min(blocks, std::max<size_t>(1, limit));
+  num_threads = std::min(num_threads, limit);
+
+  // Each worker seeks its own stream and reuses its own read buffer
+  struct BlockReader {
+    std::ifstream in;
+    std::string buffer;
+  };
+  std::vector<std::unique_ptr<BlockReader>> readers;
+  for (size_t t = 0; t < num_threads; ++t) {
+    auto reader = std::make_unique<BlockReader>();
+    reader->in.open(filename, std::ios::binary);
+    if (!reader->in.is_open()) {
+      result.success = false;
+      result.errors.push_back("Failed to open file: " + filename);
+      return result;
+    }
+    readers.push_back(std::move(reader));
+    workspace(t);
+  }
+
+  BlockSums audi;
+  BlockSums bmw;
+  std::map<std::string, BlockSums> bmw_europe;
+  // A metric not seen yet never counts as precise; revenue has no natural
+  // bound per sale, so an unseen revenue total is unbounded
+  auto precise_enough = [&]() {
+    size_t n = report.blocks_sampled;
+    return estimateTotal(audi, n, blocks, options.z).relativeError() <=
+               options.target_error &&
+           estimateTotal(bmw, n, blocks, options.z, INFINITY)
+                   .relativeError() <= options.target_error;
+  };
+
+  bool stop = false;
+  for (size_t next = 0; next < limit && !stop; next += num_threads) {
+    size_t round = std::min(num_threads, limit - next);
+    std::vector<std::future<std::pair<ChunkResult, size_t>>> futures;
+    for (size_t w = 0; w < round; ++w) {
+      uint64_t block_start = data_start + order[next + w] * block_bytes;
+      BlockReader *reader = readers[w].get();
+      ParseWorkspace *ws = workspaces_[w].get();
+      futures.push_back(std::async(
+          std::launch::async,
+          [this, reader, ws, w, data_start, file_size, block_start,
+           block_bytes]() {
+            std::string_view data =
+                readAlignedBlock(reader->in, data_start, file_size,
+                                 block_start, block_start + block_bytes,
+                                 reader->buffer);
+            // Rejected rows are only counted here, so the approximate
+            // offset of the block is good enough
+            RangeTask task{data, block_start, w, 0, nullptr};
+            return std::make_pair(parseRange(task, *ws, nullptr),
+                                  data.size());
+          }));
+    }
+
+    // Consume in sampling order; a later block of the round is discarded
+    // once the target is met, which keeps the stopping point deterministic
+    for (size_t w = 0; w < round && !stop; ++w) {
+      std::pair<ChunkResult, size_t> block;
+      try {
+        block = futures[w].get();
+      } catch (const std::exception &e) {
+        result.success = false;
+        result.errors.push_back(std::string("Sampling error: ") + e.what());
+        stop = true;
+        break;
+      }
+      const ChunkResult &partial = block.first;
+      report.blocks_sampled++;
+      report.bytes_sampled += block.second;
+      report.rows_sampled += partial.records_processed + partial.records_failed;
+      result.records_processed += partial.records_processed;
+      result.records_failed += partial.records_failed;
+      result.errors.insert(result.errors.end(), partial.errors.begin(),
+                           partial.errors.end());
+      if (!partial.success) {
+        result.success = false;
+      }
+
+      audi.add(static_cast<double>(partial.audi_china_year_sales));
+      bmw.add(static_cast<double>(partial.bmw_2025_revenue_cents));
+      for (const auto &[country, cents] : partial.bmw_europe_revenue_cents) {
+        bmw_europe[country].add(static_cast<double>(cents));
+      }
+
+      if (options.target_error > 0.0 &&
+          report.blocks_sampled >= options.min_blocks && precise_enough()) {
+        report.target_reached = true;
+        stop = true;
+      }
+    }
+  }
+
+  // Scale up; intervals are reported in sales and dollars
+  size_t n = report.blocks_sampled;
+  report.audi_china_year_sales = estimateTotal(audi, n, blocks, options.z);
+  SampleInterval bmw_cents =
+      estimateTotal(bmw, n, blocks, options.z, INFINITY);
+  report.bmw_year_total_revenue = {bmw_cents.estimate / 100.0,
+                                   bmw_cents.half_width / 100.0};
+  result.audi_china_year_sales = static_cast<int>(
+      std::llround(report.audi_china_year_sales.estimate));
+  result.bmw_2025_revenue_cents =
+      static_cast<int64_t>(std::llround(bmw_cents.estimate));
+  for (const auto &[country, sums] : bmw_europe) {
+    SampleInterval cents =
+        estimateTotal(sums, n, blocks, options.z, INFINITY);
+    report.bmw_europe_revenue[country] = {cents.estimate / 100.0,
+                                          cents.half_width / 100.0};
+    result.bmw_europe_revenue_cents[country] =
+        static_cast<int64_t>(std::llround(cents.estimate));
+  }
+
+  _total_records_processed = result.records_processed;
+  return result;
+}
+
+} // namespace car_sales
@@ -0,0 +1,107 @@
+#include <algorithm>
+#include <charconv>
+#include <cmath>
+#include <stdexcept>
+
+#include "geo_grid.hpp"
+
+namespace car_sales {
+
+bool parseCoordinate(std::string_view text, double limit, double &value) {
+  if (!text.empty() && text.front() == '+') {
+    text.remove_prefix(1);
+  }
+  auto [ptr, ec] =
+      std::from_chars(text.data(), text.data() + text.size(), value);
+  return ec == std::errc() && ptr == text.data() + text.size() &&
+         value >= -limit && value <= limit;
+}
+
+bool parseBoundingBox(std::string_view text, BoundingBox &box) {
+  double values[4];
+  for (size_t i = 0; i < 4; ++i) {
+    size_t comma = i < 3 ? text.find(',') : text.size();
+    if (comma == std::string_view::npos ||
+        !parseCoordinate(text.substr(0, comma), i % 2 == 0 ? 90.0 : 180.0,
+                         values[i])) {
+      return false;
+    }
+    text.remove_prefix(std::min(text.size(), comma + 1));
+  }
+  if (values[0] > values[2] || values[1] > values[3]) {
+    return false;
+  }
+  box.min_lat = values[0];
+  box.min_lon = values[1];
+  box.max_lat = values[2];
+  box.max_lon = values[3];
+  return true;
+}
+
+GeoGrid::GeoGrid(double cell_degrees) : cell_degrees_(cell_degrees) {
+  if (!(cell_degrees >= MIN_CELL_DEGREES &&
+        cell_degrees <= MAX_CELL_DEGREES)) {
+    throw std::invalid_argument("Grid cell size out of range");
+  }
+  inverse_ = 1.0 / cell_degrees;
+  rows_ = static_cast<uint32_t>(std::ceil(180.0 * inverse_));
+  columns_ = static_cast<uint32_t>(std::ceil(360.0 * inverse_));
+}
+
+void GeoGrid::cellsOf(const double *lat, const double *lon, size_t n,
+                      uint32_t *cells) const {
+  // Offsets are non-negative, so truncation is floor; the clamps only catch
+  // the +90 and +180 edges
+  const double inverse = inverse_;
+  const int32_t last_row = static_cast<int32_t>(rows_) - 1;
+  const int32_t last_column = static_cast<int32_t>(columns_) - 1;
+  const uint32_t columns = columns_;
+  for (size_t i = 0; i < n; ++i) {
+    int32_t row = static_cast<int32_t>((lat[i] + 90.0) * inverse);
+    int32_t column = static_cast<int32_t>((lon[i] + 180.0) * inverse);
+    row = row < last_row ? row : last_row;
+    column = column < last_column ? column : last_column;
+    cells[i] = static_cast<uint32_t>(row) * columns +
+               static_cast<uint32_t>(column);
+  }
+}
+
+void GeoGrid::add(uint32_t cell, int64_t units, int64_t revenue_cents) {
+  Totals &totals = cells_[cell];
+  totals.units += units;
+  totals.revenue_cents += revenue_cents;
+}
+
+void GeoGrid::merge(const GeoGrid &other) {
+  if (!other.enabled()) {
+    return;
+  }
+  if (!enabled()) {
+    *this = GeoGrid(other.cell_degrees_);
+  } else if (other.cell_degrees_ != cell_degrees_) {
+    throw std::invalid_argument("Cannot merge grids of different cell sizes");
+  }
+  unlocated_rows_ += other.unlocated_rows_;
+  for (const auto &[cell, totals] : other.cells_) {
+    Totals &target = cells_[cell];
+    target.units += totals.units;
+    target.revenue_cents += totals.revenue_cents;
+  }
+}
+
+std::vector<GeoCell> GeoGrid::cells() const {
+  std::vector<GeoCell> cells;
+  cells.reserve(cells_.size());
+  for (const auto &[cell, totals] : cells_) {
+    double row = static_cast<double>(cell / columns_);
+    double column = static_cast<double>(cell % columns_);
+    cells.push_back(GeoCell{cell, row * cell_degrees_ - 90.0,
+                            column * cell_degrees_ - 180.0, totals.units,
+                            totals.revenue_cents});
+  }
+  std::sort(cells.begin(), cells.end(),
+            [](const GeoCell &a, const GeoCell &b) { return a.cell < b.cell; });
+  return cells;
+}
+
+} // namespace car_sales
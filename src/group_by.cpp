@@ -0,0 +1,201 @@
+#include <algorithm>
+#include <future>
+
+#include "group_by.hpp"
+
+namespace car_sales {
+
+namespace {
+
+struct ColumnInfo {
+  GroupColumn column;
+  const char *name;
+  int index;
+};
+
+// Field indices follow the data.csv header (0-based)
+const ColumnInfo GROUP_COLUMNS[] = {
+    {GroupColumn::Country, "country", 2},
+    {GroupColumn::Manufacturer, "manufacturer", 8},
+    {GroupColumn::Model, "model", 9},
+    {GroupColumn::DealershipId, "dealership_id", 6},
+    {GroupColumn::SalespersonId, "salesperson_id", 29},
+    {GroupColumn::BuyerId, "buyer_id", 25},
+    {GroupColumn::Vin, "vin", 16},
+};
+
+} // namespace
+
+const char *groupColumnName(GroupColumn column) {
+  for (const ColumnInfo &info : GROUP_COLUMNS) {
+    if (info.column == column) {
+      return info.name;
+    }
+  }
+  return "none";
+}
+
+int groupColumnIndex(GroupColumn column) {
+  for (const ColumnInfo &info : GROUP_COLUMNS) {
+    if (info.column == column) {
+      return info.index;
+    }
+  }
+  return -1;
+}
+
+bool parseGroupColumn(std::string_view name, GroupColumn &column) {
+  for (const ColumnInfo &info : GROUP_COLUMNS) {
+    if (name == info.name) {
+      column = info.column;
+      return true;
+    }
+  }
+  return false;
+}
+
+void GroupByAggregator::enable(size_t memory_budget,
+                               std::shared_ptr<GroupSpill> spill) {
+  if (partitions_.empty()) {
+    partitions_.resize(GROUP_PARTITIONS);
+  }
+  memory_budget_ = spill ? memory_budget : 0;
+  spill_ = std::move(spill);
+}
+
+bool GroupByAggregator::spillIfOverBudget() {
+  if (memory_budget_ == 0 || memoryBytes() <= memory_budget_) {
+    return false;
+  }
+  for (size_t p = 0; p < partitions_.size(); ++p) {
+    spill_->write(p, partitions_[p]);
+    partitions_[p].release();
+  }
+  return true;
+}
+
+void GroupByAggregator::merge(const GroupByAggregator &other) {
+  if (!other.enabled()) {
+    return;
+  }
+  if (!enabled()) {
+    enable(other.memory_budget_, other.spill_);
+  } else if (!spill_ && other.spill_) {
+    spill_ = other.spill_;
+  }
+  for (size_t p = 0; p < GROUP_PARTITIONS; ++p) {
+    partitions_[p].merge(other.partitions_[p]);
+  }
+}
+
+size_t GroupByAggregator::distinctKeys() const {
+  size_t total = 0;
+  for (const AggHashTable &table : partitions_) {
+    total += table.size();
+  }
+  return total;
+}
+
+size_t GroupByAggregator::memoryBytes() const {
+  size_t total = 0;
+  for (const AggHashTable &table : partitions_) {
+    total += table.memoryBytes();
+  }
+  return total;
+}
+
+// Highest revenue first, ties by key, so rankings never depend on hash order
+static bool ranksHigher(int64_t cents_a, std::string_view key_a,
+                        int64_t cents_b, std::string_view key_b) {
+  if (cents_a != cents_b) {
+    return cents_a > cents_b;
+  }
+  return key_a < key_b;
+}
+
+// Best `limit` entries of the given tables
+static std::vector<GroupTotal>
+topOf(const std::vector<const AggHashTable *> &tables, size_t limit) {
+  // Rank views first; only the winners are copied into strings
+  std::vector<AggHashTable::Entry> entries;
+  for (const AggHashTable *table : tables) {
+    table->forEach(
+        [&entries](const AggHashTable::Entry &e) { entries.push_back(e); });
+  }
+
+  size_t count = std::min(limit, entries.size());
+  std::partial_sort(
+      entries.begin(), entries.begin() + count, entries.end(),
+      [](const AggHashTable::Entry &a, const AggHashTable::Entry &b) {
+        return ranksHigher(a.revenue_cents, a.key, b.revenue_cents, b.key);
+      });
+
+  std::vector<GroupTotal> totals;
+  totals.reserve(count);
+  for (size_t i = 0; i < count; ++i) {
+    totals.push_back(GroupTotal{std::string(entries[i].key), entries[i].count,
+                                entries[i].revenue_cents});
+  }
+  return totals;
+}
+
+std::vector<GroupTotal> GroupByAggregator::top(size_t limit) const {
+  std::vector<const AggHashTable *> tables;
+  for (const AggHashTable &table : partitions_) {
+    tables.push_back(&table);
+  }
+  return topOf(tables, limit);
+}
+
+GroupSummary GroupByAggregator::summarize(size_t limit,
+                                          size_t num_threads) const {
+  GroupSummary summary;
+  if (!spilled()) {
+    summary.top = top(limit);
+    summary.distinct_keys = distinctKeys();
+    return summary;
+  }
+  summary.spilled_bytes = spill_->bytesWritten();
+
+  // A key lives in exactly one partition, so each partition can be rebuilt
+  // and ranked on its own; keep its top `limit` as candidates
+  std::vector<std::vector<GroupTotal>> candidates(partitions_.size());
+  std::vector<size_t> distinct(partitions_.size(), 0);
+  num_threads = std::max<size_t>(1, std::min(num_threads, partitions_.size()));
+  auto rebuild_stripe = [&](size_t stripe) {
+    for (size_t p = stripe; p < partitions_.size(); p += num_threads) {
+      AggHashTable table(partitions_[p].size());
+      table.merge(partitions_[p]);
+      spill_->readInto(p, table);
+      distinct[p] = table.size();
+      candidates[p] = topOf({&table}, limit);
+    }
+  };
+
+  std::vector<std::future<void>> stripes;
+  for (size_t w = 1; w < num_threads; ++w) {
+    stripes.push_back(std::async(std::launch::async, rebuild_stripe, w));
+  }
+  rebuild_stripe(0);
+  for (auto &stripe : stripes) {
+    stripe.get();
+  }
+
+  for (size_t p = 0; p < partitions_.size(); ++p) {
+    summary.distinct_keys += distinct[p];
+    summary.top.insert(summary.top.end(),
+                       std::make_move_iterator(candidates[p].begin()),
+                       std::make_move_iterator(candidates[p].end()));
+  }
+  size_t count = std::min(limit, summary.top.size());
+  std::partial_sort(summary.top.begin(), summary.top.begin() + count,
+                    summary.top.end(),
+                    [](const GroupTotal &a, const GroupTotal &b) {
+                      return ranksHigher(a.revenue_cents, a.key,
+                                         b.revenue_cents, b.key);
+                    });
+  summary.top.resize(count);
+  return summary;
+}
+
+} // namespace car_sales
@@ -0,0 +1,188 @@
+#include <algorithm>
+#include <cerrno>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <stdexcept>
+#include <vector>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include "group_spill.hpp"
+
+namespace car_sales {
+
+static constexpr size_t SPILL_IO_BLOCK = 1 << 20;
+
+static std::runtime_error spillError(const std::string &what) {
+  return std::runtime_error("Group-by spill " + what + ": " +
+                            std::strerror(errno));
+}
+
+bool parseByteSize(const std::string &text, size_t &bytes) {
+  // std::stoull skips leading spaces and negates a leading '-', so "-1"
+  // would come back as ULLONG_MAX
+  if (text.empty() || text[0] < '0' || text[0] > '9') {
+    return false;
+  }
+  size_t pos = 0;
+  unsigned long long value = 0;
+  try {
+    value = std::stoull(text, &pos);
+  } catch (const std::exception &) {
+    return false;
+  }
+  std::string suffix = text.substr(pos);
+  unsigned long long scale = 1;
+  if (suffix == "K" || suffix == "k") {
+    scale = 1ULL << 10;
+  } else if (suffix == "M" || suffix == "m") {
+    scale = 1ULL << 20;
+  } else if (suffix == "G" || suffix == "g") {
+    scale = 1ULL << 30;
+  } else if (!suffix.empty()) {
+    return false;
+  }
+  if (value == 0 || value > SIZE_MAX / scale) {
+    return false;
+  }
+  bytes = static_cast<size_t>(value * scale);
+  return true;
+}
+
+GroupSpill::GroupSpill(std::string directory)
+    : directory_(std::move(directory)), bytes_written_(0), spill_count_(0) {
+  if (directory_.empty()) {
+    std::error_code ec;
+    directory_ = std::filesystem::temp_directory_path(ec).string();
+    if (ec || directory_.empty()) {
+      directory_ = "/tmp";
+    }
+  }
+}
+
+GroupSpill::~GroupSpill() {
+  for (Partition &partition : partitions_) {
+    if (partition.fd >= 0) {
+      ::close(partition.fd);
+    }
+  }
+}
+
+int GroupSpill::openFile() {
+  std::string pattern = directory_ + "/car_sales_spill_XXXXXX";
+  std::vector<char> path(pattern.begin(), pattern.end());
+  path.push_back('\0');
+  int fd = ::mkstemp(path.data());
+  if (fd < 0) {
+    throw spillError("create in " + directory_);
+  }
+  // Anonymous from here on: the data lives only as long as the descriptor
+  ::unlink(path.data());
+  return fd;
+}
+
+void GroupSpill::write(size_t partition, const AggHashTable &table) {
+  if (table.empty()) {
+    return;
+  }
+
+  std::vector<char> buffer;
+  buffer.reserve(SPILL_IO_BLOCK);
+  auto append = [&buffer](const void *data, size_t size) {
+    const char *bytes = static_cast<const char *>(data);
+    buffer.insert(buffer.end(), bytes, bytes + size);
+  };
+  table.forEach([&append](const AggHashTable::Entry &entry) {
+    uint32_t length = static_cast<uint32_t>(entry.key.size());
+    append(&length, sizeof(length));
+    append(entry.key.data(), entry.key.size());
+    append(&entry.count, sizeof(entry.count));
+    append(&entry.revenue_cents, sizeof(entry.revenue_cents));
+  });
+
+  Partition &target = partitions_[partition];
+  std::lock_guard<std::mutex> lock(target.mutex);
+  if (target.fd < 0) {
+    target.fd = openFile();
+  }
+  size_t done = 0;
+  while (done < buffer.size()) {
+    ssize_t n = ::pwrite(target.fd, buffer.data() + done, buffer.size() - done,
+                         static_cast<off_t>(target.size + done));
+    if (n < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      throw spillError("write");
+    }
+    done += static_cast<size_t>(n);
+  }
+  target.size += buffer.size();
+  bytes_written_ += buffer.size();
+  ++spill_count_;
+}
+
+void GroupSpill::readInto(size_t partition, AggHashTable &table) const {
+  const Partition &source = partitions_[partition];
+  if (source.fd < 0) {
+    return;
+  }
+
+  std::vector<char> buffer(SPILL_IO_BLOCK);
+  size_t filled = 0; // bytes in buffer, including a carried partial record
+  uint64_t offset = 0;
+  while (offset < source.size || filled > 0) {
+    size_t want = static_cast<size_t>(
+        std::min<uint64_t>(buffer.size() - filled, source.size - offset));
+    while (want > 0) {
+      ssize_t n = ::pread(source.fd, buffer.data() + filled, want,
+                          static_cast<off_t>(offset));
+      if (n < 0 && errno == EINTR) {
+        continue;
+      }
+      if (n <= 0) {
+        throw spillError("read");
+      }
+      filled += static_cast<size_t>(n);
+      offset += static_cast<uint64_t>(n);
+      want -= static_cast<size_t>(n);
+    }
+
+    size_t pos = 0;
+    while (true) {
+      uint32_t length;
+      if (filled - pos < sizeof(length)) {
+        break;
+      }
+      std::memcpy(&length, buffer.data() + pos, sizeof(length));
+      size_t record = sizeof(length) + length + 2 * sizeof(int64_t);
+      if (filled - pos < record) {
+        break;
+      }
+      int64_t count;
+      int64_t cents;
+      const char *key = buffer.data() + pos + sizeof(length);
+      std::memcpy(&count, key + length, sizeof(count));
+      std::memcpy(&cents, key + length + sizeof(count), sizeof(cents));
+      table.add(std::string_view(key, length), count, cents);
+      pos += record;
+    }
+
+    if (pos == 0 && filled > 0) {
+      if (offset >= source.size) {
+        throw std::runtime_error("Group-by spill file is truncated");
+      }
+      // A single record larger than the buffer
+      buffer.resize(buffer.size() * 2);
+      continue;
+    }
+    // Carry the incomplete tail to the front of the buffer
+    std::memmove(buffer.data(), buffer.data() + pos, filled - pos);
+    filled -= pos;
+  }
+}
+
+} // namespace car_sales
@@ -0,0 +1,193 @@
+#include <algorithm>
+
+#include "heavy_hitters.hpp"
+
+namespace car_sales {
+
+const char *heavyHitterMetricName(HeavyHitterMetric metric) {
+  return metric == HeavyHitterMetric::Revenue ? "revenue" : "units";
+}
+
+bool parseHeavyHitterMetric(std::string_view name, HeavyHitterMetric &metric) {
+  if (name == "units") {
+    metric = HeavyHitterMetric::Units;
+    return true;
+  }
+  if (name == "revenue") {
+    metric = HeavyHitterMetric::Revenue;
+    return true;
+  }
+  return false;
+}
+
+SpaceSavingSketch::SpaceSavingSketch(size_t capacity) : capacity_(capacity) {
+  counters_.reserve(capacity);
+  index_.reserve(capacity);
+}
+
+// Heap order is (weight, key) so equal weights evict deterministically
+static bool lighter(int64_t weight_a, const std::string &key_a,
+                    int64_t weight_b, const std::string &key_b) {
+  if (weight_a != weight_b) {
+    return weight_a < weight_b;
+  }
+  return key_a > key_b;
+}
+
+void SpaceSavingSketch::swapCounters(size_t a, size_t b) {
+  std::swap(counters_[a], counters_[b]);
+  index_[counters_[a].key] = a;
+  index_[counters_[b].key] = b;
+}
+
+void SpaceSavingSketch::siftDown(size_t position) {
+  // Weights only ever grow, so a changed counter can only move down
+  size_t n = counters_.size();
+  while (true) {
+    size_t smallest = position;
+    for (size_t child = 2 * position + 1;
+         child <= 2 * position + 2 && child < n; ++child) {
+      if (lighter(counters_[child].weight, counters_[child].key,
+                  counters_[smallest].weight, counters_[smallest].key)) {
+        smallest = child;
+      }
+    }
+    if (smallest == position) {
+      return;
+    }
+    swapCounters(position, smallest);
+    position = smallest;
+  }
+}
+
+void SpaceSavingSketch::add(std::string_view key, int64_t weight) {
+  if (capacity_ == 0) {
+    return;
+  }
+  weight = std::max<int64_t>(weight, 0);
+  total_weight_ += weight;
+
+  // Keys are short ids, so the temporary string stays in the SSO buffer
+  std::string lookup(key);
+  auto found = index_.find(lookup);
+  if (found != index_.end()) {
+    counters_[found->second].weight += weight;
+    siftDown(found->second);
+    return;
+  }
+
+  if (counters_.size() < capacity_) {
+    // New counters start at the bottom of the heap; sift them up
+    size_t position = counters_.size();
+    counters_.push_back(Counter{lookup, weight, 0});
+    index_.emplace(std::move(lookup), position);
+    while (position > 0) {
+      size_t parent = (position - 1) / 2;
+      if (!lighter(counters_[position].weight, counters_[position].key,
+                   counters_[parent].weight, counters_[parent].key)) {
+        break;
+      }
+      swapCounters(position, parent);
+      position = parent;
+    }
+    return;
+  }
+
+  // Evict the lightest counter; the newcomer inherits its weight as error.
+  // Reusing the map node avoids an allocation per eviction.
+  Counter &victim = counters_.front();
+  auto node = index_.extract(victim.key);
+  node.key() = lookup;
+  index_.insert(std::move(node));
+  victim.key = std::move(lookup);
+  victim.error = victim.weight;
+  victim.weight += weight;
+  siftDown(0);
+}
+
+int64_t SpaceSavingSketch::maxError() const {
+  if (counters_.size() < capacity_ || counters_.empty()) {
+    return 0;
+  }
+  return counters_.front().weight;
+}
+
+void SpaceSavingSketch::rebuild(std::vector<Counter> counters) {
+  counters_ = std::move(counters);
+  std::make_heap(counters_.begin(), counters_.end(),
+                 [](const Counter &a, const Counter &b) {
+                   return lighter(b.weight, b.key, a.weight, a.key);
+                 });
+  index_.clear();
+  for (size_t i = 0; i < counters_.size(); ++i) {
+    index_.emplace(counters_[i].key, i);
+  }
+}
+
+void SpaceSavingSketch::merge(const SpaceSavingSketch &other) {
+  if (!other.enabled()) {
+    return;
+  }
+  if (!enabled()) {
+    *this = other;
+    return;
+  }
+
+  // A key missing from a full sketch may still have had up to that sketch's
+  // minimum weight, so it is charged that much (as both weight and error)
+  int64_t floor_this = maxError();
+  int64_t floor_other = other.maxError();
+
+  std::vector<Counter> combined;
+  combined.reserve(counters_.size() + other.counters_.size());
+  for (const Counter &counter : counters_) {
+    auto found = other.index_.find(counter.key);
+    if (found != other.index_.end()) {
+      const Counter &match = other.counters_[found->second];
+      combined.push_back(Counter{counter.key, counter.weight + match.weight,
+                                 counter.error + match.error});
+    } else {
+      combined.push_back(Counter{counter.key, counter.weight + floor_other,
+                                 counter.error + floor_other});
+    }
+  }
+  for (const Counter &counter : other.counters_) {
+    if (index_.find(counter.key) == index_.end()) {
+      combined.push_back(Counter{counter.key, counter.weight + floor_this,
+                                 counter.error + floor_this});
+    }
+  }
+
+  // Keep the heaviest capacity_ counters
+  auto heavier = [](const Counter &a, const Counter &b) {
+    return lighter(b.weight, b.key, a.weight, a.key);
+  };
+  if (combined.size() > capacity_) {
+    std::nth_element(combined.begin(), combined.begin() + capacity_,
+                     combined.end(), heavier);
+    combined.resize(capacity_);
+  }
+  total_weight_ += other.total_weight_;
+  rebuild(std::move(combined));
+}
+
+std::vector<HeavyHitter> SpaceSavingSketch::top(size_t limit) const {
+  std::vector<HeavyHitter> hitters;
+  hitters.reserve(counters_.size());
+  for (const Counter &counter : counters_) {
+    hitters.push_back(HeavyHitter{counter.key, counter.weight, counter.error});
+  }
+  std::sort(hitters.begin(), hitters.end(),
+            [](const HeavyHitter &a, const HeavyHitter &b) {
+              if (a.estimate != b.estimate) {
+                return a.estimate > b.estimate;
+              }
+              return a.key < b.key;
+            });
+  if (hitters.size() > limit) {
+    hitters.resize(limit);
+  }
+  return hitters;
+}
+
+} // namespace car_sales
@@ -0,0 +1,149 @@
+#include <algorithm>
+#include <cmath>
+#include <map>
+#include <stdexcept>
+
+#include "hyperloglog.hpp"
+
+namespace car_sales {
+
+HyperLogLog::HyperLogLog(unsigned precision) : precision_(precision) {
+  checkPrecision(precision);
+  registers_.assign(size_t(1) << precision, 0);
+}
+
+void HyperLogLog::checkPrecision(unsigned precision) {
+  if (precision < HLL_MIN_PRECISION || precision > HLL_MAX_PRECISION) {
+    throw std::invalid_argument("HyperLogLog precision must be between " +
+                                std::to_string(HLL_MIN_PRECISION) + " and " +
+                                std::to_string(HLL_MAX_PRECISION));
+  }
+}
+
+void HyperLogLog::merge(const HyperLogLog &other) {
+  if (other.precision_ != precision_) {
+    throw std::invalid_argument("Cannot merge HyperLogLog sketches of "
+                                "different precision");
+  }
+  // The register count is a multiple of 16, so the fixed-width inner loop
+  // compiles to whole-vector byte max instructions with no scalar tail
+  constexpr size_t LANES = 16;
+  uint8_t *target = registers_.data();
+  const uint8_t *source = other.registers_.data();
+  for (size_t block = 0; block < registers_.size(); block += LANES) {
+    for (size_t i = 0; i < LANES; ++i) {
+      target[block + i] = std::max(target[block + i], source[block + i]);
+    }
+  }
+}
+
+double HyperLogLog::estimate() const {
+  double m = static_cast<double>(registers_.size());
+  double alpha;
+  switch (registers_.size()) {
+  case 16:
+    alpha = 0.673;
+    break;
+  case 32:
+    alpha = 0.697;
+    break;
+  case 64:
+    alpha = 0.709;
+    break;
+  default:
+    alpha = 0.7213 / (1.0 + 1.079 / m);
+  }
+
+  double harmonic = 0.0;
+  size_t zeros = 0;
+  for (uint8_t reg : registers_) {
+    harmonic += std::ldexp(1.0, -static_cast<int>(reg));
+    zeros += reg == 0;
+  }
+
+  double raw = alpha * m * m / harmonic;
+  if (raw <= 2.5 * m && zeros > 0) {
+    return m * std::log(m / static_cast<double>(zeros));
+  }
+  // 64-bit hashes make the large-range correction unnecessary
+  return raw;
+}
+
+double HyperLogLog::relativeError() const {
+  return 1.04 / std::sqrt(static_cast<double>(registers_.size()));
+}
+
+DistinctCounter::DistinctCounter(unsigned precision) : precision_(precision) {
+  HyperLogLog::checkPrecision(precision);
+}
+
+void DistinctCounter::add(std::string_view brand, std::string_view country,
+                          uint64_t hash) {
+  sketches_
+      .find(brand, country, [this]() { return HyperLogLog(precision_); })
+      .addHash(hash);
+}
+
+void DistinctCounter::merge(const DistinctCounter &other) {
+  if (!other.enabled()) {
+    return;
+  }
+  if (!enabled()) {
+    precision_ = other.precision_;
+  }
+  sketches_.merge(other.sketches_);
+}
+
+// Largest estimate first, then by name, so output never depends on hash order
+static void sortGroups(std::vector<DistinctGroup> &groups) {
+  std::sort(groups.begin(), groups.end(),
+            [](const DistinctGroup &a, const DistinctGroup &b) {
+              if (a.estimate != b.estimate) {
+                return a.estimate > b.estimate;
+              }
+              if (a.brand != b.brand) {
+                return a.brand < b.brand;
+              }
+              return a.country < b.country;
+            });
+}
+
+static uint64_t roundedEstimate(const HyperLogLog &sketch) {
+  return static_cast<uint64_t>(std::llround(sketch.estimate()));
+}
+
+std::vector<DistinctGroup> DistinctCounter::groups() const {
+  std::vector<DistinctGroup> groups;
+  groups.reserve(sketches_.size());
+  sketches_.forEach([&groups](std::string brand, std::string country,
+                              const HyperLogLog &sketch) {
+    groups.push_back(DistinctGroup{std::move(brand), std::move(country),
+                                   roundedEstimate(sketch)});
+  });
+  sortGroups(groups);
+  return groups;
+}
+
+std::vector<DistinctGroup>
+DistinctCounter::rollUp(const std::function<bool(std::string_view)> &include,
+                        const std::string &label) const {
+  std::map<std::string, HyperLogLog> brands = sketches_.rollUp(include);
+  std::vector<DistinctGroup> groups;
+  groups.reserve(brands.size());
+  for (const auto &[brand, sketch] : brands) {
+    groups.push_back(DistinctGroup{brand, label, roundedEstimate(sketch)});
+  }
+  sortGroups(groups);
+  return groups;
+}
+
+size_t DistinctCounter::memoryBytes() const {
+  size_t total = sketches_.keyBytes();
+  sketches_.forEach([&total](const std::string &, const std::string &,
+                             const HyperLogLog &sketch) {
+    total += sketch.memoryBytes();
+  });
+  return total;
+}
+
+} // namespace car_sales
@@ -2,22 +2,73 @@
 #include <iomanip>
 #include <chrono>
 #include <cstring>
+#include <fstream>
+#include <sstream>
 #include <thread>
+#include <sys/stat.h>
 #include "data_analyzer.hpp"
+#include "query_server.hpp"
+#include "result_cache.hpp"
 
 using namespace car_sales;
 
 void printUsage(const char* program_name) {
     std::cout << "Usage: " << program_name << " <csv_file> [options]\n";
+    std::cout << "  <csv_file> may be - for stdin, or a pipe or FIFO; streams are parsed as they arrive\n";
     std::cout << "\nOptions:\n";
     std::cout << "  --chunk-size <n>   Set chunk size for processing (default: 10000)\n";
     std::cout << "  --threads <n>      Number of threads for concurrent processing (default: auto)\n";
     std::cout << "  --sequential       Disable concurrent processing\n";
+    std::cout << "  --io-block <sz>    Read-ahead block size for --sequential and streams (default: 256K)\n";
+    std::cout << "  --io-depth <n>     Blocks read ahead on the I/O thread, at least 2 (default: 4)\n";
+    std::cout << "  --direct-io        Bypass the page cache (O_DIRECT) for --sequential reads\n";
+    std::cout << "  --placement <p>    Worker placement: none (default), cores (pin each worker) or\n";
+    std::cout << "                     numa (pin, read input and merge on each worker's node)\n";
+    std::cout << "  --reject-file <f>  Write every rejected raw line to <f>\n";
+    std::cout << "  --group-by <col>   Count and revenue per value of <col> (country, manufacturer,\n";
+    std::cout << "                     model, dealership_id, salesperson_id, buyer_id, vin)\n";
+    std::cout << "  --top <n>          Groups to list for --group-by (default: 10)\n";
+    std::cout << "  --max-memory <sz>  Spill --group-by state to temp files beyond <sz> (e.g. 512M, 4G)\n";
+    std::cout << "  --heavy-hitters <col>  Approximate top keys of <col> in bounded memory\n";
+    std::cout << "  --hh-metric <m>    Rank heavy hitters by units (default) or revenue\n";
+    std::cout << "  --hh-capacity <n>  Counters per heavy-hitter sketch (default: 256)\n";
+    std::cout << "  --distinct <col>   Estimate distinct <col> values (e.g. buyer_id, vin) per\n";
+    std::cout << "                     manufacturer and country with HyperLogLog\n";
+    std::cout << "  --hll-precision <p>  HyperLogLog precision " << HLL_MIN_PRECISION << "-" << HLL_MAX_PRECISION
+              << " (default: " << HLL_DEFAULT_PRECISION << ")\n";
+    std::cout << "  --quantiles <list> Sale price quantiles per manufacturer and country (e.g. 0.5,0.9,0.99)\n";
+    std::cout << "  --kll-k <k>        Quantile sketch size; error shrinks as 1/k (default: "
+              << KllSketch::DEFAULT_K << ")\n";
+    std::cout << "  --time-series <b>  Units and revenue per brand per month or week (ISO)\n";
+    std::cout << "  --series-file <f>  Write the time series to <f> as TSV instead of stdout\n";
+    std::cout << "  --rolling <days>   Daily BMW revenue per European country with trailing window\n";
+    std::cout << "                     sums over the given widths (e.g. 7,30)\n";
+    std::cout << "  --rolling-file <f> Write the rolling windows to <f> as TSV instead of stdout\n";
+    std::cout << "  --geo-grid <deg>   Units and revenue per latitude/longitude cell of <deg> degrees\n";
+    std::cout << "  --geo-file <f>     Write the grid cells to <f> as TSV instead of stdout\n";
+    std::cout << "  --bbox <box>       Only analyse rows inside min_lat,min_lon,max_lat,max_lon\n";
+    std::cout << "  --sample <f>       Approximate mode: read at most fraction <f> of the input in random\n";
+    std::cout << "                     blocks and report 95% confidence intervals\n";
+    std::cout << "  --sample-error <e> Stop sampling once intervals are within +/- <e> (default: 0.01)\n";
+    std::cout << "  --sample-block <sz>  Sampling block size (default: 1M)\n";
+    std::cout << "  --sample-seed <n>  Seed for the block order (default: 1)\n";
+    std::cout << "  --serve <socket>   Load the input once and answer queries on a Unix socket\n";
+    std::cout << "                     (see analyzer_client); the input is dataset \"default\"\n";
+    std::cout << "  --dataset <n>=<f>  With --serve, also load <f> as dataset <n> (repeatable)\n";
+    std::cout << "  --cache-dir <d>    Reuse results of earlier identical runs over an unchanged file\n";
+    std::cout << "  --cache-max <sz>   Evict least recently used cache entries beyond <sz> (default: 256M)\n";
+    std::cout << "  --progress         Print rate, ETA and per-thread utilization to stderr while parsing\n";
+    std::cout << "  --progress-interval <s>  Seconds between progress reports (default: 1)\n";
+    std::cout << "  --progress-file <f>  Also write each report to <f> as a JSON line (implies --progress)\n";
+    std::cout << "  --profile          Print per-stage timing breakdown\n";
+    std::cout << "  --perf-counters    Add hardware counters (IPC, cache/branch misses) to the profile\n";
     std::cout << "  --help             Show this help message\n";
     std::cout << "\nExample:\n";
     std::cout << "  " << program_name << " data.csv\n";
     std::cout << "  " << program_name << " data.csv --threads 8\n";
     std::cout << "  " << program_name << " data.csv --chunk-size 5000 --sequential\n";
+    std::cout << "  " << program_name << " data.csv --group-by dealership_id --top 20\n";
+    std::cout << "  " << program_name << " data.csv --progress --progress-file progress.jsonl\n";
 }
 
 void printResults(const AnalysisResult& result) {
@@ -38,7 +89,7 @@ void printResults(const AnalysisResult& result) {
     std::cout << "║  2. BMW TOTAL REVENUE (2025)                                     ║\n";
     std::cout << "║     ────────────────────────                                     ║\n";
     std::cout << "║     Total Revenue: $" << std::fixed << std::setprecision(2) 
-              << std::setw(15) << result.bmw_year_total_revenue 
+              << std::setw(15) << formatCents(result.bmw_year_total_revenue_cents) 
               << "                         ║\n";
     
     // Task 3: BMW European Revenue Distribution
@@ -68,21 +119,430 @@ void printResults(const AnalysisResult& result) {
               << "                              ║\n";
     std::cout << "║  Records Failed:    " << std::setw(12) << result.total_records_failed 
               << "                              ║\n";
+    if (result.total_records_filtered > 0) {
+        std::cout << "║  Outside Bbox:      " << std::setw(12) << result.total_records_filtered
+                  << "                              ║\n";
+    }
     std::cout << "║  Analysis Status:   " << std::setw(12) 
               << (result.analysis_complete ? "Complete" : "Incomplete") 
               << "                              ║\n";
     std::cout << "╚══════════════════════════════════════════════════════════════════╝\n";
     
-    // Print errors if any (limited to first 10)
-    if (!result.errors.empty()) {
-        std::cout << "\nWarnings/Errors (first " << std::min(result.errors.size(), size_t(10)) << "):\n";
-        for (size_t i = 0; i < std::min(result.errors.size(), size_t(10)); ++i) {
-            std::cout << "  - " << result.errors[i] << "\n";
+    // Print errors if any (limited to first 10); parse errors are only
+    // formatted here, when they are actually shown
+    size_t total_errors = result.errors.size() + result.parse_errors.size();
+    if (total_errors > 0) {
+        size_t shown = std::min(total_errors, size_t(10));
+        std::cout << "\nWarnings/Errors (first " << shown << "):\n";
+        for (size_t i = 0; i < shown; ++i) {
+            if (i < result.errors.size()) {
+                std::cout << "  - " << result.errors[i] << "\n";
+            } else {
+                std::cout << "  - "
+                          << formatParseError(result.parse_errors[i - result.errors.size()])
+                          << "\n";
+            }
+        }
+        if (total_errors > 10) {
+            std::cout << "  ... and " << (total_errors - 10) << " more errors\n";
+        }
+    }
+}
+
+void printGroups(const AnalysisResult& result) {
+    if (result.group_by_column == GroupColumn::None) {
+        return;
+    }
+    std::cout << "\nTop " << result.top_groups.size() << " of " << result.group_count
+              << " groups by " << groupColumnName(result.group_by_column) << " (revenue)\n";
+    if (result.group_spill_bytes > 0) {
+        std::cout << "  (over --max-memory: spilled " << std::fixed << std::setprecision(1)
+                  << static_cast<double>(result.group_spill_bytes) / (1024.0 * 1024.0)
+                  << " MB to temp files)\n";
+    }
+    std::cout << "  " << std::left << std::setw(24) << "Key" << std::right
+              << std::setw(12) << "Sales" << std::setw(20) << "Revenue" << "\n";
+    for (const auto& group : result.top_groups) {
+        std::cout << "  " << std::left << std::setw(24) << group.key << std::right
+                  << std::setw(12) << group.count
+                  << std::setw(19) << formatCents(group.revenue_cents) << "\n";
+    }
+}
+
+void printHeavyHitters(const AnalysisResult& result) {
+    if (result.heavy_hitter_column == GroupColumn::None) {
+        return;
+    }
+    bool revenue = result.heavy_hitter_metric == HeavyHitterMetric::Revenue;
+    auto show = [revenue](int64_t value) {
+        return revenue ? formatCents(value) : std::to_string(value);
+    };
+    std::cout << "\nApproximate top " << result.heavy_hitters.size() << " "
+              << groupColumnName(result.heavy_hitter_column) << " by "
+              << heavyHitterMetricName(result.heavy_hitter_metric)
+              << " (total " << show(result.heavy_hitter_total)
+              << ", max overestimate " << show(result.heavy_hitter_max_error) << ")\n";
+    std::cout << "  " << std::left << std::setw(24) << "Key" << std::right
+              << std::setw(20) << "Estimate" << std::setw(20) << "At least" << "\n";
+    for (const auto& hitter : result.heavy_hitters) {
+        std::cout << "  " << std::left << std::setw(24) << hitter.key << std::right
+                  << std::setw(20) << show(hitter.estimate)
+                  << std::setw(20) << show(hitter.guaranteed()) << "\n";
+    }
+}
+
+void printDistinct(const AnalysisResult& result, size_t limit) {
+    if (result.distinct_column == GroupColumn::None) {
+        return;
+    }
+    auto print_rows = [](const std::vector<DistinctGroup>& rows, size_t count) {
+        std::cout << "  " << std::left << std::setw(20) << "Manufacturer" << std::setw(24)
+                  << "Country" << std::right << std::setw(14) << "Estimate" << "\n";
+        for (size_t i = 0; i < rows.size() && i < count; ++i) {
+            std::cout << "  " << std::left << std::setw(20) << rows[i].brand << std::setw(24)
+                      << rows[i].country << std::right << std::setw(14) << rows[i].estimate << "\n";
+        }
+    };
+    std::cout << "\nDistinct " << groupColumnName(result.distinct_column)
+              << " (HyperLogLog p=" << result.distinct_precision << ", ~"
+              << std::fixed << std::setprecision(1) << result.distinct_relative_error * 100.0
+              << "% standard error)\n";
+    print_rows(result.distinct_europe, result.distinct_europe.size());
+    std::cout << "\nTop " << std::min(limit, result.distinct_groups.size())
+              << " manufacturer/country pairs by distinct "
+              << groupColumnName(result.distinct_column) << "\n";
+    print_rows(result.distinct_groups, limit);
+}
+
+// Comma-separated quantiles, each in [0, 1]
+bool parseQuantiles(const std::string& text, std::vector<double>& quantiles) {
+    quantiles.clear();
+    size_t start = 0;
+    while (start <= text.size()) {
+        size_t comma = text.find(',', start);
+        std::string item = text.substr(start, comma == std::string::npos ? std::string::npos : comma - start);
+        try {
+            size_t used = 0;
+            double q = std::stod(item, &used);
+            if (used != item.size() || q < 0.0 || q > 1.0) {
+                return false;
+            }
+            quantiles.push_back(q);
+        } catch (const std::exception&) {
+            return false;
+        }
+        if (comma == std::string::npos) {
+            break;
+        }
+        start = comma + 1;
+    }
+    return !quantiles.empty();
+}
+
+void printPriceQuantiles(const AnalysisResult& result, const std::vector<double>& quantiles,
+                         size_t limit) {
+    if (result.price_quantile_groups.empty()) {
+        return;
+    }
+    auto print_rows = [&quantiles](const std::vector<QuantileGroup>& rows, size_t count) {
+        std::cout << "  " << std::left << std::setw(16) << "Manufacturer" << std::setw(24)
+                  << "Country" << std::right << std::setw(8) << "Sales";
+        for (double q : quantiles) {
+            std::ostringstream label;
+            label << "p" << q * 100.0;
+            std::cout << std::setw(14) << label.str();
+        }
+        std::cout << "\n";
+        for (size_t i = 0; i < rows.size() && i < count; ++i) {
+            std::cout << "  " << std::left << std::setw(16) << rows[i].brand << std::setw(24)
+                      << rows[i].country << std::right << std::setw(8) << rows[i].sketch.count();
+            for (double q : quantiles) {
+                std::cout << std::setw(14) << formatCents(rows[i].sketch.quantile(q));
+            }
+            std::cout << "\n";
+        }
+    };
+    std::cout << "\nSale price quantiles (KLL, rank error ~" << std::fixed << std::setprecision(1)
+              << result.price_quantile_rank_error * 100.0 << "%)\n";
+    std::cout << std::defaultfloat;
+    print_rows(result.price_quantiles_europe, result.price_quantiles_europe.size());
+    std::cout << "\nTop " << std::min(limit, result.price_quantile_groups.size())
+              << " manufacturer/country pairs by sales\n";
+    print_rows(result.price_quantile_groups, limit);
+}
+
+void printSample(const AnalysisResult& result) {
+    if (!result.approximate) {
+        return;
+    }
+    const SampleReport& sample = result.sample;
+    auto interval = [](const SampleInterval& value, bool dollars) {
+        std::ostringstream text;
+        text << std::fixed << std::setprecision(dollars ? 2 : 0) << value.estimate
+             << " +/- " << value.half_width << " (" << std::setprecision(2)
+             << value.relativeError() * 100.0 << "%)";
+        return text.str();
+    };
+    double coverage = sample.blocks_total > 0
+        ? 100.0 * static_cast<double>(sample.blocks_sampled) / static_cast<double>(sample.blocks_total)
+        : 0.0;
+    std::cout << "\nApproximate results: sampled " << sample.blocks_sampled << " of "
+              << sample.blocks_total << " blocks (" << std::fixed << std::setprecision(1)
+              << coverage << "%, " << sample.rows_sampled << " rows, "
+              << static_cast<double>(sample.bytes_sampled) / (1024.0 * 1024.0) << " MB)"
+              << (sample.target_reached ? ", stopped at target error" : "") << "\n";
+    std::cout << "Confidence intervals (z = " << std::setprecision(2) << sample.z << ")\n";
+    std::cout << "  Audi sold in China:          " << interval(sample.audi_china_year_sales, false) << "\n";
+    std::cout << "  BMW revenue:                $" << interval(sample.bmw_year_total_revenue, true) << "\n";
+    for (const auto& [country, revenue] : result._bmw_europe_revenuedistribution) {
+        auto found = sample.bmw_europe_revenue.find(country);
+        if (found != sample.bmw_europe_revenue.end()) {
+            std::cout << "  BMW " << std::left << std::setw(24) << country << std::right
+                      << "$" << interval(found->second, true) << "\n";
+        }
+    }
+}
+
+// Tab-separated brand, period, units, revenue: one row per bucket
+void writeTimeSeries(std::ostream& out, const AnalysisResult& result) {
+    out << "brand\t" << timeBucketName(result.time_bucket) << "\tunits\trevenue\n";
+    for (const auto& point : result.time_series) {
+        out << point.brand << '\t' << point.label << '\t' << point.units << '\t'
+            << formatCents(point.revenue_cents) << '\n';
+    }
+}
+
+bool printTimeSeries(const AnalysisResult& result, const std::string& series_file) {
+    if (result.time_bucket == TimeBucket::None) {
+        return true;
+    }
+    if (!series_file.empty()) {
+        std::ofstream out(series_file);
+        if (!out) {
+            std::cerr << "Error: Cannot write series file: " << series_file << "\n";
+            return false;
+        }
+        writeTimeSeries(out, result);
+        std::cout << "\nWrote " << result.time_series.size() << " "
+                  << timeBucketName(result.time_bucket) << "ly points to " << series_file << "\n";
+    } else {
+        std::cout << "\nTime series by " << timeBucketName(result.time_bucket) << "\n";
+        writeTimeSeries(std::cout, result);
+    }
+    if (result.undated_rows > 0) {
+        std::cout << "(" << result.undated_rows << " rows with an invalid sale_date day or month left out)\n";
+    }
+    return true;
+}
+
+bool parseWindows(const std::string& text, std::vector<uint32_t>& windows) {
+    windows.clear();
+    size_t start = 0;
+    while (start <= text.size()) {
+        size_t comma = text.find(',', start);
+        std::string item = text.substr(start, comma == std::string::npos ? std::string::npos : comma - start);
+        try {
+            size_t used = 0;
+            unsigned long days = std::stoul(item, &used);
+            if (used != item.size() || days < 1 || days > MAX_ROLLING_WINDOW) {
+                return false;
+            }
+            windows.push_back(static_cast<uint32_t>(days));
+        } catch (const std::exception&) {
+            return false;
+        }
+        if (comma == std::string::npos) {
+            break;
+        }
+        start = comma + 1;
+    }
+    return !windows.empty();
+}
+
+// Tab-separated country, date, day revenue, then one column per window
+void writeRolling(std::ostream& out, const AnalysisResult& result) {
+    out << "country\tdate\trevenue";
+    for (uint32_t days : result.rolling_windows) {
+        out << "\trevenue_" << days << "d";
+    }
+    out << '\n';
+    for (const auto& point : result.rolling_revenue) {
+        out << point.country << '\t' << point.date << '\t' << formatCents(point.day_cents);
+        for (int64_t cents : point.window_cents) {
+            out << '\t' << formatCents(cents);
+        }
+        out << '\n';
+    }
+}
+
+bool printRolling(const AnalysisResult& result, const std::string& rolling_file) {
+    if (result.rolling_windows.empty()) {
+        return true;
+    }
+    if (!rolling_file.empty()) {
+        std::ofstream out(rolling_file);
+        if (!out) {
+            std::cerr << "Error: Cannot write rolling file: " << rolling_file << "\n";
+            return false;
+        }
+        writeRolling(out, result);
+        std::cout << "\nWrote " << result.rolling_revenue.size() << " daily points to " << rolling_file << "\n";
+    } else {
+        std::cout << "\nBMW rolling revenue in Europe\n";
+        writeRolling(std::cout, result);
+    }
+    return true;
+}
+
+// Tab-separated south-west corner, units, revenue: one row per occupied cell
+void writeGeoGrid(std::ostream& out, const AnalysisResult& result) {
+    out << "lat\tlon\tunits\trevenue\n";
+    for (const auto& cell : result.geo_cells) {
+        out << cell.lat << '\t' << cell.lon << '\t' << cell.units << '\t'
+            << formatCents(cell.revenue_cents) << '\n';
+    }
+}
+
+bool printGeoGrid(const AnalysisResult& result, const std::string& geo_file) {
+    if (result.geo_cell_degrees <= 0.0) {
+        return true;
+    }
+    if (!geo_file.empty()) {
+        std::ofstream out(geo_file);
+        if (!out) {
+            std::cerr << "Error: Cannot write grid file: " << geo_file << "\n";
+            return false;
+        }
+        writeGeoGrid(out, result);
+        std::cout << "\nWrote " << result.geo_cells.size() << " grid cells to " << geo_file << "\n";
+    } else {
+        std::cout << "\nSales per " << result.geo_cell_degrees << " degree cell\n";
+        writeGeoGrid(std::cout, result);
+    }
+    if (result.unlocated_rows > 0) {
+        std::cout << "(" << result.unlocated_rows << " rows without valid coordinates left out)\n";
+    }
+    return true;
+}
+
+void printCache(const AnalysisResult& result, const ResultCache& cache, bool cacheable) {
+    CacheStats stats = cache.stats();
+    std::cout << "\nResult cache: "
+              << (!cacheable ? "bypassed (--profile, --reject-file and --quantiles always parse)"
+                  : result.from_cache ? "hit" : "miss")
+              << "\n";
+    std::cout << "  " << stats.hits << " hits, " << stats.misses << " misses, " << stats.stores
+              << " stores, " << stats.invalidations << " invalidated, " << stats.evictions
+              << " evicted; " << std::fixed << std::setprecision(1)
+              << static_cast<double>(cache.sizeBytes()) / (1024.0 * 1024.0) << " of "
+              << static_cast<double>(cache.maxBytes()) / (1024.0 * 1024.0) << " MB used\n";
+}
+
+void printProfile(const StageProfile& profile) {
+    if (!profiling::COMPILED_IN) {
+        std::cout << "\nProfiling was compiled out (CAR_SALES_ENABLE_PROFILING=OFF)\n";
+        return;
+    }
+    if (!profile.enabled) {
+        return;
+    }
+
+    double wall_ms = static_cast<double>(profile.wall_ns) / 1e6;
+    std::cout << "\nStage profile (CPU time summed over threads, wall "
+              << std::fixed << std::setprecision(2) << wall_ms << " ms)\n";
+    std::cout << "  " << std::left << std::setw(15) << "Stage" << std::right
+              << std::setw(12) << "Time (ms)" << std::setw(12) << "Rows"
+              << std::setw(12) << "MB" << std::setw(14) << "ns/row" << "\n";
+
+    for (size_t i = 0; i < STAGE_COUNT; ++i) {
+        const StageStats& stats = profile.stages[i];
+        double ns = profile.toNanoseconds(stats.ticks);
+        std::cout << "  " << std::left << std::setw(15) << stageName(static_cast<Stage>(i))
+                  << std::right << std::setw(12) << std::setprecision(2) << ns / 1e6
+                  << std::setw(12) << stats.rows
+                  << std::setw(12) << static_cast<double>(stats.bytes) / (1024.0 * 1024.0)
+                  << std::setw(14) << (stats.rows ? ns / static_cast<double>(stats.rows) : 0.0)
+                  << "\n";
+    }
+
+    if (!profile.threads.empty()) {
+        std::cout << "\n  " << std::left << std::setw(8) << "Thread" << std::right
+                  << std::setw(12) << "Busy (ms)" << std::setw(12) << "Idle (ms)"
+                  << std::setw(12) << "Rows" << std::setw(10) << "Util %" << "\n";
+        for (const auto& usage : profile.threads) {
+            double busy = profile.toNanoseconds(usage.busy_ticks);
+            double idle = profile.toNanoseconds(usage.idle_ticks);
+            double util = busy + idle > 0 ? 100.0 * busy / (busy + idle) : 0.0;
+            std::cout << "  " << std::left << std::setw(8) << usage.thread_index << std::right
+                      << std::setprecision(2) << std::setw(12) << busy / 1e6 << std::setw(12) << idle / 1e6
+                      << std::setw(12) << usage.rows << std::setw(10) << std::setprecision(1)
+                      << util << "\n";
+        }
+    }
+
+    const HwCounterReport& hw = profile.hardware;
+    if (!hw.requested) {
+        return;
+    }
+    if (!hw.available) {
+        std::cout << "\nHardware counters unavailable: " << hw.unavailable_reason << "\n";
+        return;
+    }
+
+    std::cout << "\nHardware counters (" << hw.threads << " thread(s))\n";
+    std::cout << "  " << std::left << std::setw(11) << "Stage" << std::right
+              << std::setw(16) << "Cycles" << std::setw(16) << "Instructions"
+              << std::setw(7) << "IPC" << std::setw(14) << "Cache miss"
+              << std::setw(14) << "Branch miss" << std::setw(12) << "Instr/row" << "\n";
+    for (size_t i = 0; i < HW_STAGE_COUNT; ++i) {
+        const HwStageCounters& counters = hw.stages[i];
+        std::cout << "  " << std::left << std::setw(11) << hwStageName(static_cast<HwStage>(i))
+                  << std::right << std::setw(16) << counters[HwCounter::Cycles]
+                  << std::setw(16) << counters[HwCounter::Instructions]
+                  << std::setw(7) << std::setprecision(2) << counters.ipc()
+                  << std::setw(14) << counters[HwCounter::CacheMisses]
+                  << std::setw(14) << counters[HwCounter::BranchMisses]
+                  << std::setw(12) << std::setprecision(1) << counters.instructionsPerRow()
+                  << "\n";
+    }
+    for (size_t c = 0; c < HW_COUNTER_COUNT; ++c) {
+        if (!hw.supported[c]) {
+            std::cout << "  (" << hwCounterName(static_cast<HwCounter>(c))
+                      << " not supported on this CPU/kernel)\n";
         }
-        if (result.errors.size() > 10) {
-            std::cout << "  ... and " << (result.errors.size() - 10) << " more errors\n";
+    }
+}
+
+// Load every dataset, then answer queries until a client sends SHUTDOWN
+int runServer(const std::string& socket_path,
+              const std::vector<std::pair<std::string, std::string>>& datasets) {
+    QueryServer server(socket_path);
+    for (const auto& [name, path] : datasets) {
+        auto start = std::chrono::steady_clock::now();
+        std::string error;
+        if (!server.addDataset(name, path, error)) {
+            std::cerr << "Error: " << error << "\n";
+            return 1;
         }
+        auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(
+            std::chrono::steady_clock::now() - start);
+        std::cout << "Loaded dataset " << name << " from " << path << " in "
+                  << elapsed.count() << " ms\n";
     }
+
+    std::string error;
+    if (!server.start(error)) {
+        std::cerr << "Error: " << error << "\n";
+        return 1;
+    }
+    std::cout << "Listening on " << socket_path << "\n" << std::flush;
+    server.wait();
+
+    LatencyStats stats = server.latency();
+    std::cout << "Answered " << stats.queries << " queries (mean "
+              << (stats.queries ? stats.total_us / stats.queries : 0) << " us, max "
+              << stats.max_us << " us)\n";
+    return 0;
 }
 
 int main(int argc, char* argv[]) {
@@ -95,6 +555,38 @@ int main(int argc, char* argv[]) {
     size_t chunk_size = CsvParser::DEFAULT_CHUNK_SIZE;
     size_t num_threads = 0;  // 0 = auto-detect
     bool use_concurrent = true;
+    WorkerPlacement placement = WorkerPlacement::None;
+    ReadAheadOptions read_ahead;
+    bool profile = false;
+    bool perf_counters = false;
+    std::string reject_file;
+    GroupColumn group_by = GroupColumn::None;
+    size_t group_limit = 10;
+    size_t max_memory = 0;
+    GroupColumn heavy_hitters = GroupColumn::None;
+    HeavyHitterMetric hh_metric = HeavyHitterMetric::Units;
+    size_t hh_capacity = SpaceSavingSketch::DEFAULT_CAPACITY;
+    GroupColumn distinct = GroupColumn::None;
+    unsigned hll_precision = HLL_DEFAULT_PRECISION;
+    std::vector<double> quantiles;
+    TimeBucket time_bucket = TimeBucket::None;
+    std::string series_file;
+    std::vector<uint32_t> rolling_windows;
+    std::string rolling_file;
+    double geo_cell = 0.0;
+    std::string geo_file;
+    std::string serve_socket;
+    std::vector<std::pair<std::string, std::string>> datasets;
+    BoundingBox bbox;
+    bool has_bbox = false;
+    std::string cache_dir;
+    size_t cache_max = ResultCache::DEFAULT_MAX_BYTES;
+    bool sample = false;
+    SampleOptions sample_options;
+    uint32_t kll_k = KllSketch::DEFAULT_K;
+    bool progress = false;
+    ProgressOptions progress_options;
+    std::string progress_file;
     
     // Parse command line arguments
     for (int i = 1; i < argc; ++i) {
@@ -131,7 +623,364 @@ int main(int argc, char* argv[]) {
             }
         } else if (std::strcmp(argv[i], "--sequential") == 0) {
             use_concurrent = false;
-        } else if (argv[i][0] != '-') {
+        } else if (std::strcmp(argv[i], "--io-block") == 0) {
+            if (i + 1 < argc) {
+                if (!parseByteSize(argv[++i], read_ahead.block_bytes)) {
+                    std::cerr << "Error: Invalid --io-block value\n";
+                    return 1;
+                }
+            } else {
+                std::cerr << "Error: --io-block requires a size\n";
+                return 1;
+            }
+        } else if (std::strcmp(argv[i], "--io-depth") == 0) {
+            if (i + 1 < argc) {
+                try {
+                    read_ahead.depth = std::stoul(argv[++i]);
+                    if (read_ahead.depth < 2) {
+                        std::cerr << "Error: --io-depth must be at least 2\n";
+                        return 1;
+                    }
+                } catch (const std::exception&) {
+                    std::cerr << "Error: Invalid --io-depth value\n";
+                    return 1;
+                }
+            } else {
+                std::cerr << "Error: --io-depth requires a value\n";
+                return 1;
+            }
+        } else if (std::strcmp(argv[i], "--direct-io") == 0) {
+            read_ahead.direct = true;
+        } else if (std::strcmp(argv[i], "--placement") == 0) {
+            if (i + 1 < argc) {
+                if (!parseWorkerPlacement(argv[++i], placement)) {
+                    std::cerr << "Error: --placement must be none, cores or numa\n";
+                    return 1;
+                }
+            } else {
+                std::cerr << "Error: --placement requires a mode\n";
+                return 1;
+            }
+        } else if (std::strcmp(argv[i], "--reject-file") == 0) {
+            if (i + 1 < argc) {
+                reject_file = argv[++i];
+            } else {
+                std::cerr << "Error: --reject-file requires a path\n";
+                return 1;
+            }
+        } else if (std::strcmp(argv[i], "--group-by") == 0) {
+            if (i + 1 < argc) {
+                if (!parseGroupColumn(argv[++i], group_by)) {
+                    std::cerr << "Error: Unknown group-by column: " << argv[i] << "\n";
+                    return 1;
+                }
+            } else {
+                std::cerr << "Error: --group-by requires a column\n";
+                return 1;
+            }
+        } else if (std::strcmp(argv[i], "--top") == 0) {
+            if (i + 1 < argc) {
+                try {
+                    group_limit = std::stoul(argv[++i]);
+                } catch (const std::exception&) {
+                    std::cerr << "Error: Invalid --top value\n";
+                    return 1;
+                }
+            } else {
+                std::cerr << "Error: --top requires a value\n";
+                return 1;
+            }
+        } else if (std::strcmp(argv[i], "--max-memory") == 0) {
+            if (i + 1 < argc) {
+                if (!parseByteSize(argv[++i], max_memory)) {
+                    std::cerr << "Error: Invalid --max-memory value\n";
+                    return 1;
+                }
+            } else {
+                std::cerr << "Error: --max-memory requires a size\n";
+                return 1;
+            }
+        } else if (std::strcmp(argv[i], "--heavy-hitters") == 0) {
+            if (i + 1 < argc) {
+                if (!parseGroupColumn(argv[++i], heavy_hitters)) {
+                    std::cerr << "Error: Unknown heavy-hitter column: " << argv[i] << "\n";
+                    return 1;
+                }
+            } else {
+                std::cerr << "Error: --heavy-hitters requires a column\n";
+                return 1;
+            }
+        } else if (std::strcmp(argv[i], "--hh-metric") == 0) {
+            if (i + 1 < argc) {
+                if (!parseHeavyHitterMetric(argv[++i], hh_metric)) {
+                    std::cerr << "Error: --hh-metric must be units or revenue\n";
+                    return 1;
+                }
+            } else {
+                std::cerr << "Error: --hh-metric requires a value\n";
+                return 1;
+            }
+        } else if (std::strcmp(argv[i], "--hh-capacity") == 0) {
+            if (i + 1 < argc) {
+                try {
+                    hh_capacity = std::stoul(argv[++i]);
+                    if (hh_capacity == 0) {
+                        std::cerr << "Error: --hh-capacity must be greater than 0\n";
+                        return 1;
+                    }
+                } catch (const std::exception&) {
+                    std::cerr << "Error: Invalid --hh-capacity value\n";
+                    return 1;
+                }
+            } else {
+                std::cerr << "Error: --hh-capacity requires a value\n";
+                return 1;
+            }
+        } else if (std::strcmp(argv[i], "--distinct") == 0) {
+            if (i + 1 < argc) {
+                if (!parseGroupColumn(argv[++i], distinct)) {
+                    std::cerr << "Error: Unknown distinct column: " << argv[i] << "\n";
+                    return 1;
+                }
+            } else {
+                std::cerr << "Error: --distinct requires a column\n";
+                return 1;
+            }
+        } else if (std::strcmp(argv[i], "--hll-precision") == 0) {
+            if (i + 1 < argc) {
+                try {
+                    unsigned long value = std::stoul(argv[++i]);
+                    if (value < HLL_MIN_PRECISION || value > HLL_MAX_PRECISION) {
+                        std::cerr << "Error: --hll-precision must be between " << HLL_MIN_PRECISION
+                                  << " and " << HLL_MAX_PRECISION << "\n";
+                        return 1;
+                    }
+                    hll_precision = static_cast<unsigned>(value);
+                } catch (const std::exception&) {
+                    std::cerr << "Error: Invalid --hll-precision value\n";
+                    return 1;
+                }
+            } else {
+                std::cerr << "Error: --hll-precision requires a value\n";
+                return 1;
+            }
+        } else if (std::strcmp(argv[i], "--quantiles") == 0) {
+            if (i + 1 < argc) {
+                if (!parseQuantiles(argv[++i], quantiles)) {
+                    std::cerr << "Error: --quantiles needs comma-separated values in [0, 1]\n";
+                    return 1;
+                }
+            } else {
+                std::cerr << "Error: --quantiles requires a list\n";
+                return 1;
+            }
+        } else if (std::strcmp(argv[i], "--kll-k") == 0) {
+            if (i + 1 < argc) {
+                try {
+                    unsigned long value = std::stoul(argv[++i]);
+                    if (value < KllSketch::MIN_K || value > UINT32_MAX) {
+                        std::cerr << "Error: --kll-k must be at least " << KllSketch::MIN_K << "\n";
+                        return 1;
+                    }
+                    kll_k = static_cast<uint32_t>(value);
+                } catch (const std::exception&) {
+                    std::cerr << "Error: Invalid --kll-k value\n";
+                    return 1;
+                }
+            } else {
+                std::cerr << "Error: --kll-k requires a value\n";
+                return 1;
+            }
+        } else if (std::strcmp(argv[i], "--time-series") == 0) {
+            if (i + 1 < argc) {
+                if (!parseTimeBucket(argv[++i], time_bucket)) {
+                    std::cerr << "Error: --time-series must be month or week\n";
+                    return 1;
+                }
+            } else {
+                std::cerr << "Error: --time-series requires month or week\n";
+                return 1;
+            }
+        } else if (std::strcmp(argv[i], "--series-file") == 0) {
+            if (i + 1 < argc) {
+                series_file = argv[++i];
+            } else {
+                std::cerr << "Error: --series-file requires a path\n";
+                return 1;
+            }
+        } else if (std::strcmp(argv[i], "--rolling") == 0) {
+            if (i + 1 < argc) {
+                if (!parseWindows(argv[++i], rolling_windows)) {
+                    std::cerr << "Error: --rolling needs comma-separated day counts in [1, "
+                              << MAX_ROLLING_WINDOW << "]\n";
+                    return 1;
+                }
+            } else {
+                std::cerr << "Error: --rolling requires a list\n";
+                return 1;
+            }
+        } else if (std::strcmp(argv[i], "--rolling-file") == 0) {
+            if (i + 1 < argc) {
+                rolling_file = argv[++i];
+            } else {
+                std::cerr << "Error: --rolling-file requires a path\n";
+                return 1;
+            }
+        } else if (std::strcmp(argv[i], "--geo-grid") == 0) {
+            if (i + 1 < argc) {
+                try {
+                    geo_cell = std::stod(argv[++i]);
+                    if (!(geo_cell >= GeoGrid::MIN_CELL_DEGREES && geo_cell <= GeoGrid::MAX_CELL_DEGREES)) {
+                        std::cerr << "Error: --geo-grid must be between " << GeoGrid::MIN_CELL_DEGREES
+                                  << " and " << GeoGrid::MAX_CELL_DEGREES << " degrees\n";
+                        return 1;
+                    }
+                } catch (const std::exception&) {
+                    std::cerr << "Error: Invalid grid cell size\n";
+                    return 1;
+                }
+            } else {
+                std::cerr << "Error: --geo-grid requires a cell size\n";
+                return 1;
+            }
+        } else if (std::strcmp(argv[i], "--geo-file") == 0) {
+            if (i + 1 < argc) {
+                geo_file = argv[++i];
+            } else {
+                std::cerr << "Error: --geo-file requires a path\n";
+                return 1;
+            }
+        } else if (std::strcmp(argv[i], "--bbox") == 0) {
+            if (i + 1 < argc) {
+                if (!parseBoundingBox(argv[++i], bbox)) {
+                    std::cerr << "Error: --bbox must be min_lat,min_lon,max_lat,max_lon\n";
+                    return 1;
+                }
+                has_bbox = true;
+            } else {
+                std::cerr << "Error: --bbox requires a box\n";
+                return 1;
+            }
+        } else if (std::strcmp(argv[i], "--sample") == 0) {
+            if (i + 1 < argc) {
+                try {
+                    sample_options.max_fraction = std::stod(argv[++i]);
+                    if (!(sample_options.max_fraction > 0.0 && sample_options.max_fraction <= 1.0)) {
+                        std::cerr << "Error: --sample must be in (0, 1]\n";
+                        return 1;
+                    }
+                    sample = true;
+                } catch (const std::exception&) {
+                    std::cerr << "Error: Invalid --sample value\n";
+                    return 1;
+                }
+            } else {
+                std::cerr << "Error: --sample requires a fraction\n";
+                return 1;
+            }
+        } else if (std::strcmp(argv[i], "--sample-error") == 0) {
+            if (i + 1 < argc) {
+                try {
+                    sample_options.target_error = std::stod(argv[++i]);
+                    if (sample_options.target_error < 0.0) {
+                        std::cerr << "Error: --sample-error must not be negative\n";
+                        return 1;
+                    }
+                } catch (const std::exception&) {
+                    std::cerr << "Error: Invalid --sample-error value\n";
+                    return 1;
+                }
+            } else {
+                std::cerr << "Error: --sample-error requires a value\n";
+                return 1;
+            }
+        } else if (std::strcmp(argv[i], "--sample-block") == 0) {
+            if (i + 1 < argc) {
+                if (!parseByteSize(argv[++i], sample_options.block_bytes)) {
+                    std::cerr << "Error: Invalid --sample-block value\n";
+                    return 1;
+                }
+            } else {
+                std::cerr << "Error: --sample-block requires a size\n";
+                return 1;
+            }
+        } else if (std::strcmp(argv[i], "--sample-seed") == 0) {
+            if (i + 1 < argc) {
+                try {
+                    sample_options.seed = std::stoull(argv[++i]);
+                } catch (const std::exception&) {
+                    std::cerr << "Error: Invalid --sample-seed value\n";
+                    return 1;
+                }
+            } else {
+                std::cerr << "Error: --sample-seed requires a value\n";
+                return 1;
+            }
+        } else if (std::strcmp(argv[i], "--serve") == 0) {
+            if (i + 1 < argc) {
+                serve_socket = argv[++i];
+            } else {
+                std::cerr << "Error: --serve requires a socket path\n";
+                return 1;
+            }
+        } else if (std::strcmp(argv[i], "--dataset") == 0) {
+            const char* eq = i + 1 < argc ? std::strchr(argv[i + 1], '=') : nullptr;
+            if (eq == nullptr || eq == argv[i + 1] || eq[1] == '\0') {
+                std::cerr << "Error: --dataset requires <name>=<path>\n";
+                return 1;
+            }
+            ++i;
+            datasets.emplace_back(std::string(argv[i], static_cast<size_t>(eq - argv[i])), std::string(eq + 1));
+        } else if (std::strcmp(argv[i], "--cache-dir") == 0) {
+            if (i + 1 < argc) {
+                cache_dir = argv[++i];
+            } else {
+                std::cerr << "Error: --cache-dir requires a directory\n";
+                return 1;
+            }
+        } else if (std::strcmp(argv[i], "--cache-max") == 0) {
+            if (i + 1 < argc) {
+                if (!parseByteSize(argv[++i], cache_max)) {
+                    std::cerr << "Error: Invalid --cache-max value\n";
+                    return 1;
+                }
+            } else {
+                std::cerr << "Error: --cache-max requires a size\n";
+                return 1;
+            }
+        } else if (std::strcmp(argv[i], "--progress") == 0) {
+            progress = true;
+        } else if (std::strcmp(argv[i], "--progress-interval") == 0) {
+            if (i + 1 < argc) {
+                try {
+                    double seconds = std::stod(argv[++i]);
+                    if (!(seconds >= 0.01 && seconds <= 3600.0)) {
+                        std::cerr << "Error: --progress-interval must be between 0.01 and 3600 seconds\n";
+                        return 1;
+                    }
+                    progress_options.interval = std::chrono::milliseconds(static_cast<long long>(seconds * 1000.0));
+                } catch (const std::exception&) {
+                    std::cerr << "Error: Invalid --progress-interval value\n";
+                    return 1;
+                }
+            } else {
+                std::cerr << "Error: --progress-interval requires a value\n";
+                return 1;
+            }
+        } else if (std::strcmp(argv[i], "--progress-file") == 0) {
+            if (i + 1 < argc) {
+                progress_file = argv[++i];
+                progress = true;
+            } else {
+                std::cerr << "Error: --progress-file requires a path\n";
+                return 1;
+            }
+        } else if (std::strcmp(argv[i], "--profile") == 0) {
+            profile = true;
+        } else if (std::strcmp(argv[i], "--perf-counters") == 0) {
+            profile = true;
+            perf_counters = true;
+        } else if (argv[i][0] != '-' || std::strcmp(argv[i], STDIN_INPUT) == 0) {
             filename = argv[i];
         } else {
             std::cerr << "Unknown option: " << argv[i] << "\n";
@@ -140,12 +989,40 @@ int main(int argc, char* argv[]) {
         }
     }
     
+    if (!serve_socket.empty()) {
+        if (!filename.empty()) {
+            datasets.insert(datasets.begin(), {"default", filename});
+        }
+        return runServer(serve_socket, datasets);
+    }
+    if (!datasets.empty()) {
+        std::cerr << "Error: --dataset only applies with --serve\n";
+        return 1;
+    }
+
     if (filename.empty()) {
         std::cerr << "Error: No input file specified\n";
         printUsage(argv[0]);
         return 1;
     }
     
+    if (sample && (group_by != GroupColumn::None || heavy_hitters != GroupColumn::None ||
+                   distinct != GroupColumn::None || !quantiles.empty() ||
+                   time_bucket != TimeBucket::None || !rolling_windows.empty() ||
+                   geo_cell > 0.0 || has_bbox || !reject_file.empty() || !cache_dir.empty())) {
+        std::cerr << "Error: --sample only estimates the Audi/BMW metrics; it cannot be combined\n"
+                  << "       with --group-by, --heavy-hitters, --distinct, --quantiles,\n"
+                  << "       --time-series, --rolling, --geo-grid, --bbox, --reject-file\n"
+                  << "       or --cache-dir\n";
+        return 1;
+    }
+
+    if (sample && isStreamInput(filename)) {
+        std::cerr << "Error: --sample reads blocks in random order and needs a regular file,\n"
+                  << "       not stdin or a pipe\n";
+        return 1;
+    }
+
     // Auto-detect threads if not specified
     size_t detected_threads = num_threads;
     if (use_concurrent && num_threads == 0) {
@@ -157,25 +1034,104 @@ int main(int argc, char* argv[]) {
     std::cout << "=============================================\n";
     std::cout << "Input file: " << filename << "\n";
     std::cout << "Chunk size: " << chunk_size << " records\n";
-    std::cout << "Processing mode: " << (use_concurrent ? "Concurrent" : "Sequential") << "\n";
+    std::cout << "Processing mode: "
+              << (sample ? "Sampled" : use_concurrent ? "Concurrent" : "Sequential") << "\n";
     if (use_concurrent) {
         std::cout << "Threads: " << detected_threads << "\n";
     }
-    std::cout << "Processing...\n";
-    
-    // Start timing
-    auto start_time = std::chrono::high_resolution_clock::now();
     
     try {
         CarSalesAnalyzer analyzer(chunk_size);
-        AnalysisResult result = analyzer.analyzeFile(filename, use_concurrent, num_threads);
+        analyzer.setReadAhead(read_ahead);
+        if (use_concurrent && !sample && placement != WorkerPlacement::None) {
+            analyzer.setWorkerPlacement(placement);
+            std::cout << "Placement: " << workerPlacementName(placement) << "\n";
+            std::cout << "Topology: " << analyzer.getTopology().describe() << "\n";
+        }
+        std::cout << "Processing...\n";
+
+        // Start timing
+        auto start_time = std::chrono::high_resolution_clock::now();
+
+        analyzer.setProfilingEnabled(profile);
+        analyzer.setHardwareCountersEnabled(perf_counters);
+        analyzer.setRejectFile(reject_file);
+        analyzer.setGroupBy(group_by);
+        analyzer.setGroupByLimit(group_limit);
+        analyzer.setMaxMemory(max_memory);
+        analyzer.setHeavyHitters(heavy_hitters, hh_metric, hh_capacity);
+        analyzer.setDistinct(distinct, hll_precision);
+        analyzer.setPriceQuantiles(quantiles.empty() ? 0 : kll_k);
+        analyzer.setTimeSeries(time_bucket);
+        analyzer.setRollingWindows(rolling_windows);
+        analyzer.setGeoGrid(geo_cell);
+        if (has_bbox) {
+            analyzer.setBoundingBox(bbox);
+        }
+        std::shared_ptr<ResultCache> cache;
+        if (!cache_dir.empty()) {
+            cache = std::make_shared<ResultCache>(cache_dir, cache_max);
+            analyzer.setResultCache(cache);
+        }
+
+        // Live progress on stderr (and as JSON lines), one slot per worker;
+        // sampling reads too little to need it
+        std::shared_ptr<ProgressTracker> tracker;
+        std::unique_ptr<ProgressReporter> reporter;
+        std::ofstream progress_out;
+        if (progress && !sample) {
+            if (!progress_file.empty()) {
+                progress_out.open(progress_file);
+                if (!progress_out) {
+                    std::cerr << "Error: Cannot write " << progress_file << "\n";
+                    return 1;
+                }
+                progress_options.machine = &progress_out;
+            }
+            progress_options.human = &std::cerr;
+            struct stat info;
+            uint64_t total_bytes = !isStreamInput(filename) && ::stat(filename.c_str(), &info) == 0
+                ? static_cast<uint64_t>(info.st_size) : 0;
+            tracker = std::make_shared<ProgressTracker>(
+                use_concurrent ? std::max<size_t>(1, detected_threads) : 1, total_bytes);
+            analyzer.setProgress(tracker);
+            reporter = std::make_unique<ProgressReporter>(*tracker, progress_options);
+        }
+
+        AnalysisResult result = sample
+            ? analyzer.analyzeSample(filename, sample_options, use_concurrent ? num_threads : 1)
+            : analyzer.analyzeFile(filename, use_concurrent, num_threads);
+        if (reporter) {
+            reporter->stop();
+        }
         
         // End timing
         auto end_time = std::chrono::high_resolution_clock::now();
         auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(end_time - start_time);
         
         printResults(result);
+        printSample(result);
+        printGroups(result);
+        printHeavyHitters(result);
+        printDistinct(result, group_limit);
+        printPriceQuantiles(result, quantiles, group_limit);
+        if (!printTimeSeries(result, series_file)) {
+            return 1;
+        }
+        if (!printRolling(result, rolling_file)) {
+            return 1;
+        }
+        if (!printGeoGrid(result, geo_file)) {
+            return 1;
+        }
+        if (cache) {
+            printCache(result, *cache, analyzer.cacheable());
+        }
         
+        if (profile) {
+            printProfile(result.profile);
+        }
+
         std::cout << "\nProcessing time: " << duration.count() << " ms\n";
         
         if (result.total_records_processed > 0 && duration.count() > 0) {
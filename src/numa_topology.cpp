@@ -0,0 +1,254 @@
+#include "numa_topology.hpp"
+
+#include <algorithm>
+#include <cctype>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <sstream>
+#include <thread>
+
+#if defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#define CAR_SALES_HAVE_AFFINITY 1
+#else
+#define CAR_SALES_HAVE_AFFINITY 0
+#endif
+
+namespace car_sales {
+
+namespace fs = std::filesystem;
+
+bool parseWorkerPlacement(std::string_view name, WorkerPlacement &placement) {
+  if (name == "none") {
+    placement = WorkerPlacement::None;
+  } else if (name == "cores") {
+    placement = WorkerPlacement::Cores;
+  } else if (name == "numa") {
+    placement = WorkerPlacement::Numa;
+  } else {
+    return false;
+  }
+  return true;
+}
+
+const char *workerPlacementName(WorkerPlacement placement) {
+  switch (placement) {
+  case WorkerPlacement::None:
+    return "none";
+  case WorkerPlacement::Cores:
+    return "cores";
+  case WorkerPlacement::Numa:
+    return "numa";
+  }
+  return "unknown";
+}
+
+static bool parseCpu(std::string_view text, int &cpu) {
+  if (text.empty() || text.size() > 6) {
+    return false;
+  }
+  cpu = 0;
+  for (char c : text) {
+    if (!std::isdigit(static_cast<unsigned char>(c))) {
+      return false;
+    }
+    cpu = cpu * 10 + (c - '0');
+  }
+  return true;
+}
+
+bool parseCpuList(std::string_view text, std::vector<int> &cpus) {
+  cpus.clear();
+  while (!text.empty() && std::isspace(static_cast<unsigned char>(text.back()))) {
+    text.remove_suffix(1);
+  }
+  if (text.empty()) {
+    return true; // a node without CPUs
+  }
+  while (true) {
+    size_t comma = text.find(',');
+    std::string_view item = text.substr(0, comma);
+    size_t dash = item.find('-');
+    int first;
+    int last;
+    if (!parseCpu(item.substr(0, dash), first)) {
+      return false;
+    }
+    last = first;
+    if (dash != std::string_view::npos &&
+        (!parseCpu(item.substr(dash + 1), last) || last < first)) {
+      return false;
+    }
+    for (int cpu = first; cpu <= last; ++cpu) {
+      cpus.push_back(cpu);
+    }
+    if (comma == std::string_view::npos) {
+      break;
+    }
+    text.remove_prefix(comma + 1);
+  }
+  std::sort(cpus.begin(), cpus.end());
+  cpus.erase(std::unique(cpus.begin(), cpus.end()), cpus.end());
+  return true;
+}
+
+std::string formatCpuList(const std::vector<int> &cpus) {
+  std::string text;
+  for (size_t i = 0; i < cpus.size();) {
+    size_t j = i;
+    while (j + 1 < cpus.size() && cpus[j + 1] == cpus[j] + 1) {
+      ++j;
+    }
+    if (!text.empty()) {
+      text += ',';
+    }
+    text += std::to_string(cpus[i]);
+    if (j > i) {
+      text += '-' + std::to_string(cpus[j]);
+    }
+    i = j + 1;
+  }
+  return text;
+}
+
+NumaTopology::NumaTopology(std::vector<NumaNode> nodes)
+    : nodes_(std::move(nodes)) {}
+
+// CPUs the process may run on, ascending
+static std::vector<int> allowedCpus() {
+  std::vector<int> cpus;
+#if CAR_SALES_HAVE_AFFINITY
+  cpu_set_t set;
+  CPU_ZERO(&set);
+  if (sched_getaffinity(0, sizeof(set), &set) == 0) {
+    for (int cpu = 0; cpu < CPU_SETSIZE; ++cpu) {
+      if (CPU_ISSET(cpu, &set)) {
+        cpus.push_back(cpu);
+      }
+    }
+  }
+#endif
+  if (cpus.empty()) {
+    unsigned count = std::max(1u, std::thread::hardware_concurrency());
+    for (unsigned cpu = 0; cpu < count; ++cpu) {
+      cpus.push_back(static_cast<int>(cpu));
+    }
+  }
+  return cpus;
+}
+
+// "Node 0 MemTotal:       65843212 kB"
+static uint64_t nodeMemory(const fs::path &meminfo) {
+  std::ifstream in(meminfo);
+  std::string line;
+  while (std::getline(in, line)) {
+    size_t key = line.find("MemTotal:");
+    if (key != std::string::npos) {
+      unsigned long long kb = 0;
+      if (std::sscanf(line.c_str() + key + 9, "%llu", &kb) == 1) {
+        return static_cast<uint64_t>(kb) * 1024;
+      }
+    }
+  }
+  return 0;
+}
+
+NumaTopology NumaTopology::discover(const std::string &sysfs_root) {
+  std::vector<int> allowed = allowedCpus();
+  std::vector<NumaNode> nodes;
+
+  std::error_code ec;
+  for (const auto &entry : fs::directory_iterator(sysfs_root, ec)) {
+    std::string name = entry.path().filename().string();
+    int id;
+    if (name.compare(0, 4, "node") != 0 || !parseCpu(name.substr(4), id)) {
+      continue;
+    }
+    std::ifstream in(entry.path() / "cpulist");
+    std::string text;
+    std::vector<int> cpus;
+    if (!std::getline(in, text) || !parseCpuList(text, cpus)) {
+      continue;
+    }
+    NumaNode node{id, {}, nodeMemory(entry.path() / "meminfo")};
+    std::set_intersection(cpus.begin(), cpus.end(), allowed.begin(),
+                          allowed.end(), std::back_inserter(node.cpus));
+    if (!node.cpus.empty()) {
+      nodes.push_back(std::move(node));
+    }
+  }
+
+  if (nodes.empty()) {
+    nodes.push_back(NumaNode{0, std::move(allowed), 0});
+  }
+  std::sort(nodes.begin(), nodes.end(),
+            [](const NumaNode &a, const NumaNode &b) { return a.id < b.id; });
+  return NumaTopology(std::move(nodes));
+}
+
+size_t NumaTopology::cpuCount() const {
+  size_t count = 0;
+  for (const NumaNode &node : nodes_) {
+    count += node.cpus.size();
+  }
+  return count;
+}
+
+std::vector<CpuSlot> NumaTopology::assign(size_t workers) const {
+  std::vector<CpuSlot> flat;
+  for (size_t n = 0; n < nodes_.size(); ++n) {
+    for (int cpu : nodes_[n].cpus) {
+      flat.push_back(CpuSlot{n, cpu});
+    }
+  }
+  std::vector<CpuSlot> slots;
+  if (flat.empty()) {
+    return slots;
+  }
+  slots.reserve(workers);
+  for (size_t w = 0; w < workers; ++w) {
+    // Monotonic in w, so each node's workers stay contiguous
+    slots.push_back(flat[w * flat.size() / workers]);
+  }
+  return slots;
+}
+
+std::string NumaTopology::describe() const {
+  std::ostringstream out;
+  out << nodes_.size() << (nodes_.size() == 1 ? " node" : " nodes") << ":";
+  for (size_t n = 0; n < nodes_.size(); ++n) {
+    const NumaNode &node = nodes_[n];
+    out << (n ? ", " : " ") << "node" << node.id << " cpus "
+        << formatCpuList(node.cpus);
+    if (node.memory_bytes > 0) {
+      out.setf(std::ios::fixed);
+      out.precision(1);
+      out << " (" << static_cast<double>(node.memory_bytes) / (1 << 30)
+          << " GiB)";
+    }
+  }
+  return out.str();
+}
+
+bool pinCurrentThread(const std::vector<int> &cpus) {
+#if CAR_SALES_HAVE_AFFINITY
+  cpu_set_t set;
+  CPU_ZERO(&set);
+  for (int cpu : cpus) {
+    if (cpu < 0 || cpu >= CPU_SETSIZE) {
+      return false;
+    }
+    CPU_SET(cpu, &set);
+  }
+  return !cpus.empty() &&
+         pthread_setaffinity_np(pthread_self(), sizeof(set), &set) == 0;
+#else
+  (void)cpus;
+  return false;
+#endif
+}
+
+} // namespace car_sales
@@ -0,0 +1,59 @@
+#include "parse_error.hpp"
+
+namespace car_sales {
+
+const char *parseErrorReason(ParseErrorCode code) {
+  switch (code) {
+  case ParseErrorCode::None:
+    return "no error";
+  case ParseErrorCode::TooFewFields:
+    return "too few fields";
+  case ParseErrorCode::MissingBrand:
+    return "missing manufacturer";
+  case ParseErrorCode::MissingCountry:
+    return "missing country";
+  case ParseErrorCode::InvalidDate:
+    return "invalid sale_date";
+  case ParseErrorCode::YearOutOfRange:
+    return "sale year out of range";
+  case ParseErrorCode::InvalidPrice:
+    return "invalid sale_price_usd";
+  case ParseErrorCode::Filtered:
+    return "filtered out";
+  default:
+    return "unknown error";
+  }
+}
+
+uint32_t parseErrorColumn(ParseErrorCode code) {
+  switch (code) {
+  case ParseErrorCode::MissingBrand:
+    return 9;
+  case ParseErrorCode::MissingCountry:
+    return 3;
+  case ParseErrorCode::InvalidDate:
+  case ParseErrorCode::YearOutOfRange:
+    return 2;
+  case ParseErrorCode::InvalidPrice:
+    return 21;
+  default:
+    return 0;
+  }
+}
+
+std::string formatParseError(const ParseError &error) {
+  std::string message = "Failed to parse ";
+  if (error.line > 0) {
+    message += "line " + std::to_string(error.line);
+  } else {
+    message += "row";
+  }
+  if (error.column > 0) {
+    message += ", column " + std::to_string(error.column);
+  }
+  message += " (byte " + std::to_string(error.byte_offset) + "): ";
+  message += parseErrorReason(error.code);
+  return message;
+}
+
+} // namespace car_sales
@@ -0,0 +1,280 @@
+#include "perf_counters.hpp"
+
+#if CAR_SALES_PERF_COUNTERS && defined(__linux__)
+#include <cerrno>
+#include <cstring>
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#define CAR_SALES_HAVE_PERF_EVENT 1
+#else
+#define CAR_SALES_HAVE_PERF_EVENT 0
+#endif
+
+namespace car_sales {
+
+const char *hwCounterName(HwCounter counter) {
+  switch (counter) {
+  case HwCounter::Cycles:
+    return "Cycles";
+  case HwCounter::Instructions:
+    return "Instructions";
+  case HwCounter::CacheMisses:
+    return "Cache misses";
+  case HwCounter::BranchMisses:
+    return "Branch misses";
+  default:
+    return "Unknown";
+  }
+}
+
+const char *hwStageName(HwStage stage) {
+  switch (stage) {
+  case HwStage::Parse:
+    return "Parse";
+  case HwStage::Aggregate:
+    return "Aggregate";
+  default:
+    return "Unknown";
+  }
+}
+
+double HwStageCounters::ipc() const {
+  uint64_t cycles = (*this)[HwCounter::Cycles];
+  if (cycles == 0) {
+    return 0.0;
+  }
+  return static_cast<double>((*this)[HwCounter::Instructions]) /
+         static_cast<double>(cycles);
+}
+
+double HwStageCounters::instructionsPerRow() const {
+  if (rows == 0) {
+    return 0.0;
+  }
+  return static_cast<double>((*this)[HwCounter::Instructions]) /
+         static_cast<double>(rows);
+}
+
+void HwCounterReport::merge(const HwCounterReport &other) {
+  for (size_t s = 0; s < HW_STAGE_COUNT; ++s) {
+    for (size_t c = 0; c < HW_COUNTER_COUNT; ++c) {
+      stages[s].values[c] += other.stages[s].values[c];
+    }
+    stages[s].rows += other.stages[s].rows;
+  }
+  for (size_t c = 0; c < HW_COUNTER_COUNT; ++c) {
+    supported[c] = supported[c] || other.supported[c];
+  }
+  threads += other.threads;
+  requested = requested || other.requested;
+  available = available || other.available;
+  if (unavailable_reason.empty()) {
+    unavailable_reason = other.unavailable_reason;
+  }
+}
+
+std::array<uint64_t, HW_COUNTER_COUNT>
+PerfCounterSample::deltaSince(const PerfCounterSample &before) const {
+  std::array<uint64_t, HW_COUNTER_COUNT> delta{};
+  uint64_t enabled = time_enabled > before.time_enabled
+                         ? time_enabled - before.time_enabled
+                         : 0;
+  uint64_t running = time_running > before.time_running
+                         ? time_running - before.time_running
+                         : 0;
+  double scale = (running > 0 && running < enabled)
+                     ? static_cast<double>(enabled) /
+                           static_cast<double>(running)
+                     : 1.0;
+  for (size_t c = 0; c < HW_COUNTER_COUNT; ++c) {
+    uint64_t counted = raw[c] > before.raw[c] ? raw[c] - before.raw[c] : 0;
+    delta[c] = static_cast<uint64_t>(static_cast<double>(counted) * scale);
+  }
+  return delta;
+}
+
+bool PerfCounterGroup::read(
+    std::array<uint64_t, HW_COUNTER_COUNT> &values) const {
+  PerfCounterSample sample;
+  if (!read(sample)) {
+    return false;
+  }
+  values = sample.deltaSince(PerfCounterSample());
+  return true;
+}
+
+// ============================================================================
+// PerfCounterGroup
+// ============================================================================
+
+#if CAR_SALES_HAVE_PERF_EVENT
+
+static const uint64_t PERF_CONFIGS[HW_COUNTER_COUNT] = {
+    PERF_COUNT_HW_CPU_CYCLES, PERF_COUNT_HW_INSTRUCTIONS,
+    PERF_COUNT_HW_CACHE_MISSES, PERF_COUNT_HW_BRANCH_MISSES};
+
+static int openCounter(uint64_t config, int group_fd) {
+  perf_event_attr attr;
+  std::memset(&attr, 0, sizeof(attr));
+  attr.size = sizeof(attr);
+  attr.type = PERF_TYPE_HARDWARE;
+  attr.config = config;
+  attr.disabled = group_fd < 0 ? 1 : 0;
+  attr.exclude_kernel = 1;
+  attr.exclude_hv = 1;
+  attr.read_format = PERF_FORMAT_GROUP | PERF_FORMAT_TOTAL_TIME_ENABLED |
+                     PERF_FORMAT_TOTAL_TIME_RUNNING;
+  // pid 0 / cpu -1: count the calling thread on whichever CPU it runs
+  return static_cast<int>(
+      syscall(SYS_perf_event_open, &attr, 0, -1, group_fd, 0));
+}
+
+PerfCounterGroup::PerfCounterGroup() : leader_fd_(-1), supported_{} {
+  fds_.fill(-1);
+
+  int first_errno = 0;
+  for (size_t c = 0; c < HW_COUNTER_COUNT; ++c) {
+    int fd = openCounter(PERF_CONFIGS[c], leader_fd_);
+    if (fd < 0) {
+      if (first_errno == 0) {
+        first_errno = errno;
+      }
+      continue;
+    }
+    if (leader_fd_ < 0) {
+      leader_fd_ = fd;
+    }
+    fds_[c] = fd;
+    supported_[c] = true;
+  }
+
+  if (leader_fd_ < 0) {
+    error_ = std::string("perf_event_open failed: ") +
+             std::strerror(first_errno);
+    if (first_errno == EACCES || first_errno == EPERM) {
+      error_ += " (check /proc/sys/kernel/perf_event_paranoid)";
+    }
+    return;
+  }
+
+  ioctl(leader_fd_, PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+  ioctl(leader_fd_, PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+}
+
+PerfCounterGroup::~PerfCounterGroup() {
+  for (int fd : fds_) {
+    if (fd >= 0) {
+      close(fd);
+    }
+  }
+}
+
+bool PerfCounterGroup::read(PerfCounterSample &sample) const {
+  if (leader_fd_ < 0) {
+    return false;
+  }
+
+  // Layout for PERF_FORMAT_GROUP with both time fields:
+  // nr, time_enabled, time_running, value[nr]
+  uint64_t buffer[3 + HW_COUNTER_COUNT];
+  ssize_t n = ::read(leader_fd_, buffer, sizeof(buffer));
+  if (n < static_cast<ssize_t>(3 * sizeof(uint64_t))) {
+    return false;
+  }
+
+  uint64_t nr = buffer[0];
+  sample.time_enabled = buffer[1];
+  sample.time_running = buffer[2];
+
+  // Group values come back in the order the events joined the group
+  size_t slot = 0;
+  for (size_t c = 0; c < HW_COUNTER_COUNT; ++c) {
+    if (!supported_[c] || slot >= nr) {
+      sample.raw[c] = 0;
+      continue;
+    }
+    sample.raw[c] = buffer[3 + slot];
+    ++slot;
+  }
+  return true;
+}
+
+#else
+
+PerfCounterGroup::PerfCounterGroup() : leader_fd_(-1), supported_{} {
+  fds_.fill(-1);
+  error_ = "hardware counters are not supported in this build";
+}
+
+PerfCounterGroup::~PerfCounterGroup() = default;
+
+bool PerfCounterGroup::read(PerfCounterSample &) const { return false; }
+
+#endif
+
+// ============================================================================
+// HwStageTracker
+// ============================================================================
+
+HwStageTracker::HwStageTracker(const PerfCounterGroup *group,
+                               HwCounterReport *report)
+    : group_(group), report_(report), current_(HwStage::Parse),
+      running_(false) {
+  if (!report_) {
+    return;
+  }
+  report_->requested = true;
+  if (!group_ || !group_->valid()) {
+    if (report_->unavailable_reason.empty()) {
+      report_->unavailable_reason =
+          group_ ? group_->error() : "no counter group";
+    }
+    report_ = nullptr;
+    return;
+  }
+  report_->available = true;
+  report_->threads += 1;
+  for (size_t c = 0; c < HW_COUNTER_COUNT; ++c) {
+    report_->supported[c] = report_->supported[c] || group_->supported()[c];
+  }
+}
+
+void HwStageTracker::enter(HwStage stage) {
+  if (!report_) {
+    return;
+  }
+  // Scale each delta by its own enabled/running interval; scaled totals
+  // use the ratio at read time, which can shrink and wrap the difference
+  PerfCounterSample now;
+  if (!group_->read(now)) {
+    return;
+  }
+  if (running_) {
+    HwStageCounters &counters = (*report_)[current_];
+    std::array<uint64_t, HW_COUNTER_COUNT> delta = now.deltaSince(last_);
+    for (size_t c = 0; c < HW_COUNTER_COUNT; ++c) {
+      counters.values[c] += delta[c];
+    }
+  }
+  last_ = now;
+  current_ = stage;
+  running_ = true;
+}
+
+void HwStageTracker::addRows(HwStage stage, uint64_t rows) {
+  if (report_) {
+    (*report_)[stage].rows += rows;
+  }
+}
+
+void HwStageTracker::stop() {
+  if (!report_ || !running_) {
+    return;
+  }
+  enter(current_);
+  running_ = false;
+}
+
+} // namespace car_sales
@@ -0,0 +1,166 @@
+#include "progress.hpp"
+
+#include <algorithm>
+#include <cstdio>
+#include <string>
+
+namespace car_sales {
+
+ProgressTracker::ProgressTracker(size_t workers, uint64_t total_bytes)
+    : workers_(std::max<size_t>(1, workers)), total_bytes_(total_bytes),
+      start_(std::chrono::steady_clock::now()),
+      slots_(new WorkerProgress[workers_]) {}
+
+uint64_t ProgressTracker::nowNs() {
+  return static_cast<uint64_t>(
+      std::chrono::duration_cast<std::chrono::nanoseconds>(
+          std::chrono::steady_clock::now().time_since_epoch())
+          .count());
+}
+
+ProgressSnapshot ProgressTracker::snapshot() const {
+  ProgressSnapshot snapshot;
+  snapshot.elapsed_s = std::chrono::duration<double>(
+                           std::chrono::steady_clock::now() - start_)
+                           .count();
+  snapshot.total_bytes = total_bytes_;
+  snapshot.busy_ns.resize(workers_);
+  for (size_t w = 0; w < workers_; ++w) {
+    const WorkerProgress &slot = slots_[w];
+    snapshot.bytes += slot.bytes.load(std::memory_order_relaxed);
+    snapshot.rows += slot.rows.load(std::memory_order_relaxed);
+    snapshot.failed += slot.failed.load(std::memory_order_relaxed);
+    snapshot.busy_ns[w] = slot.busy_ns.load(std::memory_order_relaxed);
+  }
+  return snapshot;
+}
+
+ProgressReporter::ProgressReporter(const ProgressTracker &tracker,
+                                   const ProgressOptions &options)
+    : tracker_(tracker), options_(options) {
+  if (options_.interval.count() <= 0) {
+    options_.interval = std::chrono::milliseconds(1);
+  }
+  last_ = tracker_.snapshot();
+  thread_ = std::thread(&ProgressReporter::run, this);
+}
+
+ProgressReporter::~ProgressReporter() { stop(); }
+
+void ProgressReporter::stop() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (stopped_) {
+      return;
+    }
+    stopping_ = true;
+    stopped_ = true;
+  }
+  wake_.notify_all();
+  if (thread_.joinable()) {
+    thread_.join();
+  }
+  report(true);
+}
+
+void ProgressReporter::run() {
+  std::unique_lock<std::mutex> lock(mutex_);
+  while (!wake_.wait_for(lock, options_.interval,
+                         [this] { return stopping_; })) {
+    lock.unlock();
+    report(false);
+    lock.lock();
+  }
+}
+
+static std::string formatBytes(double bytes) {
+  const char *units[] = {"B", "KB", "MB", "GB", "TB"};
+  size_t unit = 0;
+  while (bytes >= 1024.0 && unit + 1 < sizeof(units) / sizeof(units[0])) {
+    bytes /= 1024.0;
+    ++unit;
+  }
+  char text[32];
+  std::snprintf(text, sizeof(text), "%.1f %s", bytes, units[unit]);
+  return text;
+}
+
+static std::string formatNumber(double value, int decimals) {
+  char text[48];
+  std::snprintf(text, sizeof(text), "%.*f", decimals, value);
+  return text;
+}
+
+void ProgressReporter::report(bool done) {
+  ProgressSnapshot now = tracker_.snapshot();
+  // Rates over the last interval; the final report averages the whole run
+  const ProgressSnapshot &base = done ? ProgressSnapshot() : last_;
+  double seconds = now.elapsed_s - base.elapsed_s;
+  double bytes_per_s =
+      seconds > 0.0 ? static_cast<double>(now.bytes - base.bytes) / seconds
+                    : 0.0;
+  double rows_per_s =
+      seconds > 0.0 ? static_cast<double>(now.rows - base.rows) / seconds : 0.0;
+
+  std::vector<double> utilization(now.busy_ns.size(), 0.0);
+  for (size_t w = 0; w < utilization.size(); ++w) {
+    uint64_t before = w < base.busy_ns.size() ? base.busy_ns[w] : 0;
+    if (seconds > 0.0) {
+      utilization[w] = std::min(
+          1.0, static_cast<double>(now.busy_ns[w] - before) / (seconds * 1e9));
+    }
+  }
+
+  // Remaining bytes at the average rate so far; unknown for a stream
+  double eta_s = -1.0;
+  if (!done && now.total_bytes > 0 && now.bytes > 0 && now.elapsed_s > 0.0) {
+    uint64_t remaining =
+        now.total_bytes > now.bytes ? now.total_bytes - now.bytes : 0;
+    eta_s = static_cast<double>(remaining) /
+            (static_cast<double>(now.bytes) / now.elapsed_s);
+  }
+
+  if (options_.human) {
+    std::string line = done ? "Progress: done" : "Progress:";
+    if (now.total_bytes > 0) {
+      double percent = std::min(100.0, 100.0 * static_cast<double>(now.bytes) /
+                                           static_cast<double>(now.total_bytes));
+      line += ' ' + formatNumber(done ? 100.0 : percent, 1) + "% of " +
+              formatBytes(static_cast<double>(now.total_bytes));
+    } else {
+      line += ' ' + formatBytes(static_cast<double>(now.bytes));
+    }
+    line += " | " + formatBytes(bytes_per_s) + "/s | " +
+            formatNumber(rows_per_s, 0) + " rows/s | " +
+            std::to_string(now.failed) + " failed";
+    if (eta_s >= 0.0) {
+      line += " | ETA " + formatNumber(eta_s, 1) + "s";
+    }
+    line += " | util";
+    for (double u : utilization) {
+      line += ' ' + formatNumber(100.0 * u, 0) + '%';
+    }
+    *options_.human << line << '\n' << std::flush;
+  }
+
+  if (options_.machine) {
+    std::string json = "{\"elapsed_s\":" + formatNumber(now.elapsed_s, 3) +
+                       ",\"bytes\":" + std::to_string(now.bytes) +
+                       ",\"total_bytes\":" + std::to_string(now.total_bytes) +
+                       ",\"rows\":" + std::to_string(now.rows) +
+                       ",\"failed\":" + std::to_string(now.failed) +
+                       ",\"bytes_per_s\":" + formatNumber(bytes_per_s, 0) +
+                       ",\"rows_per_s\":" + formatNumber(rows_per_s, 0) +
+                       ",\"eta_s\":" +
+                       (eta_s >= 0.0 ? formatNumber(eta_s, 3) : "null") +
+                       ",\"utilization\":[";
+    for (size_t w = 0; w < utilization.size(); ++w) {
+      json += (w ? "," : "") + formatNumber(utilization[w], 3);
+    }
+    json += std::string("],\"done\":") + (done ? "true" : "false") + "}";
+    *options_.machine << json << '\n' << std::flush;
+  }
+  last_ = std::move(now);
+}
+
+} // namespace car_sales
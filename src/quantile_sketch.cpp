@@ -0,0 +1,219 @@
+#include <algorithm>
+#include <cmath>
+#include <map>
+#include <stdexcept>
+
+#include "hash.hpp"
+#include "quantile_sketch.hpp"
+
+namespace car_sales {
+
+KllSketch::KllSketch(uint32_t k) : k_(k) {
+  checkK(k);
+  addLevel();
+}
+
+void KllSketch::checkK(uint32_t k) {
+  if (k < MIN_K) {
+    throw std::invalid_argument("KLL sketch k must be at least " +
+                                std::to_string(MIN_K));
+  }
+}
+
+size_t KllSketch::levelCapacity(size_t level) const {
+  // Capacities shrink by 2/3 per level below the top one
+  size_t depth = levels_.size() - 1 - level;
+  double capacity = std::ceil(k_ * std::pow(2.0 / 3.0, depth));
+  return std::max<size_t>(2, static_cast<size_t>(capacity));
+}
+
+void KllSketch::addLevel() {
+  levels_.emplace_back();
+  max_retained_ = 0;
+  for (size_t h = 0; h < levels_.size(); ++h) {
+    max_retained_ += levelCapacity(h);
+  }
+}
+
+void KllSketch::add(int64_t value) {
+  if (!enabled()) {
+    return;
+  }
+  if (count_ == 0) {
+    min_ = max_ = value;
+  } else {
+    min_ = std::min(min_, value);
+    max_ = std::max(max_, value);
+  }
+  ++count_;
+  levels_[0].push_back(value);
+  if (++retained_ >= max_retained_) {
+    compress();
+  }
+}
+
+void KllSketch::compress() {
+  for (size_t h = 0; h < levels_.size(); ++h) {
+    if (levels_[h].size() < levelCapacity(h)) {
+      continue;
+    }
+    if (h + 1 == levels_.size()) {
+      addLevel();
+    }
+    std::vector<int64_t> &level = levels_[h];
+    std::vector<int64_t> &above = levels_[h + 1];
+    std::sort(level.begin(), level.end());
+
+    // An odd item out stays behind so the total weight is preserved
+    bool odd = level.size() % 2 == 1;
+    int64_t leftover = odd ? level.back() : 0;
+    if (odd) {
+      level.pop_back();
+    }
+    random_state_ += 0x9E3779B97F4A7C15ULL;
+    size_t offset = mixHash(random_state_) & 1;
+    for (size_t i = offset; i < level.size(); i += 2) {
+      above.push_back(level[i]);
+    }
+    retained_ -= level.size() / 2;
+    level.clear();
+    if (odd) {
+      level.push_back(leftover);
+    }
+
+    if (retained_ < max_retained_) {
+      return;
+    }
+  }
+}
+
+void KllSketch::merge(const KllSketch &other) {
+  if (!other.enabled() || other.count_ == 0) {
+    return;
+  }
+  if (!enabled()) {
+    *this = other;
+    return;
+  }
+  if (other.k_ != k_) {
+    throw std::invalid_argument("Cannot merge KLL sketches with different k");
+  }
+
+  if (count_ == 0) {
+    min_ = other.min_;
+    max_ = other.max_;
+  } else {
+    min_ = std::min(min_, other.min_);
+    max_ = std::max(max_, other.max_);
+  }
+  count_ += other.count_;
+  while (levels_.size() < other.levels_.size()) {
+    addLevel();
+  }
+  for (size_t h = 0; h < other.levels_.size(); ++h) {
+    levels_[h].insert(levels_[h].end(), other.levels_[h].begin(),
+                      other.levels_[h].end());
+  }
+  retained_ += other.retained_;
+  while (retained_ >= max_retained_) {
+    compress();
+  }
+}
+
+int64_t KllSketch::quantile(double q) const {
+  if (count_ == 0) {
+    return 0;
+  }
+  if (q <= 0.0) {
+    return min_;
+  }
+  if (q >= 1.0) {
+    return max_;
+  }
+
+  std::vector<std::pair<int64_t, uint64_t>> weighted;
+  weighted.reserve(retained_);
+  for (size_t h = 0; h < levels_.size(); ++h) {
+    for (int64_t value : levels_[h]) {
+      weighted.emplace_back(value, uint64_t(1) << h);
+    }
+  }
+  std::sort(weighted.begin(), weighted.end());
+
+  double target = q * static_cast<double>(count_);
+  uint64_t cumulative = 0;
+  for (const auto &[value, weight] : weighted) {
+    cumulative += weight;
+    if (static_cast<double>(cumulative) >= target) {
+      return value;
+    }
+  }
+  return max_;
+}
+
+double KllSketch::rankError() const {
+  // Empirical single-rank fit for KLL at 99% confidence
+  return enabled() ? 2.296 / std::pow(static_cast<double>(k_), 0.9723) : 0.0;
+}
+
+size_t KllSketch::retained() const { return retained_; }
+
+PriceQuantiles::PriceQuantiles(uint32_t k) : k_(k) { KllSketch::checkK(k); }
+
+void PriceQuantiles::add(std::string_view brand, std::string_view country,
+                         int64_t price_cents) {
+  sketches_.find(brand, country, [this]() { return KllSketch(k_); })
+      .add(price_cents);
+}
+
+void PriceQuantiles::merge(const PriceQuantiles &other) {
+  if (!other.enabled()) {
+    return;
+  }
+  if (!enabled()) {
+    k_ = other.k_;
+  }
+  sketches_.merge(other.sketches_);
+}
+
+// Most sales first, then by name, so output never depends on hash order
+static void sortGroups(std::vector<QuantileGroup> &groups) {
+  std::sort(groups.begin(), groups.end(),
+            [](const QuantileGroup &a, const QuantileGroup &b) {
+              if (a.sketch.count() != b.sketch.count()) {
+                return a.sketch.count() > b.sketch.count();
+              }
+              if (a.brand != b.brand) {
+                return a.brand < b.brand;
+              }
+              return a.country < b.country;
+            });
+}
+
+std::vector<QuantileGroup> PriceQuantiles::groups() const {
+  std::vector<QuantileGroup> groups;
+  groups.reserve(sketches_.size());
+  sketches_.forEach([&groups](std::string brand, std::string country,
+                              const KllSketch &sketch) {
+    groups.push_back(
+        QuantileGroup{std::move(brand), std::move(country), sketch});
+  });
+  sortGroups(groups);
+  return groups;
+}
+
+std::vector<QuantileGroup>
+PriceQuantiles::rollUp(const std::function<bool(std::string_view)> &include,
+                       const std::string &label) const {
+  // KLL merges depend on order; the table merges in key order
+  std::map<std::string, KllSketch> brands = sketches_.rollUp(include);
+  std::vector<QuantileGroup> groups;
+  groups.reserve(brands.size());
+  for (auto &[brand, sketch] : brands) {
+    groups.push_back(QuantileGroup{brand, label, std::move(sketch)});
+  }
+  sortGroups(groups);
+  return groups;
+}
+
+} // namespace car_sales
@@ -0,0 +1,440 @@
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <stdexcept>
+#include <utility>
+
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include "query_server.hpp"
+
+namespace car_sales {
+
+// Longest request line accepted before a connection is dropped
+static constexpr size_t MAX_REQUEST_BYTES = 64 * 1024;
+
+static bool fillAddress(const std::string &path, sockaddr_un &address) {
+  std::memset(&address, 0, sizeof(address));
+  address.sun_family = AF_UNIX;
+  if (path.empty() || path.size() >= sizeof(address.sun_path)) {
+    return false;
+  }
+  std::memcpy(address.sun_path, path.c_str(), path.size() + 1);
+  return true;
+}
+
+static bool writeAll(int fd, const std::string &data) {
+  size_t sent = 0;
+  while (sent < data.size()) {
+    ssize_t n = ::send(fd, data.data() + sent, data.size() - sent, MSG_NOSIGNAL);
+    if (n < 0 && errno == EINTR) {
+      continue;
+    }
+    if (n <= 0) {
+      return false;
+    }
+    sent += static_cast<size_t>(n);
+  }
+  return true;
+}
+
+// Next '\n'-terminated line from fd; pending holds bytes read past it
+static bool readLine(int fd, std::string &pending, std::string &line) {
+  while (true) {
+    size_t newline = pending.find('\n');
+    if (newline != std::string::npos) {
+      line.assign(pending, 0, newline);
+      pending.erase(0, newline + 1);
+      if (!line.empty() && line.back() == '\r') {
+        line.pop_back();
+      }
+      return true;
+    }
+    if (pending.size() > MAX_REQUEST_BYTES) {
+      return false;
+    }
+    char buffer[4096];
+    ssize_t n = ::recv(fd, buffer, sizeof(buffer), 0);
+    if (n < 0 && errno == EINTR) {
+      continue;
+    }
+    if (n <= 0) {
+      return false;
+    }
+    pending.append(buffer, static_cast<size_t>(n));
+  }
+}
+
+static std::vector<std::string> splitFields(const std::string &request) {
+  std::vector<std::string> fields;
+  size_t start = 0;
+  while (start <= request.size()) {
+    size_t tab = request.find('\t', start);
+    if (tab == std::string::npos) {
+      tab = request.size();
+    }
+    if (tab > start) {
+      fields.push_back(request.substr(start, tab - start));
+    }
+    start = tab + 1;
+  }
+  return fields;
+}
+
+static int parseYear(const std::string &text) {
+  size_t used = 0;
+  int year = 0;
+  try {
+    year = std::stoi(text, &used);
+  } catch (const std::exception &) {
+    used = 0;
+  }
+  if (used == 0 || used != text.size() || year < 1900 || year > 2100) {
+    throw std::invalid_argument("invalid year: " + text);
+  }
+  return year;
+}
+
+static int64_t parsePrice(const std::string &text) {
+  int64_t cents = 0;
+  if (!parseCents(text, cents)) {
+    throw std::invalid_argument("invalid price: " + text);
+  }
+  return cents;
+}
+
+QueryServer::QueryServer(std::string socket_path)
+    : socket_path_(std::move(socket_path)) {}
+
+QueryServer::~QueryServer() { stop(); }
+
+bool QueryServer::addDataset(const std::string &name,
+                             const std::string &filename, std::string &error) {
+  auto store = std::make_shared<ColumnStore>();
+  try {
+    if (!store->loadFile(filename, error)) {
+      return false;
+    }
+  } catch (const std::exception &e) {
+    error = e.what();
+    return false;
+  }
+  std::lock_guard<std::mutex> lock(mutex_);
+  datasets_[name] = std::move(store);
+  return true;
+}
+
+std::shared_ptr<const ColumnStore>
+QueryServer::dataset(const std::string &name) const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto it = datasets_.find(name);
+  if (it == datasets_.end()) {
+    throw std::invalid_argument("unknown dataset: " + name);
+  }
+  return it->second;
+}
+
+LatencyStats QueryServer::latency() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return stats_;
+}
+
+std::string QueryServer::execute(const std::vector<std::string> &fields,
+                                 size_t &rows) {
+  if (fields.empty()) {
+    throw std::invalid_argument("empty request");
+  }
+  const std::string &command = fields[0];
+  std::string body;
+  auto line = [&body, &rows](const std::string &text) {
+    body += text;
+    body += '\n';
+    ++rows;
+  };
+
+  if (command == "PING") {
+    return body;
+  }
+  if (command == "DATASETS") {
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (const auto &[name, store] : datasets_) {
+      line(name + '\t' + std::to_string(store->rows()) + '\t' +
+           std::to_string(store->memoryBytes()));
+    }
+    return body;
+  }
+  if (command == "LOAD") {
+    if (fields.size() != 3) {
+      throw std::invalid_argument("usage: LOAD <name> <path>");
+    }
+    std::string error;
+    if (!addDataset(fields[1], fields[2], error)) {
+      throw std::invalid_argument(error);
+    }
+    line(fields[1] + '\t' + std::to_string(dataset(fields[1])->rows()));
+    return body;
+  }
+  if (command == "SUMMARY") {
+    if (fields.size() < 2 || fields.size() > 3) {
+      throw std::invalid_argument("usage: SUMMARY <dataset> [year]");
+    }
+    int year = fields.size() == 3 ? parseYear(fields[2]) : 2025;
+    StoreSummary summary = dataset(fields[1])->summary(year);
+    line("rows\t" + std::to_string(summary.rows));
+    line("audi_china_sales\t" + std::to_string(summary.audi_china_year_sales));
+    line("bmw_revenue\t" + formatCents(summary.bmw_year_revenue_cents));
+    for (const GroupTotal &country : summary.bmw_europe) {
+      line("bmw_europe\t" + country.key + '\t' +
+           formatCents(country.revenue_cents));
+    }
+    return body;
+  }
+  if (command == "GROUP") {
+    StoreKey key;
+    if (fields.size() < 3 || !parseStoreKey(fields[2], key)) {
+      throw std::invalid_argument(
+          "usage: GROUP <dataset> <brand|country|year|month> [filters]");
+    }
+    StoreFilter filter;
+    for (size_t i = 3; i < fields.size(); ++i) {
+      size_t eq = fields[i].find('=');
+      std::string name = fields[i].substr(0, eq);
+      std::string value =
+          eq == std::string::npos ? std::string() : fields[i].substr(eq + 1);
+      if (name == "brand" && !value.empty()) {
+        filter.brand = value;
+      } else if (name == "country" && !value.empty()) {
+        filter.country = value;
+      } else if (name == "year") {
+        filter.year = parseYear(value);
+      } else if (name == "region" && value == "europe") {
+        filter.europe = true;
+      } else if (name == "min_price") {
+        filter.min_cents = parsePrice(value);
+      } else if (name == "max_price") {
+        filter.max_cents = parsePrice(value);
+      } else {
+        throw std::invalid_argument("unknown filter: " + fields[i]);
+      }
+    }
+    for (const GroupTotal &total : dataset(fields[1])->groupBy(key, filter)) {
+      line(total.key + '\t' + std::to_string(total.count) + '\t' +
+           formatCents(total.revenue_cents));
+    }
+    return body;
+  }
+  if (command == "STATS") {
+    LatencyStats stats = latency();
+    line("queries\t" + std::to_string(stats.queries));
+    line("total_us\t" + std::to_string(stats.total_us));
+    line("max_us\t" + std::to_string(stats.max_us));
+    line("mean_us\t" +
+         std::to_string(stats.queries ? stats.total_us / stats.queries : 0));
+    return body;
+  }
+  if (command == "SHUTDOWN") {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stopping_ = true;
+    stop_requested_.notify_all();
+    return body;
+  }
+  throw std::invalid_argument("unknown command: " + command);
+}
+
+std::string QueryServer::handle(const std::string &request) {
+  auto start = std::chrono::steady_clock::now();
+  size_t rows = 0;
+  std::string body;
+  try {
+    body = execute(splitFields(request), rows);
+  } catch (const std::exception &e) {
+    return std::string("ERR ") + e.what() + "\n";
+  }
+  uint64_t us = static_cast<uint64_t>(
+      std::chrono::duration_cast<std::chrono::microseconds>(
+          std::chrono::steady_clock::now() - start)
+          .count());
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    ++stats_.queries;
+    stats_.total_us += us;
+    stats_.max_us = std::max(stats_.max_us, us);
+  }
+  return "OK " + std::to_string(rows) + " " + std::to_string(us) + "\n" + body;
+}
+
+bool QueryServer::start(std::string &error) {
+  sockaddr_un address;
+  if (!fillAddress(socket_path_, address)) {
+    error = "Socket path is empty or too long: " + socket_path_;
+    return false;
+  }
+
+  // A socket file nobody answers on is left over from a crashed server
+  struct stat info;
+  if (::stat(socket_path_.c_str(), &info) == 0 && S_ISSOCK(info.st_mode)) {
+    int probe = ::socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    bool live = probe >= 0 &&
+                ::connect(probe, reinterpret_cast<sockaddr *>(&address),
+                          sizeof(address)) == 0;
+    if (probe >= 0) {
+      ::close(probe);
+    }
+    if (live) {
+      error = "Another server is listening on " + socket_path_;
+      return false;
+    }
+    ::unlink(socket_path_.c_str());
+  }
+
+  listen_fd_ = ::socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+  if (listen_fd_ < 0 ||
+      ::bind(listen_fd_, reinterpret_cast<sockaddr *>(&address),
+             sizeof(address)) != 0 ||
+      ::listen(listen_fd_, SOMAXCONN) != 0) {
+    error = "Cannot listen on " + socket_path_ + ": " + std::strerror(errno);
+    if (listen_fd_ >= 0) {
+      ::close(listen_fd_);
+      listen_fd_ = -1;
+    }
+    return false;
+  }
+  stopping_ = false;
+  acceptor_ = std::thread(&QueryServer::acceptLoop, this);
+  return true;
+}
+
+void QueryServer::acceptLoop() {
+  while (!stopping_) {
+    // Wake up regularly so a stop request is noticed without a connection
+    pollfd pending{listen_fd_, POLLIN, 0};
+    if (::poll(&pending, 1, 100) <= 0) {
+      continue;
+    }
+    int fd = ::accept4(listen_fd_, nullptr, nullptr, SOCK_CLOEXEC);
+    if (fd < 0) {
+      continue;
+    }
+    reapClients();
+    auto done = std::make_shared<std::atomic<bool>>(false);
+    std::lock_guard<std::mutex> lock(mutex_);
+    clients_.push_back(
+        Client{std::thread(&QueryServer::serve, this, fd, done), fd, done});
+  }
+}
+
+void QueryServer::serve(int fd, std::shared_ptr<std::atomic<bool>> done) {
+  std::string pending;
+  std::string request;
+  while (!stopping_ && readLine(fd, pending, request)) {
+    if (!writeAll(fd, handle(request)) || request == "SHUTDOWN") {
+      break;
+    }
+  }
+  *done = true;
+}
+
+// Join finished connection threads; their sockets are closed here rather
+// than by the thread so stop() never touches a reused descriptor
+void QueryServer::reapClients() {
+  std::vector<Client> finished;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (size_t i = 0; i < clients_.size();) {
+      if (*clients_[i].done) {
+        finished.push_back(std::move(clients_[i]));
+        clients_[i] = std::move(clients_.back());
+        clients_.pop_back();
+      } else {
+        ++i;
+      }
+    }
+  }
+  for (Client &client : finished) {
+    client.thread.join();
+    ::close(client.fd);
+  }
+}
+
+void QueryServer::wait() {
+  {
+    std::unique_lock<std::mutex> lock(mutex_);
+    stop_requested_.wait(lock, [this] { return stopping_.load(); });
+  }
+  stop();
+}
+
+void QueryServer::stop() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stopping_ = true;
+    stop_requested_.notify_all();
+  }
+  if (acceptor_.joinable()) {
+    acceptor_.join();
+  }
+
+  std::vector<Client> clients;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    clients.swap(clients_);
+  }
+  for (Client &client : clients) {
+    ::shutdown(client.fd, SHUT_RDWR); // unblocks a waiting recv()
+  }
+  for (Client &client : clients) {
+    client.thread.join();
+    ::close(client.fd);
+  }
+
+  if (listen_fd_ >= 0) {
+    ::close(listen_fd_);
+    listen_fd_ = -1;
+    ::unlink(socket_path_.c_str());
+  }
+}
+
+std::string sendQuery(const std::string &socket_path,
+                      const std::string &request) {
+  sockaddr_un address;
+  if (!fillAddress(socket_path, address)) {
+    throw std::runtime_error("Socket path is empty or too long: " +
+                             socket_path);
+  }
+  int fd = ::socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+  if (fd < 0 || ::connect(fd, reinterpret_cast<sockaddr *>(&address),
+                          sizeof(address)) != 0) {
+    std::string reason = std::strerror(errno);
+    if (fd >= 0) {
+      ::close(fd);
+    }
+    throw std::runtime_error("Cannot connect to " + socket_path + ": " +
+                             reason);
+  }
+
+  std::string pending;
+  std::string header;
+  bool ok = writeAll(fd, request + "\n") && readLine(fd, pending, header);
+  std::string answer = header + "\n";
+  if (ok && header.compare(0, 3, "OK ") == 0) {
+    size_t rows = std::stoul(header.substr(3));
+    std::string line;
+    for (size_t i = 0; ok && i < rows; ++i) {
+      ok = readLine(fd, pending, line);
+      answer += line + "\n";
+    }
+  }
+  ::close(fd);
+  if (!ok) {
+    throw std::runtime_error("Connection to " + socket_path +
+                             " closed mid-answer");
+  }
+  return answer;
+}
+
+} // namespace car_sales
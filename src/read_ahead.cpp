@@ -0,0 +1,232 @@
+#include "read_ahead.hpp"
+#include "record_boundaries.hpp"
+#include "stream_input.hpp"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+namespace car_sales {
+
+void ReadAheadReader::FreeDeleter::operator()(char *p) const { std::free(p); }
+
+ReadAheadReader::ReadAheadReader(const ReadAheadOptions &options)
+    : options_(options) {
+  size_t align = ReadAheadOptions::ALIGNMENT;
+  options_.block_bytes =
+      std::max(align, (options_.block_bytes + align - 1) / align * align);
+  options_.depth = std::max<size_t>(2, options_.depth);
+}
+
+ReadAheadReader::~ReadAheadReader() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stop_ = true;
+  }
+  drained_.notify_all();
+  if (thread_.joinable()) {
+    thread_.join();
+  }
+  if (owns_fd_ && fd_ >= 0) {
+    ::close(fd_);
+  }
+}
+
+bool ReadAheadReader::open(const std::string &filename, std::string &error) {
+  if (filename == STDIN_INPUT) {
+    attach(STDIN_FILENO);
+    return true;
+  }
+  int flags = O_RDONLY | O_CLOEXEC;
+#ifdef O_DIRECT
+  if (options_.direct) {
+    fd_ = ::open(filename.c_str(), flags | O_DIRECT);
+    direct_ = fd_ >= 0;
+  }
+#endif
+  if (fd_ < 0) {
+    // Also the fallback for file systems that refuse O_DIRECT (tmpfs)
+    fd_ = ::open(filename.c_str(), flags);
+  }
+  if (fd_ < 0) {
+    error = std::strerror(errno);
+    return false;
+  }
+  owns_fd_ = true;
+#ifdef POSIX_FADV_SEQUENTIAL
+  ::posix_fadvise(fd_, 0, 0, POSIX_FADV_SEQUENTIAL);
+#endif
+  start();
+  return true;
+}
+
+void ReadAheadReader::attach(int fd) {
+  fd_ = fd;
+  owns_fd_ = false;
+  start();
+}
+
+void ReadAheadReader::start() {
+  void *memory = nullptr;
+  if (::posix_memalign(&memory, ReadAheadOptions::ALIGNMENT,
+                       options_.block_bytes * options_.depth) != 0) {
+    throw std::bad_alloc();
+  }
+  memory_.reset(static_cast<char *>(memory));
+  sizes_.assign(options_.depth, 0);
+  thread_ = std::thread(&ReadAheadReader::readLoop, this);
+}
+
+bool ReadAheadReader::readBlock(char *data, size_t &size, std::string &error) {
+  size = 0;
+  while (size < options_.block_bytes) {
+    ssize_t n = ::read(fd_, data + size, options_.block_bytes - size);
+    if (n < 0 && errno == EINTR) {
+      continue;
+    }
+#ifdef O_DIRECT
+    if (n < 0 && errno == EINVAL && direct_) {
+      // Alignment the device rejects: drop O_DIRECT and carry on buffered
+      ::fcntl(fd_, F_SETFL, ::fcntl(fd_, F_GETFL) & ~O_DIRECT);
+      direct_ = false;
+      continue;
+    }
+#endif
+    if (n < 0) {
+      error = std::string("Read error: ") + std::strerror(errno);
+      return false;
+    }
+    if (n == 0) {
+      return false; // end of input
+    }
+    size += static_cast<size_t>(n);
+#ifdef O_DIRECT
+    if (direct_ && size % ReadAheadOptions::ALIGNMENT != 0) {
+      return false; // a short O_DIRECT read is the tail of the file
+    }
+#endif
+  }
+  return true;
+}
+
+void ReadAheadReader::readLoop() {
+  while (true) {
+    size_t index;
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+      drained_.wait(lock, [this] {
+        return stop_ || produced_ - consumed_ < options_.depth;
+      });
+      if (stop_) {
+        return;
+      }
+      index = static_cast<size_t>(produced_ % options_.depth);
+    }
+
+    // The caller never touches a block between consumed_ and produced_, so
+    // this one is ours until it is published below
+    size_t size;
+    std::string error;
+    bool more = readBlock(memory_.get() + index * options_.block_bytes, size,
+                          error);
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      if (size > 0) {
+        sizes_[index] = size;
+        ++produced_;
+      }
+      if (!more) {
+        eof_ = true;
+        error_ = std::move(error);
+      }
+    }
+    filled_.notify_one();
+    if (!more) {
+      return;
+    }
+  }
+}
+
+std::string_view ReadAheadReader::next() {
+  std::unique_lock<std::mutex> lock(mutex_);
+  if (holding_) {
+    ++consumed_;
+    holding_ = false;
+    drained_.notify_one();
+  }
+  filled_.wait(lock, [this] { return produced_ > consumed_ || eof_; });
+  if (produced_ == consumed_) {
+    return std::string_view();
+  }
+  holding_ = true;
+  size_t index = static_cast<size_t>(consumed_ % options_.depth);
+  return std::string_view(memory_.get() + index * options_.block_bytes,
+                          sizes_[index]);
+}
+
+std::string ReadAheadReader::error() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return error_;
+}
+
+bool LineReader::next(std::string_view &line) {
+  if (carry_returned_) {
+    carry_.clear();
+    carry_returned_ = false;
+  }
+  while (true) {
+    size_t newline = block_.find('\n');
+    if (newline != std::string_view::npos) {
+      if (carry_.empty()) {
+        line = block_.substr(0, newline);
+      } else {
+        carry_.append(block_.data(), newline);
+        line = carry_;
+        carry_returned_ = true;
+      }
+      block_.remove_prefix(newline + 1);
+      return true;
+    }
+
+    // The rest of this block starts a line that ends in a later one
+    carry_.append(block_.data(), block_.size());
+    block_ = blocks_ ? blocks_->next() : std::string_view();
+    if (block_.empty()) {
+      if (carry_.empty()) {
+        return false;
+      }
+      line = carry_;
+      carry_returned_ = true;
+      return true;
+    }
+  }
+}
+
+bool LineReader::nextRecord(std::string_view &record, size_t &lines) {
+  if (!next(record)) {
+    return false;
+  }
+  lines = 1;
+  if (!hasOpenQuote(record)) {
+    return true;
+  }
+  // The line views may be invalidated by the next read, so copy
+  record_.assign(record.data(), record.size());
+  bool open = true;
+  std::string_view line;
+  while (open && next(line)) {
+    record_ += '\n';
+    record_.append(line.data(), line.size());
+    open ^= hasOpenQuote(line);
+    ++lines;
+  }
+  record = record_;
+  return true;
+}
+
+} // namespace car_sales
@@ -0,0 +1,156 @@
+#include "record_boundaries.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <future>
+#include <limits>
+
+namespace car_sales {
+
+bool hasOpenQuote(std::string_view text) {
+  // Most lines hold no quotes at all; memchr rules that out cheaply
+  const void *first = std::memchr(text.data(), '"', text.size());
+  if (!first) {
+    return false;
+  }
+  size_t from = static_cast<size_t>(static_cast<const char *>(first) -
+                                    text.data());
+  return std::count(text.begin() + from, text.end(), '"') % 2 == 1;
+}
+
+size_t recordEnd(std::string_view data, size_t pos, size_t &embedded_newlines) {
+  embedded_newlines = 0;
+  bool in_quotes = false;
+  while (true) {
+    size_t eol = data.find('\n', pos);
+    if (eol == std::string_view::npos) {
+      eol = data.size();
+    }
+    in_quotes ^= hasOpenQuote(data.substr(pos, eol - pos));
+    if (!in_quotes || eol == data.size()) {
+      return eol;
+    }
+    ++embedded_newlines;
+    pos = eol + 1;
+  }
+}
+
+size_t lastRecordEnd(std::string_view data) {
+  size_t newline = data.rfind('\n');
+  if (newline == std::string_view::npos) {
+    return 0;
+  }
+  // A newline ends a record when the quotes before it are balanced; step
+  // back a line at a time while it falls inside a quoted field
+  bool open = hasOpenQuote(data.substr(0, newline));
+  while (open) {
+    size_t previous =
+        newline == 0 ? std::string_view::npos : data.rfind('\n', newline - 1);
+    if (previous == std::string_view::npos) {
+      return 0;
+    }
+    open ^= hasOpenQuote(data.substr(previous, newline - previous));
+    newline = previous;
+  }
+  return newline + 1;
+}
+
+// Offset just past the first newline outside quotes, given the state at
+// the start of chunk; jumps between quotes and newlines with memchr
+static size_t firstRecordStart(std::string_view chunk, bool in_quotes) {
+  size_t pos = 0;
+  while (pos < chunk.size()) {
+    if (in_quotes) {
+      // Only a quote can end the quoted state
+      size_t quote = chunk.find('"', pos);
+      if (quote == std::string_view::npos) {
+        return std::string_view::npos;
+      }
+      in_quotes = false;
+      pos = quote + 1;
+      continue;
+    }
+    size_t newline = chunk.find('\n', pos);
+    size_t span_end = newline == std::string_view::npos ? chunk.size() : newline;
+    const void *quote = std::memchr(chunk.data() + pos, '"', span_end - pos);
+    if (!quote) {
+      return newline == std::string_view::npos ? newline : newline + 1;
+    }
+    in_quotes = true;
+    pos = static_cast<size_t>(static_cast<const char *>(quote) - chunk.data()) + 1;
+  }
+  return std::string_view::npos;
+}
+
+QuoteScan scanQuotes(std::string_view chunk) {
+  QuoteScan scan;
+  scan.odd_quotes = hasOpenQuote(chunk);
+  scan.first_start[0] = firstRecordStart(chunk, false);
+  scan.first_start[1] = firstRecordStart(chunk, true);
+  return scan;
+}
+
+std::vector<uint64_t> resolveRecordStarts(const std::vector<QuoteScan> &scans,
+                                          const std::vector<uint64_t> &cuts,
+                                          uint64_t end) {
+  constexpr uint64_t NONE = std::numeric_limits<uint64_t>::max();
+  size_t chunks = scans.size();
+  std::vector<uint64_t> starts(chunks + 1, end);
+  if (chunks == 0) {
+    return starts;
+  }
+  starts[0] = cuts[0];
+
+  bool in_quotes = false;
+  for (size_t c = 1; c < chunks; ++c) {
+    in_quotes ^= scans[c - 1].odd_quotes;
+    size_t start = scans[c].first_start[in_quotes];
+    starts[c] = start == std::string_view::npos ? NONE : cuts[c] + start;
+  }
+  // A chunk that starts no record hands its bytes to the one before it
+  for (size_t c = chunks - 1; c > 0; --c) {
+    if (starts[c] == NONE) {
+      starts[c] = starts[c + 1];
+    }
+  }
+  return starts;
+}
+
+std::vector<std::string_view> splitRecords(std::string_view data,
+                                           size_t parts) {
+  std::vector<std::string_view> ranges;
+  if (data.empty()) {
+    return ranges;
+  }
+  parts = std::max<size_t>(1, std::min(parts, data.size()));
+
+  std::vector<uint64_t> cuts(parts + 1);
+  for (size_t c = 0; c <= parts; ++c) {
+    cuts[c] = static_cast<uint64_t>(data.size()) * c / parts;
+  }
+
+  // Pass 1: every chunk scanned under both hypotheses, in parallel
+  std::vector<QuoteScan> scans(parts);
+  auto scan = [&](size_t c) {
+    scans[c] = scanQuotes(data.substr(cuts[c], cuts[c + 1] - cuts[c]));
+  };
+  std::vector<std::future<void>> futures;
+  for (size_t c = 1; c < parts; ++c) {
+    futures.push_back(std::async(std::launch::async, scan, c));
+  }
+  scan(0);
+  for (auto &future : futures) {
+    future.get();
+  }
+
+  // Pass 2: the prefix XOR of quote parities picks each chunk's boundary
+  std::vector<uint64_t> starts = resolveRecordStarts(scans, cuts, data.size());
+  for (size_t c = 0; c < parts; ++c) {
+    if (starts[c + 1] > starts[c]) {
+      ranges.push_back(data.substr(starts[c], starts[c + 1] - starts[c]));
+    }
+  }
+  return ranges;
+}
+
+} // namespace car_sales
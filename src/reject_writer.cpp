@@ -0,0 +1,126 @@
+#include <algorithm>
+
+#include "reject_writer.hpp"
+
+namespace car_sales {
+
+RejectFileWriter::RejectFileWriter(const std::string &path)
+    : path_(path), file_(std::fopen(path.c_str(), "wb")), stopping_(false),
+      write_failed_(false), rows_written_(0) {
+  if (file_) {
+    thread_ = std::thread(&RejectFileWriter::run, this);
+  }
+}
+
+RejectFileWriter::~RejectFileWriter() { close(); }
+
+void RejectFileWriter::submit(std::string &&block) {
+  if (!file_ || block.empty()) {
+    return;
+  }
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    pending_.push_back(std::move(block));
+  }
+  cv_.notify_one();
+}
+
+std::string RejectFileWriter::acquireBlock() {
+  std::string block;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!free_blocks_.empty()) {
+      block = std::move(free_blocks_.back());
+      free_blocks_.pop_back();
+    }
+  }
+  block.clear();
+  if (block.capacity() < BLOCK_SIZE) {
+    block.reserve(BLOCK_SIZE);
+  }
+  return block;
+}
+
+void RejectFileWriter::run() {
+  std::deque<std::string> batch;
+  while (true) {
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+      cv_.wait(lock, [this] { return stopping_ || !pending_.empty(); });
+      if (pending_.empty() && stopping_) {
+        return;
+      }
+      batch.swap(pending_);
+    }
+
+    // Write without holding the lock so workers can keep submitting
+    size_t rows = 0;
+    bool failed = false;
+    for (auto &block : batch) {
+      if (std::fwrite(block.data(), 1, block.size(), file_) != block.size()) {
+        failed = true;
+      }
+      rows += static_cast<size_t>(
+          std::count(block.begin(), block.end(), '\n'));
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    rows_written_ += rows;
+    write_failed_ = write_failed_ || failed;
+    for (auto &block : batch) {
+      if (free_blocks_.size() < 16) {
+        free_blocks_.push_back(std::move(block));
+      }
+    }
+    batch.clear();
+  }
+}
+
+bool RejectFileWriter::close() {
+  if (!file_) {
+    return !write_failed_;
+  }
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stopping_ = true;
+  }
+  cv_.notify_one();
+  if (thread_.joinable()) {
+    thread_.join();
+  }
+  if (std::fclose(file_) != 0) {
+    write_failed_ = true;
+  }
+  file_ = nullptr;
+  return !write_failed_;
+}
+
+size_t RejectFileWriter::rowsWritten() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return rows_written_;
+}
+
+RejectBuffer::RejectBuffer(RejectFileWriter *writer) : writer_(writer) {}
+
+void RejectBuffer::add(std::string_view line) {
+  if (!writer_) {
+    return;
+  }
+  if (block_.capacity() < RejectFileWriter::BLOCK_SIZE) {
+    block_ = writer_->acquireBlock();
+  }
+  block_.append(line.data(), line.size());
+  block_.push_back('\n');
+  if (block_.size() >= RejectFileWriter::BLOCK_SIZE) {
+    flush();
+  }
+}
+
+void RejectBuffer::flush() {
+  if (writer_ && !block_.empty()) {
+    writer_->submit(std::move(block_));
+    block_.clear();
+  }
+}
+
+} // namespace car_sales
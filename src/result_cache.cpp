@@ -0,0 +1,546 @@
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <sstream>
+#include <system_error>
+#include <vector>
+
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "hash.hpp"
+#include "result_cache.hpp"
+
+namespace car_sales {
+
+namespace fs = std::filesystem;
+
+namespace {
+
+constexpr char MAGIC[4] = {'C', 'S', 'R', 'C'};
+// Bump whenever AnalysisResult or the layout below changes; changes to what
+// the parser produces bump CsvParser::PARSE_SEMANTICS_VERSION instead
+constexpr uint64_t FORMAT_VERSION = 2;
+constexpr const char *ENTRY_SUFFIX = ".entry";
+constexpr const char *STATS_FILE = "stats.txt";
+
+// Native-endian fields; a cache directory is local to one machine
+class Writer {
+public:
+  void u64(uint64_t value) {
+    char bytes[8];
+    std::memcpy(bytes, &value, 8);
+    out_.append(bytes, 8);
+  }
+  void i64(int64_t value) { u64(static_cast<uint64_t>(value)); }
+  void f64(double value) {
+    uint64_t bits;
+    std::memcpy(&bits, &value, 8);
+    u64(bits);
+  }
+  void str(const std::string &value) {
+    u64(value.size());
+    out_ += value;
+  }
+  std::string &data() { return out_; }
+
+private:
+  std::string out_;
+};
+
+// Reads past the end yield zeros and clear ok()
+class Reader {
+public:
+  explicit Reader(const std::string &data) : data_(data) {}
+
+  uint64_t u64() {
+    uint64_t value = 0;
+    if (pos_ + 8 > data_.size()) {
+      ok_ = false;
+      return 0;
+    }
+    std::memcpy(&value, data_.data() + pos_, 8);
+    pos_ += 8;
+    return value;
+  }
+  int64_t i64() { return static_cast<int64_t>(u64()); }
+  double f64() {
+    uint64_t bits = u64();
+    double value;
+    std::memcpy(&value, &bits, 8);
+    return value;
+  }
+  std::string str() {
+    uint64_t size = u64();
+    if (size > data_.size() - pos_) {
+      ok_ = false;
+      return std::string();
+    }
+    std::string value = data_.substr(pos_, size);
+    pos_ += size;
+    return value;
+  }
+  // Element count of a vector; each element takes at least 8 bytes
+  size_t count() {
+    uint64_t n = u64();
+    if (n > (data_.size() - pos_) / 8) {
+      ok_ = false;
+      return 0;
+    }
+    return static_cast<size_t>(n);
+  }
+
+  bool ok() const { return ok_; }
+  bool atEnd() const { return pos_ == data_.size(); }
+  size_t position() const { return pos_; }
+
+private:
+  const std::string &data_;
+  size_t pos_ = 0;
+  bool ok_ = true;
+};
+
+void writeIdentity(Writer &out, const FileIdentity &file, uint64_t query) {
+  out.data().append(MAGIC, sizeof(MAGIC));
+  out.u64(FORMAT_VERSION);
+  out.u64(CsvParser::PARSE_SEMANTICS_VERSION);
+  out.u64(query);
+  out.str(file.path);
+  out.u64(file.device);
+  out.u64(file.inode);
+  out.u64(file.size);
+  out.i64(file.mtime_ns);
+  out.u64(file.content_hash);
+}
+
+bool readFile(const std::string &path, std::string &data) {
+  std::ifstream in(path, std::ios::binary);
+  if (!in) {
+    return false;
+  }
+  data.assign(std::istreambuf_iterator<char>(in),
+              std::istreambuf_iterator<char>());
+  return !in.bad();
+}
+
+// Write then rename, so other processes see the old file or the new one
+bool replaceFile(const std::string &path, const std::string &data) {
+  std::string temp = path + ".tmp" + std::to_string(::getpid());
+  {
+    std::ofstream out(temp, std::ios::binary | std::ios::trunc);
+    out.write(data.data(), static_cast<std::streamsize>(data.size()));
+    if (!out) {
+      std::error_code ec;
+      fs::remove(temp, ec);
+      return false;
+    }
+  }
+  return std::rename(temp.c_str(), path.c_str()) == 0;
+}
+
+CacheStats readStats(const std::string &path) {
+  CacheStats stats;
+  std::string data;
+  if (!readFile(path, data)) {
+    return stats;
+  }
+  std::istringstream in(data);
+  std::string name;
+  uint64_t value;
+  while (in >> name >> value) {
+    if (name == "hits") {
+      stats.hits = value;
+    } else if (name == "misses") {
+      stats.misses = value;
+    } else if (name == "stores") {
+      stats.stores = value;
+    } else if (name == "evictions") {
+      stats.evictions = value;
+    } else if (name == "invalidations") {
+      stats.invalidations = value;
+    }
+  }
+  return stats;
+}
+
+} // namespace
+
+bool FileIdentity::of(const std::string &filename, FileIdentity &identity) {
+  struct stat info;
+  if (::stat(filename.c_str(), &info) != 0 || !S_ISREG(info.st_mode)) {
+    return false;
+  }
+  std::error_code ec;
+  fs::path absolute = fs::absolute(filename, ec);
+  identity.path = ec ? filename : absolute.lexically_normal().string();
+  identity.device = static_cast<uint64_t>(info.st_dev);
+  identity.inode = static_cast<uint64_t>(info.st_ino);
+  identity.size = static_cast<uint64_t>(info.st_size);
+  identity.mtime_ns = static_cast<int64_t>(info.st_mtim.tv_sec) * 1000000000 +
+                      info.st_mtim.tv_nsec;
+
+  std::ifstream in(filename, std::ios::binary);
+  if (!in) {
+    return false;
+  }
+  uint64_t sample = std::min<uint64_t>(CONTENT_SAMPLE_BYTES, identity.size);
+  std::string head(static_cast<size_t>(sample), '\0');
+  std::string tail(static_cast<size_t>(sample), '\0');
+  in.read(&head[0], static_cast<std::streamsize>(sample));
+  in.seekg(static_cast<std::streamoff>(identity.size - sample));
+  in.read(&tail[0], static_cast<std::streamsize>(sample));
+  if (!in) {
+    return false;
+  }
+  identity.content_hash = mixHash(hashBytes(head) + 31 * hashBytes(tail));
+  return true;
+}
+
+std::string ResultCache::serialize(const AnalysisResult &result) {
+  Writer out;
+  out.i64(result.audi_china_year_sales);
+  out.i64(result.bmw_year_total_revenue_cents);
+  out.u64(result._bmw_europe_revenuedistribution.size());
+  for (const auto &[country, revenue] : result._bmw_europe_revenuedistribution) {
+    out.str(country);
+    out.f64(revenue);
+  }
+
+  out.u64(static_cast<uint64_t>(result.group_by_column));
+  out.u64(result.top_groups.size());
+  for (const GroupTotal &group : result.top_groups) {
+    out.str(group.key);
+    out.i64(group.count);
+    out.i64(group.revenue_cents);
+  }
+  out.u64(result.group_count);
+  out.u64(result.group_spill_bytes);
+
+  out.u64(static_cast<uint64_t>(result.heavy_hitter_column));
+  out.u64(static_cast<uint64_t>(result.heavy_hitter_metric));
+  out.u64(result.heavy_hitters.size());
+  for (const HeavyHitter &hitter : result.heavy_hitters) {
+    out.str(hitter.key);
+    out.i64(hitter.estimate);
+    out.i64(hitter.error);
+  }
+  out.i64(result.heavy_hitter_total);
+  out.i64(result.heavy_hitter_max_error);
+
+  out.u64(static_cast<uint64_t>(result.distinct_column));
+  out.u64(result.distinct_precision);
+  out.f64(result.distinct_relative_error);
+  for (const auto *groups : {&result.distinct_groups, &result.distinct_europe}) {
+    out.u64(groups->size());
+    for (const DistinctGroup &group : *groups) {
+      out.str(group.brand);
+      out.str(group.country);
+      out.u64(group.estimate);
+    }
+  }
+
+  out.u64(static_cast<uint64_t>(result.time_bucket));
+  out.u64(result.time_series.size());
+  for (const SeriesPoint &point : result.time_series) {
+    out.str(point.brand);
+    out.i64(point.bucket);
+    out.str(point.label);
+    out.i64(point.units);
+    out.i64(point.revenue_cents);
+  }
+  out.i64(result.undated_rows);
+
+  out.u64(result.rolling_windows.size());
+  for (uint32_t days : result.rolling_windows) {
+    out.u64(days);
+  }
+  out.u64(result.rolling_revenue.size());
+  for (const RollingPoint &point : result.rolling_revenue) {
+    out.str(point.country);
+    out.i64(point.day);
+    out.str(point.date);
+    out.i64(point.day_cents);
+    out.u64(point.window_cents.size());
+    for (int64_t cents : point.window_cents) {
+      out.i64(cents);
+    }
+  }
+
+  out.f64(result.geo_cell_degrees);
+  out.u64(result.geo_cells.size());
+  for (const GeoCell &cell : result.geo_cells) {
+    out.u64(cell.cell);
+    out.f64(cell.lat);
+    out.f64(cell.lon);
+    out.i64(cell.units);
+    out.i64(cell.revenue_cents);
+  }
+  out.i64(result.unlocated_rows);
+
+  out.u64(result.total_records_processed);
+  out.u64(result.total_records_failed);
+  out.u64(result.total_records_filtered);
+  out.u64(result.analysis_complete);
+  out.u64(result.errors.size());
+  for (const std::string &error : result.errors) {
+    out.str(error);
+  }
+  out.u64(result.parse_errors.size());
+  for (const ParseError &error : result.parse_errors) {
+    out.u64(error.byte_offset);
+    out.u64(error.line);
+    out.u64(error.column);
+    out.u64(static_cast<uint64_t>(error.code));
+  }
+  return std::move(out.data());
+}
+
+bool ResultCache::deserialize(const std::string &data, AnalysisResult &result) {
+  Reader in(data);
+  AnalysisResult r;
+  r.audi_china_year_sales = static_cast<int>(in.i64());
+  r.bmw_year_total_revenue_cents = in.i64();
+  r.bmw_year_total_revenue = centsToDollars(r.bmw_year_total_revenue_cents);
+  for (size_t n = in.count(); n > 0 && in.ok(); --n) {
+    std::string country = in.str();
+    r._bmw_europe_revenuedistribution.emplace_back(std::move(country),
+                                                   in.f64());
+  }
+
+  r.group_by_column = static_cast<GroupColumn>(in.u64());
+  for (size_t n = in.count(); n > 0 && in.ok(); --n) {
+    GroupTotal group;
+    group.key = in.str();
+    group.count = in.i64();
+    group.revenue_cents = in.i64();
+    r.top_groups.push_back(std::move(group));
+  }
+  r.group_count = static_cast<size_t>(in.u64());
+  r.group_spill_bytes = in.u64();
+
+  r.heavy_hitter_column = static_cast<GroupColumn>(in.u64());
+  r.heavy_hitter_metric = static_cast<HeavyHitterMetric>(in.u64());
+  for (size_t n = in.count(); n > 0 && in.ok(); --n) {
+    HeavyHitter hitter;
+    hitter.key = in.str();
+    hitter.estimate = in.i64();
+    hitter.error = in.i64();
+    r.heavy_hitters.push_back(std::move(hitter));
+  }
+  r.heavy_hitter_total = in.i64();
+  r.heavy_hitter_max_error = in.i64();
+
+  r.distinct_column = static_cast<GroupColumn>(in.u64());
+  r.distinct_precision = static_cast<unsigned>(in.u64());
+  r.distinct_relative_error = in.f64();
+  for (auto *groups : {&r.distinct_groups, &r.distinct_europe}) {
+    for (size_t n = in.count(); n > 0 && in.ok(); --n) {
+      DistinctGroup group;
+      group.brand = in.str();
+      group.country = in.str();
+      group.estimate = in.u64();
+      groups->push_back(std::move(group));
+    }
+  }
+
+  r.time_bucket = static_cast<TimeBucket>(in.u64());
+  for (size_t n = in.count(); n > 0 && in.ok(); --n) {
+    SeriesPoint point;
+    point.brand = in.str();
+    point.bucket = static_cast<int32_t>(in.i64());
+    point.label = in.str();
+    point.units = in.i64();
+    point.revenue_cents = in.i64();
+    r.time_series.push_back(std::move(point));
+  }
+  r.undated_rows = in.i64();
+
+  for (size_t n = in.count(); n > 0 && in.ok(); --n) {
+    r.rolling_windows.push_back(static_cast<uint32_t>(in.u64()));
+  }
+  for (size_t n = in.count(); n > 0 && in.ok(); --n) {
+    RollingPoint point;
+    point.country = in.str();
+    point.day = static_cast<int32_t>(in.i64());
+    point.date = in.str();
+    point.day_cents = in.i64();
+    for (size_t w = in.count(); w > 0 && in.ok(); --w) {
+      point.window_cents.push_back(in.i64());
+    }
+    r.rolling_revenue.push_back(std::move(point));
+  }
+
+  r.geo_cell_degrees = in.f64();
+  for (size_t n = in.count(); n > 0 && in.ok(); --n) {
+    GeoCell cell;
+    cell.cell = static_cast<uint32_t>(in.u64());
+    cell.lat = in.f64();
+    cell.lon = in.f64();
+    cell.units = in.i64();
+    cell.revenue_cents = in.i64();
+    r.geo_cells.push_back(cell);
+  }
+  r.unlocated_rows = in.i64();
+
+  r.total_records_processed = static_cast<size_t>(in.u64());
+  r.total_records_failed = static_cast<size_t>(in.u64());
+  r.total_records_filtered = static_cast<size_t>(in.u64());
+  r.analysis_complete = in.u64() != 0;
+  for (size_t n = in.count(); n > 0 && in.ok(); --n) {
+    r.errors.push_back(in.str());
+  }
+  for (size_t n = in.count(); n > 0 && in.ok(); --n) {
+    ParseError error;
+    error.byte_offset = in.u64();
+    error.line = in.u64();
+    error.column = static_cast<uint32_t>(in.u64());
+    error.code = static_cast<ParseErrorCode>(in.u64());
+    r.parse_errors.push_back(error);
+  }
+
+  if (!in.ok() || !in.atEnd()) {
+    return false;
+  }
+  result = std::move(r);
+  return true;
+}
+
+ResultCache::ResultCache(std::string directory, uint64_t max_bytes)
+    : directory_(std::move(directory)), max_bytes_(max_bytes) {
+  std::error_code ec;
+  fs::create_directories(directory_, ec);
+}
+
+std::string ResultCache::entryPath(const FileIdentity &file,
+                                   uint64_t query) const {
+  std::string key = file.path;
+  key.push_back('\0');
+  key.append(reinterpret_cast<const char *>(&query), sizeof(query));
+  char name[32];
+  std::snprintf(name, sizeof(name), "%016llx",
+                static_cast<unsigned long long>(hashBytes(key)));
+  return (fs::path(directory_) / (std::string(name) + ENTRY_SUFFIX)).string();
+}
+
+bool ResultCache::lookup(const FileIdentity &file, uint64_t query,
+                         AnalysisResult &result) {
+  std::string path = entryPath(file, query);
+  std::string data;
+  if (!readFile(path, data)) {
+    count(&CacheStats::misses);
+    return false;
+  }
+
+  Writer expected;
+  writeIdentity(expected, file, query);
+  const std::string &header = expected.data();
+  std::error_code ec;
+  if (data.compare(0, header.size(), header) != 0) {
+    // Same slot, other version of the file (or an older format)
+    fs::remove(path, ec);
+    count(&CacheStats::invalidations);
+    count(&CacheStats::misses);
+    return false;
+  }
+
+  AnalysisResult cached;
+  if (!deserialize(data.substr(header.size()), cached)) {
+    fs::remove(path, ec);
+    count(&CacheStats::misses);
+    return false;
+  }
+  result = std::move(cached);
+  fs::last_write_time(path, fs::file_time_type::clock::now(), ec);
+  count(&CacheStats::hits);
+  return true;
+}
+
+void ResultCache::store(const FileIdentity &file, uint64_t query,
+                        const AnalysisResult &result) {
+  Writer entry;
+  writeIdentity(entry, file, query);
+  entry.data() += serialize(result);
+  if (entry.data().size() > max_bytes_ ||
+      !replaceFile(entryPath(file, query), entry.data())) {
+    return;
+  }
+  count(&CacheStats::stores);
+  evict();
+}
+
+void ResultCache::evict() {
+  struct Entry {
+    fs::file_time_type used;
+    uint64_t bytes;
+    fs::path path;
+  };
+  std::vector<Entry> entries;
+  uint64_t total = 0;
+  std::error_code ec;
+  for (const auto &item : fs::directory_iterator(directory_, ec)) {
+    if (item.path().extension() != ENTRY_SUFFIX) {
+      continue;
+    }
+    std::error_code item_ec;
+    Entry entry{item.last_write_time(item_ec), item.file_size(item_ec),
+                item.path()};
+    if (!item_ec) {
+      total += entry.bytes;
+      entries.push_back(std::move(entry));
+    }
+  }
+  if (total <= max_bytes_) {
+    return;
+  }
+
+  std::sort(entries.begin(), entries.end(),
+            [](const Entry &a, const Entry &b) { return a.used < b.used; });
+  uint64_t evicted = 0;
+  for (const Entry &entry : entries) {
+    if (total <= max_bytes_) {
+      break;
+    }
+    if (fs::remove(entry.path, ec)) {
+      total -= entry.bytes;
+      ++evicted;
+    }
+  }
+  count(&CacheStats::evictions, evicted);
+}
+
+uint64_t ResultCache::sizeBytes() const {
+  uint64_t total = 0;
+  std::error_code ec;
+  for (const auto &item : fs::directory_iterator(directory_, ec)) {
+    std::error_code item_ec;
+    if (item.path().extension() == ENTRY_SUFFIX) {
+      uint64_t bytes = item.file_size(item_ec);
+      total += item_ec ? 0 : bytes;
+    }
+  }
+  return total;
+}
+
+CacheStats ResultCache::stats() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return readStats((fs::path(directory_) / STATS_FILE).string());
+}
+
+void ResultCache::count(uint64_t CacheStats::*counter, uint64_t amount) {
+  if (amount == 0) {
+    return;
+  }
+  std::lock_guard<std::mutex> lock(mutex_);
+  std::string path = (fs::path(directory_) / STATS_FILE).string();
+  CacheStats stats = readStats(path);
+  stats.*counter += amount;
+  std::ostringstream out;
+  out << "hits " << stats.hits << "\nmisses " << stats.misses << "\nstores "
+      << stats.stores << "\nevictions " << stats.evictions
+      << "\ninvalidations " << stats.invalidations << "\n";
+  replaceFile(path, out.str());
+}
+
+} // namespace car_sales
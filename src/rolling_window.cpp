@@ -0,0 +1,37 @@
+#include <utility>
+
+#include "rolling_window.hpp"
+
+namespace car_sales {
+
+std::vector<RollingPoint> rollingWindows(const std::vector<SeriesPoint> &daily,
+                                         const std::vector<uint32_t> &windows) {
+  std::vector<RollingPoint> points;
+  points.reserve(daily.size());
+  std::vector<int64_t> sums(windows.size(), 0);
+
+  size_t series_start = 0;
+  for (size_t i = 0; i < daily.size(); ++i) {
+    const SeriesPoint &today = daily[i];
+    if (i == 0 || today.brand != daily[i - 1].brand) {
+      series_start = i;
+      sums.assign(windows.size(), 0);
+    }
+
+    RollingPoint point{today.brand, today.bucket, today.label,
+                       today.revenue_cents, {}};
+    point.window_cents.resize(windows.size());
+    size_t position = i - series_start;
+    for (size_t w = 0; w < windows.size(); ++w) {
+      sums[w] += today.revenue_cents;
+      if (windows[w] > 0 && position >= windows[w]) {
+        sums[w] -= daily[i - windows[w]].revenue_cents;
+      }
+      point.window_cents[w] = sums[w];
+    }
+    points.push_back(std::move(point));
+  }
+  return points;
+}
+
+} // namespace car_sales
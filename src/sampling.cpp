@@ -0,0 +1,129 @@
+#include <algorithm>
+#include <cmath>
+
+#include "hash.hpp"
+#include "sampling.hpp"
+
+namespace car_sales {
+
+double SampleInterval::relativeError() const {
+  // Nothing seen yet is no evidence of precision; only an exact zero (every
+  // block read) has no error
+  if (estimate == 0.0) {
+    return half_width == 0.0 ? 0.0 : INFINITY;
+  }
+  return half_width / std::fabs(estimate);
+}
+
+double unseenUpperBound(size_t sampled, size_t population, double z) {
+  if (sampled >= population) {
+    return 0.0;
+  }
+  if (sampled == 0) {
+    return INFINITY;
+  }
+  // Poisson bound: zero occurrences in n blocks keeps the rate per block
+  // below -ln(alpha) / n at one-sided level alpha
+  double alpha = 0.5 * std::erfc(z / std::sqrt(2.0));
+  return -std::log(alpha) * static_cast<double>(population) /
+         static_cast<double>(sampled);
+}
+
+SampleInterval estimateTotal(const BlockSums &sums, size_t sampled,
+                             size_t population, double z, double unit) {
+  SampleInterval interval;
+  if (sampled == 0 || population == 0) {
+    return interval;
+  }
+  double n = static_cast<double>(sampled);
+  double big_n = static_cast<double>(population);
+  double mean = sums.sum / n;
+  interval.estimate = big_n * mean;
+
+  if (sums.sum == 0.0) {
+    // Not seen in any sampled block: bound the total instead of +/- 0
+    double bound = unseenUpperBound(sampled, population, z);
+    interval.half_width = bound > 0.0 ? unit * bound : 0.0;
+    return interval;
+  }
+  if (sampled < 2) {
+    // One block says nothing about the spread between blocks
+    interval.half_width = sampled >= population ? 0.0 : INFINITY;
+    return interval;
+  }
+  double variance =
+      std::max(0.0, (sums.sum_sq - sums.sum * mean) / (n - 1.0));
+  double correction = std::max(0.0, 1.0 - n / big_n);
+  interval.half_width = z * big_n * std::sqrt(correction * variance / n);
+  return interval;
+}
+
+std::vector<size_t> samplingOrder(size_t blocks, uint64_t seed) {
+  std::vector<size_t> order(blocks);
+  for (size_t i = 0; i < blocks; ++i) {
+    order[i] = i;
+  }
+  // Fisher-Yates driven by splitmix64
+  uint64_t state = seed;
+  for (size_t i = blocks; i > 1; --i) {
+    state += 0x9E3779B97F4A7C15ULL;
+    size_t j = static_cast<size_t>(mixHash(state) % i);
+    std::swap(order[i - 1], order[j]);
+  }
+  return order;
+}
+
+std::string_view readAlignedBlock(std::istream &in, uint64_t data_start,
+                                  uint64_t file_size, uint64_t block_start,
+                                  uint64_t block_end, std::string &buffer) {
+  block_end = std::min(block_end, file_size);
+  if (block_start >= block_end) {
+    return std::string_view();
+  }
+
+  // Start one byte early to see whether block_start begins a line, and read
+  // some slack past the end for the line that straddles it
+  constexpr uint64_t SLACK = 64 * 1024;
+  uint64_t read_start = block_start > data_start ? block_start - 1 : block_start;
+  uint64_t read_end = std::min(file_size, block_end + SLACK);
+
+  size_t begin = std::string::npos;
+  size_t end = std::string::npos;
+  while (true) {
+    buffer.resize(static_cast<size_t>(read_end - read_start));
+    in.clear();
+    in.seekg(static_cast<std::streamoff>(read_start));
+    in.read(&buffer[0], static_cast<std::streamsize>(buffer.size()));
+    buffer.resize(static_cast<size_t>(in.gcount()));
+
+    if (begin == std::string::npos) {
+      if (read_start == block_start) {
+        begin = 0;
+      } else {
+        // Skip the tail of a line that started in an earlier block
+        size_t newline = buffer.find('\n');
+        begin = newline == std::string::npos ? buffer.size() : newline + 1;
+      }
+      if (read_start + begin >= block_end) {
+        return std::string_view(); // no line starts in this block
+      }
+    }
+
+    // The last line that starts in the block ends at the first newline at
+    // or after block_end - 1
+    size_t last = static_cast<size_t>(block_end - 1 - read_start);
+    size_t newline = buffer.find('\n', std::max<size_t>(begin, last));
+    if (newline != std::string::npos) {
+      end = newline + 1;
+      break;
+    }
+    if (read_end >= file_size || buffer.size() < read_end - read_start) {
+      end = buffer.size();
+      break;
+    }
+    read_end = std::min(file_size, read_end + (read_end - read_start));
+  }
+  return std::string_view(buffer).substr(begin, end - begin);
+}
+
+} // namespace car_sales
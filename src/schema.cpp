@@ -0,0 +1,114 @@
+#include "schema.hpp"
+
+namespace car_sales {
+
+namespace {
+
+// Indexed by SchemaColumn
+const char *const COLUMN_NAMES[SCHEMA_COLUMNS] = {
+    "sale_date",    "country", "latitude", "longitude",      "dealership_id",
+    "manufacturer", "model",   "vin",      "sale_price_usd", "buyer_id",
+    "salesperson_id"};
+
+// Header cell without surrounding spaces or quotes
+std::string_view headerName(std::string_view cell) {
+  while (!cell.empty() && (cell.front() == ' ' || cell.front() == '"' ||
+                           cell.front() == '\r')) {
+    cell.remove_prefix(1);
+  }
+  while (!cell.empty() && (cell.back() == ' ' || cell.back() == '"' ||
+                           cell.back() == '\r')) {
+    cell.remove_suffix(1);
+  }
+  return cell;
+}
+
+} // namespace
+
+const char *schemaColumnName(SchemaColumn column) {
+  return COLUMN_NAMES[static_cast<size_t>(column)];
+}
+
+SchemaColumn schemaColumnFor(GroupColumn column) {
+  switch (column) {
+  case GroupColumn::Country:
+    return SchemaColumn::Country;
+  case GroupColumn::Manufacturer:
+    return SchemaColumn::Manufacturer;
+  case GroupColumn::Model:
+    return SchemaColumn::Model;
+  case GroupColumn::DealershipId:
+    return SchemaColumn::DealershipId;
+  case GroupColumn::SalespersonId:
+    return SchemaColumn::SalespersonId;
+  case GroupColumn::BuyerId:
+    return SchemaColumn::BuyerId;
+  default:
+    return SchemaColumn::Vin;
+  }
+}
+
+Schema Schema::standard() {
+  Schema schema;
+  schema.index_ = STANDARD_COLUMN_INDEX;
+  return schema;
+}
+
+Schema Schema::fromHeader(std::string_view header, char delimiter) {
+  constexpr std::string_view BOM = "\xEF\xBB\xBF";
+  if (header.substr(0, BOM.size()) == BOM) {
+    header.remove_prefix(BOM.size());
+  }
+
+  Schema schema;
+  schema.index_.fill(MISSING);
+  bool any = false;
+  int position = 0;
+  size_t start = 0;
+  while (start <= header.size()) {
+    size_t end = header.find(delimiter, start);
+    if (end == std::string_view::npos) {
+      end = header.size();
+    }
+    std::string_view name = headerName(header.substr(start, end - start));
+    for (size_t c = 0; c < SCHEMA_COLUMNS; ++c) {
+      // The first of duplicate names wins
+      if (name == COLUMN_NAMES[c] && schema.index_[c] == MISSING) {
+        schema.index_[c] = position;
+        any = true;
+      }
+    }
+    ++position;
+    start = end + 1;
+  }
+
+  if (!any) {
+    return standard();
+  }
+  schema.from_header_ = true;
+  return schema;
+}
+
+uint32_t Schema::errorColumn(ParseErrorCode code) const {
+  SchemaColumn column;
+  switch (code) {
+  case ParseErrorCode::MissingBrand:
+    column = SchemaColumn::Manufacturer;
+    break;
+  case ParseErrorCode::MissingCountry:
+    column = SchemaColumn::Country;
+    break;
+  case ParseErrorCode::InvalidDate:
+  case ParseErrorCode::YearOutOfRange:
+    column = SchemaColumn::SaleDate;
+    break;
+  case ParseErrorCode::InvalidPrice:
+    column = SchemaColumn::SalePrice;
+    break;
+  default:
+    return 0;
+  }
+  return static_cast<uint32_t>(index(column) + 1);
+}
+
+} // namespace car_sales
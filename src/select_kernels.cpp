@@ -0,0 +1,123 @@
+#include "select_kernels.hpp"
+
+namespace car_sales {
+
+namespace {
+
+// Branch-free: every row is written, the count only advances past passes,
+// so the loop costs the same at any selectivity
+
+size_t selectEqU16(const uint16_t *column, size_t rows, uint16_t value,
+                   uint32_t *out) {
+  size_t count = 0;
+  for (size_t i = 0; i < rows; ++i) {
+    out[count] = static_cast<uint32_t>(i);
+    count += column[i] == value;
+  }
+  return count;
+}
+
+size_t refineEqU16(const uint16_t *column, size_t, const uint32_t *selection,
+                   size_t selected, uint16_t value, uint32_t *out) {
+  size_t count = 0;
+  for (size_t i = 0; i < selected; ++i) {
+    uint32_t row = selection[i];
+    out[count] = row;
+    count += column[row] == value;
+  }
+  return count;
+}
+
+size_t selectRangeI64(const int64_t *column, size_t rows, int64_t lo,
+                      int64_t hi, uint32_t *out) {
+  size_t count = 0;
+  for (size_t i = 0; i < rows; ++i) {
+    out[count] = static_cast<uint32_t>(i);
+    count += (column[i] >= lo) & (column[i] <= hi);
+  }
+  return count;
+}
+
+size_t refineRangeI64(const int64_t *column, size_t, const uint32_t *selection,
+                      size_t selected, int64_t lo, int64_t hi, uint32_t *out) {
+  size_t count = 0;
+  for (size_t i = 0; i < selected; ++i) {
+    uint32_t row = selection[i];
+    out[count] = row;
+    count += (column[row] >= lo) & (column[row] <= hi);
+  }
+  return count;
+}
+
+size_t refineLookupU16(const uint16_t *column, size_t,
+                       const uint32_t *selection, size_t selected,
+                       const uint8_t *table, uint32_t *out) {
+  size_t count = 0;
+  for (size_t i = 0; i < selected; ++i) {
+    uint32_t row = selection[i];
+    out[count] = row;
+    count += table[column[row]] != 0;
+  }
+  return count;
+}
+
+int64_t sumSelectedI64(const int64_t *column, size_t,
+                       const uint32_t *selection, size_t selected) {
+  int64_t sum = 0;
+  for (size_t i = 0; i < selected; ++i) {
+    sum += column[selection[i]];
+  }
+  return sum;
+}
+
+const SelectKernels SCALAR_KERNELS = {
+    SelectIsa::Scalar, selectEqU16,     refineEqU16,   selectRangeI64,
+    refineRangeI64,    refineLookupU16, sumSelectedI64};
+
+bool cpuHasAvx2() {
+#if CAR_SALES_AVX2 && (defined(__GNUC__) || defined(__clang__))
+  __builtin_cpu_init();
+  return __builtin_cpu_supports("avx2");
+#else
+  return false;
+#endif
+}
+
+} // namespace
+
+const char *selectIsaName(SelectIsa isa) {
+  switch (isa) {
+  case SelectIsa::Scalar:
+    return "scalar";
+  case SelectIsa::Avx2:
+    return "avx2";
+  default:
+    return "unknown";
+  }
+}
+
+bool selectIsaAvailable(SelectIsa isa) {
+  if (isa == SelectIsa::Avx2) {
+    static const bool avx2 = cpuHasAvx2();
+    return avx2;
+  }
+  return true;
+}
+
+const SelectKernels &selectKernels(SelectIsa isa) {
+#if CAR_SALES_AVX2
+  if (isa == SelectIsa::Avx2 && selectIsaAvailable(SelectIsa::Avx2)) {
+    return avx2SelectKernels();
+  }
+#else
+  (void)isa;
+#endif
+  return SCALAR_KERNELS;
+}
+
+const SelectKernels &activeSelectKernels() {
+  static const SelectKernels &kernels = selectKernels(SelectIsa::Avx2);
+  return kernels;
+}
+
+} // namespace car_sales
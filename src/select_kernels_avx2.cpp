@@ -0,0 +1,213 @@
+// Built with -mavx2; only reached after the CPU reported AVX2 support
+#include "select_kernels.hpp"
+
+#include <immintrin.h>
+
+namespace car_sales {
+
+namespace {
+
+// Lane indices of the set bits of each 8-bit mask, packed one per byte,
+// lowest lane first: the permute that moves passing lanes to the front
+struct CompactTable {
+  uint64_t lanes[256];
+};
+
+constexpr CompactTable makeCompactTable() {
+  CompactTable table{};
+  for (int mask = 0; mask < 256; ++mask) {
+    uint64_t packed = 0;
+    int next = 0;
+    for (int lane = 0; lane < 8; ++lane) {
+      if (mask >> lane & 1) {
+        packed |= static_cast<uint64_t>(lane) << (8 * next++);
+      }
+    }
+    table.lanes[mask] = packed;
+  }
+  return table;
+}
+
+constexpr CompactTable COMPACT = makeCompactTable();
+
+/**
+ * Store the lanes of rows whose mask bit is set at out, in order, and
+ * return how many. All 8 lanes are written; the caller's out has room
+ * because it never runs ahead of the rows being read.
+ */
+inline size_t compact(uint32_t *out, __m256i rows, int mask) {
+  __m256i lanes = _mm256_cvtepu8_epi32(
+      _mm_cvtsi64_si128(static_cast<long long>(COMPACT.lanes[mask])));
+  _mm256_storeu_si256(reinterpret_cast<__m256i *>(out),
+                      _mm256_permutevar8x32_epi32(rows, lanes));
+  return static_cast<size_t>(__builtin_popcount(static_cast<unsigned>(mask)));
+}
+
+/**
+ * Rows a gather may address: below rows - overread, so a gather reading
+ * wider than one entry stays inside the column, and below 2^31, as gather
+ * indices are signed 32-bit lanes
+ */
+inline size_t gatherLimit(size_t rows, size_t overread) {
+  if (rows <= overread) {
+    return 0;
+  }
+  size_t limit = rows - overread;
+  return limit < (size_t{1} << 31) ? limit : (size_t{1} << 31);
+}
+
+// Bit per lane (4) where lo <= value <= hi
+inline int inRange(__m256i values, __m256i lo, __m256i hi) {
+  __m256i outside = _mm256_or_si256(_mm256_cmpgt_epi64(lo, values),
+                                    _mm256_cmpgt_epi64(values, hi));
+  return ~_mm256_movemask_pd(_mm256_castsi256_pd(outside)) & 0xF;
+}
+
+size_t selectEqU16(const uint16_t *column, size_t rows, uint16_t value,
+                   uint32_t *out) {
+  const __m256i target = _mm256_set1_epi32(value);
+  const __m256i step = _mm256_set1_epi32(8);
+  __m256i index = _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7);
+  size_t count = 0;
+  size_t i = 0;
+  for (; i + 8 <= rows; i += 8) {
+    __m256i values = _mm256_cvtepu16_epi32(
+        _mm_loadu_si128(reinterpret_cast<const __m128i *>(column + i)));
+    int mask = _mm256_movemask_ps(
+        _mm256_castsi256_ps(_mm256_cmpeq_epi32(values, target)));
+    count += compact(out + count, index, mask);
+    index = _mm256_add_epi32(index, step);
+  }
+  for (; i < rows; ++i) {
+    out[count] = static_cast<uint32_t>(i);
+    count += column[i] == value;
+  }
+  return count;
+}
+
+size_t refineEqU16(const uint16_t *column, size_t rows,
+                   const uint32_t *selection, size_t selected, uint16_t value,
+                   uint32_t *out) {
+  // Each gather reads 4 bytes: the entry and the one after it
+  const size_t limit = gatherLimit(rows, 1);
+  const __m256i target = _mm256_set1_epi32(value);
+  const __m256i low16 = _mm256_set1_epi32(0xFFFF);
+  size_t count = 0;
+  size_t i = 0;
+  for (; i + 8 <= selected && selection[i + 7] < limit; i += 8) {
+    __m256i picked =
+        _mm256_loadu_si256(reinterpret_cast<const __m256i *>(selection + i));
+    __m256i values = _mm256_and_si256(
+        _mm256_i32gather_epi32(reinterpret_cast<const int *>(column), picked,
+                               2),
+        low16);
+    int mask = _mm256_movemask_ps(
+        _mm256_castsi256_ps(_mm256_cmpeq_epi32(values, target)));
+    count += compact(out + count, picked, mask);
+  }
+  for (; i < selected; ++i) {
+    uint32_t row = selection[i];
+    out[count] = row;
+    count += column[row] == value;
+  }
+  return count;
+}
+
+size_t selectRangeI64(const int64_t *column, size_t rows, int64_t lo,
+                      int64_t hi, uint32_t *out) {
+  const __m256i low = _mm256_set1_epi64x(lo);
+  const __m256i high = _mm256_set1_epi64x(hi);
+  const __m256i step = _mm256_set1_epi32(8);
+  __m256i index = _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7);
+  size_t count = 0;
+  size_t i = 0;
+  for (; i + 8 <= rows; i += 8) {
+    const __m256i *values = reinterpret_cast<const __m256i *>(column + i);
+    int mask = inRange(_mm256_loadu_si256(values), low, high) |
+               inRange(_mm256_loadu_si256(values + 1), low, high) << 4;
+    count += compact(out + count, index, mask);
+    index = _mm256_add_epi32(index, step);
+  }
+  for (; i < rows; ++i) {
+    out[count] = static_cast<uint32_t>(i);
+    count += (column[i] >= lo) & (column[i] <= hi);
+  }
+  return count;
+}
+
+size_t refineRangeI64(const int64_t *column, size_t rows,
+                      const uint32_t *selection, size_t selected, int64_t lo,
+                      int64_t hi, uint32_t *out) {
+  const size_t limit = gatherLimit(rows, 0);
+  const __m256i low = _mm256_set1_epi64x(lo);
+  const __m256i high = _mm256_set1_epi64x(hi);
+  const long long *base = reinterpret_cast<const long long *>(column);
+  size_t count = 0;
+  size_t i = 0;
+  for (; i + 8 <= selected && selection[i + 7] < limit; i += 8) {
+    __m256i picked =
+        _mm256_loadu_si256(reinterpret_cast<const __m256i *>(selection + i));
+    __m256i first =
+        _mm256_i32gather_epi64(base, _mm256_castsi256_si128(picked), 8);
+    __m256i second =
+        _mm256_i32gather_epi64(base, _mm256_extracti128_si256(picked, 1), 8);
+    int mask = inRange(first, low, high) | inRange(second, low, high) << 4;
+    count += compact(out + count, picked, mask);
+  }
+  for (; i < selected; ++i) {
+    uint32_t row = selection[i];
+    out[count] = row;
+    count += (column[row] >= lo) & (column[row] <= hi);
+  }
+  return count;
+}
+
+// A byte table has no gather; this one stays scalar
+size_t refineLookupU16(const uint16_t *column, size_t,
+                       const uint32_t *selection, size_t selected,
+                       const uint8_t *table, uint32_t *out) {
+  size_t count = 0;
+  for (size_t i = 0; i < selected; ++i) {
+    uint32_t row = selection[i];
+    out[count] = row;
+    count += table[column[row]] != 0;
+  }
+  return count;
+}
+
+int64_t sumSelectedI64(const int64_t *column, size_t rows,
+                       const uint32_t *selection, size_t selected) {
+  const size_t limit = gatherLimit(rows, 0);
+  const long long *base = reinterpret_cast<const long long *>(column);
+  __m256i first_sum = _mm256_setzero_si256();
+  __m256i second_sum = _mm256_setzero_si256();
+  size_t i = 0;
+  for (; i + 8 <= selected && selection[i + 7] < limit; i += 8) {
+    __m256i picked =
+        _mm256_loadu_si256(reinterpret_cast<const __m256i *>(selection + i));
+    first_sum = _mm256_add_epi64(
+        first_sum,
+        _mm256_i32gather_epi64(base, _mm256_castsi256_si128(picked), 8));
+    second_sum = _mm256_add_epi64(
+        second_sum,
+        _mm256_i32gather_epi64(base, _mm256_extracti128_si256(picked, 1), 8));
+  }
+  alignas(32) int64_t lanes[4];
+  _mm256_store_si256(reinterpret_cast<__m256i *>(lanes),
+                     _mm256_add_epi64(first_sum, second_sum));
+  int64_t sum = lanes[0] + lanes[1] + lanes[2] + lanes[3];
+  for (; i < selected; ++i) {
+    sum += column[selection[i]];
+  }
+  return sum;
+}
+
+const SelectKernels AVX2_KERNELS = {
+    SelectIsa::Avx2, selectEqU16,     refineEqU16,   selectRangeI64,
+    refineRangeI64,  refineLookupU16, sumSelectedI64};
+
+} // namespace
+
+const SelectKernels &avx2SelectKernels() { return AVX2_KERNELS; }
+
+} // namespace car_sales
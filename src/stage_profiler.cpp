@@ -0,0 +1,67 @@
+#include "stage_profiler.hpp"
+
+namespace car_sales {
+
+const char *stageName(Stage stage) {
+  switch (stage) {
+  case Stage::Io:
+    return "I/O";
+  case Stage::Tokenize:
+    return "Tokenize";
+  case Stage::NumericParse:
+    return "Numeric parse";
+  case Stage::Aggregate:
+    return "Aggregate";
+  case Stage::Merge:
+    return "Merge";
+  default:
+    return "Unknown";
+  }
+}
+
+void StageProfile::begin() {
+  enabled = true;
+  begin_time_ = std::chrono::steady_clock::now();
+  begin_ticks_ = profiling::ticks();
+}
+
+void StageProfile::end() {
+  uint64_t end_ticks = profiling::ticks();
+  auto end_time = std::chrono::steady_clock::now();
+  wall_ticks += end_ticks - begin_ticks_;
+  wall_ns += static_cast<uint64_t>(
+      std::chrono::duration_cast<std::chrono::nanoseconds>(end_time -
+                                                           begin_time_)
+          .count());
+}
+
+void StageProfile::merge(const StageProfile &other) {
+  for (size_t i = 0; i < STAGE_COUNT; ++i) {
+    stages[i].ticks += other.stages[i].ticks;
+    stages[i].bytes += other.stages[i].bytes;
+    stages[i].rows += other.stages[i].rows;
+  }
+  threads.insert(threads.end(), other.threads.begin(), other.threads.end());
+  hardware.merge(other.hardware);
+  enabled = enabled || other.enabled;
+}
+
+double StageProfile::toNanoseconds(uint64_t ticks) const {
+  if (wall_ticks == 0) {
+    return 0.0;
+  }
+  return static_cast<double>(ticks) * static_cast<double>(wall_ns) /
+         static_cast<double>(wall_ticks);
+}
+
+void StageProfile::reset() {
+  stages = {};
+  threads.clear();
+  hardware = HwCounterReport();
+  wall_ticks = 0;
+  wall_ns = 0;
+  enabled = false;
+  row_sample_ = 0;
+}
+
+} // namespace car_sales
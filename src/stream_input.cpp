@@ -0,0 +1,137 @@
+#include "stream_input.hpp"
+#include "record_boundaries.hpp"
+
+#include <algorithm>
+
+#include <sys/stat.h>
+
+namespace car_sales {
+
+bool isStreamInput(const std::string &name) {
+  if (name == STDIN_INPUT) {
+    return true;
+  }
+  // A name that cannot be stat'ed fails later, when it is opened
+  struct stat info;
+  return ::stat(name.c_str(), &info) == 0 && !S_ISREG(info.st_mode);
+}
+
+StreamSplitter::StreamSplitter(ReadAheadReader &reader, size_t segment_bytes)
+    : reader_(reader), segment_bytes_(segment_bytes > 0 ? segment_bytes : 1) {
+}
+
+bool StreamSplitter::readBlock(std::string &data) {
+  if (eof_) {
+    return false;
+  }
+  std::string_view block = reader_.next();
+  if (block.empty()) {
+    eof_ = true;
+    return false;
+  }
+  data.append(block.data(), block.size());
+  return true;
+}
+
+bool StreamSplitter::header(std::string &header, size_t &lines) {
+  size_t end = 0;
+  size_t embedded = 0;
+  // Until a record-ending newline (or the end of the stream) is in carry_
+  while ((end = recordEnd(carry_, 0, embedded)) == carry_.size() &&
+         readBlock(carry_)) {
+  }
+  if (carry_.empty()) {
+    return false;
+  }
+  header.assign(carry_, 0, end);
+  lines = 1 + embedded;
+  size_t consumed = std::min(end + 1, carry_.size());
+  carry_.erase(0, consumed);
+  offset_ = consumed;
+  return true;
+}
+
+bool StreamSplitter::next(StreamSegment &segment) {
+  segment.data.swap(carry_);
+  carry_.clear();
+  segment.base_offset = offset_;
+
+  size_t cut = 0;
+  while (true) {
+    while (segment.data.size() < segment_bytes_ && readBlock(segment.data)) {
+    }
+    if (eof_) {
+      cut = segment.data.size(); // the last record needs no newline
+      break;
+    }
+    cut = lastRecordEnd(segment.data);
+    if (cut > 0) {
+      break;
+    }
+    // Not one record ended yet: read on
+    if (!readBlock(segment.data)) {
+      cut = segment.data.size();
+      break;
+    }
+  }
+  if (cut == 0) {
+    return false;
+  }
+  carry_.assign(segment.data, cut, std::string::npos);
+  segment.data.resize(cut);
+  segment.index = next_index_++;
+  offset_ += cut;
+  return true;
+}
+
+StreamSegmentQueue::StreamSegmentQueue(size_t buffers)
+    : storage_(buffers > 0 ? buffers : 1) {
+  for (StreamSegment &segment : storage_) {
+    free_.push_back(&segment);
+  }
+}
+
+StreamSegment *StreamSegmentQueue::acquire() {
+  std::unique_lock<std::mutex> lock(mutex_);
+  freed_.wait(lock, [this] { return !free_.empty(); });
+  StreamSegment *segment = free_.back();
+  free_.pop_back();
+  return segment;
+}
+
+void StreamSegmentQueue::push(StreamSegment *segment) {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    full_.push_back(segment);
+  }
+  ready_.notify_one();
+}
+
+bool StreamSegmentQueue::pop(StreamSegment *&segment) {
+  std::unique_lock<std::mutex> lock(mutex_);
+  ready_.wait(lock, [this] { return !full_.empty() || closed_; });
+  if (full_.empty()) {
+    return false;
+  }
+  segment = full_.front();
+  full_.pop_front();
+  return true;
+}
+
+void StreamSegmentQueue::release(StreamSegment *segment) {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    free_.push_back(segment);
+  }
+  freed_.notify_one();
+}
+
+void StreamSegmentQueue::close() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    closed_ = true;
+  }
+  ready_.notify_all();
+}
+
+} // namespace car_sales
@@ -0,0 +1,272 @@
+#include <algorithm>
+#include <charconv>
+#include <cstdio>
+
+#include "time_series.hpp"
+
+namespace car_sales {
+
+// Civil-calendar conversions after Howard Hinnant's date algorithms
+int32_t daysFromCivil(int year, unsigned month, unsigned day) {
+  year -= month <= 2;
+  int era = (year >= 0 ? year : year - 399) / 400;
+  unsigned yoe = static_cast<unsigned>(year - era * 400);
+  unsigned doy = (153 * (month + (month > 2 ? -3 : 9)) + 2) / 5 + day - 1;
+  unsigned doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+  return era * 146097 + static_cast<int32_t>(doe) - 719468;
+}
+
+void civilFromDays(int32_t days, int &year, unsigned &month, unsigned &day) {
+  days += 719468;
+  int era = (days >= 0 ? days : days - 146096) / 146097;
+  unsigned doe = static_cast<unsigned>(days - era * 146097);
+  unsigned yoe = (doe - doe / 1460 + doe / 36524 - doe / 146096) / 365;
+  unsigned doy = doe - (365 * yoe + yoe / 4 - yoe / 100);
+  unsigned mp = (5 * doy + 2) / 153;
+  day = doy - (153 * mp + 2) / 5 + 1;
+  month = mp < 10 ? mp + 3 : mp - 9;
+  year = static_cast<int>(yoe) + era * 400 + (month <= 2);
+}
+
+static bool isLeapYear(int year) {
+  return (year % 4 == 0 && year % 100 != 0) || year % 400 == 0;
+}
+
+static unsigned daysInMonth(int year, unsigned month) {
+  static const unsigned DAYS[] = {31, 28, 31, 30, 31, 30,
+                                  31, 31, 30, 31, 30, 31};
+  return month == 2 && isLeapYear(year) ? 29 : DAYS[month - 1];
+}
+
+// Parse all of text as a non-negative integer
+static bool parseNumber(std::string_view text, int &value) {
+  auto [ptr, ec] = std::from_chars(text.data(), text.data() + text.size(), value);
+  return ec == std::errc() && ptr == text.data() + text.size() && value >= 0;
+}
+
+int32_t parseSaleDay(std::string_view date) {
+  // Format: DD-MM-YYYY
+  size_t first_dash = date.find('-');
+  size_t second_dash = first_dash == std::string_view::npos
+                           ? std::string_view::npos
+                           : date.find('-', first_dash + 1);
+  if (second_dash == std::string_view::npos) {
+    return INVALID_DAY;
+  }
+  int day = 0;
+  int month = 0;
+  int year = 0;
+  if (!parseNumber(date.substr(0, first_dash), day) ||
+      !parseNumber(date.substr(first_dash + 1, second_dash - first_dash - 1),
+                   month) ||
+      !parseNumber(date.substr(second_dash + 1), year)) {
+    return INVALID_DAY;
+  }
+  // Bounding the year keeps every bucket array (and label) small
+  if (year < MIN_SALE_YEAR || year > MAX_SALE_YEAR || month < 1 ||
+      month > 12 || day < 1 ||
+      static_cast<unsigned>(day) >
+          daysInMonth(year, static_cast<unsigned>(month))) {
+    return INVALID_DAY;
+  }
+  return daysFromCivil(year, static_cast<unsigned>(month),
+                       static_cast<unsigned>(day));
+}
+
+const char *timeBucketName(TimeBucket bucket) {
+  switch (bucket) {
+  case TimeBucket::Month:
+    return "month";
+  case TimeBucket::IsoWeek:
+    return "week";
+  case TimeBucket::Day:
+    return "day";
+  default:
+    return "none";
+  }
+}
+
+bool parseTimeBucket(std::string_view name, TimeBucket &bucket) {
+  if (name == "month") {
+    bucket = TimeBucket::Month;
+    return true;
+  }
+  if (name == "week") {
+    bucket = TimeBucket::IsoWeek;
+    return true;
+  }
+  return false;
+}
+
+static int32_t floorDiv(int32_t a, int32_t b) {
+  return a / b - (a % b != 0 && (a < 0) != (b < 0));
+}
+
+int32_t bucketOf(TimeBucket bucket, int32_t day) {
+  if (bucket == TimeBucket::Day) {
+    return day;
+  }
+  if (bucket == TimeBucket::Month) {
+    int year;
+    unsigned month;
+    unsigned dom;
+    civilFromDays(day, year, month, dom);
+    return year * 12 + static_cast<int32_t>(month) - 1;
+  }
+  // 1970-01-01 was a Thursday, so ISO weeks start at days -3 + 7k
+  return floorDiv(day + 3, 7);
+}
+
+std::string bucketLabel(TimeBucket bucket, int32_t index) {
+  char label[24]; // room for any int year
+  if (bucket == TimeBucket::Month) {
+    int year = floorDiv(index, 12);
+    int month = index - year * 12 + 1;
+    std::snprintf(label, sizeof(label), "%04d-%02d", year, month);
+    return label;
+  }
+  if (bucket == TimeBucket::Day) {
+    int year;
+    unsigned month;
+    unsigned day;
+    civilFromDays(index, year, month, day);
+    std::snprintf(label, sizeof(label), "%04d-%02u-%02u", year, month, day);
+    return label;
+  }
+  // The ISO year is the year holding the week's Thursday
+  int32_t monday = index * 7 - 3;
+  int32_t thursday = monday + 3;
+  int year;
+  unsigned month;
+  unsigned day;
+  civilFromDays(thursday, year, month, day);
+  int week = (thursday - daysFromCivil(year, 1, 1)) / 7 + 1;
+  std::snprintf(label, sizeof(label), "%04d-W%02d", year, week);
+  return label;
+}
+
+TimeSeriesAggregator::Series &
+TimeSeriesAggregator::seriesFor(std::string_view brand) {
+  for (size_t n = 0; n < series_.size(); ++n) {
+    size_t i = (last_series_ + n) % series_.size();
+    if (series_[i].brand == brand) {
+      last_series_ = i;
+      return series_[i];
+    }
+  }
+  series_.emplace_back();
+  series_.back().brand.assign(brand);
+  last_series_ = series_.size() - 1;
+  return series_.back();
+}
+
+void TimeSeriesAggregator::cover(Series &series, int32_t low, int32_t high) {
+  int32_t size = static_cast<int32_t>(series.units.size());
+  int32_t first = series.first_bucket;
+  if (size > 0 && low >= first && high < first + size) {
+    return;
+  }
+  if (size == 0) {
+    series.first_bucket = low;
+    series.units.assign(static_cast<size_t>(high - low + 1), 0);
+    series.revenue_cents.assign(series.units.size(), 0);
+    return;
+  }
+
+  // Grow by at least the current size so repeated extensions stay amortised
+  int32_t new_first = low < first ? std::min(low, first - size) : first;
+  int32_t new_end =
+      high >= first + size ? std::max(high + 1, first + 2 * size) : first + size;
+  std::vector<int64_t> units(static_cast<size_t>(new_end - new_first), 0);
+  std::vector<int64_t> cents(units.size(), 0);
+  std::copy(series.units.begin(), series.units.end(),
+            units.begin() + (first - new_first));
+  std::copy(series.revenue_cents.begin(), series.revenue_cents.end(),
+            cents.begin() + (first - new_first));
+  series.first_bucket = new_first;
+  series.units = std::move(units);
+  series.revenue_cents = std::move(cents);
+}
+
+void TimeSeriesAggregator::add(std::string_view brand, int32_t day,
+                               int64_t units, int64_t revenue_cents) {
+  if (!enabled()) {
+    return;
+  }
+  if (day == INVALID_DAY) {
+    ++undated_rows_;
+    return;
+  }
+  int32_t bucket = bucketOf(bucket_, day);
+  Series &series = seriesFor(brand);
+  cover(series, bucket, bucket);
+  if (series.high < series.low) {
+    series.low = series.high = bucket;
+  } else {
+    series.low = std::min(series.low, bucket);
+    series.high = std::max(series.high, bucket);
+  }
+  size_t index = static_cast<size_t>(bucket - series.first_bucket);
+  series.units[index] += units;
+  series.revenue_cents[index] += revenue_cents;
+}
+
+void TimeSeriesAggregator::merge(const TimeSeriesAggregator &other) {
+  if (!other.enabled()) {
+    return;
+  }
+  if (!enabled()) {
+    bucket_ = other.bucket_;
+  }
+  undated_rows_ += other.undated_rows_;
+  for (const Series &source : other.series_) {
+    if (source.high < source.low) {
+      continue;
+    }
+    Series &target = seriesFor(source.brand);
+    cover(target, source.low, source.high);
+    if (target.high < target.low) {
+      target.low = source.low;
+      target.high = source.high;
+    } else {
+      target.low = std::min(target.low, source.low);
+      target.high = std::max(target.high, source.high);
+    }
+
+    size_t count = static_cast<size_t>(source.high - source.low + 1);
+    int64_t *units = &target.units[source.low - target.first_bucket];
+    int64_t *cents = &target.revenue_cents[source.low - target.first_bucket];
+    const int64_t *add_units = &source.units[source.low - source.first_bucket];
+    const int64_t *add_cents =
+        &source.revenue_cents[source.low - source.first_bucket];
+    for (size_t i = 0; i < count; ++i) {
+      units[i] += add_units[i];
+      cents[i] += add_cents[i];
+    }
+  }
+}
+
+std::vector<SeriesPoint> TimeSeriesAggregator::points() const {
+  std::vector<const Series *> ordered;
+  for (const Series &series : series_) {
+    if (series.high >= series.low) {
+      ordered.push_back(&series);
+    }
+  }
+  std::sort(ordered.begin(), ordered.end(),
+            [](const Series *a, const Series *b) { return a->brand < b->brand; });
+
+  std::vector<SeriesPoint> points;
+  for (const Series *series : ordered) {
+    for (int32_t bucket = series->low; bucket <= series->high; ++bucket) {
+      size_t index = static_cast<size_t>(bucket - series->first_bucket);
+      points.push_back(SeriesPoint{series->brand, bucket,
+                                   bucketLabel(bucket_, bucket),
+                                   series->units[index],
+                                   series->revenue_cents[index]});
+    }
+  }
+  return points;
+}
+
+} // namespace car_sales
@@ -0,0 +1,155 @@
+#ifndef sale_rows_HPP
+#define sale_rows_HPP
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <utility>
+
+#include <gtest/gtest.h>
+
+#include "fixed_point.hpp"
+#include "schema.hpp"
+
+namespace car_sales {
+
+/**
+ * @brief Builds one row in the 43-column data.csv layout for tests
+ *
+ * Every column starts from a valid default (a BMW sold in Germany on
+ * 15-01-2025 for 1000.00); tests override only the columns they are about:
+ *
+ *   SaleRow().brand("Audi").country("China").price("45000").line()
+ */
+class SaleRow {
+public:
+  static constexpr size_t COLUMNS = 43;
+
+  SaleRow()
+      : fields_{"SALE001", "15-01-2025", "Germany",   "Region",  "0.0",
+                "0.0",     "D001",       "Dealer",    "BMW",     "Model",
+                "2025",    "Sedan",      "Petrol",    "Automatic", "AWD",
+                "Black",   "VIN1",       "New",       "0",       "0",
+                "1000.00", "USD",        "TRUE",      "Lease",   "In-store",
+                "B001",    "35",         "Male",      "75000",   "S001",
+                "Sales 1", "48",         "M",         "F",       "120",
+                "25",      "32",         "2.0",       "201",     "280",
+                "4.5",     "",           "FALSE"} {}
+
+  /**
+   * @brief The data.csv header row, without a trailing newline
+   */
+  static std::string header(char delimiter = '\t') {
+    static const char *const NAMES[COLUMNS] = {
+        "sale_id",          "sale_date",         "country",
+        "region",           "latitude",          "longitude",
+        "dealership_id",    "dealership_name",   "manufacturer",
+        "model",            "vehicle_year",      "body_type",
+        "fuel_type",        "transmission",      "drivetrain",
+        "color",            "vin",               "condition",
+        "previous_owners",  "odometer_km",       "sale_price_usd",
+        "currency",         "financing",         "payment_type",
+        "sales_channel",    "buyer_id",          "buyer_age",
+        "buyer_gender",     "buyer_income_usd",  "salesperson_id",
+        "salesperson_name", "warranty_months",   "warranty_provider",
+        "features",         "co2_g_km",          "mpg_city",
+        "mpg_highway",      "engine_displacement_l", "horsepower",
+        "torque_nm",        "dealer_rating",     "condition_notes",
+        "service_history"};
+    std::string text = NAMES[0];
+    for (size_t i = 1; i < COLUMNS; ++i) {
+      text += delimiter;
+      text += NAMES[i];
+    }
+    return text;
+  }
+
+  /**
+   * @brief Override the field at a 0-based position
+   */
+  SaleRow &set(size_t index, std::string value) {
+    fields_.at(index) = std::move(value);
+    return *this;
+  }
+
+  SaleRow &set(SchemaColumn column, std::string value) {
+    return set(static_cast<size_t>(
+                   STANDARD_COLUMN_INDEX[static_cast<size_t>(column)]),
+               std::move(value));
+  }
+
+  SaleRow &date(std::string value) {
+    return set(SchemaColumn::SaleDate, std::move(value));
+  }
+  SaleRow &country(std::string value) {
+    return set(SchemaColumn::Country, std::move(value));
+  }
+  SaleRow &latitude(std::string value) {
+    return set(SchemaColumn::Latitude, std::move(value));
+  }
+  SaleRow &longitude(std::string value) {
+    return set(SchemaColumn::Longitude, std::move(value));
+  }
+  SaleRow &dealership(std::string value) {
+    return set(SchemaColumn::DealershipId, std::move(value));
+  }
+  SaleRow &brand(std::string value) {
+    return set(SchemaColumn::Manufacturer, std::move(value));
+  }
+  SaleRow &model(std::string value) {
+    return set(SchemaColumn::Model, std::move(value));
+  }
+  SaleRow &vin(std::string value) {
+    return set(SchemaColumn::Vin, std::move(value));
+  }
+  SaleRow &price(std::string value) {
+    return set(SchemaColumn::SalePrice, std::move(value));
+  }
+  SaleRow &priceCents(int64_t cents) { return price(formatCents(cents)); }
+  SaleRow &buyer(std::string value) {
+    return set(SchemaColumn::BuyerId, std::move(value));
+  }
+  SaleRow &salesperson(std::string value) {
+    return set(SchemaColumn::SalespersonId, std::move(value));
+  }
+
+  /**
+   * @brief The fields joined by delimiter, without a trailing newline
+   */
+  std::string line(char delimiter = '\t') const {
+    std::string text = fields_[0];
+    for (size_t i = 1; i < COLUMNS; ++i) {
+      text += delimiter;
+      text += fields_[i];
+    }
+    return text;
+  }
+
+private:
+  std::array<std::string, COLUMNS> fields_;
+};
+
+/**
+ * @brief Write content to name in the test temp directory
+ * @return the file's path
+ */
+inline std::string writeTempFile(const std::string &name,
+                                 const std::string &content) {
+  std::string path = ::testing::TempDir() + name;
+  std::ofstream out(path, std::ios::binary | std::ios::trunc);
+  out << content;
+  return path;
+}
+
+inline std::string readWholeFile(const std::string &path) {
+  std::ifstream in(path, std::ios::binary);
+  return std::string(std::istreambuf_iterator<char>(in),
+                     std::istreambuf_iterator<char>());
+}
+
+} // namespace car_sales
+
+#endif // sale_rows_HPP
@@ -0,0 +1,90 @@
+#include "agg_hash_table.hpp"
+#include <gtest/gtest.h>
+
+#include <map>
+#include <string>
+
+using namespace car_sales;
+
+TEST(AggHashTableTest, AccumulatesPerKey) {
+  AggHashTable table;
+  table.add("D001", 1, 1000);
+  table.add("D002", 1, 500);
+  table.add("D001", 2, 250);
+
+  EXPECT_EQ(table.size(), 2u);
+  AggHashTable::Entry entry;
+  ASSERT_TRUE(table.find("D001", entry));
+  EXPECT_EQ(entry.key, "D001");
+  EXPECT_EQ(entry.count, 3);
+  EXPECT_EQ(entry.revenue_cents, 1250);
+  EXPECT_FALSE(table.find("D003", entry));
+}
+
+TEST(AggHashTableTest, EmptyKeyIsAValidGroup) {
+  AggHashTable table;
+  table.add("", 1, 10);
+  table.add("", 1, 20);
+  AggHashTable::Entry entry;
+  ASSERT_TRUE(table.find("", entry));
+  EXPECT_EQ(entry.count, 2);
+  EXPECT_EQ(entry.revenue_cents, 30);
+}
+
+TEST(AggHashTableTest, GrowsAndKeepsEveryKey) {
+  AggHashTable table(16);
+  for (int i = 0; i < 100000; ++i) {
+    table.add("KEY" + std::to_string(i % 25000), 1, i);
+  }
+  EXPECT_EQ(table.size(), 25000u);
+  EXPECT_GE(table.capacity() * 3, table.size() * 4);
+
+  AggHashTable::Entry entry;
+  ASSERT_TRUE(table.find("KEY7", entry));
+  EXPECT_EQ(entry.count, 4);
+  EXPECT_EQ(entry.revenue_cents, 7 + 25007 + 50007 + 75007);
+}
+
+TEST(AggHashTableTest, MergeMatchesDirectInsertion) {
+  AggHashTable left;
+  AggHashTable right;
+  std::map<std::string, std::pair<int64_t, int64_t>> expected;
+  for (int i = 0; i < 5000; ++i) {
+    std::string key = "B" + std::to_string(i * 37 % 1200);
+    (i % 2 ? left : right).add(key, 1, i);
+    expected[key].first += 1;
+    expected[key].second += i;
+  }
+
+  left.merge(right);
+  EXPECT_EQ(left.size(), expected.size());
+  size_t visited = 0;
+  left.forEach([&](const AggHashTable::Entry &entry) {
+    auto it = expected.find(std::string(entry.key));
+    ASSERT_NE(it, expected.end());
+    EXPECT_EQ(entry.count, it->second.first);
+    EXPECT_EQ(entry.revenue_cents, it->second.second);
+    ++visited;
+  });
+  EXPECT_EQ(visited, expected.size());
+}
+
+TEST(AggHashTableTest, ClearKeepsCapacityReleaseDoesNot) {
+  AggHashTable table;
+  for (int i = 0; i < 1000; ++i) {
+    table.add(std::to_string(i), 1, 1);
+  }
+  size_t capacity = table.capacity();
+
+  table.clear();
+  EXPECT_TRUE(table.empty());
+  EXPECT_EQ(table.capacity(), capacity);
+  AggHashTable::Entry entry;
+  EXPECT_FALSE(table.find("5", entry));
+  table.add("5", 1, 1);
+  EXPECT_EQ(table.size(), 1u);
+
+  table.release();
+  EXPECT_TRUE(table.empty());
+  EXPECT_LT(table.capacity(), capacity);
+}
@@ -0,0 +1,95 @@
+#include "arena.hpp"
+#include "data_parser.hpp"
+#include <gtest/gtest.h>
+
+#include <cstdint>
+
+using namespace car_sales;
+
+// ============================================================================
+// Arena Tests
+// ============================================================================
+
+TEST(ArenaTest, CopyReturnsIndependentView) {
+  Arena arena(64);
+  std::string source = "Germany";
+  std::string_view copy = arena.copy(source);
+  source[0] = 'X';
+
+  EXPECT_EQ(copy, "Germany");
+  EXPECT_EQ(arena.bytesUsed(), 7u);
+}
+
+TEST(ArenaTest, AllocationsAreAligned) {
+  Arena arena(256);
+  arena.allocate(3, 1);
+  auto *values = arena.allocateArray<uint64_t>(4);
+
+  EXPECT_EQ(reinterpret_cast<uintptr_t>(values) % alignof(uint64_t), 0u);
+}
+
+TEST(ArenaTest, ResetReusesMemoryWithoutNewBlocks) {
+  Arena arena(128);
+  for (int cycle = 0; cycle < 10; ++cycle) {
+    for (int i = 0; i < 50; ++i) {
+      arena.allocate(10, 1);
+    }
+    arena.reset();
+  }
+
+  // The first cycle spills into several blocks; reset coalesces them into
+  // one, after which no further blocks are needed
+  size_t after_warmup = arena.blockAllocations();
+  for (int i = 0; i < 50; ++i) {
+    arena.allocate(10, 1);
+  }
+  arena.reset();
+
+  EXPECT_EQ(arena.blockAllocations(), after_warmup);
+  EXPECT_EQ(arena.bytesUsed(), 0u);
+  EXPECT_GE(arena.bytesReserved(), 500u);
+}
+
+TEST(ArenaTest, OversizedAllocationGetsOwnBlock) {
+  Arena arena(16);
+  char *big = static_cast<char *>(arena.allocate(1000, 1));
+  big[999] = 'x';
+
+  EXPECT_GE(arena.bytesReserved(), 1000u);
+}
+
+TEST(ArenaTest, ReleaseFreesEverything) {
+  Arena arena(64);
+  arena.allocate(10);
+  arena.release();
+
+  EXPECT_EQ(arena.bytesReserved(), 0u);
+  EXPECT_EQ(arena.bytesUsed(), 0u);
+}
+
+// ============================================================================
+// RecordBatch Tests
+// ============================================================================
+
+TEST(RecordBatchTest, ClearKeepsSlotsForReuse) {
+  RecordBatch batch;
+  batch.next().country = "Bosnia and Herzegovina";
+  batch.next().country = "Germany";
+  const CarSaleRecord *first = batch.begin();
+
+  batch.clear();
+  EXPECT_TRUE(batch.empty());
+
+  CarSaleRecord &reused = batch.next();
+  EXPECT_EQ(&reused, first);
+  EXPECT_EQ(reused.country, "Bosnia and Herzegovina"); // stale until written
+}
+
+TEST(RecordBatchTest, DiscardLastDropsSlot) {
+  RecordBatch batch;
+  batch.next();
+  batch.next();
+  batch.discardLast();
+
+  EXPECT_EQ(batch.size(), 1u);
+}
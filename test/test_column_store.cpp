@@ -0,0 +1,130 @@
+#include "column_store.hpp"
+#include "data_analyzer.hpp"
+#include "sale_rows.hpp"
+#include <gtest/gtest.h>
+
+#include <cstdio>
+#include <string>
+
+using namespace car_sales;
+
+namespace {
+
+std::string createLine(const std::string &brand, const std::string &country,
+                       const std::string &date, const std::string &price) {
+  return SaleRow()
+      .brand(brand)
+      .country(country)
+      .date(date)
+      .price(price)
+      .line();
+}
+
+} // namespace
+
+TEST(ColumnStoreTest, GroupsWithFilters) {
+  std::string content = "header\n";
+  content += createLine("BMW", "Germany", "15-01-2025", "100.00") + "\n";
+  content += createLine("BMW", "Germany", "20-02-2025", "50.00") + "\n";
+  content += createLine("BMW", "France", "01-02-2024", "70.00") + "\n";
+  content += createLine("BMW", "China", "01-03-2025", "500.00") + "\n";
+  content += createLine("Audi", "China", "31-12-2025", "30.00") + "\n";
+  content += createLine("Audi", "China", "bad-date", "30.00") + "\n";
+  std::string path = writeTempFile("column_store.csv", content);
+
+  ColumnStore store;
+  std::string error;
+  ASSERT_TRUE(store.loadFile(path, error)) << error;
+  EXPECT_EQ(store.rows(), 5u);
+  EXPECT_EQ(store.failedRows(), 1u);
+  EXPECT_GT(store.memoryBytes(), 0u);
+
+  StoreFilter bmw;
+  bmw.brand = "BMW";
+  auto countries = store.groupBy(StoreKey::Country, bmw);
+  ASSERT_EQ(countries.size(), 3u);
+  EXPECT_EQ(countries[0].key, "China"); // highest revenue first
+  EXPECT_EQ(countries[1].key, "Germany");
+  EXPECT_EQ(countries[1].count, 2);
+  EXPECT_EQ(countries[1].revenue_cents, 15000);
+
+  bmw.europe = true;
+  bmw.year = 2025;
+  countries = store.groupBy(StoreKey::Country, bmw);
+  ASSERT_EQ(countries.size(), 1u);
+  EXPECT_EQ(countries[0].key, "Germany");
+
+  auto months = store.groupBy(StoreKey::Month, StoreFilter());
+  ASSERT_EQ(months.size(), 5u); // 2024-02, 2025-01, -02, -03, -12
+  EXPECT_EQ(months[0].key, "2024-02");
+  EXPECT_EQ(months[2].key, "2025-02");
+  EXPECT_EQ(months[2].revenue_cents, 5000);
+
+  auto years = store.groupBy(StoreKey::Year, StoreFilter());
+  ASSERT_EQ(years.size(), 2u);
+  EXPECT_EQ(years[0].key, "2024");
+  EXPECT_EQ(years[1].count, 4);
+
+  StoreFilter unknown;
+  unknown.brand = "Tesla";
+  EXPECT_TRUE(store.groupBy(StoreKey::Brand, unknown).empty());
+  EXPECT_EQ(store.total(unknown).count, 0);
+
+  StoreFilter priced;
+  priced.min_cents = 5000;
+  priced.max_cents = 10000;
+  GroupTotal total = store.total(priced);
+  EXPECT_EQ(total.count, 3);
+  EXPECT_EQ(total.revenue_cents, 22000);
+  priced.year = 2025;
+  priced.europe = true;
+  countries = store.groupBy(StoreKey::Country, priced);
+  ASSERT_EQ(countries.size(), 1u);
+  EXPECT_EQ(countries[0].count, 2);
+
+  StoreFilter europe;
+  europe.europe = true;
+  EXPECT_EQ(store.total(europe).count, 3);
+  EXPECT_EQ(store.total(StoreFilter()).revenue_cents, 75000);
+  std::remove(path.c_str());
+}
+
+TEST(ColumnStoreTest, SummaryMatchesAnalyzer) {
+  std::string content = "header\n";
+  const char *countries[] = {"China", "Germany", "France", "Italy", "Japan"};
+  const char *brands[] = {"Audi", "BMW", "Ford"};
+  for (int i = 0; i < 2000; ++i) {
+    std::string date = "15-0" + std::to_string(1 + i % 9) + "-" +
+                       std::to_string(2024 + i % 2);
+    content += createLine(brands[i % 3], countries[i % 5], date,
+                          std::to_string(20000 + i % 900) + ".75") +
+               "\n";
+  }
+  std::string path = writeTempFile("column_store_summary.csv", content);
+
+  CarSalesAnalyzer analyzer(100);
+  AnalysisResult expected = analyzer.analyzeFile(path, false);
+
+  ColumnStore store;
+  std::string error;
+  ASSERT_TRUE(store.loadFile(path, error, 100));
+  StoreSummary summary = store.summary();
+  EXPECT_EQ(summary.rows, 2000);
+  EXPECT_EQ(summary.audi_china_year_sales, expected.audi_china_year_sales);
+  EXPECT_EQ(summary.bmw_year_revenue_cents,
+            expected.bmw_year_total_revenue_cents);
+  ASSERT_EQ(summary.bmw_europe.size(),
+            expected._bmw_europe_revenuedistribution.size());
+  for (size_t i = 0; i < summary.bmw_europe.size(); ++i) {
+    EXPECT_EQ(summary.bmw_europe[i].key,
+              expected._bmw_europe_revenuedistribution[i].first);
+  }
+  std::remove(path.c_str());
+}
+
+TEST(ColumnStoreTest, MissingFileFails) {
+  ColumnStore store;
+  std::string error;
+  EXPECT_FALSE(store.loadFile("/nonexistent/file.csv", error));
+  EXPECT_FALSE(error.empty());
+}
@@ -254,6 +254,34 @@ TEST_F(CarSalesAnalyzerTest, BmwEuropeDistribution_IgnoresOtherBrands) {
   EXPECT_EQ(result._bmw_europe_revenuedistribution[0].first, "Germany");
 }
 
+TEST_F(CarSalesAnalyzerTest, BmwEuropeDistribution_TiesOrderedByCountry) {
+  std::string csv = createHeader();
+  csv += createLine("15-01-2025", "Italy", "BMW", 50000) + "\n";
+  csv += createLine("20-01-2025", "Austria", "BMW", 50000) + "\n";
+  csv += createLine("25-01-2025", "France", "BMW", 50000) + "\n";
+
+  auto result = analyzer->analyzeString(csv);
+
+  ASSERT_EQ(result._bmw_europe_revenuedistribution.size(), 3);
+  EXPECT_EQ(result._bmw_europe_revenuedistribution[0].first, "Austria");
+  EXPECT_EQ(result._bmw_europe_revenuedistribution[1].first, "France");
+  EXPECT_EQ(result._bmw_europe_revenuedistribution[2].first, "Italy");
+}
+
+TEST_F(CarSalesAnalyzerTest, BmwRevenueIsExactInCents) {
+  std::string csv = createHeader();
+  for (int i = 0; i < 10; ++i) {
+    csv += createLine("15-01-2025", "Germany", "BMW", 0.1) + "\n";
+  }
+  csv += createLine("15-01-2025", "Germany", "BMW", 0.2) + "\n";
+
+  auto result = analyzer->analyzeString(csv);
+
+  EXPECT_EQ(result.bmw_year_total_revenue_cents, 120);
+  EXPECT_EQ(analyzer->getBmw2025RevenueCents(), 120);
+  EXPECT_EQ(result.bmw_year_total_revenue, 1.2);
+}
+
 // ============================================================================
 // Processing Statistics Tests
 // ============================================================================
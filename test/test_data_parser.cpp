@@ -1,6 +1,10 @@
 #include "data_parser.hpp"
+#include "sale_rows.hpp"
 #include <gtest/gtest.h>
 
+#include <cstdio>
+#include <limits>
+
 using namespace car_sales;
 
 class CsvParserTest : public ::testing::Test {
@@ -220,6 +224,34 @@ TEST_F(CsvParserTest, ProcessorFailure) {
   EXPECT_FALSE(result.success);
 }
 
+TEST_F(CsvParserTest, ChunksReuseRecordSlots) {
+  // Rejected rows give their slot to the next row; full chunks are handed
+  // over in the same storage every time
+  CsvParser small_chunk_parser(2, '\t');
+  std::string csv = SaleRow::header() + "\n";
+  for (const char *brand : {"Audi", "", "BMW", "Kia", "", "Seat", "Fiat", ""}) {
+    csv += SaleRow().brand(brand).line() + "\n";
+  }
+
+  std::vector<std::string> brands;
+  std::vector<const CarSaleRecord *> storage;
+  auto result = small_chunk_parser.parseString(
+      csv, [&](const std::vector<CarSaleRecord> &chunk, ChunkResult &) {
+        for (const auto &record : chunk) {
+          brands.push_back(record.brand);
+        }
+        storage.push_back(chunk.data());
+        return true;
+      });
+
+  EXPECT_TRUE(result.success);
+  EXPECT_EQ(result.records_failed, 3u);
+  EXPECT_EQ(brands, (std::vector<std::string>{"Audi", "BMW", "Kia", "Seat",
+                                              "Fiat"}));
+  ASSERT_EQ(storage.size(), 3u);
+  EXPECT_EQ(storage[0], storage[1]);
+}
+
 TEST_F(CsvParserTest, FileNotFound) {
   auto result = parser->parseFile(
       "/nonexistent/path/to/file.csv",
@@ -229,4 +261,130 @@ TEST_F(CsvParserTest, FileNotFound) {
   EXPECT_FALSE(result.errors.empty());
 }
 
+// ============================================================================
+// Concurrent Parsing Tests
+// ============================================================================
 
+TEST_F(CsvParserTest, ConcurrentMatchesSequential) {
+  std::string path = ::testing::TempDir() + "concurrent_parse.csv";
+  {
+    std::ofstream out(path);
+    out << "header\n";
+    for (int i = 0; i < 257; ++i) {
+      const char *country = i % 3 == 0 ? "China" : (i % 3 == 1 ? "Germany"
+                                                               : "France");
+      const char *brand = i % 2 == 0 ? "Audi" : "BMW";
+      out << createLine("15-01-2025", country, brand, 1000 + i) << "\n";
+      if (i % 50 == 0) {
+        out << "\n";            // empty lines are skipped
+        out << "broken line\n"; // counts as a failure
+      }
+    }
+  }
+
+  CsvParser sequential(10, '\t');
+  size_t sequential_rows = 0;
+  auto seq = sequential.parseFile(
+      path, [&](const std::vector<CarSaleRecord> &chunk, ChunkResult &) {
+        sequential_rows += chunk.size();
+        return true;
+      });
+
+  for (size_t threads : {1u, 3u, 8u}) {
+    CsvParser concurrent(10, '\t');
+    auto result = concurrent.parseFileConcurrent(path, threads);
+
+    EXPECT_TRUE(result.success);
+    EXPECT_EQ(result.records_processed, sequential_rows);
+    EXPECT_EQ(result.records_failed, seq.records_failed);
+    EXPECT_EQ(result.records_failed, 6u);
+    EXPECT_EQ(result.audi_china_year_sales, 43);
+    EXPECT_EQ(result.bmw_europe_revenue_cents.size(), 2u);
+  }
+
+  std::remove(path.c_str());
+}
+
+TEST_F(CsvParserTest, ConcurrentReusesParserAcrossRuns) {
+  std::string path = ::testing::TempDir() + "concurrent_reuse.csv";
+  {
+    std::ofstream out(path);
+    out << "header\n";
+    for (int i = 0; i < 40; ++i) {
+      out << createLine("15-01-2025", "Germany", "BMW", 100) << "\n";
+    }
+  }
+
+  CsvParser concurrent(8, '\t');
+  auto first = concurrent.parseFileConcurrent(path, 4);
+  auto second = concurrent.parseFileConcurrent(path, 4);
+
+  EXPECT_EQ(first.records_processed, 40u);
+  EXPECT_EQ(second.records_processed, 40u);
+  EXPECT_EQ(second.bmw_2025_revenue_cents, 400000);
+
+  std::remove(path.c_str());
+}
+
+TEST_F(CsvParserTest, RevenueCentsIdenticalAcrossThreadCounts) {
+  std::string path = ::testing::TempDir() + "concurrent_cents.csv";
+  int64_t expected_cents = 0;
+  {
+    std::ofstream out(path);
+    out << "header\n";
+    for (int i = 0; i < 1000; ++i) {
+      // Amounts like 0.10 + 0.20 that a double sum cannot represent exactly
+      int64_t cents = 10 + (i * 7919) % 100000;
+      expected_cents += cents;
+      out << createLine("15-01-2025", i % 2 ? "Germany" : "France", "BMW",
+                        static_cast<double>(cents) / 100.0)
+          << "\n";
+    }
+  }
+
+  for (size_t threads : {1u, 2u, 3u, 5u, 8u}) {
+    CsvParser concurrent(7, '\t');
+    auto result = concurrent.parseFileConcurrent(path, threads);
+    EXPECT_TRUE(result.success);
+    EXPECT_EQ(result.bmw_2025_revenue_cents, expected_cents)
+        << threads << " threads";
+    EXPECT_EQ(result.bmw_europe_revenue_cents["Germany"] +
+                  result.bmw_europe_revenue_cents["France"],
+              expected_cents);
+  }
+
+  std::remove(path.c_str());
+}
+
+TEST_F(CsvParserTest, ParseLineKeepsExactCents) {
+  auto result = parser->parseLine(createLine("15-01-2025", "China", "Audi",
+                                             19999.99));
+  ASSERT_TRUE(result.has_value());
+  EXPECT_EQ(result->revenue_cents, 1999999);
+  EXPECT_DOUBLE_EQ(result->revenue, 19999.99);
+}
+
+TEST_F(CsvParserTest, ChunkAnalysisFlagsRevenueOverflow) {
+  std::vector<CarSaleRecord> records(2, CarSaleRecord("BMW", "Germany", 2025,
+                                                      1, 0.0));
+  records[0].revenue_cents = MAX_PRICE_CENTS;
+  records[1].revenue_cents = MAX_PRICE_CENTS;
+
+  ChunkResult result;
+  result.bmw_2025_revenue_cents = std::numeric_limits<int64_t>::max() - 1;
+  CsvParser::processChunkAnalysis(records.data(),
+                                  records.data() + records.size(), result);
+  EXPECT_FALSE(result.success);
+  ASSERT_EQ(result.errors.size(), 1u);
+  EXPECT_EQ(result.bmw_2025_revenue_cents,
+            std::numeric_limits<int64_t>::max() - 1);
+}
+
+TEST_F(CsvParserTest, QuotedFieldsAreUnquoted) {
+  std::string line = createLine("15-01-2025", "\"United Kingdom\"", "BMW",
+                                75000);
+  auto result = parser->parseLine(line);
+
+  ASSERT_TRUE(result.has_value());
+  EXPECT_EQ(result->country, "United Kingdom");
+}
@@ -0,0 +1,86 @@
+#include "fixed_point.hpp"
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <limits>
+
+using namespace car_sales;
+
+TEST(FixedPointTest, ParsesWholeAndFractionalAmounts) {
+  int64_t cents = 0;
+  ASSERT_TRUE(parseCents("45000", cents));
+  EXPECT_EQ(cents, 4500000);
+  ASSERT_TRUE(parseCents("19999.99", cents));
+  EXPECT_EQ(cents, 1999999);
+  ASSERT_TRUE(parseCents("0.5", cents));
+  EXPECT_EQ(cents, 50);
+  ASSERT_TRUE(parseCents(".07", cents));
+  EXPECT_EQ(cents, 7);
+  ASSERT_TRUE(parseCents("12.", cents));
+  EXPECT_EQ(cents, 1200);
+}
+
+TEST(FixedPointTest, HandlesSigns) {
+  int64_t cents = 0;
+  ASSERT_TRUE(parseCents("+100.25", cents));
+  EXPECT_EQ(cents, 10025);
+  ASSERT_TRUE(parseCents("-100.25", cents));
+  EXPECT_EQ(cents, -10025);
+}
+
+TEST(FixedPointTest, RoundsHalfAwayFromZeroAtThirdDecimal) {
+  int64_t cents = 0;
+  ASSERT_TRUE(parseCents("45000.000000", cents));
+  EXPECT_EQ(cents, 4500000);
+  ASSERT_TRUE(parseCents("1.005", cents));
+  EXPECT_EQ(cents, 101);
+  ASSERT_TRUE(parseCents("1.0049999", cents));
+  EXPECT_EQ(cents, 100);
+  ASSERT_TRUE(parseCents("-1.005", cents));
+  EXPECT_EQ(cents, -101);
+  ASSERT_TRUE(parseCents("0.999", cents));
+  EXPECT_EQ(cents, 100);
+}
+
+TEST(FixedPointTest, RejectsMalformedInput) {
+  int64_t cents = 0;
+  EXPECT_FALSE(parseCents("", cents));
+  EXPECT_FALSE(parseCents("-", cents));
+  EXPECT_FALSE(parseCents(".", cents));
+  EXPECT_FALSE(parseCents("abc", cents));
+  EXPECT_FALSE(parseCents("1.2.3", cents));
+  EXPECT_FALSE(parseCents("12a", cents));
+  EXPECT_FALSE(parseCents("1e5", cents));
+}
+
+TEST(FixedPointTest, RejectsAmountsAboveLimit) {
+  int64_t cents = 0;
+  EXPECT_TRUE(parseCents("10000000000", cents));
+  EXPECT_EQ(cents, MAX_PRICE_CENTS);
+  EXPECT_FALSE(parseCents("10000000000.01", cents));
+  EXPECT_FALSE(parseCents("99999999999999999999999", cents));
+}
+
+TEST(FixedPointTest, AddDetectsOverflow) {
+  int64_t total = std::numeric_limits<int64_t>::max() - 5;
+  EXPECT_TRUE(addCents(total, 5));
+  EXPECT_EQ(total, std::numeric_limits<int64_t>::max());
+  EXPECT_FALSE(addCents(total, 1));
+  EXPECT_EQ(total, std::numeric_limits<int64_t>::max());
+}
+
+TEST(FixedPointTest, FormatsExactly) {
+  EXPECT_EQ(formatCents(0), "0.00");
+  EXPECT_EQ(formatCents(7), "0.07");
+  EXPECT_EQ(formatCents(1999999), "19999.99");
+  EXPECT_EQ(formatCents(-10025), "-100.25");
+  // Beyond 2^53, where a double could no longer hold every cent
+  EXPECT_EQ(formatCents(9007199254740993LL), "90071992547409.93");
+  EXPECT_EQ(formatCents(std::numeric_limits<int64_t>::min()),
+            "-92233720368547758.08");
+}
+
+TEST(FixedPointTest, ConvertsToDollars) {
+  EXPECT_DOUBLE_EQ(centsToDollars(4500050), 45000.5);
+  EXPECT_DOUBLE_EQ(centsToDollars(-25), -0.25);
+}
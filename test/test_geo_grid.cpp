@@ -0,0 +1,167 @@
+#include "data_analyzer.hpp"
+#include "geo_grid.hpp"
+#include "sale_rows.hpp"
+#include <gtest/gtest.h>
+
+#include <cstdio>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+
+using namespace car_sales;
+
+namespace {
+
+std::string createLine(const std::string &lat, const std::string &lon,
+                       const std::string &brand, const std::string &price) {
+  return SaleRow()
+      .latitude(lat)
+      .longitude(lon)
+      .brand(brand)
+      .price(price)
+      .line();
+}
+
+} // namespace
+
+TEST(GeoGridTest, ParsesCoordinatesAndBoxes) {
+  double value = 0.0;
+  EXPECT_TRUE(parseCoordinate("-33.8688", 90.0, value));
+  EXPECT_DOUBLE_EQ(value, -33.8688);
+  EXPECT_TRUE(parseCoordinate("+151.2", 180.0, value));
+  EXPECT_FALSE(parseCoordinate("91", 90.0, value));
+  EXPECT_FALSE(parseCoordinate("12.5x", 90.0, value));
+  EXPECT_FALSE(parseCoordinate("", 90.0, value));
+
+  BoundingBox box;
+  ASSERT_TRUE(parseBoundingBox("35,-10,60,30", box));
+  EXPECT_TRUE(box.contains(48.1, 11.6));  // Munich
+  EXPECT_FALSE(box.contains(40.7, -74.0)); // New York
+  EXPECT_TRUE(box.contains(35.0, 30.0));   // edges are inside
+  EXPECT_FALSE(parseBoundingBox("60,-10,35,30", box)); // min above max
+  EXPECT_FALSE(parseBoundingBox("35,-10,60", box));
+  EXPECT_FALSE(parseBoundingBox("35,-10,60,30,1", box));
+}
+
+TEST(GeoGridTest, MapsCoordinatesToCells) {
+  EXPECT_THROW(GeoGrid(0.0), std::invalid_argument);
+  EXPECT_THROW(GeoGrid(100.0), std::invalid_argument);
+
+  GeoGrid grid(10.0); // 18 rows by 36 columns
+  double lat[] = {-90.0, -89.9, 0.0, 89.9, 90.0, 48.1};
+  double lon[] = {-180.0, 179.9, 0.0, -180.0, 180.0, 11.6};
+  uint32_t cells[6];
+  grid.cellsOf(lat, lon, 6, cells);
+  EXPECT_EQ(cells[0], 0u);
+  EXPECT_EQ(cells[1], 35u);
+  EXPECT_EQ(cells[2], 9u * 36u + 18u);
+  EXPECT_EQ(cells[3], 17u * 36u);
+  EXPECT_EQ(cells[4], 17u * 36u + 35u); // +90/+180 fold into the last cell
+  EXPECT_EQ(cells[5], 13u * 36u + 19u);
+
+  grid.add(cells[5], 1, 1000);
+  grid.add(cells[5], 2, 500);
+  grid.add(cells[0], 1, 10);
+  auto occupied = grid.cells();
+  ASSERT_EQ(occupied.size(), 2u);
+  EXPECT_EQ(occupied[0].cell, 0u);
+  EXPECT_DOUBLE_EQ(occupied[1].lat, 40.0);
+  EXPECT_DOUBLE_EQ(occupied[1].lon, 10.0);
+  EXPECT_EQ(occupied[1].units, 3);
+  EXPECT_EQ(occupied[1].revenue_cents, 1500);
+}
+
+TEST(GeoGridTest, MergeAddsMatchingCells) {
+  GeoGrid left(1.0);
+  GeoGrid right(1.0);
+  left.add(7, 1, 100);
+  right.add(7, 2, 50);
+  right.add(9, 1, 1);
+  right.addUnlocated();
+  left.merge(right);
+  auto cells = left.cells();
+  ASSERT_EQ(cells.size(), 2u);
+  EXPECT_EQ(cells[0].units, 3);
+  EXPECT_EQ(cells[0].revenue_cents, 150);
+  EXPECT_EQ(left.unlocatedRows(), 1);
+
+  GeoGrid disabled;
+  disabled.merge(left);
+  EXPECT_TRUE(disabled.enabled());
+  EXPECT_EQ(disabled.occupiedCells(), 2u);
+  EXPECT_THROW(left.merge(GeoGrid(2.0)), std::invalid_argument);
+}
+
+TEST(GeoGridTest, AnalyzerGridSameForAllThreadCounts) {
+  std::string content = "header\n";
+  for (int i = 0; i < 2000; ++i) {
+    std::string lat = std::to_string(-60.0 + (i * 37) % 1200 / 10.0);
+    std::string lon = std::to_string(-170.0 + (i * 53) % 3400 / 10.0);
+    content += createLine(lat, lon, i % 2 ? "BMW" : "Audi",
+                          std::to_string(1000 + i % 300) + ".50") +
+               "\n";
+  }
+  content += createLine("n/a", "0.0", "BMW", "10.00") + "\n";
+
+  std::string path = ::testing::TempDir() + "geo_grid.csv";
+  {
+    std::ofstream out(path);
+    out << content;
+  }
+
+  CarSalesAnalyzer sequential(100);
+  sequential.setGeoGrid(5.0);
+  auto expected = sequential.analyzeFile(path, false);
+  EXPECT_DOUBLE_EQ(expected.geo_cell_degrees, 5.0);
+  EXPECT_EQ(expected.unlocated_rows, 1);
+  EXPECT_EQ(expected.total_records_processed, 2001u);
+  int64_t units = 0;
+  for (const auto &cell : expected.geo_cells) {
+    units += cell.units;
+  }
+  EXPECT_EQ(units, 2000);
+
+  for (size_t threads : {1u, 2u, 3u, 5u}) {
+    CarSalesAnalyzer analyzer(100);
+    analyzer.setGeoGrid(5.0);
+    auto result = analyzer.analyzeFile(path, true, threads);
+    ASSERT_EQ(result.geo_cells.size(), expected.geo_cells.size());
+    for (size_t i = 0; i < result.geo_cells.size(); ++i) {
+      EXPECT_EQ(result.geo_cells[i].cell, expected.geo_cells[i].cell);
+      EXPECT_EQ(result.geo_cells[i].units, expected.geo_cells[i].units);
+      EXPECT_EQ(result.geo_cells[i].revenue_cents,
+                expected.geo_cells[i].revenue_cents);
+    }
+    EXPECT_EQ(result.unlocated_rows, 1);
+  }
+  std::remove(path.c_str());
+}
+
+TEST(GeoGridTest, BoundingBoxDropsRowsBeforeParsing) {
+  std::string content = "header\n";
+  content += createLine("48.1", "11.6", "BMW", "100.00") + "\n";  // inside
+  content += createLine("40.7", "-74.0", "BMW", "200.00") + "\n"; // outside
+  content += createLine("n/a", "0.0", "BMW", "300.00") + "\n";    // unlocated
+  // Outside the box, so its bad price is never looked at
+  content += createLine("-33.9", "151.2", "BMW", "not-a-price") + "\n";
+  content += createLine("52.5", "13.4", "BMW", "not-a-price") + "\n";
+
+  std::string path = ::testing::TempDir() + "geo_bbox.csv";
+  {
+    std::ofstream out(path);
+    out << content;
+  }
+
+  BoundingBox box;
+  ASSERT_TRUE(parseBoundingBox("35,-10,60,30", box));
+  for (bool concurrent : {false, true}) {
+    CarSalesAnalyzer analyzer(100);
+    analyzer.setBoundingBox(box);
+    AnalysisResult result = analyzer.analyzeFile(path, concurrent, 2);
+    EXPECT_EQ(result.total_records_processed, 1u);
+    EXPECT_EQ(result.total_records_failed, 1u);
+    EXPECT_EQ(result.total_records_filtered, 3u);
+    EXPECT_EQ(result.bmw_year_total_revenue_cents, 10000);
+  }
+  std::remove(path.c_str());
+}
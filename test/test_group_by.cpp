@@ -0,0 +1,147 @@
+#include "data_analyzer.hpp"
+#include "group_by.hpp"
+#include "sale_rows.hpp"
+#include <gtest/gtest.h>
+
+#include <cstdio>
+#include <fstream>
+#include <map>
+
+using namespace car_sales;
+
+class GroupByTest : public ::testing::Test {
+protected:
+  std::string createLine(const std::string &dealership,
+                         const std::string &buyer, int64_t cents) {
+    return SaleRow()
+        .dealership(dealership)
+        .buyer(buyer)
+        .priceCents(cents)
+        .line();
+  }
+};
+
+TEST_F(GroupByTest, ColumnNamesRoundTrip) {
+  for (GroupColumn column :
+       {GroupColumn::Country, GroupColumn::Manufacturer, GroupColumn::Model,
+        GroupColumn::DealershipId, GroupColumn::SalespersonId,
+        GroupColumn::BuyerId, GroupColumn::Vin}) {
+    GroupColumn parsed = GroupColumn::None;
+    ASSERT_TRUE(parseGroupColumn(groupColumnName(column), parsed));
+    EXPECT_EQ(parsed, column);
+    EXPECT_GE(groupColumnIndex(column), 0);
+  }
+  GroupColumn parsed = GroupColumn::None;
+  EXPECT_FALSE(parseGroupColumn("sale_price_usd", parsed));
+  EXPECT_EQ(groupColumnIndex(GroupColumn::None), -1);
+  EXPECT_EQ(groupColumnIndex(GroupColumn::DealershipId), 6);
+  EXPECT_EQ(groupColumnIndex(GroupColumn::BuyerId), 25);
+}
+
+TEST_F(GroupByTest, KeyAlwaysLandsInSamePartition) {
+  GroupByAggregator first;
+  GroupByAggregator second;
+  first.enable();
+  second.enable();
+  for (int i = 0; i < 2000; ++i) {
+    first.add("K" + std::to_string(i), 1, i);
+    second.add("K" + std::to_string(1999 - i), 1, 1999 - i);
+  }
+  for (size_t p = 0; p < GROUP_PARTITIONS; ++p) {
+    EXPECT_EQ(first.partition(p).size(), second.partition(p).size());
+  }
+  EXPECT_EQ(first.distinctKeys(), 2000u);
+}
+
+TEST_F(GroupByTest, TopOrdersByRevenueThenKey) {
+  GroupByAggregator groups;
+  groups.enable();
+  groups.add("b", 1, 500);
+  groups.add("a", 1, 500);
+  groups.add("c", 1, 900);
+  groups.add("d", 1, 100);
+  groups.add("d", 1, 100);
+
+  auto top = groups.top(3);
+  ASSERT_EQ(top.size(), 3u);
+  EXPECT_EQ(top[0].key, "c");
+  EXPECT_EQ(top[1].key, "a");
+  EXPECT_EQ(top[2].key, "b");
+
+  auto all = groups.top(100);
+  ASSERT_EQ(all.size(), 4u);
+  EXPECT_EQ(all[3].key, "d");
+  EXPECT_EQ(all[3].count, 2);
+  EXPECT_EQ(all[3].revenue_cents, 200);
+}
+
+TEST_F(GroupByTest, ConcurrentMatchesSequential) {
+  std::string path = ::testing::TempDir() + "group_by.csv";
+  std::map<std::string, std::pair<int64_t, int64_t>> expected;
+  {
+    std::ofstream out(path);
+    out << "header\n";
+    for (int i = 0; i < 6000; ++i) {
+      std::string dealer = "D" + std::to_string(i * 7 % 1700);
+      int64_t cents = 100000 + (i * 131) % 9973;
+      expected[dealer].first += 1;
+      expected[dealer].second += cents;
+      out << createLine(dealer, "B" + std::to_string(i), cents) << "\n";
+    }
+  }
+
+  CarSalesAnalyzer sequential(64);
+  sequential.setGroupBy(GroupColumn::DealershipId);
+  sequential.setGroupByLimit(5000);
+  auto seq = sequential.analyzeFile(path, false);
+  ASSERT_EQ(seq.group_count, expected.size());
+  ASSERT_EQ(seq.top_groups.size(), expected.size());
+  for (const auto &group : seq.top_groups) {
+    EXPECT_EQ(group.count, expected[group.key].first);
+    EXPECT_EQ(group.revenue_cents, expected[group.key].second);
+  }
+
+  for (size_t threads : {1u, 2u, 3u, 8u}) {
+    CarSalesAnalyzer concurrent(64);
+    concurrent.setGroupBy(GroupColumn::DealershipId);
+    concurrent.setGroupByLimit(5000);
+    auto result = concurrent.analyzeFile(path, true, threads);
+    EXPECT_EQ(result.group_by_column, GroupColumn::DealershipId);
+    ASSERT_EQ(result.group_count, seq.group_count) << threads << " threads";
+    ASSERT_EQ(result.top_groups.size(), seq.top_groups.size());
+    for (size_t i = 0; i < seq.top_groups.size(); ++i) {
+      EXPECT_EQ(result.top_groups[i].key, seq.top_groups[i].key);
+      EXPECT_EQ(result.top_groups[i].count, seq.top_groups[i].count);
+      EXPECT_EQ(result.top_groups[i].revenue_cents,
+                seq.top_groups[i].revenue_cents);
+    }
+  }
+
+  std::remove(path.c_str());
+}
+
+TEST_F(GroupByTest, MissingColumnGroupsUnderEmptyKey) {
+  // Only 21 fields: enough for a valid row, but no buyer_id column
+  std::string line = createLine("D1", "B1", 100);
+  size_t cut = 0;
+  for (int tabs = 0; tabs < 21; ++tabs) {
+    cut = line.find('\t', cut) + 1;
+  }
+  std::string csv = "header\n" + line.substr(0, cut - 1) + "\n";
+
+  CarSalesAnalyzer analyzer;
+  analyzer.setGroupBy(GroupColumn::BuyerId);
+  auto result = analyzer.analyzeString(csv);
+  ASSERT_EQ(result.top_groups.size(), 1u);
+  EXPECT_EQ(result.top_groups[0].key, "");
+  EXPECT_EQ(result.top_groups[0].revenue_cents, 100);
+}
+
+TEST_F(GroupByTest, DisabledByDefault) {
+  CarSalesAnalyzer analyzer;
+  auto result =
+      analyzer.analyzeString("header\n" + createLine("D1", "B1", 100) + "\n");
+  EXPECT_EQ(result.group_by_column, GroupColumn::None);
+  EXPECT_TRUE(result.top_groups.empty());
+  EXPECT_EQ(result.group_count, 0u);
+}
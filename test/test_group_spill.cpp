@@ -0,0 +1,185 @@
+#include "data_analyzer.hpp"
+#include "group_spill.hpp"
+#include "sale_rows.hpp"
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <memory>
+#include <string>
+
+using namespace car_sales;
+
+class GroupSpillTest : public ::testing::Test {
+protected:
+  std::string writeFile(const std::string &name, int rows, int distinct) {
+    std::string path = ::testing::TempDir() + name;
+    std::ofstream out(path);
+    out << "header\n";
+    for (int i = 0; i < rows; ++i) {
+      out << SaleRow()
+                 .vin("VIN" + std::to_string(i % distinct))
+                 .priceCents(1000 + i % 977)
+                 .line()
+          << "\n";
+    }
+    return path;
+  }
+
+  static void expectSameGroups(const AnalysisResult &a,
+                               const AnalysisResult &b) {
+    EXPECT_EQ(a.group_count, b.group_count);
+    ASSERT_EQ(a.top_groups.size(), b.top_groups.size());
+    for (size_t i = 0; i < a.top_groups.size(); ++i) {
+      EXPECT_EQ(a.top_groups[i].key, b.top_groups[i].key);
+      EXPECT_EQ(a.top_groups[i].count, b.top_groups[i].count);
+      EXPECT_EQ(a.top_groups[i].revenue_cents, b.top_groups[i].revenue_cents);
+    }
+  }
+};
+
+TEST_F(GroupSpillTest, RoundTripsAndReaggregates) {
+  GroupSpill spill;
+  AggHashTable first;
+  first.add("short", 1, 100);
+  first.add("a-key-longer-than-inline", 2, 250);
+  AggHashTable second;
+  second.add("short", 3, 50);
+  second.add("", 1, 7);
+
+  spill.write(5, first);
+  spill.write(5, second);
+  EXPECT_EQ(spill.spillCount(), 2u);
+  EXPECT_GT(spill.bytesWritten(), 0u);
+
+  AggHashTable merged;
+  merged.add("short", 1, 1);
+  spill.readInto(5, merged);
+  EXPECT_EQ(merged.size(), 3u);
+
+  AggHashTable::Entry entry;
+  ASSERT_TRUE(merged.find("short", entry));
+  EXPECT_EQ(entry.count, 5);
+  EXPECT_EQ(entry.revenue_cents, 151);
+  ASSERT_TRUE(merged.find("a-key-longer-than-inline", entry));
+  EXPECT_EQ(entry.revenue_cents, 250);
+  ASSERT_TRUE(merged.find("", entry));
+  EXPECT_EQ(entry.count, 1);
+
+  AggHashTable untouched;
+  spill.readInto(6, untouched);
+  EXPECT_TRUE(untouched.empty());
+}
+
+TEST_F(GroupSpillTest, HandlesRecordsLargerThanReadBlock) {
+  GroupSpill spill;
+  AggHashTable table;
+  std::string huge(3 << 20, 'x');
+  table.add(huge, 1, 10);
+  table.add("tail", 1, 20);
+  spill.write(0, table);
+
+  AggHashTable merged;
+  spill.readInto(0, merged);
+  AggHashTable::Entry entry;
+  ASSERT_TRUE(merged.find(huge, entry));
+  EXPECT_EQ(entry.revenue_cents, 10);
+  ASSERT_TRUE(merged.find("tail", entry));
+}
+
+TEST_F(GroupSpillTest, ReportsUnusableDirectory) {
+  GroupSpill spill("/nonexistent/spill/dir");
+  AggHashTable table;
+  table.add("k", 1, 1);
+  EXPECT_THROW(spill.write(0, table), std::runtime_error);
+}
+
+TEST(ParseByteSizeTest, ParsesSuffixesAndRejectsBadSizes) {
+  size_t bytes = 0;
+  ASSERT_TRUE(parseByteSize("1048576", bytes));
+  EXPECT_EQ(bytes, 1048576u);
+  ASSERT_TRUE(parseByteSize("512K", bytes));
+  EXPECT_EQ(bytes, 512u << 10);
+  ASSERT_TRUE(parseByteSize("64m", bytes));
+  EXPECT_EQ(bytes, 64u << 20);
+  ASSERT_TRUE(parseByteSize("4G", bytes));
+  EXPECT_EQ(bytes, size_t(4) << 30);
+
+  bytes = 7;
+  // stoull would wrap these to ULLONG_MAX rather than fail
+  EXPECT_FALSE(parseByteSize("-1", bytes));
+  EXPECT_FALSE(parseByteSize(" -1", bytes));
+  EXPECT_FALSE(parseByteSize("+1", bytes));
+  // value * scale would overflow size_t
+  EXPECT_FALSE(parseByteSize(std::to_string(SIZE_MAX / 1024 + 1) + "K", bytes));
+  EXPECT_FALSE(parseByteSize("18446744073709551616", bytes));
+  EXPECT_FALSE(parseByteSize("0", bytes));
+  EXPECT_FALSE(parseByteSize("12T", bytes));
+  EXPECT_FALSE(parseByteSize("", bytes));
+  EXPECT_EQ(bytes, 7u);
+}
+
+TEST_F(GroupSpillTest, AggregatorSummaryMatchesInMemory) {
+  GroupByAggregator in_memory;
+  in_memory.enable();
+  GroupByAggregator bounded;
+  bounded.enable(4096, std::make_shared<GroupSpill>());
+
+  for (int i = 0; i < 20000; ++i) {
+    std::string key = "K" + std::to_string(i % 3001);
+    in_memory.add(key, 1, i);
+    bounded.add(key, 1, i);
+    if (i % 500 == 0) {
+      bounded.spillIfOverBudget();
+    }
+  }
+  ASSERT_TRUE(bounded.spilled());
+
+  GroupSummary expected = in_memory.summarize(25, 1);
+  for (size_t threads : {1u, 4u}) {
+    GroupSummary actual = bounded.summarize(25, threads);
+    EXPECT_EQ(actual.distinct_keys, 3001u);
+    EXPECT_EQ(actual.distinct_keys, expected.distinct_keys);
+    EXPECT_GT(actual.spilled_bytes, 0u);
+    ASSERT_EQ(actual.top.size(), expected.top.size());
+    for (size_t i = 0; i < expected.top.size(); ++i) {
+      EXPECT_EQ(actual.top[i].key, expected.top[i].key);
+      EXPECT_EQ(actual.top[i].count, expected.top[i].count);
+      EXPECT_EQ(actual.top[i].revenue_cents, expected.top[i].revenue_cents);
+    }
+  }
+}
+
+TEST_F(GroupSpillTest, BudgetedAnalysisMatchesUnbounded) {
+  std::string path = writeFile("spill_groups.csv", 8000, 5000);
+
+  CarSalesAnalyzer unbounded(100);
+  unbounded.setGroupBy(GroupColumn::Vin);
+  unbounded.setGroupByLimit(50);
+  auto expected = unbounded.analyzeFile(path, false);
+  EXPECT_EQ(expected.group_spill_bytes, 0u);
+  EXPECT_EQ(expected.group_count, 5000u);
+
+  CarSalesAnalyzer sequential(100);
+  sequential.setGroupBy(GroupColumn::Vin);
+  sequential.setGroupByLimit(50);
+  sequential.setMaxMemory(64 * 1024);
+  auto seq = sequential.analyzeFile(path, false);
+  EXPECT_TRUE(seq.analysis_complete);
+  EXPECT_GT(seq.group_spill_bytes, 0u);
+  expectSameGroups(seq, expected);
+
+  for (size_t threads : {1u, 3u}) {
+    CarSalesAnalyzer concurrent(100);
+    concurrent.setGroupBy(GroupColumn::Vin);
+    concurrent.setGroupByLimit(50);
+    concurrent.setMaxMemory(64 * 1024);
+    auto result = concurrent.analyzeFile(path, true, threads);
+    EXPECT_TRUE(result.analysis_complete);
+    EXPECT_GT(result.group_spill_bytes, 0u);
+    expectSameGroups(result, expected);
+  }
+
+  std::remove(path.c_str());
+}
@@ -0,0 +1,183 @@
+#include "data_analyzer.hpp"
+#include "heavy_hitters.hpp"
+#include "sale_rows.hpp"
+#include <gtest/gtest.h>
+
+#include <cstdio>
+#include <fstream>
+#include <map>
+#include <random>
+#include <string>
+
+using namespace car_sales;
+
+namespace {
+
+// Zipf-like stream: key i appears roughly proportionally to 1/(i+1)
+std::vector<std::string> skewedStream(size_t length, size_t keys,
+                                      unsigned seed) {
+  std::vector<double> weights;
+  for (size_t i = 0; i < keys; ++i) {
+    weights.push_back(1.0 / static_cast<double>(i + 1));
+  }
+  std::mt19937 rng(seed);
+  std::discrete_distribution<size_t> pick(weights.begin(), weights.end());
+  std::vector<std::string> stream;
+  for (size_t i = 0; i < length; ++i) {
+    stream.push_back("D" + std::to_string(pick(rng)));
+  }
+  return stream;
+}
+
+void expectWithinBounds(const SpaceSavingSketch &sketch,
+                        const std::map<std::string, int64_t> &truth) {
+  int64_t bound = sketch.totalWeight() / static_cast<int64_t>(sketch.capacity());
+  for (const HeavyHitter &hitter : sketch.top(sketch.capacity())) {
+    auto it = truth.find(hitter.key);
+    int64_t actual = it == truth.end() ? 0 : it->second;
+    EXPECT_GE(hitter.estimate, actual) << hitter.key;
+    EXPECT_LE(hitter.guaranteed(), actual) << hitter.key;
+    EXPECT_LE(hitter.error, bound) << hitter.key;
+  }
+  // Every key heavier than N/k must be reported
+  std::vector<HeavyHitter> reported = sketch.top(sketch.capacity());
+  for (const auto &[key, weight] : truth) {
+    if (weight > bound) {
+      bool found = false;
+      for (const HeavyHitter &hitter : reported) {
+        found = found || hitter.key == key;
+      }
+      EXPECT_TRUE(found) << key;
+    }
+  }
+}
+
+} // namespace
+
+TEST(HeavyHittersTest, ExactBelowCapacity) {
+  SpaceSavingSketch sketch(8);
+  sketch.add("a", 5);
+  sketch.add("b", 2);
+  sketch.add("a", 1);
+  sketch.add("c", 9);
+
+  EXPECT_EQ(sketch.maxError(), 0);
+  EXPECT_EQ(sketch.totalWeight(), 17);
+  auto top = sketch.top(10);
+  ASSERT_EQ(top.size(), 3u);
+  EXPECT_EQ(top[0].key, "c");
+  EXPECT_EQ(top[1].key, "a");
+  EXPECT_EQ(top[1].estimate, 6);
+  EXPECT_EQ(top[1].error, 0);
+  EXPECT_EQ(top[2].key, "b");
+}
+
+TEST(HeavyHittersTest, EvictionKeepsBoundsOnSkewedStream) {
+  SpaceSavingSketch sketch(64);
+  std::map<std::string, int64_t> truth;
+  for (const std::string &key : skewedStream(50000, 5000, 7)) {
+    sketch.add(key, 1);
+    truth[key] += 1;
+  }
+  EXPECT_EQ(sketch.size(), 64u);
+  EXPECT_GT(sketch.maxError(), 0);
+  expectWithinBounds(sketch, truth);
+
+  // The true heaviest key is ranked first
+  EXPECT_EQ(sketch.top(1)[0].key, "D0");
+}
+
+TEST(HeavyHittersTest, WeightedByRevenue) {
+  SpaceSavingSketch sketch(2);
+  sketch.add("cheap", 100);
+  sketch.add("cheap", 100);
+  sketch.add("cheap", 100);
+  sketch.add("pricey", 100000);
+  sketch.add("other", 50);
+  auto top = sketch.top(1);
+  ASSERT_EQ(top.size(), 1u);
+  EXPECT_EQ(top[0].key, "pricey");
+  EXPECT_EQ(top[0].estimate, 100000);
+}
+
+TEST(HeavyHittersTest, MergeKeepsBounds) {
+  std::vector<std::string> stream = skewedStream(60000, 4000, 11);
+  std::map<std::string, int64_t> truth;
+  std::vector<SpaceSavingSketch> parts(4, SpaceSavingSketch(48));
+  for (size_t i = 0; i < stream.size(); ++i) {
+    // Different parts see differently ordered, uneven slices
+    parts[(i * 7 / 1000) % parts.size()].add(stream[i], 1);
+    truth[stream[i]] += 1;
+  }
+
+  SpaceSavingSketch merged;
+  for (const SpaceSavingSketch &part : parts) {
+    merged.merge(part);
+  }
+  EXPECT_EQ(merged.totalWeight(), static_cast<int64_t>(stream.size()));
+  EXPECT_LE(merged.size(), 48u);
+  expectWithinBounds(merged, truth);
+}
+
+TEST(HeavyHittersTest, DisabledSketchIgnoresInput) {
+  SpaceSavingSketch sketch;
+  sketch.add("a", 1);
+  EXPECT_FALSE(sketch.enabled());
+  EXPECT_EQ(sketch.totalWeight(), 0);
+  EXPECT_TRUE(sketch.top(5).empty());
+}
+
+TEST(HeavyHittersTest, MetricNamesRoundTrip) {
+  HeavyHitterMetric metric = HeavyHitterMetric::Units;
+  ASSERT_TRUE(parseHeavyHitterMetric("revenue", metric));
+  EXPECT_EQ(metric, HeavyHitterMetric::Revenue);
+  EXPECT_STREQ(heavyHitterMetricName(metric), "revenue");
+  EXPECT_FALSE(parseHeavyHitterMetric("profit", metric));
+}
+
+TEST(HeavyHittersTest, AnalyzerReportsDealersAcrossThreadCounts) {
+  std::string path = ::testing::TempDir() + "heavy_hitters.csv";
+  std::map<std::string, int64_t> truth;
+  {
+    std::ofstream out(path);
+    out << "header\n";
+    for (const std::string &dealer : skewedStream(6000, 800, 3)) {
+      truth[dealer] += 1;
+      out << SaleRow().dealership(dealer).line() << "\n";
+    }
+  }
+
+  std::vector<HeavyHitter> first;
+  for (size_t threads : {1u, 2u, 4u}) {
+    CarSalesAnalyzer analyzer(100);
+    analyzer.setHeavyHitters(GroupColumn::DealershipId,
+                             HeavyHitterMetric::Units, 32);
+    analyzer.setGroupByLimit(5);
+    auto result = analyzer.analyzeFile(path, true, threads);
+
+    EXPECT_EQ(result.heavy_hitter_column, GroupColumn::DealershipId);
+    EXPECT_EQ(result.heavy_hitter_total, 6000);
+    ASSERT_EQ(result.heavy_hitters.size(), 5u);
+    EXPECT_EQ(result.heavy_hitters[0].key, "D0");
+    for (const HeavyHitter &hitter : result.heavy_hitters) {
+      EXPECT_GE(hitter.estimate, truth[hitter.key]);
+      EXPECT_LE(hitter.guaranteed(), truth[hitter.key]);
+      EXPECT_LE(hitter.error, result.heavy_hitter_max_error);
+    }
+  }
+
+  // Same input and thread count give the same answer
+  CarSalesAnalyzer a(100);
+  CarSalesAnalyzer b(100);
+  a.setHeavyHitters(GroupColumn::DealershipId, HeavyHitterMetric::Units, 32);
+  b.setHeavyHitters(GroupColumn::DealershipId, HeavyHitterMetric::Units, 32);
+  auto ra = a.analyzeFile(path, true, 3);
+  auto rb = b.analyzeFile(path, true, 3);
+  ASSERT_EQ(ra.heavy_hitters.size(), rb.heavy_hitters.size());
+  for (size_t i = 0; i < ra.heavy_hitters.size(); ++i) {
+    EXPECT_EQ(ra.heavy_hitters[i].key, rb.heavy_hitters[i].key);
+    EXPECT_EQ(ra.heavy_hitters[i].estimate, rb.heavy_hitters[i].estimate);
+  }
+
+  std::remove(path.c_str());
+}
@@ -0,0 +1,178 @@
+#include "data_analyzer.hpp"
+#include "hyperloglog.hpp"
+#include "sale_rows.hpp"
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <set>
+#include <stdexcept>
+#include <string>
+
+using namespace car_sales;
+
+namespace {
+
+double relativeDeviation(double estimate, double truth) {
+  return std::fabs(estimate - truth) / truth;
+}
+
+} // namespace
+
+TEST(HyperLogLogTest, EmptySketchEstimatesZero) {
+  HyperLogLog sketch;
+  EXPECT_EQ(sketch.precision(), HLL_DEFAULT_PRECISION);
+  EXPECT_EQ(sketch.registerCount(), 1u << HLL_DEFAULT_PRECISION);
+  EXPECT_DOUBLE_EQ(sketch.estimate(), 0.0);
+}
+
+TEST(HyperLogLogTest, DuplicatesAreNotCounted) {
+  HyperLogLog sketch(10);
+  for (int round = 0; round < 50; ++round) {
+    for (int i = 0; i < 100; ++i) {
+      sketch.add("B" + std::to_string(i));
+    }
+  }
+  EXPECT_LT(relativeDeviation(sketch.estimate(), 100.0), 0.05);
+}
+
+TEST(HyperLogLogTest, LargeCardinalityWithinErrorBound) {
+  for (unsigned precision : {8u, 12u, 14u}) {
+    HyperLogLog sketch(precision);
+    const int distinct = 200000;
+    for (int i = 0; i < distinct; ++i) {
+      sketch.add("VIN" + std::to_string(i));
+    }
+    // Four standard errors keeps the test far from flaky
+    EXPECT_LT(relativeDeviation(sketch.estimate(), distinct),
+              4.0 * sketch.relativeError())
+        << "precision " << precision;
+  }
+}
+
+TEST(HyperLogLogTest, MergeEqualsSketchOfUnion) {
+  HyperLogLog left(12);
+  HyperLogLog right(12);
+  HyperLogLog whole(12);
+  for (int i = 0; i < 30000; ++i) {
+    std::string key = "B" + std::to_string(i);
+    // Overlapping halves: [0, 20000) and [10000, 30000)
+    if (i < 20000) {
+      left.add(key);
+    }
+    if (i >= 10000) {
+      right.add(key);
+    }
+    whole.add(key);
+  }
+  left.merge(right);
+  EXPECT_DOUBLE_EQ(left.estimate(), whole.estimate());
+  EXPECT_LT(relativeDeviation(left.estimate(), 30000.0),
+            4.0 * left.relativeError());
+}
+
+TEST(HyperLogLogTest, RejectsBadPrecision) {
+  EXPECT_THROW(HyperLogLog(HLL_MIN_PRECISION - 1), std::invalid_argument);
+  EXPECT_THROW(HyperLogLog(HLL_MAX_PRECISION + 1), std::invalid_argument);
+
+  HyperLogLog a(10);
+  HyperLogLog b(11);
+  EXPECT_THROW(a.merge(b), std::invalid_argument);
+}
+
+TEST(HyperLogLogTest, CounterGroupsAndRollsUp) {
+  DistinctCounter counter(12);
+  // Buyers 0-99 bought in both Germany and France; 100-149 only in France
+  for (int i = 0; i < 150; ++i) {
+    uint64_t hash = hashBytes("B" + std::to_string(i));
+    if (i < 100) {
+      counter.add("BMW", "Germany", hash);
+    }
+    counter.add("BMW", "France", hash);
+  }
+  counter.add("Audi", "China", hashBytes("B1"));
+
+  auto groups = counter.groups();
+  ASSERT_EQ(groups.size(), 3u);
+  EXPECT_EQ(groups[0].country, "France");
+  EXPECT_NEAR(static_cast<double>(groups[0].estimate), 150.0, 3.0);
+  EXPECT_EQ(groups[1].country, "Germany");
+  EXPECT_NEAR(static_cast<double>(groups[1].estimate), 100.0, 2.0);
+  EXPECT_EQ(groups[2].brand, "Audi");
+
+  auto europe = counter.rollUp(
+      [](std::string_view country) { return country != "China"; }, "Europe");
+  ASSERT_EQ(europe.size(), 1u);
+  EXPECT_EQ(europe[0].brand, "BMW");
+  EXPECT_EQ(europe[0].country, "Europe");
+  // Germany's buyers are a subset of France's, so the union is France
+  EXPECT_EQ(europe[0].estimate, groups[0].estimate);
+}
+
+TEST(HyperLogLogTest, AnalyzerIdenticalAcrossThreadCounts) {
+  std::string path = ::testing::TempDir() + "hyperloglog.csv";
+  std::set<std::string> bmw_europe_buyers;
+  {
+    std::ofstream out(path);
+    out << "header\n";
+    const char *countries[] = {"Germany", "France", "China"};
+    for (int i = 0; i < 5000; ++i) {
+      std::string country = countries[i % 3];
+      std::string brand = i % 2 ? "BMW" : "Audi";
+      std::string buyer = "B" + std::to_string(i % 1700);
+      if (brand == "BMW" && country != "China") {
+        bmw_europe_buyers.insert(buyer);
+      }
+      out << SaleRow().country(country).brand(brand).buyer(buyer).line()
+          << "\n";
+    }
+  }
+
+  CarSalesAnalyzer sequential(100);
+  sequential.setDistinct(GroupColumn::BuyerId, 12);
+  auto expected = sequential.analyzeFile(path, false);
+  ASSERT_TRUE(expected.analysis_complete);
+  EXPECT_EQ(expected.distinct_column, GroupColumn::BuyerId);
+  EXPECT_EQ(expected.distinct_groups.size(), 6u);
+
+  const DistinctGroup *bmw = nullptr;
+  for (const auto &group : expected.distinct_europe) {
+    if (group.brand == "BMW") {
+      bmw = &group;
+    }
+  }
+  ASSERT_NE(bmw, nullptr);
+  EXPECT_LT(relativeDeviation(static_cast<double>(bmw->estimate),
+                              bmw_europe_buyers.size()),
+            4.0 * expected.distinct_relative_error);
+
+  // Register-wise max merges make the estimates exact across splits
+  for (size_t threads : {1u, 2u, 3u, 4u}) {
+    CarSalesAnalyzer analyzer(100);
+    analyzer.setDistinct(GroupColumn::BuyerId, 12);
+    auto result = analyzer.analyzeFile(path, true, threads);
+    ASSERT_EQ(result.distinct_groups.size(), expected.distinct_groups.size());
+    for (size_t i = 0; i < result.distinct_groups.size(); ++i) {
+      EXPECT_EQ(result.distinct_groups[i].brand,
+                expected.distinct_groups[i].brand);
+      EXPECT_EQ(result.distinct_groups[i].country,
+                expected.distinct_groups[i].country);
+      EXPECT_EQ(result.distinct_groups[i].estimate,
+                expected.distinct_groups[i].estimate);
+    }
+    ASSERT_EQ(result.distinct_europe.size(), expected.distinct_europe.size());
+    for (size_t i = 0; i < result.distinct_europe.size(); ++i) {
+      EXPECT_EQ(result.distinct_europe[i].estimate,
+                expected.distinct_europe[i].estimate);
+    }
+  }
+
+  // Disabled by default
+  CarSalesAnalyzer plain(100);
+  auto none = plain.analyzeFile(path, true, 2);
+  EXPECT_EQ(none.distinct_column, GroupColumn::None);
+  EXPECT_TRUE(none.distinct_groups.empty());
+
+  std::remove(path.c_str());
+}
@@ -0,0 +1,146 @@
+#include "data_parser.hpp"
+#include "numa_topology.hpp"
+#include "sale_rows.hpp"
+#include <gtest/gtest.h>
+
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <string>
+
+using namespace car_sales;
+
+namespace fs = std::filesystem;
+
+namespace {
+
+std::string createLine(const std::string &brand, const std::string &country,
+                       int64_t cents) {
+  return SaleRow().brand(brand).country(country).priceCents(cents).line();
+}
+
+} // namespace
+
+TEST(NumaTopologyTest, ParsesAndFormatsCpuLists) {
+  std::vector<int> cpus;
+  ASSERT_TRUE(parseCpuList("0-3,8,10-11\n", cpus));
+  EXPECT_EQ(cpus, (std::vector<int>{0, 1, 2, 3, 8, 10, 11}));
+  EXPECT_EQ(formatCpuList(cpus), "0-3,8,10-11");
+
+  ASSERT_TRUE(parseCpuList("", cpus));
+  EXPECT_TRUE(cpus.empty());
+  EXPECT_FALSE(parseCpuList("3-1", cpus));
+  EXPECT_FALSE(parseCpuList("0,,2", cpus));
+  EXPECT_FALSE(parseCpuList("a-b", cpus));
+}
+
+TEST(NumaTopologyTest, ParsesPlacementNames) {
+  WorkerPlacement placement = WorkerPlacement::None;
+  EXPECT_TRUE(parseWorkerPlacement("numa", placement));
+  EXPECT_EQ(placement, WorkerPlacement::Numa);
+  EXPECT_TRUE(parseWorkerPlacement("cores", placement));
+  EXPECT_STREQ(workerPlacementName(placement), "cores");
+  EXPECT_FALSE(parseWorkerPlacement("sockets", placement));
+}
+
+TEST(NumaTopologyTest, DiscoversNodesFromSysfs) {
+  std::string root = ::testing::TempDir() + "numa_sysfs";
+  fs::remove_all(root);
+  fs::create_directories(root + "/node0");
+  fs::create_directories(root + "/node3"); // memory-only node
+  fs::create_directories(root + "/power");
+  std::ofstream(root + "/node0/cpulist") << "0-4095\n";
+  std::ofstream(root + "/node0/meminfo") << "Node 0 MemTotal:  2097152 kB\n";
+  std::ofstream(root + "/node3/cpulist") << "\n";
+
+  NumaTopology topology = NumaTopology::discover(root);
+  ASSERT_EQ(topology.nodes().size(), 1u);
+  EXPECT_EQ(topology.nodes()[0].id, 0);
+  EXPECT_EQ(topology.nodes()[0].memory_bytes, uint64_t(2) << 30);
+  // Only CPUs this process may use are kept
+  EXPECT_GE(topology.cpuCount(), 1u);
+  EXPECT_LT(topology.cpuCount(), 4096u);
+  EXPECT_NE(topology.describe().find("node0 cpus"), std::string::npos);
+
+  // Without sysfs there is one node holding every allowed CPU
+  NumaTopology flat = NumaTopology::discover(root + "/missing");
+  ASSERT_EQ(flat.nodes().size(), 1u);
+  EXPECT_EQ(flat.cpuCount(), topology.cpuCount());
+}
+
+TEST(NumaTopologyTest, AssignsContiguousWorkersPerNode) {
+  NumaTopology topology({{0, {0, 1}, 0}, {1, {2, 3}, 0}});
+  EXPECT_EQ(topology.cpuCount(), 4u);
+
+  auto four = topology.assign(4);
+  ASSERT_EQ(four.size(), 4u);
+  for (size_t w = 0; w < 4; ++w) {
+    EXPECT_EQ(four[w].cpu, static_cast<int>(w));
+    EXPECT_EQ(four[w].node, w / 2);
+  }
+
+  auto two = topology.assign(2);
+  EXPECT_EQ(two[0].cpu, 0);
+  EXPECT_EQ(two[1].cpu, 2); // one worker per node
+
+  auto seven = topology.assign(7);
+  for (size_t w = 1; w < seven.size(); ++w) {
+    EXPECT_GE(seven[w].node, seven[w - 1].node);
+  }
+  EXPECT_EQ(seven.back().node, 1u);
+}
+
+TEST(NumaTopologyTest, PlacementsGiveIdenticalResults) {
+  std::string path = ::testing::TempDir() + "numa_placement.csv";
+  {
+    std::ofstream out(path);
+    out << "header\n";
+    for (int i = 0; i < 601; ++i) {
+      const char *country = i % 3 == 0 ? "China" : (i % 3 == 1 ? "Germany"
+                                                               : "France");
+      out << createLine(i % 2 ? "BMW" : "Audi", country, 1000 + i * 37)
+          << "\n";
+      if (i % 97 == 0) {
+        out << "broken line\n";
+      }
+    }
+  }
+
+  // Two "nodes" sharing the one CPU every sandbox has
+  int cpu = NumaTopology::discover().nodes()[0].cpus[0];
+  NumaTopology two_nodes({{0, {cpu}, 0}, {1, {cpu}, 0}});
+
+  CsvParser baseline(16, '\t');
+  baseline.setGroupBy(GroupColumn::Country);
+  ChunkResult expected = baseline.parseFileConcurrent(path, 5);
+  ASSERT_TRUE(expected.success);
+
+  for (WorkerPlacement placement :
+       {WorkerPlacement::Cores, WorkerPlacement::Numa}) {
+    CsvParser parser(16, '\t');
+    parser.setGroupBy(GroupColumn::Country);
+    parser.setTopology(two_nodes);
+    parser.setWorkerPlacement(placement);
+    for (size_t threads : {1u, 2u, 5u}) {
+      ChunkResult result = parser.parseFileConcurrent(path, threads);
+      SCOPED_TRACE(std::string(workerPlacementName(placement)) + " " +
+                   std::to_string(threads) + " threads");
+      EXPECT_TRUE(result.success);
+      EXPECT_EQ(result.records_processed, expected.records_processed);
+      EXPECT_EQ(result.records_failed, 7u);
+      EXPECT_EQ(result.audi_china_year_sales, expected.audi_china_year_sales);
+      EXPECT_EQ(result.bmw_2025_revenue_cents, expected.bmw_2025_revenue_cents);
+      EXPECT_EQ(result.bmw_europe_revenue_cents,
+                expected.bmw_europe_revenue_cents);
+      EXPECT_EQ(result.group_by.summarize(10, 1).top.size(), 3u);
+      ASSERT_EQ(result.parse_errors.size(), expected.parse_errors.size());
+      for (size_t e = 0; e < result.parse_errors.size(); ++e) {
+        EXPECT_EQ(result.parse_errors[e].line, expected.parse_errors[e].line);
+        EXPECT_EQ(result.parse_errors[e].byte_offset,
+                  expected.parse_errors[e].byte_offset);
+      }
+    }
+  }
+
+  std::remove(path.c_str());
+}
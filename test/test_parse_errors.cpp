@@ -0,0 +1,188 @@
+#include "data_parser.hpp"
+#include "parse_error.hpp"
+#include "reject_writer.hpp"
+#include "sale_rows.hpp"
+#include <gtest/gtest.h>
+
+#include <cstdio>
+#include <fstream>
+
+using namespace car_sales;
+
+class ParseErrorTest : public ::testing::Test {
+protected:
+  std::string createLine(const std::string &sale_date,
+                         const std::string &country,
+                         const std::string &manufacturer,
+                         const std::string &sale_price) {
+    return SaleRow()
+        .date(sale_date)
+        .country(country)
+        .brand(manufacturer)
+        .price(sale_price)
+        .line();
+  }
+
+  static auto acceptAll() {
+    return [](const std::vector<CarSaleRecord> &, ChunkResult &) {
+      return true;
+    };
+  }
+};
+
+// ============================================================================
+// Error Record Tests
+// ============================================================================
+
+TEST_F(ParseErrorTest, FormatIncludesLocationAndReason) {
+  ParseError error(1234, 17, ParseErrorCode::InvalidPrice);
+
+  EXPECT_EQ(error.column, 21u);
+  EXPECT_EQ(formatParseError(error),
+            "Failed to parse line 17, column 21 (byte 1234): "
+            "invalid sale_price_usd");
+}
+
+TEST_F(ParseErrorTest, FormatWithoutLineNumber) {
+  ParseError error(99, 0, ParseErrorCode::TooFewFields);
+
+  EXPECT_EQ(formatParseError(error),
+            "Failed to parse row (byte 99): too few fields");
+}
+
+TEST_F(ParseErrorTest, SequentialParseRecordsCodesLinesAndOffsets) {
+  CsvParser parser(10, '\t');
+  std::string header = "header";
+  std::string good = createLine("15-01-2025", "China", "Audi", "45000");
+  std::string bad_price = createLine("15-01-2025", "China", "Audi", "n/a");
+  std::string bad_year = createLine("15-01-1800", "China", "Audi", "45000");
+  std::string csv = header + "\n" + good + "\n" + bad_price + "\n" +
+                    "short\tline\n" + bad_year + "\n";
+
+  auto result = parser.parseString(csv, acceptAll());
+
+  EXPECT_EQ(result.records_processed, 1u);
+  EXPECT_EQ(result.records_failed, 3u);
+  ASSERT_EQ(result.parse_errors.size(), 3u);
+
+  EXPECT_EQ(result.parse_errors[0].code, ParseErrorCode::InvalidPrice);
+  EXPECT_EQ(result.parse_errors[0].line, 3u);
+  EXPECT_EQ(result.parse_errors[0].byte_offset,
+            header.size() + 1 + good.size() + 1);
+
+  EXPECT_EQ(result.parse_errors[1].code, ParseErrorCode::TooFewFields);
+  EXPECT_EQ(result.parse_errors[1].line, 4u);
+
+  EXPECT_EQ(result.parse_errors[2].code, ParseErrorCode::YearOutOfRange);
+  EXPECT_EQ(result.parse_errors[2].column, 2u);
+}
+
+// ============================================================================
+// Reject File Tests
+// ============================================================================
+
+TEST_F(ParseErrorTest, WriterStreamsBlocksInOrder) {
+  std::string path = ::testing::TempDir() + "reject_writer.tsv";
+  {
+    RejectFileWriter writer(path);
+    ASSERT_TRUE(writer.isOpen());
+    RejectBuffer buffer(&writer);
+    buffer.add("first");
+    buffer.add("second");
+    buffer.flush();
+    EXPECT_TRUE(writer.close());
+    EXPECT_EQ(writer.rowsWritten(), 2u);
+  }
+
+  EXPECT_EQ(readWholeFile(path), "first\nsecond\n");
+  std::remove(path.c_str());
+}
+
+TEST_F(ParseErrorTest, UnopenableWriterIgnoresInput) {
+  RejectFileWriter writer("/nonexistent/dir/rejects.tsv");
+  EXPECT_FALSE(writer.isOpen());
+
+  RejectBuffer buffer(&writer);
+  buffer.add("ignored");
+  buffer.flush();
+  EXPECT_TRUE(writer.close());
+}
+
+TEST_F(ParseErrorTest, ConcurrentParseWritesEveryRejectedLine) {
+  std::string input = ::testing::TempDir() + "reject_input.tsv";
+  std::string rejects = ::testing::TempDir() + "reject_output.tsv";
+
+  std::string bad = createLine("15-01-2025", "", "Audi", "45000");
+  {
+    std::ofstream out(input);
+    out << "header\n";
+    for (int i = 0; i < 300; ++i) {
+      out << (i % 7 == 0 ? bad : createLine("15-01-2025", "China", "Audi",
+                                            "45000"))
+          << "\n";
+    }
+  }
+
+  CsvParser parser(16, '\t');
+  parser.setRejectFile(rejects);
+  auto result = parser.parseFileConcurrent(input, 4);
+
+  EXPECT_EQ(result.records_failed, 43u);
+  ASSERT_EQ(result.parse_errors.size(), 43u);
+  for (const auto &error : result.parse_errors) {
+    EXPECT_EQ(error.code, ParseErrorCode::MissingCountry);
+  }
+
+  std::string written = readWholeFile(rejects);
+  EXPECT_EQ(written.rfind("header\n", 0), 0u); // header comes first
+  size_t rows = 0;
+  for (size_t pos = 0; (pos = written.find(bad, pos)) != std::string::npos;
+       pos += bad.size()) {
+    ++rows;
+  }
+  EXPECT_EQ(rows, 43u);
+
+  std::remove(input.c_str());
+  std::remove(rejects.c_str());
+}
+
+// ============================================================================
+// Parallel Line Number Tests
+// ============================================================================
+
+TEST_F(ParseErrorTest, ParallelLineNumbersMatchSequential) {
+  std::string input = ::testing::TempDir() + "parallel_lines.tsv";
+  {
+    std::ofstream out(input);
+    out << "header\n";
+    for (int i = 0; i < 500; ++i) {
+      if (i % 37 == 0) {
+        out << createLine("15-01-2025", "China", "Audi", "bad") << "\n";
+      } else if (i % 41 == 0) {
+        out << "\n"; // blank lines still count as lines
+      } else {
+        out << createLine("15-01-2025", "China", "Audi", "45000") << "\n";
+      }
+    }
+  }
+
+  CsvParser sequential(32, '\t');
+  auto expected = sequential.parseFile(input, acceptAll());
+  ASSERT_EQ(expected.parse_errors.size(), 14u);
+
+  for (size_t threads : {1u, 2u, 5u, 16u}) {
+    CsvParser parallel(32, '\t');
+    auto result = parallel.parseFileConcurrent(input, threads);
+
+    ASSERT_EQ(result.parse_errors.size(), expected.parse_errors.size());
+    for (size_t i = 0; i < expected.parse_errors.size(); ++i) {
+      EXPECT_EQ(result.parse_errors[i].line, expected.parse_errors[i].line)
+          << "threads=" << threads << " error=" << i;
+      EXPECT_EQ(result.parse_errors[i].byte_offset,
+                expected.parse_errors[i].byte_offset);
+      EXPECT_EQ(result.parse_errors[i].code, expected.parse_errors[i].code);
+    }
+  }
+
+  std::remove(input.c_str());
+}
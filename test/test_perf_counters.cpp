@@ -0,0 +1,99 @@
+#include "data_analyzer.hpp"
+#include "perf_counters.hpp"
+#include "sale_rows.hpp"
+#include <gtest/gtest.h>
+
+using namespace car_sales;
+
+// ============================================================================
+// Counter Arithmetic Tests
+// ============================================================================
+
+TEST(PerfCountersTest, IpcAndInstructionsPerRow) {
+  HwStageCounters counters;
+  counters.values[static_cast<size_t>(HwCounter::Cycles)] = 200;
+  counters.values[static_cast<size_t>(HwCounter::Instructions)] = 500;
+  counters.rows = 10;
+
+  EXPECT_DOUBLE_EQ(counters.ipc(), 2.5);
+  EXPECT_DOUBLE_EQ(counters.instructionsPerRow(), 50.0);
+}
+
+TEST(PerfCountersTest, ZeroDenominatorsAreSafe) {
+  HwStageCounters counters;
+  EXPECT_DOUBLE_EQ(counters.ipc(), 0.0);
+  EXPECT_DOUBLE_EQ(counters.instructionsPerRow(), 0.0);
+}
+
+TEST(PerfCountersTest, ReportMergeSumsThreads) {
+  HwCounterReport a;
+  HwCounterReport b;
+  b.available = true;
+  b.threads = 2;
+  b[HwStage::Aggregate].values[0] = 42;
+  b[HwStage::Aggregate].rows = 3;
+
+  a.merge(b);
+  a.merge(b);
+
+  EXPECT_TRUE(a.available);
+  EXPECT_EQ(a.threads, 4u);
+  EXPECT_EQ(a[HwStage::Aggregate][HwCounter::Cycles], 84u);
+  EXPECT_EQ(a[HwStage::Aggregate].rows, 6u);
+}
+
+TEST(PerfCountersTest, DeltaScalesItsOwnInterval) {
+  // Multiplexed: the first 100 units ran in full, the next 100 only half
+  PerfCounterSample before;
+  before.raw[0] = 1000;
+  before.time_enabled = 100;
+  before.time_running = 100;
+  PerfCounterSample after;
+  after.raw[0] = 1400;
+  after.time_enabled = 200;
+  after.time_running = 150;
+  EXPECT_EQ(after.deltaSince(before)[0], 800u);
+
+  // Scaling the totals instead (1000 vs 1400 * 200/150 = 1866) would
+  // attribute 866; with a falling ratio the difference could go negative
+  // and wrap. A counter that did not advance reads as zero either way.
+  after.raw[0] = 1000;
+  EXPECT_EQ(after.deltaSince(before)[0], 0u);
+  EXPECT_EQ(before.deltaSince(after)[0], 0u);
+}
+
+// ============================================================================
+// Backend Tests (must pass whether or not the kernel allows counting)
+// ============================================================================
+
+TEST(PerfCountersTest, GroupEitherReadsOrExplains) {
+  PerfCounterGroup group;
+  std::array<uint64_t, HW_COUNTER_COUNT> values{};
+
+  if (group.valid()) {
+    EXPECT_TRUE(group.read(values));
+  } else {
+    EXPECT_FALSE(group.error().empty());
+    EXPECT_FALSE(group.read(values));
+  }
+}
+
+TEST(PerfCountersTest, AnalyzerDegradesGracefully) {
+  std::string csv = "header\n";
+  csv += SaleRow().country("China").brand("Audi").price("45000").line() + "\n";
+
+  CarSalesAnalyzer analyzer(10);
+  analyzer.setHardwareCountersEnabled(true);
+  auto result = analyzer.analyzeString(csv);
+
+  EXPECT_EQ(result.audi_china_year_sales, 1);
+  const HwCounterReport &hw = result.profile.hardware;
+  EXPECT_TRUE(hw.requested);
+  if (hw.available) {
+    EXPECT_EQ(hw.threads, 1u);
+    EXPECT_EQ(hw[HwStage::Parse].rows, 1u);
+    EXPECT_EQ(hw[HwStage::Aggregate].rows, 1u);
+  } else {
+    EXPECT_FALSE(hw.unavailable_reason.empty());
+  }
+}
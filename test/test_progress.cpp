@@ -0,0 +1,128 @@
+#include "data_parser.hpp"
+#include "progress.hpp"
+#include "sale_rows.hpp"
+#include <gtest/gtest.h>
+
+#include <cstdio>
+#include <sstream>
+#include <string>
+
+using namespace car_sales;
+
+namespace {
+
+std::string writeInput(const std::string &name, int rows, uint64_t &size) {
+  std::string content = "header\n";
+  for (int i = 0; i < rows; ++i) {
+    content += SaleRow()
+                   .brand(i % 2 ? "BMW" : "Audi")
+                   .price(i % 13 == 0 ? "n/a"
+                                      : std::to_string(1000 + i) + ".50")
+                   .line() +
+               "\n";
+  }
+  size = content.size();
+  return writeTempFile(name, content);
+}
+
+std::string lastLine(const std::string &text) {
+  size_t end = text.find_last_not_of('\n');
+  if (end == std::string::npos) {
+    return "";
+  }
+  size_t begin = text.rfind('\n', end);
+  return text.substr(begin == std::string::npos ? 0 : begin + 1,
+                     end + 1 - (begin == std::string::npos ? 0 : begin + 1));
+}
+
+} // namespace
+
+TEST(ProgressTest, SlotsAreSeparateCacheLines) {
+  ProgressTracker tracker(3, 1000);
+  ASSERT_NE(tracker.worker(0), nullptr);
+  ASSERT_NE(tracker.worker(2), nullptr);
+  EXPECT_EQ(tracker.worker(3), nullptr);
+  for (size_t w = 0; w < 3; ++w) {
+    EXPECT_EQ(reinterpret_cast<uintptr_t>(tracker.worker(w)) % 64, 0u);
+  }
+  EXPECT_EQ(reinterpret_cast<char *>(tracker.worker(1)) -
+                reinterpret_cast<char *>(tracker.worker(0)),
+            64);
+  EXPECT_EQ(ProgressTracker(0).workers(), 1u);
+}
+
+TEST(ProgressTest, SnapshotSumsWorkers) {
+  ProgressTracker tracker(2, 1000);
+  tracker.worker(0)->publish(100, 10, 1, 5);
+  tracker.worker(1)->publish(250, 20, 2, 7);
+  ProgressSnapshot snapshot = tracker.snapshot();
+  EXPECT_EQ(snapshot.total_bytes, 1000u);
+  EXPECT_EQ(snapshot.bytes, 350u);
+  EXPECT_EQ(snapshot.rows, 30u);
+  EXPECT_EQ(snapshot.failed, 3u);
+  ASSERT_EQ(snapshot.busy_ns.size(), 2u);
+  EXPECT_EQ(snapshot.busy_ns[1], 7u);
+
+  // Totals replace, not add to, the earlier ones
+  tracker.worker(0)->publish(150, 12, 1, 9);
+  EXPECT_EQ(tracker.snapshot().bytes, 400u);
+}
+
+TEST(ProgressTest, ReporterWritesHumanAndJsonLines) {
+  ProgressTracker tracker(2);
+  std::ostringstream human;
+  std::ostringstream machine;
+  ProgressOptions options;
+  options.interval = std::chrono::milliseconds(5);
+  options.human = &human;
+  options.machine = &machine;
+  {
+    ProgressReporter reporter(tracker, options);
+    tracker.worker(0)->publish(2048, 40, 2, 1000);
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    reporter.stop();
+    reporter.stop(); // idempotent
+  }
+  std::string json = lastLine(machine.str());
+  EXPECT_NE(json.find("\"rows\":40"), std::string::npos) << json;
+  EXPECT_NE(json.find("\"failed\":2"), std::string::npos) << json;
+  EXPECT_NE(json.find("\"eta_s\":null"), std::string::npos) << json;
+  EXPECT_NE(json.find("\"done\":true"), std::string::npos) << json;
+  // Ticks came before the final line
+  EXPECT_NE(machine.str().find("\"done\":false"), std::string::npos);
+  EXPECT_NE(lastLine(human.str()).find("Progress: done 2.0 KB"),
+            std::string::npos)
+      << human.str();
+}
+
+TEST(ProgressTest, ParserPublishesFinalTotals) {
+  uint64_t size = 0;
+  std::string path = writeInput("progress_input.csv", 2000, size);
+
+  auto tracker = std::make_shared<ProgressTracker>(3, size);
+  CsvParser parser(100, '\t');
+  parser.setProgress(tracker);
+  ChunkResult result = parser.parseFileConcurrent(path, 3);
+  ASSERT_TRUE(result.success);
+  ProgressSnapshot snapshot = tracker->snapshot();
+  EXPECT_EQ(snapshot.rows, result.records_processed);
+  EXPECT_EQ(snapshot.failed, result.records_failed);
+  EXPECT_GT(snapshot.failed, 0u);
+  // Every byte after the header
+  EXPECT_EQ(snapshot.bytes, size - std::string("header\n").size());
+
+  // The sequential path reports as worker 0
+  auto sequential = std::make_shared<ProgressTracker>(1, size);
+  CsvParser sequential_parser(100, '\t');
+  sequential_parser.setProgress(sequential);
+  result = sequential_parser.parseFile(
+      path, [](const std::vector<CarSaleRecord> &, ChunkResult &) {
+        return true;
+      });
+  ASSERT_TRUE(result.success);
+  snapshot = sequential->snapshot();
+  EXPECT_EQ(snapshot.rows, result.records_processed);
+  EXPECT_EQ(snapshot.failed, result.records_failed);
+  EXPECT_EQ(snapshot.bytes, size);
+  std::remove(path.c_str());
+}
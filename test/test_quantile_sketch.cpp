@@ -0,0 +1,178 @@
+#include "data_analyzer.hpp"
+#include "quantile_sketch.hpp"
+#include "sale_rows.hpp"
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+using namespace car_sales;
+
+namespace {
+
+// Fraction of sorted values strictly below value
+double rankOf(const std::vector<int64_t> &sorted, int64_t value) {
+  auto below = std::lower_bound(sorted.begin(), sorted.end(), value);
+  return static_cast<double>(below - sorted.begin()) /
+         static_cast<double>(sorted.size());
+}
+
+void expectRanksWithinBound(const KllSketch &sketch,
+                            std::vector<int64_t> values) {
+  std::sort(values.begin(), values.end());
+  for (double q : {0.01, 0.1, 0.25, 0.5, 0.75, 0.9, 0.99}) {
+    int64_t answer = sketch.quantile(q);
+    // Any rank inside [rank of answer, rank after its duplicates] is correct
+    double low = rankOf(values, answer);
+    double high = rankOf(values, answer + 1);
+    double error = q < low ? low - q : (q > high ? q - high : 0.0);
+    EXPECT_LE(error, sketch.rankError()) << "q = " << q;
+  }
+}
+
+std::vector<int64_t> randomPrices(size_t count, unsigned seed) {
+  std::mt19937 rng(seed);
+  std::lognormal_distribution<double> price(10.5, 0.6);
+  std::vector<int64_t> values;
+  for (size_t i = 0; i < count; ++i) {
+    values.push_back(static_cast<int64_t>(price(rng) * 100.0));
+  }
+  return values;
+}
+
+} // namespace
+
+TEST(QuantileSketchTest, ExactBeforeFirstCompaction) {
+  KllSketch sketch(200);
+  for (int64_t v = 100; v >= 1; --v) {
+    sketch.add(v * 100);
+  }
+  EXPECT_EQ(sketch.count(), 100u);
+  EXPECT_EQ(sketch.retained(), 100u);
+  EXPECT_EQ(sketch.min(), 100);
+  EXPECT_EQ(sketch.max(), 10000);
+  EXPECT_EQ(sketch.quantile(0.0), 100);
+  EXPECT_EQ(sketch.quantile(0.5), 5000);
+  EXPECT_EQ(sketch.quantile(0.9), 9000);
+  EXPECT_EQ(sketch.quantile(1.0), 10000);
+}
+
+TEST(QuantileSketchTest, LargeStreamWithinRankError) {
+  std::vector<int64_t> values = randomPrices(200000, 5);
+  KllSketch sketch(KllSketch::DEFAULT_K);
+  for (int64_t v : values) {
+    sketch.add(v);
+  }
+  EXPECT_EQ(sketch.count(), values.size());
+  EXPECT_LT(sketch.retained(), 3u * KllSketch::DEFAULT_K + 64);
+  EXPECT_EQ(sketch.min(), *std::min_element(values.begin(), values.end()));
+  EXPECT_EQ(sketch.max(), *std::max_element(values.begin(), values.end()));
+  expectRanksWithinBound(sketch, values);
+}
+
+TEST(QuantileSketchTest, MergedSketchesWithinRankError) {
+  std::vector<int64_t> values = randomPrices(120000, 9);
+  std::vector<KllSketch> parts(5, KllSketch(KllSketch::DEFAULT_K));
+  for (size_t i = 0; i < values.size(); ++i) {
+    parts[(i / 7000) % parts.size()].add(values[i]);
+  }
+  KllSketch merged;
+  for (const KllSketch &part : parts) {
+    merged.merge(part);
+  }
+  EXPECT_EQ(merged.count(), values.size());
+  expectRanksWithinBound(merged, values);
+}
+
+TEST(QuantileSketchTest, DisabledAndInvalidSketches) {
+  KllSketch disabled;
+  disabled.add(5);
+  EXPECT_FALSE(disabled.enabled());
+  EXPECT_EQ(disabled.count(), 0u);
+  EXPECT_EQ(disabled.quantile(0.5), 0);
+
+  EXPECT_THROW(KllSketch(KllSketch::MIN_K - 1), std::invalid_argument);
+  KllSketch a(100);
+  KllSketch b(200);
+  a.add(1);
+  b.add(2);
+  EXPECT_THROW(a.merge(b), std::invalid_argument);
+}
+
+TEST(QuantileSketchTest, PriceQuantilesGroupAndRollUp) {
+  PriceQuantiles prices(200);
+  for (int64_t v = 1; v <= 100; ++v) {
+    prices.add("BMW", "Germany", v * 100);
+    prices.add("BMW", "France", (v + 100) * 100);
+  }
+  prices.add("Audi", "China", 123);
+
+  auto groups = prices.groups();
+  ASSERT_EQ(groups.size(), 3u);
+  EXPECT_EQ(groups[0].country, "France"); // tie on count, then by name
+  EXPECT_EQ(groups[0].sketch.quantile(0.5), 15000);
+  EXPECT_EQ(groups[1].country, "Germany");
+  EXPECT_EQ(groups[2].brand, "Audi");
+
+  auto europe = prices.rollUp(
+      [](std::string_view country) { return country != "China"; }, "Europe");
+  ASSERT_EQ(europe.size(), 1u);
+  EXPECT_EQ(europe[0].sketch.count(), 200u);
+  EXPECT_EQ(europe[0].sketch.quantile(0.5), 10000);
+  EXPECT_EQ(europe[0].sketch.max(), 20000);
+}
+
+TEST(QuantileSketchTest, AnalyzerQuantilesAcrossThreadCounts) {
+  std::string path = ::testing::TempDir() + "quantiles.csv";
+  std::vector<int64_t> bmw_germany;
+  {
+    std::ofstream out(path);
+    out << "header\n";
+    std::vector<int64_t> prices = randomPrices(20000, 13);
+    for (size_t i = 0; i < prices.size(); ++i) {
+      std::string brand = i % 2 ? "BMW" : "Audi";
+      std::string country = i % 3 ? "Germany" : "China";
+      if (brand == "BMW" && country == "Germany") {
+        bmw_germany.push_back(prices[i]);
+      }
+      out << SaleRow()
+                 .country(country)
+                 .brand(brand)
+                 .priceCents(prices[i])
+                 .line()
+          << "\n";
+    }
+  }
+
+  for (size_t threads : {0u, 1u, 2u, 4u}) {
+    CarSalesAnalyzer analyzer(500);
+    analyzer.setPriceQuantiles(100);
+    // threads == 0 runs the sequential path
+    auto result = analyzer.analyzeFile(path, threads > 0, threads);
+    ASSERT_TRUE(result.analysis_complete);
+    ASSERT_EQ(result.price_quantile_groups.size(), 4u);
+    EXPECT_GT(result.price_quantile_rank_error, 0.0);
+
+    const QuantileGroup *group = nullptr;
+    for (const auto &candidate : result.price_quantile_groups) {
+      if (candidate.brand == "BMW" && candidate.country == "Germany") {
+        group = &candidate;
+      }
+    }
+    ASSERT_NE(group, nullptr);
+    EXPECT_EQ(group->sketch.count(), bmw_germany.size());
+    expectRanksWithinBound(group->sketch, bmw_germany);
+
+    ASSERT_EQ(result.price_quantiles_europe.size(), 2u);
+  }
+
+  CarSalesAnalyzer plain(500);
+  EXPECT_TRUE(plain.analyzeFile(path, true, 2).price_quantile_groups.empty());
+
+  std::remove(path.c_str());
+}
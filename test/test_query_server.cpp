@@ -0,0 +1,108 @@
+#include "query_server.hpp"
+#include "sale_rows.hpp"
+#include <gtest/gtest.h>
+
+#include <unistd.h>
+
+#include <cstdio>
+#include <future>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+using namespace car_sales;
+
+namespace {
+
+std::string createLine(const std::string &brand, const std::string &country,
+                       const std::string &price) {
+  return SaleRow().brand(brand).country(country).price(price).line();
+}
+
+std::string writeDataset() {
+  return writeTempFile("query_server.csv",
+                       "header\n" + createLine("BMW", "Germany", "100.00") +
+                           "\n" +
+                           createLine("BMW", "United Kingdom", "250.50") +
+                           "\n" + createLine("Audi", "China", "80.00") + "\n");
+}
+
+std::string socketPath() {
+  return "/tmp/car_sales_test_" + std::to_string(::getpid()) + ".sock";
+}
+
+} // namespace
+
+TEST(QueryServerTest, AnswersRequestsInProcess) {
+  std::string path = writeDataset();
+  QueryServer server(socketPath());
+  std::string error;
+  ASSERT_TRUE(server.addDataset("sales", path, error)) << error;
+
+  std::string answer = server.handle("GROUP\tsales\tcountry\tbrand=BMW");
+  EXPECT_EQ(answer.compare(0, 5, "OK 2 "), 0) << answer;
+  EXPECT_NE(answer.find("United Kingdom\t1\t250.50\n"), std::string::npos);
+
+  answer = server.handle("SUMMARY\tsales");
+  EXPECT_NE(answer.find("audi_china_sales\t1\n"), std::string::npos);
+  EXPECT_NE(answer.find("bmw_revenue\t350.50\n"), std::string::npos);
+
+  EXPECT_EQ(server.handle("GROUP\tmissing\tbrand"),
+            "ERR unknown dataset: missing\n");
+  EXPECT_EQ(server.handle("GROUP\tsales\tmodel").compare(0, 4, "ERR "), 0);
+  EXPECT_EQ(server.handle("GROUP\tsales\tbrand\tyear=soon").compare(0, 4, "ERR "),
+            0);
+  EXPECT_EQ(server.handle("GROUP\tsales\tbrand\tmax_price=lots")
+                .compare(0, 4, "ERR "),
+            0);
+  EXPECT_EQ(server.handle("FROB").compare(0, 4, "ERR "), 0);
+  EXPECT_EQ(server.latency().queries, 2u); // errors are not timed
+  std::remove(path.c_str());
+}
+
+TEST(QueryServerTest, ServesConcurrentClientsOverSocket) {
+  std::string path = writeDataset();
+  std::string socket = socketPath();
+  QueryServer server(socket);
+  std::string error;
+  ASSERT_TRUE(server.addDataset("sales", path, error)) << error;
+  ASSERT_TRUE(server.start(error)) << error;
+
+  std::vector<std::future<std::string>> clients;
+  for (int i = 0; i < 8; ++i) {
+    clients.push_back(std::async(std::launch::async, [&socket] {
+      return sendQuery(socket, "GROUP\tsales\tbrand");
+    }));
+  }
+  for (auto &client : clients) {
+    std::string answer = client.get();
+    EXPECT_EQ(answer.compare(0, 5, "OK 2 "), 0) << answer;
+    EXPECT_NE(answer.find("BMW\t2\t350.50\n"), std::string::npos);
+  }
+
+  std::string stats = sendQuery(socket, "STATS");
+  EXPECT_NE(stats.find("queries\t8\n"), std::string::npos) << stats;
+
+  // Reloading under a new name is visible to the next query
+  EXPECT_EQ(sendQuery(socket, "LOAD\tagain\t" + path).compare(0, 5, "OK 1 "),
+            0);
+  EXPECT_NE(sendQuery(socket, "DATASETS").find("again\t3\t"),
+            std::string::npos);
+
+  EXPECT_EQ(sendQuery(socket, "SHUTDOWN").compare(0, 5, "OK 0 "), 0);
+  server.wait();
+  EXPECT_THROW(sendQuery(socket, "PING"), std::runtime_error);
+  std::remove(path.c_str());
+}
+
+TEST(QueryServerTest, RefusesSecondServerOnSameSocket) {
+  std::string socket = socketPath();
+  QueryServer first(socket);
+  QueryServer second(socket);
+  std::string error;
+  ASSERT_TRUE(first.start(error)) << error;
+  EXPECT_FALSE(second.start(error));
+  first.stop();
+  EXPECT_TRUE(second.start(error)) << error;
+  second.stop();
+}
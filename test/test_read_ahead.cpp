@@ -0,0 +1,161 @@
+#include "data_parser.hpp"
+#include "read_ahead.hpp"
+#include "sale_rows.hpp"
+#include <gtest/gtest.h>
+
+#include <cstdio>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <unistd.h>
+
+using namespace car_sales;
+
+namespace {
+
+// Lines of varied length, some much longer than one 4 KiB block
+std::string variedLines(size_t count) {
+  std::string content;
+  for (size_t i = 0; i < count; ++i) {
+    content += std::to_string(i) + ':';
+    content += std::string((i * 7919) % (i % 10 == 0 ? 9000 : 300), 'a' + i % 26);
+    content += '\n';
+  }
+  return content;
+}
+
+std::vector<std::string> splitLines(const std::string &content) {
+  std::vector<std::string> lines;
+  std::istringstream in(content);
+  std::string line;
+  while (std::getline(in, line)) {
+    lines.push_back(line);
+  }
+  return lines;
+}
+
+std::vector<std::string> readAll(LineReader &reader) {
+  std::vector<std::string> lines;
+  std::string_view line;
+  while (reader.next(line)) {
+    lines.emplace_back(line);
+  }
+  return lines;
+}
+
+} // namespace
+
+TEST(ReadAheadTest, LineReaderMatchesGetline) {
+  for (std::string content : {"a\nb\n\nc", "a\n", "", "\n\n", "single"}) {
+    LineReader reader{std::string_view(content)};
+    EXPECT_EQ(readAll(reader), splitLines(content)) << content;
+  }
+}
+
+TEST(ReadAheadTest, LinesSpanBlockBoundaries) {
+  std::string content = variedLines(400);
+  content += "no trailing newline";
+  std::string path = writeTempFile("read_ahead_lines.txt", content);
+  std::vector<std::string> expected = splitLines(content);
+
+  for (size_t depth : {2u, 3u, 8u}) {
+    for (bool direct : {false, true}) {
+      ReadAheadOptions options;
+      options.block_bytes = 1; // rounds up to one 4 KiB block
+      options.depth = depth;
+      options.direct = direct;
+      ReadAheadReader blocks(options);
+      std::string error;
+      ASSERT_TRUE(blocks.open(path, error)) << error;
+      LineReader reader(blocks);
+      EXPECT_EQ(readAll(reader), expected) << depth << " deep";
+      EXPECT_TRUE(blocks.error().empty());
+    }
+  }
+  std::remove(path.c_str());
+}
+
+TEST(ReadAheadTest, ReadsFromPipes) {
+  int fds[2];
+  ASSERT_EQ(::pipe(fds), 0);
+  std::string content = variedLines(200);
+  std::thread writer([&]() {
+    size_t done = 0;
+    while (done < content.size()) {
+      // Small writes, so blocks arrive in pieces
+      size_t n = std::min<size_t>(1000, content.size() - done);
+      ssize_t written = ::write(fds[1], content.data() + done, n);
+      if (written <= 0) {
+        break;
+      }
+      done += static_cast<size_t>(written);
+    }
+    ::close(fds[1]);
+  });
+
+  ReadAheadOptions options;
+  options.block_bytes = 8192;
+  ReadAheadReader blocks(options);
+  blocks.attach(fds[0]);
+  LineReader reader(blocks);
+  EXPECT_EQ(readAll(reader), splitLines(content));
+  writer.join();
+  ::close(fds[0]);
+}
+
+TEST(ReadAheadTest, MissingFileFailsToOpen) {
+  ReadAheadReader blocks;
+  std::string error;
+  EXPECT_FALSE(blocks.open(::testing::TempDir() + "no_such_file.csv", error));
+  EXPECT_FALSE(error.empty());
+}
+
+TEST(ReadAheadTest, ParseFileIndependentOfBlockSize) {
+  std::string content = "header\n";
+  for (int i = 0; i < 3000; ++i) {
+    content += SaleRow()
+                   .country(i % 2 ? "Germany" : "China")
+                   .brand(i % 3 ? "BMW" : "Audi")
+                   .price(std::to_string(1000 + i) + ".25")
+                   .line() +
+               "\n";
+    if (i % 500 == 0) {
+      content += "broken line\n";
+    }
+  }
+  std::string path = writeTempFile("read_ahead_parse.csv", content);
+
+  auto parse = [&](size_t block_bytes) {
+    CsvParser parser(64, '\t');
+    ReadAheadOptions options;
+    options.block_bytes = block_bytes;
+    parser.setReadAhead(options);
+    int64_t cents = 0;
+    ChunkResult result = parser.parseFile(
+        path, [&](const std::vector<CarSaleRecord> &chunk, ChunkResult &) {
+          for (const CarSaleRecord &record : chunk) {
+            cents += record.revenue_cents;
+          }
+          return true;
+        });
+    EXPECT_TRUE(result.success);
+    return std::make_pair(result, cents);
+  };
+
+  auto [expected, expected_cents] = parse(ReadAheadOptions::DEFAULT_BLOCK_BYTES);
+  EXPECT_EQ(expected.records_processed, 3000u);
+  EXPECT_EQ(expected.records_failed, 6u);
+
+  auto [small, small_cents] = parse(4096);
+  EXPECT_EQ(small.records_processed, expected.records_processed);
+  EXPECT_EQ(small_cents, expected_cents);
+  ASSERT_EQ(small.parse_errors.size(), expected.parse_errors.size());
+  for (size_t e = 0; e < small.parse_errors.size(); ++e) {
+    EXPECT_EQ(small.parse_errors[e].line, expected.parse_errors[e].line);
+    EXPECT_EQ(small.parse_errors[e].byte_offset,
+              expected.parse_errors[e].byte_offset);
+  }
+  std::remove(path.c_str());
+}
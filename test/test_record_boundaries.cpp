@@ -0,0 +1,217 @@
+#include "data_parser.hpp"
+#include "read_ahead.hpp"
+#include "record_boundaries.hpp"
+#include "sale_rows.hpp"
+#include <gtest/gtest.h>
+
+#include <cstdio>
+#include <fstream>
+#include <set>
+#include <string>
+#include <vector>
+
+using namespace car_sales;
+
+namespace {
+
+std::string createLine(const std::string &brand, const std::string &model,
+                       int64_t cents) {
+  return SaleRow()
+      .country("China")
+      .brand(brand)
+      .model(model)
+      .price(std::to_string(cents / 100) + ".00")
+      .line();
+}
+
+// Record starts found by walking the data one record at a time
+std::set<size_t> serialRecordStarts(std::string_view data) {
+  std::set<size_t> starts;
+  size_t pos = 0;
+  while (pos < data.size()) {
+    starts.insert(pos);
+    size_t embedded;
+    pos = recordEnd(data, pos, embedded) + 1;
+  }
+  starts.insert(data.size());
+  return starts;
+}
+
+} // namespace
+
+TEST(RecordBoundariesTest, FindsRecordEndsOutsideQuotes) {
+  EXPECT_FALSE(hasOpenQuote("no quotes"));
+  EXPECT_TRUE(hasOpenQuote("a\t\"open"));
+  EXPECT_FALSE(hasOpenQuote("\"say \"\"hi\"\"\""));
+
+  std::string_view data = "a\t\"x\ny\"\tb\nnext\n\"unterminated\nend";
+  size_t embedded;
+  size_t end = recordEnd(data, 0, embedded);
+  EXPECT_EQ(data.substr(0, end), "a\t\"x\ny\"\tb");
+  EXPECT_EQ(embedded, 1u);
+
+  end = recordEnd(data, end + 1, embedded);
+  EXPECT_EQ(data.substr(end - 4, 4), "next");
+  EXPECT_EQ(embedded, 0u);
+
+  // An unterminated quote runs to the end of the data
+  EXPECT_EQ(recordEnd(data, end + 1, embedded), data.size());
+  EXPECT_EQ(embedded, 1u);
+
+  // The last cut point steps back over newlines inside quotes
+  EXPECT_EQ(lastRecordEnd(data), data.find("\"unterminated"));
+  EXPECT_EQ(lastRecordEnd("a\nb\n"), 4u);
+  EXPECT_EQ(lastRecordEnd("partial"), 0u);
+  EXPECT_EQ(lastRecordEnd("\"x\ny\nz"), 0u);
+}
+
+TEST(RecordBoundariesTest, ScansBothHypotheses) {
+  // Outside quotes the first record ends at the first newline; inside, the
+  // quote closes first and the record ends at the second
+  QuoteScan scan = scanQuotes("ab\ncd\"\nef\ngh");
+  EXPECT_TRUE(scan.odd_quotes);
+  EXPECT_EQ(scan.first_start[0], 3u);
+  EXPECT_EQ(scan.first_start[1], 7u);
+
+  QuoteScan none = scanQuotes("\"only quoted\nnewlines");
+  EXPECT_EQ(none.first_start[0], std::string_view::npos);
+  EXPECT_EQ(none.first_start[1], 13u);
+}
+
+TEST(RecordBoundariesTest, SplitNeverCutsInsideQuotes) {
+  std::string data;
+  for (int i = 0; i < 12; ++i) {
+    data += i % 3 == 0 ? "a\t\"q\n\"\"x\"\"\n\"\tb\n" : "plain\tline\n";
+  }
+  data += "\"long\n\n\n\n\n\n\n\n\n\n\n\n\n\n\n\n\n\n\nfield\"\tend";
+  std::set<size_t> expected = serialRecordStarts(data);
+
+  for (size_t parts = 1; parts <= data.size(); ++parts) {
+    std::vector<std::string_view> ranges = splitRecords(data, parts);
+    size_t pos = 0;
+    for (std::string_view range : ranges) {
+      size_t begin = static_cast<size_t>(range.data() - data.data());
+      ASSERT_EQ(begin, pos) << parts << " parts";
+      EXPECT_TRUE(expected.count(begin)) << parts << " parts at " << begin;
+      pos = begin + range.size();
+    }
+    EXPECT_EQ(pos, data.size()) << parts << " parts";
+  }
+}
+
+TEST(RecordBoundariesTest, UnescapesDoubledQuotes) {
+  CsvParser parser(16, '\t');
+  auto record = parser.parseLine(createLine("\"Au\"\"di\"", "Model", 100000));
+  ASSERT_TRUE(record.has_value());
+  EXPECT_EQ(record->brand, "Au\"di");
+
+  record = parser.parseLine(createLine("\"Audi\"", "\"Tab\there\"", 100000));
+  ASSERT_TRUE(record.has_value());
+  EXPECT_EQ(record->brand, "Audi");
+}
+
+TEST(RecordBoundariesTest, LineReaderJoinsQuotedNewlines) {
+  std::string content = "one\n\"two\nthree\"\tx\n\"a\"\"\nb\"\nlast";
+  LineReader reader{std::string_view(content)};
+  std::vector<std::string> records;
+  std::vector<size_t> lines;
+  std::string_view record;
+  size_t count;
+  while (reader.nextRecord(record, count)) {
+    records.emplace_back(record);
+    lines.push_back(count);
+  }
+  EXPECT_EQ(records, (std::vector<std::string>{
+                         "one", "\"two\nthree\"\tx", "\"a\"\"\nb\"", "last"}));
+  EXPECT_EQ(lines, (std::vector<size_t>{1, 2, 2, 1}));
+}
+
+TEST(RecordBoundariesTest, ParallelMatchesSequentialOnQuotedData) {
+  std::string path = ::testing::TempDir() + "quoted_records.csv";
+  std::vector<size_t> error_lines;
+  size_t records = 0;
+  {
+    std::ofstream out(path, std::ios::binary);
+    out << "header\n";
+    size_t line = 1;
+    for (int i = 0; i < 400; ++i) {
+      std::string model;
+      switch (i % 4) {
+      case 0: // a whole record hidden in a quoted field
+        model = "\"Fake\n" + createLine("Audi", "Model", 99900) + "\n\"";
+        break;
+      case 1:
+        model = "\"Tab\there\"";
+        break;
+      case 2:
+        model = "\"Say \"\"hi\"\"\"";
+        break;
+      default:
+        model = "\"Line one\nline two\"";
+      }
+      std::string text = createLine(i % 2 ? "BMW" : "Audi", model, 1000 + i);
+      out << text << "\n";
+      line += 1 + std::count(text.begin(), text.end(), '\n');
+      ++records;
+      if (i % 53 == 0) {
+        out << "broken \"multi\nline\" record\n";
+        error_lines.push_back(++line);
+        ++line;
+      }
+    }
+  }
+
+  CsvParser sequential(16, '\t');
+  sequential.setGroupBy(GroupColumn::Model);
+  size_t sequential_records = 0;
+  ChunkResult expected = sequential.parseFile(
+      path, [&](const std::vector<CarSaleRecord> &chunk, ChunkResult &) {
+        sequential_records += chunk.size();
+        return true;
+      });
+  ASSERT_TRUE(expected.success);
+  EXPECT_EQ(sequential_records, records);
+  ASSERT_EQ(expected.parse_errors.size(), error_lines.size());
+  for (size_t e = 0; e < error_lines.size(); ++e) {
+    EXPECT_EQ(expected.parse_errors[e].line, error_lines[e]);
+  }
+
+  for (WorkerPlacement placement :
+       {WorkerPlacement::None, WorkerPlacement::Numa}) {
+    CsvParser parser(16, '\t');
+    parser.setGroupBy(GroupColumn::Model);
+    parser.setWorkerPlacement(placement);
+    ChunkResult baseline;
+    for (size_t threads = 1; threads <= 12; ++threads) {
+      ChunkResult result = parser.parseFileConcurrent(path, threads);
+      SCOPED_TRACE(std::string(workerPlacementName(placement)) + " " +
+                   std::to_string(threads) + " threads");
+      ASSERT_TRUE(result.success);
+      EXPECT_EQ(result.records_processed, records);
+      EXPECT_EQ(result.lines_scanned, expected.lines_scanned);
+      ASSERT_EQ(result.parse_errors.size(), error_lines.size());
+      for (size_t e = 0; e < error_lines.size(); ++e) {
+        EXPECT_EQ(result.parse_errors[e].line, error_lines[e]);
+        EXPECT_EQ(result.parse_errors[e].byte_offset,
+                  expected.parse_errors[e].byte_offset);
+      }
+      if (threads == 1) {
+        baseline = result;
+        continue;
+      }
+      EXPECT_EQ(result.audi_china_year_sales, baseline.audi_china_year_sales);
+      EXPECT_EQ(result.bmw_2025_revenue_cents, baseline.bmw_2025_revenue_cents);
+    }
+
+    std::set<std::string> models;
+    for (const GroupTotal &total : baseline.group_by.summarize(10, 1).top) {
+      models.insert(total.key);
+      EXPECT_EQ(total.count, 100);
+    }
+    EXPECT_EQ(models.count("Tab\there"), 1u);
+    EXPECT_EQ(models.count("Say \"hi\""), 1u);
+    EXPECT_EQ(models.count("Line one\nline two"), 1u);
+  }
+
+  std::remove(path.c_str());
+}
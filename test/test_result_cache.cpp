@@ -0,0 +1,210 @@
+#include "data_analyzer.hpp"
+#include "result_cache.hpp"
+#include "sale_rows.hpp"
+#include <gtest/gtest.h>
+
+#include <filesystem>
+#include <fstream>
+#include <string>
+
+using namespace car_sales;
+
+namespace fs = std::filesystem;
+
+namespace {
+
+std::string createLine(const std::string &brand, const std::string &country,
+                       const std::string &date, const std::string &price) {
+  return SaleRow()
+      .brand(brand)
+      .country(country)
+      .date(date)
+      .latitude("48.1")
+      .longitude("11.5")
+      .price(price)
+      .line();
+}
+
+std::string sampleContent(const std::string &bmw_price) {
+  std::string content = "header\n";
+  content += createLine("BMW", "Germany", "15-01-2025", bmw_price) + "\n";
+  content += createLine("BMW", "France", "20-02-2025", "50.00") + "\n";
+  content += createLine("Audi", "China", "01-03-2025", "30.00") + "\n";
+  content += createLine("Audi", "China", "bad-date", "30.00") + "\n";
+  return content;
+}
+
+std::string freshDirectory(const std::string &name) {
+  std::string path = ::testing::TempDir() + name;
+  fs::remove_all(path);
+  return path;
+}
+
+} // namespace
+
+TEST(ResultCacheTest, HitReturnsStoredResult) {
+  std::string path = writeTempFile("cache_hit.csv", sampleContent("100.00"));
+  auto cache = std::make_shared<ResultCache>(freshDirectory("cache_hit"));
+
+  CarSalesAnalyzer analyzer;
+  analyzer.setGroupBy(GroupColumn::Country);
+  analyzer.setTimeSeries(TimeBucket::Month);
+  analyzer.setGeoGrid(1.0);
+  analyzer.setResultCache(cache);
+
+  AnalysisResult first = analyzer.analyzeFile(path, false);
+  ASSERT_TRUE(first.analysis_complete);
+  EXPECT_FALSE(first.from_cache);
+  AnalysisResult second = analyzer.analyzeFile(path, true, 2);
+  EXPECT_TRUE(second.from_cache);
+
+  EXPECT_EQ(ResultCache::serialize(second), ResultCache::serialize(first));
+  EXPECT_EQ(second.audi_china_year_sales, 1);
+  EXPECT_EQ(second.bmw_year_total_revenue_cents, 15000);
+  EXPECT_DOUBLE_EQ(second.bmw_year_total_revenue, 150.0);
+  EXPECT_EQ(second.top_groups.size(), 3u);
+  EXPECT_EQ(second.total_records_failed, 1u);
+  ASSERT_EQ(second.parse_errors.size(), 1u);
+  EXPECT_EQ(second.parse_errors[0].code, first.parse_errors[0].code);
+
+  CacheStats stats = cache->stats();
+  EXPECT_EQ(stats.hits, 1u);
+  EXPECT_EQ(stats.misses, 1u);
+  EXPECT_EQ(stats.stores, 1u);
+  EXPECT_GT(cache->sizeBytes(), 0u);
+}
+
+TEST(ResultCacheTest, ChangedFileInvalidatesEntry) {
+  std::string path = writeTempFile("cache_change.csv", sampleContent("100.00"));
+  auto cache = std::make_shared<ResultCache>(freshDirectory("cache_change"));
+  CarSalesAnalyzer analyzer;
+  analyzer.setResultCache(cache);
+
+  EXPECT_EQ(analyzer.analyzeFile(path).bmw_year_total_revenue_cents, 15000);
+
+  // Same size and mtime: only the content checksum tells them apart
+  auto mtime = fs::last_write_time(path);
+  writeTempFile("cache_change.csv", sampleContent("900.00"));
+  fs::last_write_time(path, mtime);
+
+  AnalysisResult changed = analyzer.analyzeFile(path);
+  EXPECT_FALSE(changed.from_cache);
+  EXPECT_EQ(changed.bmw_year_total_revenue_cents, 95000);
+  EXPECT_EQ(cache->stats().invalidations, 1u);
+
+  EXPECT_TRUE(analyzer.analyzeFile(path).from_cache);
+}
+
+TEST(ResultCacheTest, OlderParserInvalidatesEntry) {
+  std::string path = writeTempFile("cache_parser.csv", sampleContent("100.00"));
+  std::string directory = freshDirectory("cache_parser");
+  auto cache = std::make_shared<ResultCache>(directory);
+  CarSalesAnalyzer analyzer;
+  analyzer.setResultCache(cache);
+  analyzer.analyzeFile(path);
+
+  // Rewrite the entry's parser version (after magic and format version),
+  // as if an earlier build with other parse semantics had stored it
+  size_t entries = 0;
+  for (const auto &file : fs::directory_iterator(directory)) {
+    if (file.path().extension() != ".entry") {
+      continue;
+    }
+    std::fstream entry(file.path(), std::ios::in | std::ios::out |
+                                        std::ios::binary);
+    uint64_t older = CsvParser::PARSE_SEMANTICS_VERSION - 1;
+    entry.seekp(12);
+    entry.write(reinterpret_cast<const char *>(&older), sizeof(older));
+    ++entries;
+  }
+  ASSERT_EQ(entries, 1u);
+
+  EXPECT_FALSE(analyzer.analyzeFile(path).from_cache);
+  EXPECT_EQ(cache->stats().invalidations, 1u);
+  EXPECT_TRUE(analyzer.analyzeFile(path).from_cache);
+}
+
+TEST(ResultCacheTest, DifferentQueryMisses) {
+  std::string path = writeTempFile("cache_query.csv", sampleContent("100.00"));
+  auto cache = std::make_shared<ResultCache>(freshDirectory("cache_query"));
+  CarSalesAnalyzer analyzer;
+  analyzer.setResultCache(cache);
+
+  uint64_t plain = analyzer.queryFingerprint();
+  analyzer.analyzeFile(path);
+  analyzer.setGroupBy(GroupColumn::Manufacturer);
+  EXPECT_NE(analyzer.queryFingerprint(), plain);
+
+  AnalysisResult grouped = analyzer.analyzeFile(path);
+  EXPECT_FALSE(grouped.from_cache);
+  EXPECT_EQ(grouped.top_groups.size(), 2u);
+
+  analyzer.setGroupBy(GroupColumn::None);
+  EXPECT_EQ(analyzer.queryFingerprint(), plain);
+  EXPECT_TRUE(analyzer.analyzeFile(path).from_cache);
+  EXPECT_EQ(cache->stats().stores, 2u);
+}
+
+TEST(ResultCacheTest, SideEffectRunsBypassCache) {
+  std::string path = writeTempFile("cache_bypass.csv", sampleContent("100.00"));
+  auto cache = std::make_shared<ResultCache>(freshDirectory("cache_bypass"));
+  CarSalesAnalyzer analyzer;
+  analyzer.setResultCache(cache);
+  analyzer.setRejectFile(::testing::TempDir() + "cache_bypass.rej");
+
+  EXPECT_FALSE(analyzer.cacheable());
+  analyzer.analyzeFile(path);
+  EXPECT_FALSE(analyzer.analyzeFile(path).from_cache);
+  CacheStats stats = cache->stats();
+  EXPECT_EQ(stats.stores, 0u);
+  EXPECT_EQ(stats.misses, 0u);
+}
+
+TEST(ResultCacheTest, EvictsLeastRecentlyUsed) {
+  std::string path = writeTempFile("cache_evict.csv", sampleContent("100.00"));
+  FileIdentity file;
+  ASSERT_TRUE(FileIdentity::of(path, file));
+
+  AnalysisResult result;
+  result.errors.push_back(std::string(1000, 'x'));
+  result.analysis_complete = true;
+  std::string directory = freshDirectory("cache_evict");
+  uint64_t entry_bytes;
+  {
+    ResultCache sizing(directory);
+    sizing.store(file, 1, result);
+    entry_bytes = sizing.sizeBytes();
+  }
+  // Room for three entries, not four
+  ResultCache cache(directory, entry_bytes * 7 / 2);
+
+  cache.store(file, 2, result);
+  cache.store(file, 3, result);
+  AnalysisResult found;
+  EXPECT_TRUE(cache.lookup(file, 1, found)); // now most recently used
+  EXPECT_EQ(found.errors, result.errors);
+
+  cache.store(file, 4, result);
+  EXPECT_LE(cache.sizeBytes(), cache.maxBytes());
+  EXPECT_GE(cache.stats().evictions, 1u);
+  EXPECT_TRUE(cache.lookup(file, 4, found));
+  EXPECT_TRUE(cache.lookup(file, 1, found));
+  EXPECT_FALSE(cache.lookup(file, 2, found));
+
+  // An entry larger than the whole cache is never stored
+  result.errors.push_back(std::string(4 * entry_bytes, 'y'));
+  cache.store(file, 5, result);
+  EXPECT_FALSE(cache.lookup(file, 5, found));
+}
+
+TEST(ResultCacheTest, RejectsTruncatedEntries) {
+  AnalysisResult result;
+  result.top_groups.push_back({"Germany", 2, 15000});
+  std::string data = ResultCache::serialize(result);
+
+  AnalysisResult decoded;
+  ASSERT_TRUE(ResultCache::deserialize(data, decoded));
+  EXPECT_EQ(decoded.top_groups[0].key, "Germany");
+  EXPECT_FALSE(ResultCache::deserialize(data.substr(0, data.size() - 1), decoded));
+  EXPECT_FALSE(ResultCache::deserialize(data + "x", decoded));
+}
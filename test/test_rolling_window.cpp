@@ -0,0 +1,139 @@
+#include "data_analyzer.hpp"
+#include "rolling_window.hpp"
+#include "sale_rows.hpp"
+#include <gtest/gtest.h>
+
+#include <cstdio>
+#include <fstream>
+#include <string>
+
+using namespace car_sales;
+
+namespace {
+
+std::string createLine(const std::string &brand, const std::string &country,
+                       const std::string &date, const std::string &price) {
+  return SaleRow()
+      .brand(brand)
+      .country(country)
+      .date(date)
+      .price(price)
+      .line();
+}
+
+} // namespace
+
+TEST(RollingWindowTest, DayBucketsAndLabels) {
+  int32_t day = daysFromCivil(2025, 3, 9);
+  EXPECT_EQ(bucketOf(TimeBucket::Day, day), day);
+  EXPECT_EQ(bucketLabel(TimeBucket::Day, day), "2025-03-09");
+  EXPECT_EQ(bucketLabel(TimeBucket::Day, -1), "1969-12-31");
+}
+
+TEST(RollingWindowTest, WindowsSlideOverDenseDays) {
+  // Rows arrive out of order; the daily buckets put them in place
+  TimeSeriesAggregator daily(TimeBucket::Day);
+  int32_t first = daysFromCivil(2025, 1, 1);
+  daily.add("Germany", first + 4, 1, 500);
+  daily.add("Germany", first, 1, 100);
+  daily.add("Germany", first + 2, 1, 300);
+  daily.add("France", first + 1, 1, 7);
+  daily.add("Germany", first + 2, 1, 30);
+
+  auto points = rollingWindows(daily.points(), {1, 2, 3});
+  ASSERT_EQ(points.size(), 1u + 5u); // France: 1 day, Germany: 5 days
+  EXPECT_EQ(points[0].country, "France");
+  EXPECT_EQ(points[0].window_cents, (std::vector<int64_t>{7, 7, 7}));
+
+  // Germany by day: 100, 0, 330, 0, 500
+  EXPECT_EQ(points[1].date, "2025-01-01");
+  EXPECT_EQ(points[1].window_cents, (std::vector<int64_t>{100, 100, 100}));
+  EXPECT_EQ(points[2].window_cents, (std::vector<int64_t>{0, 100, 100}));
+  EXPECT_EQ(points[3].day_cents, 330);
+  EXPECT_EQ(points[3].window_cents, (std::vector<int64_t>{330, 330, 430}));
+  EXPECT_EQ(points[4].window_cents, (std::vector<int64_t>{0, 330, 330}));
+  EXPECT_EQ(points[5].date, "2025-01-05");
+  EXPECT_EQ(points[5].window_cents, (std::vector<int64_t>{500, 500, 830}));
+}
+
+TEST(RollingWindowTest, MatchesBruteForceSums) {
+  TimeSeriesAggregator daily(TimeBucket::Day);
+  std::vector<int64_t> truth(200, 0);
+  for (int i = 0; i < 1000; ++i) {
+    int offset = (i * 73) % 200;
+    int64_t cents = 100 + (i * 31) % 997;
+    daily.add("Italy", 20000 + offset, 1, cents);
+    truth[offset] += cents;
+  }
+
+  auto points = rollingWindows(daily.points(), {7, 30});
+  ASSERT_EQ(points.size(), truth.size());
+  for (size_t i = 0; i < truth.size(); ++i) {
+    int64_t week = 0;
+    int64_t month = 0;
+    for (size_t j = 0; j <= i; ++j) {
+      week += i - j < 7 ? truth[j] : 0;
+      month += i - j < 30 ? truth[j] : 0;
+    }
+    EXPECT_EQ(points[i].window_cents[0], week) << "day " << i;
+    EXPECT_EQ(points[i].window_cents[1], month) << "day " << i;
+  }
+}
+
+TEST(RollingWindowTest, AnalyzerWindowsSameForAllThreadCounts) {
+  std::string content = "header\n";
+  const char *countries[] = {"Germany", "France", "China", "Italy"};
+  const char *brands[] = {"BMW", "BMW", "Audi"};
+  for (int i = 0; i < 3000; ++i) {
+    char date[16];
+    std::snprintf(date, sizeof(date), "%02d-%02d-%d", 1 + (i * 7) % 28,
+                  1 + (i * 5) % 12, 2024 + i % 2);
+    content += createLine(brands[i % 3], countries[i % 4], date,
+                          std::to_string(20000 + i % 700) + ".10") +
+               "\n";
+  }
+
+  std::string path = ::testing::TempDir() + "rolling_window.csv";
+  {
+    std::ofstream out(path);
+    out << content;
+  }
+
+  CarSalesAnalyzer sequential(100);
+  sequential.setRollingWindows({7, 30});
+  auto expected = sequential.analyzeFile(path, false);
+  EXPECT_EQ(expected.rolling_windows, (std::vector<uint32_t>{7, 30}));
+  ASSERT_FALSE(expected.rolling_revenue.empty());
+
+  int64_t european_cents = 0;
+  for (const auto &point : expected.rolling_revenue) {
+    EXPECT_NE(point.country, "China");
+    european_cents += point.day_cents;
+  }
+  int64_t bmw_2025_europe = 0;
+  for (const auto &[country, revenue] :
+       expected._bmw_europe_revenuedistribution) {
+    bmw_2025_europe += static_cast<int64_t>(revenue * 100.0 + 0.5);
+  }
+  // Both years count towards the windows, only 2025 towards the headline
+  EXPECT_GT(european_cents, bmw_2025_europe);
+
+  for (size_t threads : {1u, 2u, 3u, 5u}) {
+    CarSalesAnalyzer analyzer(100);
+    analyzer.setRollingWindows({7, 30});
+    auto result = analyzer.analyzeFile(path, true, threads);
+    ASSERT_EQ(result.rolling_revenue.size(), expected.rolling_revenue.size());
+    for (size_t i = 0; i < result.rolling_revenue.size(); ++i) {
+      EXPECT_EQ(result.rolling_revenue[i].country,
+                expected.rolling_revenue[i].country);
+      EXPECT_EQ(result.rolling_revenue[i].date,
+                expected.rolling_revenue[i].date);
+      EXPECT_EQ(result.rolling_revenue[i].window_cents,
+                expected.rolling_revenue[i].window_cents);
+    }
+  }
+
+  CarSalesAnalyzer plain(100);
+  EXPECT_TRUE(plain.analyzeFile(path, true, 2).rolling_revenue.empty());
+  std::remove(path.c_str());
+}
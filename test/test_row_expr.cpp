@@ -0,0 +1,93 @@
+#include "row_expr.hpp"
+#include <gtest/gtest.h>
+
+#include <string>
+#include <vector>
+
+using namespace car_sales;
+using namespace car_sales::expr;
+
+namespace {
+
+std::vector<CarSaleRecord> sampleRows() {
+  const char *brands[] = {"Audi", "BMW", "Audii", "BM"};
+  const char *countries[] = {"China", "Germany", "France", "Chin"};
+  std::vector<CarSaleRecord> rows;
+  for (int i = 0; i < 3000; ++i) {
+    rows.emplace_back(brands[i % 4], countries[(i / 4) % 4],
+                      2023 + i % 3, 1 + i % 2, 100.0 + i);
+  }
+  return rows;
+}
+
+} // namespace
+
+TEST(RowExprTest, EvaluatesPredicates) {
+  CarSaleRecord row("BMW", "Germany", 2025, 1, 1234.56);
+  EXPECT_TRUE((col<Manufacturer> == "BMW")(row));
+  EXPECT_FALSE((col<Manufacturer> == "BM")(row));
+  EXPECT_TRUE((col<Manufacturer> == "BMW" && col<Year> == 2025)(row));
+  EXPECT_FALSE((col<Manufacturer> == "Audi" && col<Year> == 2025)(row));
+  EXPECT_TRUE((col<Manufacturer> == "Audi" || col<Year> >= 2025)(row));
+  EXPECT_TRUE((!(col<Country> != "Germany"))(row));
+  EXPECT_TRUE((col<RevenueCents> > 123455 && col<RevenueCents> <= 123456)(row));
+  EXPECT_TRUE((2024 < col<Year>)(row));
+
+  std::string wanted = "Germany";
+  EXPECT_TRUE((col<Country> == wanted)(row));
+}
+
+TEST(RowExprTest, CheapConditionsSkipShortCircuit) {
+  auto cheap = col<Year> == 2025 && col<Manufacturer> == "BMW";
+  static_assert(decltype(cheap)::cheap, "comparisons evaluate unconditionally");
+
+  int calls = 0;
+  auto counted = [&calls](const std::string &country) {
+    ++calls;
+    return country == "Germany";
+  };
+  auto guarded = col<Manufacturer> == "BMW" && call(col<Country>, counted);
+  static_assert(!decltype(guarded)::cheap, "calls stay behind the guard");
+
+  std::vector<CarSaleRecord> rows = sampleRows();
+  size_t matched = 0;
+  forEachWhere(rows.data(), rows.size(), guarded,
+               [&matched](const CarSaleRecord &) { ++matched; });
+  // The call ran only for BMW rows
+  EXPECT_EQ(calls, 750);
+  EXPECT_EQ(matched, 188u); // BMW rows in Germany
+}
+
+TEST(RowExprTest, FusedSumsMatchHandwrittenLoop) {
+  std::vector<CarSaleRecord> rows = sampleRows();
+  auto audi_china =
+      col<Year> == 2025 && col<Manufacturer> == "Audi" && col<Country> == "China";
+  auto bmw_2025 = col<Year> == 2025 && col<Manufacturer> == "BMW";
+  int64_t bmw_rows = 0;
+  auto [units, cents, all, action] =
+      sumRows(rows.data(), rows.size(), sumIf(audi_china, col<Quantity>),
+              sumIf(bmw_2025, col<RevenueCents>),
+              sumIf(col<Year> > 0, col<Quantity>),
+              eachIf(bmw_2025, [&bmw_rows](const CarSaleRecord &) {
+                ++bmw_rows;
+              }));
+
+  int64_t expected_units = 0;
+  int64_t expected_cents = 0;
+  int64_t expected_all = 0;
+  for (const CarSaleRecord &row : rows) {
+    if (row.year == 2025 && row.brand == "Audi" && row.country == "China") {
+      expected_units += row.quantity;
+    }
+    if (row.year == 2025 && row.brand == "BMW") {
+      expected_cents += row.revenue_cents;
+    }
+    expected_all += row.quantity;
+  }
+  EXPECT_GT(expected_units, 0);
+  EXPECT_EQ(units, expected_units);
+  EXPECT_EQ(cents, expected_cents);
+  EXPECT_EQ(all, expected_all);
+  EXPECT_EQ(action, 0);
+  EXPECT_EQ(bmw_rows, 250);
+}
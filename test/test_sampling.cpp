@@ -0,0 +1,224 @@
+#include "data_analyzer.hpp"
+#include "sampling.hpp"
+#include "sale_rows.hpp"
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <string>
+
+using namespace car_sales;
+
+namespace {
+
+std::string createLine(const std::string &brand, const std::string &country,
+                       int year, const std::string &price) {
+  return SaleRow()
+      .date("15-01-" + std::to_string(year))
+      .country(country)
+      .brand(brand)
+      .price(price)
+      .line();
+}
+
+// A mixed file large enough to cut into many small blocks
+std::string writeSampleFile() {
+  std::string path = ::testing::TempDir() + "sampling.csv";
+  std::ofstream out(path);
+  out << "header\n";
+  const char *countries[] = {"China", "Germany", "France", "Italy"};
+  const char *brands[] = {"Audi", "BMW", "Ford"};
+  for (int i = 0; i < 30000; ++i) {
+    int year = i % 5 == 0 ? 2024 : 2025;
+    std::string price = std::to_string(20000 + (i * 37) % 50000) + ".50";
+    out << createLine(brands[i % 3], countries[(i / 3) % 4], year, price)
+        << "\n";
+  }
+  return path;
+}
+
+} // namespace
+
+TEST(SamplingTest, FullSampleHasNoError) {
+  BlockSums sums;
+  for (double v : {4.0, 6.0, 5.0, 9.0}) {
+    sums.add(v);
+  }
+  SampleInterval all = estimateTotal(sums, 4, 4, 1.96);
+  EXPECT_DOUBLE_EQ(all.estimate, 24.0);
+  EXPECT_DOUBLE_EQ(all.half_width, 0.0);
+
+  // Half the blocks: N * mean, with s^2 = 14 / 3 and fpc 1 - 4/8
+  SampleInterval half = estimateTotal(sums, 4, 8, 2.0);
+  EXPECT_DOUBLE_EQ(half.estimate, 48.0);
+  EXPECT_NEAR(half.half_width, 2.0 * 8.0 * std::sqrt(0.5 * (14.0 / 3.0) / 4.0),
+              1e-9);
+  EXPECT_NEAR(half.relativeError(), half.half_width / 48.0, 1e-12);
+}
+
+TEST(SamplingTest, UnseenMetricIsBoundedNotExact) {
+  BlockSums none;
+  SampleInterval unseen = estimateTotal(none, 16, 858, 1.96);
+  EXPECT_DOUBLE_EQ(unseen.estimate, 0.0);
+  // -ln(0.025) occurrences per 16 blocks, scaled to 858
+  EXPECT_NEAR(unseen.half_width, 3.689 * 858.0 / 16.0, 0.1);
+  EXPECT_TRUE(std::isinf(unseen.relativeError()));
+
+  // Revenue has no bound per occurrence
+  EXPECT_TRUE(std::isinf(estimateTotal(none, 16, 858, 1.96, INFINITY)
+                             .half_width));
+
+  // Once every block was read, zero is exact
+  SampleInterval exact = estimateTotal(none, 858, 858, 1.96, INFINITY);
+  EXPECT_DOUBLE_EQ(exact.half_width, 0.0);
+  EXPECT_DOUBLE_EQ(exact.relativeError(), 0.0);
+}
+
+TEST(SamplingTest, OrderIsAReproduciblePermutation) {
+  std::vector<size_t> order = samplingOrder(1000, 7);
+  EXPECT_EQ(order, samplingOrder(1000, 7));
+  EXPECT_NE(order, samplingOrder(1000, 8));
+  std::vector<size_t> sorted = order;
+  std::sort(sorted.begin(), sorted.end());
+  for (size_t i = 0; i < sorted.size(); ++i) {
+    EXPECT_EQ(sorted[i], i);
+  }
+}
+
+TEST(SamplingTest, AlignedBlocksCoverEveryLineOnce) {
+  std::string data = "header\n";
+  for (int i = 0; i < 200; ++i) {
+    data += "line " + std::to_string(i) + std::string(i % 17, 'x') + "\n";
+  }
+  data += "last line without newline";
+  std::istringstream in(data);
+  uint64_t data_start = 7;
+
+  for (uint64_t block_bytes : {1u, 13u, 64u, 1000u, 100000u}) {
+    std::string joined;
+    std::string buffer;
+    for (uint64_t start = data_start; start < data.size();
+         start += block_bytes) {
+      joined += std::string(readAlignedBlock(in, data_start, data.size(),
+                                             start, start + block_bytes,
+                                             buffer));
+    }
+    EXPECT_EQ(joined, data.substr(data_start)) << "block " << block_bytes;
+  }
+}
+
+TEST(SamplingTest, SampleOfWholeFileIsExact) {
+  std::string path = writeSampleFile();
+  CarSalesAnalyzer exact_analyzer(1000);
+  AnalysisResult exact = exact_analyzer.analyzeFile(path, true, 2);
+
+  SampleOptions options;
+  options.max_fraction = 1.0;
+  options.target_error = 0.0;
+  options.block_bytes = 16 * 1024;
+  CarSalesAnalyzer analyzer(1000);
+  AnalysisResult sampled = analyzer.analyzeSample(path, options, 3);
+
+  EXPECT_TRUE(sampled.approximate);
+  EXPECT_TRUE(sampled.analysis_complete);
+  EXPECT_EQ(sampled.sample.blocks_sampled, sampled.sample.blocks_total);
+  EXPECT_EQ(sampled.total_records_processed, exact.total_records_processed);
+  EXPECT_EQ(sampled.audi_china_year_sales, exact.audi_china_year_sales);
+  EXPECT_EQ(sampled.bmw_year_total_revenue_cents,
+            exact.bmw_year_total_revenue_cents);
+  EXPECT_DOUBLE_EQ(sampled.sample.bmw_year_total_revenue.half_width, 0.0);
+  EXPECT_EQ(sampled._bmw_europe_revenuedistribution,
+            exact._bmw_europe_revenuedistribution);
+  std::remove(path.c_str());
+}
+
+TEST(SamplingTest, PartialSampleCoversTruth) {
+  std::string path = writeSampleFile();
+  CarSalesAnalyzer exact_analyzer(1000);
+  AnalysisResult exact = exact_analyzer.analyzeFile(path, true, 2);
+
+  SampleOptions options;
+  options.max_fraction = 0.3;
+  options.target_error = 0.0;
+  options.block_bytes = 16 * 1024;
+  options.z = 3.0; // wide enough that the fixed seed cannot flake
+  CarSalesAnalyzer analyzer(1000);
+  AnalysisResult sampled = analyzer.analyzeSample(path, options, 2);
+
+  const SampleReport &report = sampled.sample;
+  EXPECT_LT(report.blocks_sampled, report.blocks_total);
+  EXPECT_LT(sampled.total_records_processed, exact.total_records_processed);
+  EXPECT_GT(report.bmw_year_total_revenue.half_width, 0.0);
+  EXPECT_NEAR(report.audi_china_year_sales.estimate,
+              exact.audi_china_year_sales,
+              report.audi_china_year_sales.half_width);
+  EXPECT_NEAR(report.bmw_year_total_revenue.estimate,
+              exact.bmw_year_total_revenue,
+              report.bmw_year_total_revenue.half_width);
+  std::remove(path.c_str());
+}
+
+TEST(SamplingTest, StopsEarlyAndIgnoresThreadCount) {
+  std::string path = writeSampleFile();
+  SampleOptions options;
+  options.max_fraction = 1.0;
+  options.target_error = 0.2;
+  options.min_blocks = 8;
+  options.block_bytes = 16 * 1024;
+
+  CarSalesAnalyzer one(1000);
+  AnalysisResult first = one.analyzeSample(path, options, 1);
+  EXPECT_TRUE(first.sample.target_reached);
+  EXPECT_LT(first.sample.blocks_sampled, first.sample.blocks_total);
+  EXPECT_LE(first.sample.bmw_year_total_revenue.relativeError(), 0.2);
+
+  for (size_t threads : {2u, 3u, 8u}) {
+    CarSalesAnalyzer analyzer(1000);
+    AnalysisResult again = analyzer.analyzeSample(path, options, threads);
+    EXPECT_EQ(again.sample.blocks_sampled, first.sample.blocks_sampled);
+    EXPECT_EQ(again.bmw_year_total_revenue_cents,
+              first.bmw_year_total_revenue_cents);
+    EXPECT_EQ(again.audi_china_year_sales, first.audi_china_year_sales);
+  }
+  std::remove(path.c_str());
+}
+
+TEST(SamplingTest, RareMetricDoesNotStopAtZero) {
+  // Plenty of BMW sales, only three Audi sales in China, all in one block
+  std::string path = ::testing::TempDir() + "sampling_rare.csv";
+  {
+    std::ofstream out(path);
+    out << "header\n";
+    for (int i = 0; i < 30000; ++i) {
+      bool rare = i >= 20000 && i < 20003;
+      out << createLine(rare ? "Audi" : "BMW", rare ? "China" : "Germany",
+                        2025, std::to_string(20000 + (i * 37) % 50000) + ".50")
+          << "\n";
+    }
+  }
+  SampleOptions options;
+  options.max_fraction = 0.5;
+  options.target_error = 0.5;
+  options.min_blocks = 8;
+  options.block_bytes = 16 * 1024;
+  CarSalesAnalyzer analyzer(1000);
+  AnalysisResult result = analyzer.analyzeSample(path, options, 2);
+
+  const SampleReport &report = result.sample;
+  ASSERT_LT(report.blocks_sampled, report.blocks_total);
+  if (report.audi_china_year_sales.estimate == 0.0) {
+    EXPECT_FALSE(report.target_reached);
+    EXPECT_GT(report.audi_china_year_sales.half_width, 0.0);
+  }
+  std::remove(path.c_str());
+}
+
+TEST(SamplingTest, MissingFileFails) {
+  CarSalesAnalyzer analyzer;
+  AnalysisResult result = analyzer.analyzeSample("/nonexistent/file.csv");
+  EXPECT_FALSE(result.analysis_complete);
+  EXPECT_FALSE(result.errors.empty());
+}
@@ -0,0 +1,161 @@
+#include "data_parser.hpp"
+#include "sale_rows.hpp"
+#include "schema.hpp"
+#include <gtest/gtest.h>
+
+#include <cstdio>
+#include <sstream>
+#include <string>
+#include <vector>
+
+using namespace car_sales;
+
+namespace {
+
+const std::string HEADER = SaleRow::header();
+
+std::string createLine(int i) {
+  std::string country = i % 3 == 0 ? "China" : (i % 3 == 1 ? "Germany"
+                                                           : "France");
+  std::string price = i % 41 == 0 ? "n/a" : std::to_string(1000 + i) + ".50";
+  return SaleRow()
+      .country(country)
+      .latitude(std::to_string(i % 90) + ".0")
+      .dealership("D00" + std::to_string(i % 7))
+      .brand(i % 2 ? "BMW" : "Audi")
+      .price(price)
+      .line();
+}
+
+std::vector<std::string> split(const std::string &line) {
+  std::vector<std::string> fields;
+  std::istringstream in(line);
+  std::string field;
+  while (std::getline(in, field, '\t')) {
+    fields.push_back(field);
+  }
+  if (!line.empty() && line.back() == '\t') {
+    fields.emplace_back();
+  }
+  return fields;
+}
+
+// Columns reversed, with an extra column in front
+std::string reorder(const std::string &line, const std::string &extra) {
+  std::vector<std::string> fields = split(line);
+  std::string out = extra;
+  for (size_t f = fields.size(); f-- > 0;) {
+    out += '\t' + fields[f];
+  }
+  return out;
+}
+
+} // namespace
+
+TEST(SchemaTest, BindsColumnsByHeaderName) {
+  Schema standard = Schema::fromHeader(HEADER, '\t');
+  EXPECT_TRUE(standard.isStandard());
+  EXPECT_TRUE(standard.fromHeaderNames());
+  EXPECT_EQ(standard.index(SchemaColumn::SalePrice), 20);
+
+  Schema reordered = Schema::fromHeader(reorder(HEADER, "export_batch"), '\t');
+  EXPECT_FALSE(reordered.isStandard());
+  EXPECT_EQ(reordered.index(SchemaColumn::SalePrice), 23);
+  EXPECT_EQ(reordered.index(SchemaColumn::SaleDate), 42);
+  EXPECT_EQ(reordered.errorColumn(ParseErrorCode::InvalidPrice), 24u);
+  EXPECT_EQ(reordered.errorColumn(ParseErrorCode::TooFewFields), 0u);
+
+  Schema quoted =
+      Schema::fromHeader("\xEF\xBB\xBF\"country\", manufacturer ,x\r", ',');
+  EXPECT_EQ(quoted.index(SchemaColumn::Country), 0);
+  EXPECT_EQ(quoted.index(SchemaColumn::Manufacturer), 1);
+  EXPECT_FALSE(quoted.has(SchemaColumn::SalePrice));
+
+  // Not a header of this format: read positionally as data.csv
+  Schema unnamed = Schema::fromHeader("header", '\t');
+  EXPECT_TRUE(unnamed.isStandard());
+  EXPECT_FALSE(unnamed.fromHeaderNames());
+}
+
+TEST(SchemaTest, ReorderedExportMatchesStandardLayout) {
+  std::string standard = HEADER + "\n";
+  std::string reordered = reorder(HEADER, "export_batch") + "\n";
+  for (int i = 0; i < 500; ++i) {
+    standard += createLine(i) + "\n";
+    reordered += reorder(createLine(i), std::to_string(i)) + "\n";
+  }
+  std::string standard_path = writeTempFile("schema_standard.csv", standard);
+  std::string reordered_path = writeTempFile("schema_reordered.csv", reordered);
+
+  for (bool concurrent : {false, true}) {
+    SCOPED_TRACE(concurrent ? "concurrent" : "sequential");
+    auto parse = [&](const std::string &path) {
+      CsvParser parser(64, '\t');
+      parser.setGroupBy(GroupColumn::DealershipId);
+      parser.setGeoGrid(10.0);
+      if (concurrent) {
+        return parser.parseFileConcurrent(path, 3);
+      }
+      ChunkResult result = parser.parseFile(
+          path, [](const std::vector<CarSaleRecord> &, ChunkResult &) {
+            return true;
+          });
+      return result;
+    };
+    ChunkResult expected = parse(standard_path);
+    ChunkResult result = parse(reordered_path);
+    ASSERT_TRUE(result.success);
+    EXPECT_EQ(result.records_failed, 13u);
+    EXPECT_EQ(result.records_failed, expected.records_failed);
+    if (concurrent) {
+      EXPECT_EQ(result.audi_china_year_sales, expected.audi_china_year_sales);
+      EXPECT_EQ(result.bmw_2025_revenue_cents,
+                expected.bmw_2025_revenue_cents);
+      EXPECT_EQ(result.group_by.summarize(10, 1).top.size(), 7u);
+      EXPECT_EQ(result.geo_grid.cells().size(),
+                expected.geo_grid.cells().size());
+    }
+    ASSERT_EQ(result.parse_errors.size(), expected.parse_errors.size());
+    EXPECT_EQ(expected.parse_errors[0].column, 21u);
+    EXPECT_EQ(result.parse_errors[0].column, 24u);
+    EXPECT_EQ(result.parse_errors[0].line, expected.parse_errors[0].line);
+  }
+
+  std::remove(standard_path.c_str());
+  std::remove(reordered_path.c_str());
+}
+
+TEST(SchemaTest, MissingColumnFailsUpFront) {
+  std::string content = "sale_id\tsale_date\tcountry\tmanufacturer\n"
+                        "S1\t15-01-2025\tChina\tAudi\n";
+  CsvParser parser(16, '\t');
+  int calls = 0;
+  ChunkResult result = parser.parseString(
+      content, [&](const std::vector<CarSaleRecord> &, ChunkResult &) {
+        ++calls;
+        return true;
+      });
+  EXPECT_FALSE(result.success);
+  EXPECT_EQ(calls, 0);
+  ASSERT_FALSE(result.errors.empty());
+  EXPECT_NE(result.errors[0].find("sale_price_usd"), std::string::npos);
+
+  // A column only the configured analysis needs
+  std::string path = writeTempFile(
+      "schema_missing.csv",
+      "sale_date\tcountry\tmanufacturer\tsale_price_usd\n"
+      "15-01-2025\tChina\tAudi\t100.00\n");
+  CsvParser grouped(16, '\t');
+  grouped.setGroupBy(GroupColumn::Vin);
+  result = grouped.parseFileConcurrent(path, 2);
+  EXPECT_FALSE(result.success);
+  ASSERT_FALSE(result.errors.empty());
+  EXPECT_NE(result.errors[0].find("vin"), std::string::npos);
+
+  CsvParser plain(16, '\t');
+  result = plain.parseFileConcurrent(path, 2);
+  EXPECT_TRUE(result.success);
+  EXPECT_EQ(result.records_processed, 1u);
+  EXPECT_EQ(result.audi_china_year_sales, 1);
+  std::remove(path.c_str());
+}
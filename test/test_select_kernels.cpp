@@ -0,0 +1,127 @@
+#include "select_kernels.hpp"
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace car_sales;
+
+namespace {
+
+struct Columns {
+  std::vector<uint16_t> codes;
+  std::vector<int64_t> cents;
+};
+
+Columns randomColumns(size_t rows, uint32_t seed) {
+  std::mt19937 rng(seed);
+  Columns columns;
+  for (size_t i = 0; i < rows; ++i) {
+    columns.codes.push_back(static_cast<uint16_t>(rng() % 7));
+    columns.cents.push_back(static_cast<int64_t>(rng() % 200000) - 1000);
+  }
+  return columns;
+}
+
+std::vector<uint32_t> expectedEq(const std::vector<uint16_t> &column,
+                                 uint16_t value) {
+  std::vector<uint32_t> rows;
+  for (size_t i = 0; i < column.size(); ++i) {
+    if (column[i] == value) {
+      rows.push_back(static_cast<uint32_t>(i));
+    }
+  }
+  return rows;
+}
+
+} // namespace
+
+TEST(SelectKernelsTest, DispatchFallsBackToScalar) {
+  EXPECT_EQ(selectKernels(SelectIsa::Scalar).isa, SelectIsa::Scalar);
+  EXPECT_STREQ(selectIsaName(SelectIsa::Avx2), "avx2");
+  EXPECT_TRUE(selectIsaAvailable(SelectIsa::Scalar));
+  SelectIsa expected = selectIsaAvailable(SelectIsa::Avx2) ? SelectIsa::Avx2
+                                                           : SelectIsa::Scalar;
+  EXPECT_EQ(selectKernels(SelectIsa::Avx2).isa, expected);
+  EXPECT_EQ(activeSelectKernels().isa, expected);
+}
+
+TEST(SelectKernelsTest, EveryIsaSelectsTheSameRows) {
+  // Sizes around the 8-row step, so tails are covered
+  for (size_t rows : {0u, 1u, 7u, 8u, 9u, 63u, 1000u, 4099u}) {
+    Columns columns = randomColumns(rows, static_cast<uint32_t>(rows));
+    std::vector<uint32_t> expected = expectedEq(columns.codes, 3);
+    for (SelectIsa isa : {SelectIsa::Scalar, SelectIsa::Avx2}) {
+      SCOPED_TRACE(std::string(selectIsaName(isa)) + " rows " +
+                   std::to_string(rows));
+      const SelectKernels &kernels = selectKernels(isa);
+      std::vector<uint32_t> selection(rows);
+      size_t selected =
+          kernels.select_eq_u16(columns.codes.data(), rows, 3, selection.data());
+      selection.resize(selected);
+      EXPECT_EQ(selection, expected);
+
+      // Refined in place by price, then summed
+      std::vector<uint32_t> priced;
+      int64_t sum = 0;
+      for (uint32_t row : expected) {
+        if (columns.cents[row] >= 0 && columns.cents[row] <= 50000) {
+          priced.push_back(row);
+          sum += columns.cents[row];
+        }
+      }
+      selected = kernels.refine_range_i64(columns.cents.data(), rows,
+                                          selection.data(), selected, 0, 50000,
+                                          selection.data());
+      selection.resize(selected);
+      EXPECT_EQ(selection, priced);
+      EXPECT_EQ(kernels.sum_selected_i64(columns.cents.data(), rows,
+                                         selection.data(), selected),
+                sum);
+
+      std::vector<uint32_t> negative;
+      for (size_t row = 0; row < rows; ++row) {
+        if (columns.cents[row] < 0) {
+          negative.push_back(static_cast<uint32_t>(row));
+        }
+      }
+      std::vector<uint32_t> ranged(rows);
+      ranged.resize(kernels.select_range_i64(columns.cents.data(), rows,
+                                             INT64_MIN, -1, ranged.data()));
+      EXPECT_EQ(ranged, negative);
+    }
+  }
+}
+
+TEST(SelectKernelsTest, RefinesReachTheLastRow) {
+  // Gathers must not read past the end when the last rows are selected
+  const size_t rows = 37;
+  std::vector<uint16_t> codes(rows, 5);
+  std::vector<int64_t> cents(rows, 100);
+  uint8_t table[8] = {0, 0, 0, 0, 0, 1, 0, 0};
+  std::vector<uint32_t> all;
+  for (uint32_t row = 0; row < rows; ++row) {
+    all.push_back(row);
+  }
+  for (SelectIsa isa : {SelectIsa::Scalar, SelectIsa::Avx2}) {
+    SCOPED_TRACE(selectIsaName(isa));
+    const SelectKernels &kernels = selectKernels(isa);
+    std::vector<uint32_t> tail(all.end() - 16, all.end());
+    std::vector<uint32_t> out(rows);
+    EXPECT_EQ(kernels.refine_eq_u16(codes.data(), rows, tail.data(),
+                                    tail.size(), 5, out.data()),
+              16u);
+    EXPECT_EQ(out[15], rows - 1);
+    EXPECT_EQ(kernels.refine_eq_u16(codes.data(), rows, tail.data(),
+                                    tail.size(), 4, out.data()),
+              0u);
+    EXPECT_EQ(kernels.refine_lookup_u16(codes.data(), rows, all.data(), rows,
+                                        table, out.data()),
+              0u + rows);
+    EXPECT_EQ(kernels.sum_selected_i64(cents.data(), rows, tail.data(),
+                                       tail.size()),
+              1600);
+  }
+}
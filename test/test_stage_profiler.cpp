@@ -0,0 +1,101 @@
+#include "data_analyzer.hpp"
+#include "sale_rows.hpp"
+#include "stage_profiler.hpp"
+#include <gtest/gtest.h>
+
+using namespace car_sales;
+
+class StageProfilerTest : public ::testing::Test {
+protected:
+  std::string createCsv(int rows) {
+    std::string csv = "header\n";
+    for (int i = 0; i < rows; ++i) {
+      csv += SaleRow().price(std::to_string(1000 + i)).line() + "\n";
+    }
+    return csv;
+  }
+};
+
+// ============================================================================
+// StageProfile Tests
+// ============================================================================
+
+TEST_F(StageProfilerTest, AddAccumulatesPerStage) {
+  StageProfile profile;
+  profile.add(Stage::Io, 10, 100, 1);
+  profile.add(Stage::Io, 5, 50, 1);
+  profile.add(Stage::Merge, 7);
+
+  EXPECT_EQ(profile[Stage::Io].ticks, 15u);
+  EXPECT_EQ(profile[Stage::Io].bytes, 150u);
+  EXPECT_EQ(profile[Stage::Io].rows, 2u);
+  EXPECT_EQ(profile[Stage::Merge].ticks, 7u);
+  EXPECT_EQ(profile[Stage::Tokenize].ticks, 0u);
+}
+
+TEST_F(StageProfilerTest, MergeSumsStagesAndThreads) {
+  StageProfile a;
+  StageProfile b;
+  a.add(Stage::Aggregate, 10, 0, 5);
+  b.add(Stage::Aggregate, 20, 0, 7);
+  b.threads.push_back(ThreadUtilization());
+
+  a.merge(b);
+
+  EXPECT_EQ(a[Stage::Aggregate].ticks, 30u);
+  EXPECT_EQ(a[Stage::Aggregate].rows, 12u);
+  EXPECT_EQ(a.threads.size(), 1u);
+}
+
+TEST_F(StageProfilerTest, RowTickScaleSamplesOnePerPeriod) {
+  StageProfile profile;
+  uint64_t sampled = 0;
+  for (uint64_t row = 0; row < 3 * StageProfile::ROW_SAMPLE_PERIOD; ++row) {
+    uint64_t scale = profile.rowTickScale();
+    EXPECT_TRUE(scale == 0 || scale == StageProfile::ROW_SAMPLE_PERIOD);
+    sampled += scale != 0;
+    // Unsampled rows are still counted, just not timed
+    ScopedStageTimer timer(&profile, Stage::Tokenize, 10, 1, scale);
+  }
+  EXPECT_EQ(sampled, 3u);
+  EXPECT_EQ(profile[Stage::Tokenize].rows, 3 * StageProfile::ROW_SAMPLE_PERIOD);
+  EXPECT_EQ(profile[Stage::Tokenize].bytes,
+            30 * StageProfile::ROW_SAMPLE_PERIOD);
+  EXPECT_EQ(profile[Stage::Tokenize].ticks % StageProfile::ROW_SAMPLE_PERIOD,
+            0u);
+}
+
+TEST_F(StageProfilerTest, NullProfileTimerIsNoOp) {
+  ScopedStageTimer timer(nullptr, Stage::Io, 1, 1);
+  SUCCEED();
+}
+
+// ============================================================================
+// Parser/Analyzer Integration Tests
+// ============================================================================
+
+TEST_F(StageProfilerTest, DisabledByDefault) {
+  CarSalesAnalyzer analyzer(10);
+  auto result = analyzer.analyzeString(createCsv(5));
+
+  EXPECT_FALSE(result.profile.enabled);
+  EXPECT_EQ(result.profile[Stage::Tokenize].rows, 0u);
+}
+
+TEST_F(StageProfilerTest, SequentialRunCountsRowsPerStage) {
+  if (!profiling::COMPILED_IN) {
+    GTEST_SKIP() << "profiling compiled out";
+  }
+
+  CarSalesAnalyzer analyzer(10);
+  analyzer.setProfilingEnabled(true);
+  auto result = analyzer.analyzeString(createCsv(25));
+
+  ASSERT_TRUE(result.profile.enabled);
+  EXPECT_EQ(result.profile[Stage::Io].rows, 26u); // header + 25 rows
+  EXPECT_EQ(result.profile[Stage::Tokenize].rows, 25u);
+  EXPECT_EQ(result.profile[Stage::NumericParse].rows, 25u);
+  EXPECT_EQ(result.profile[Stage::Aggregate].rows, 25u);
+  EXPECT_GT(result.profile.wall_ns, 0u);
+  EXPECT_DOUBLE_EQ(result.bmw_year_total_revenue, 25 * 1000 + 300);
+}
@@ -0,0 +1,190 @@
+#include "data_parser.hpp"
+#include "record_boundaries.hpp"
+#include "sale_rows.hpp"
+#include "stream_input.hpp"
+#include <gtest/gtest.h>
+
+#include <cstdio>
+#include <fstream>
+#include <string>
+#include <thread>
+
+#include <sys/stat.h>
+#include <unistd.h>
+
+using namespace car_sales;
+
+namespace {
+
+std::string createLine(int i) {
+  std::string country = i % 3 == 0 ? "China" : (i % 3 == 1 ? "Germany"
+                                                           : "France");
+  // Some rows carry a quoted newline, some are rejected
+  return SaleRow()
+      .country(country)
+      .dealership("D00" + std::to_string(i % 7))
+      .brand(i % 2 ? "BMW" : "Audi")
+      .model(i % 17 == 0 ? "\"Model\nLong\"" : "Model")
+      .price(i % 29 == 0 ? "n/a" : std::to_string(1000 + i) + ".50")
+      .line();
+}
+
+std::string createContent(int rows) {
+  std::string content = "header\n";
+  for (int i = 0; i < rows; ++i) {
+    content += createLine(i) + "\n";
+  }
+  return content;
+}
+
+// Writes content to fd in small pieces on its own thread, then closes it
+std::thread startWriter(int fd, const std::string &content) {
+  return std::thread([fd, &content]() {
+    size_t done = 0;
+    while (done < content.size()) {
+      size_t n = std::min<size_t>(3000, content.size() - done);
+      ssize_t written = ::write(fd, content.data() + done, n);
+      if (written <= 0) {
+        break;
+      }
+      done += static_cast<size_t>(written);
+    }
+    ::close(fd);
+  });
+}
+
+ReadAheadOptions smallSegments() {
+  ReadAheadOptions options;
+  options.block_bytes = 4096;
+  options.segment_bytes = 10000;
+  return options;
+}
+
+} // namespace
+
+TEST(StreamInputTest, RecognisesStreams) {
+  EXPECT_TRUE(isStreamInput("-"));
+  std::string path = writeTempFile("stream_regular.csv", "header\n");
+  EXPECT_FALSE(isStreamInput(path));
+  EXPECT_FALSE(isStreamInput(::testing::TempDir() + "stream_missing.csv"));
+  std::remove(path.c_str());
+}
+
+TEST(StreamInputTest, SplitterHandsOutWholeRecords) {
+  std::string content = createContent(400);
+  std::string path = writeTempFile("stream_split.csv", content);
+  ReadAheadReader reader(smallSegments());
+  std::string error;
+  ASSERT_TRUE(reader.open(path, error)) << error;
+
+  StreamSplitter splitter(reader, 10000);
+  std::string header;
+  size_t header_lines = 0;
+  ASSERT_TRUE(splitter.header(header, header_lines));
+  EXPECT_EQ(header, "header");
+  EXPECT_EQ(header_lines, 1u);
+
+  std::string joined;
+  StreamSegment segment;
+  while (splitter.next(segment)) {
+    EXPECT_EQ(segment.base_offset, header.size() + 1 + joined.size());
+    EXPECT_EQ(segment.index + 1, splitter.segments());
+    // Ends on a record boundary, never inside a quoted model
+    EXPECT_EQ(lastRecordEnd(segment.data), segment.data.size());
+    joined += segment.data;
+  }
+  EXPECT_GT(splitter.segments(), 5u);
+  EXPECT_EQ("header\n" + joined, content);
+  std::remove(path.c_str());
+}
+
+TEST(StreamInputTest, PipeMatchesFileInput) {
+  std::string content = createContent(3000);
+  std::string path = writeTempFile("stream_file.csv", content);
+
+  auto configure = [](CsvParser &parser) {
+    parser.setReadAhead(smallSegments());
+    parser.setGroupBy(GroupColumn::DealershipId);
+  };
+  CsvParser file_parser(64, '\t');
+  configure(file_parser);
+  ChunkResult expected = file_parser.parseFileConcurrent(path, 3);
+  ASSERT_TRUE(expected.success);
+
+  int fds[2];
+  ASSERT_EQ(::pipe(fds), 0);
+  std::thread writer = startWriter(fds[1], content);
+  CsvParser parser(64, '\t');
+  configure(parser);
+  ChunkResult result = parser.parseDescriptorConcurrent(fds[0], 3);
+  writer.join();
+  ::close(fds[0]);
+
+  ASSERT_TRUE(result.success);
+  EXPECT_EQ(result.records_processed, expected.records_processed);
+  EXPECT_EQ(result.records_failed, expected.records_failed);
+  EXPECT_GT(result.records_failed, 0u);
+  EXPECT_EQ(result.lines_scanned, expected.lines_scanned);
+  EXPECT_EQ(result.audi_china_year_sales, expected.audi_china_year_sales);
+  EXPECT_EQ(result.bmw_2025_revenue_cents, expected.bmw_2025_revenue_cents);
+  EXPECT_EQ(result.bmw_europe_revenue_cents, expected.bmw_europe_revenue_cents);
+  EXPECT_EQ(result.group_by.summarize(10, 1).top.size(), 7u);
+  ASSERT_EQ(result.parse_errors.size(), expected.parse_errors.size());
+  for (size_t i = 0; i < result.parse_errors.size(); ++i) {
+    EXPECT_EQ(result.parse_errors[i].line, expected.parse_errors[i].line);
+    EXPECT_EQ(result.parse_errors[i].byte_offset,
+              expected.parse_errors[i].byte_offset);
+  }
+  std::remove(path.c_str());
+}
+
+TEST(StreamInputTest, ReadsStdinAndFifos) {
+  std::string content = createContent(500);
+  CsvParser file_parser(64, '\t');
+  std::string path = writeTempFile("stream_expected.csv", content);
+  ChunkResult expected = file_parser.parseFileConcurrent(path, 2);
+  std::remove(path.c_str());
+
+  // A named FIFO, as from a shell process substitution
+  std::string fifo = ::testing::TempDir() + "stream_fifo";
+  std::remove(fifo.c_str());
+  ASSERT_EQ(::mkfifo(fifo.c_str(), 0600), 0);
+  EXPECT_TRUE(isStreamInput(fifo));
+  std::thread fifo_writer([&fifo, &content]() {
+    std::ofstream out(fifo, std::ios::binary);
+    out << content;
+  });
+  CsvParser fifo_parser(64, '\t');
+  ChunkResult result = fifo_parser.parseFileConcurrent(fifo, 2);
+  fifo_writer.join();
+  std::remove(fifo.c_str());
+  EXPECT_TRUE(result.success);
+  EXPECT_EQ(result.records_processed, expected.records_processed);
+  EXPECT_EQ(result.bmw_2025_revenue_cents, expected.bmw_2025_revenue_cents);
+
+  // "-" reads stdin, here swapped for a pipe
+  int fds[2];
+  ASSERT_EQ(::pipe(fds), 0);
+  int saved_stdin = ::dup(STDIN_FILENO);
+  ASSERT_GE(::dup2(fds[0], STDIN_FILENO), 0);
+  ::close(fds[0]);
+  std::thread writer = startWriter(fds[1], content);
+  CsvParser stdin_parser(64, '\t');
+  size_t rows = 0;
+  result = stdin_parser.parseFile(
+      STDIN_INPUT, [&rows](const std::vector<CarSaleRecord> &chunk,
+                           ChunkResult &) {
+        rows += chunk.size();
+        return true;
+      });
+  writer.join();
+  ::dup2(saved_stdin, STDIN_FILENO);
+  ::close(saved_stdin);
+  EXPECT_TRUE(result.success);
+  EXPECT_EQ(rows, expected.records_processed);
+  EXPECT_EQ(result.records_failed, expected.records_failed);
+
+  SampleOptions options;
+  SampleReport report;
+  EXPECT_FALSE(stdin_parser.sampleFile(STDIN_INPUT, options, report).success);
+}
@@ -0,0 +1,161 @@
+#include "data_analyzer.hpp"
+#include "time_series.hpp"
+#include "sale_rows.hpp"
+#include <gtest/gtest.h>
+
+#include <cstdio>
+#include <fstream>
+#include <string>
+
+using namespace car_sales;
+
+namespace {
+
+std::string createLine(const std::string &brand, const std::string &date,
+                       const std::string &price) {
+  return SaleRow().brand(brand).date(date).price(price).line();
+}
+
+} // namespace
+
+TEST(TimeSeriesTest, DayNumbersMatchCalendar) {
+  EXPECT_EQ(daysFromCivil(1970, 1, 1), 0);
+  EXPECT_EQ(daysFromCivil(1969, 12, 31), -1);
+  EXPECT_EQ(daysFromCivil(2000, 2, 29), 11016);
+  EXPECT_EQ(daysFromCivil(2025, 1, 15), 20103);
+
+  for (int32_t day = -50000; day < 80000; day += 37) {
+    int year;
+    unsigned month;
+    unsigned dom;
+    civilFromDays(day, year, month, dom);
+    EXPECT_EQ(daysFromCivil(year, month, dom), day);
+  }
+}
+
+TEST(TimeSeriesTest, ParsesSaleDates) {
+  EXPECT_EQ(parseSaleDay("15-01-2025"), 20103);
+  EXPECT_EQ(parseSaleDay("29-02-2000"), 11016);
+  EXPECT_EQ(parseSaleDay("29-02-2025"), INVALID_DAY); // not a leap year
+  EXPECT_EQ(parseSaleDay("31-04-2025"), INVALID_DAY);
+  EXPECT_EQ(parseSaleDay("15-13-2025"), INVALID_DAY);
+  EXPECT_EQ(parseSaleDay("00-01-2025"), INVALID_DAY);
+  EXPECT_EQ(parseSaleDay("2025-01-15x"), INVALID_DAY);
+  EXPECT_EQ(parseSaleDay("invalid"), INVALID_DAY);
+  // Years the parser rejects, so a typo cannot stretch a dense series
+  EXPECT_EQ(parseSaleDay("20-01-202500"), INVALID_DAY);
+  EXPECT_EQ(parseSaleDay("20-01-2100000000"), INVALID_DAY);
+  EXPECT_EQ(parseSaleDay("31-12-1899"), INVALID_DAY);
+  EXPECT_NE(parseSaleDay("01-01-1900"), INVALID_DAY);
+  EXPECT_NE(parseSaleDay("31-12-2100"), INVALID_DAY);
+}
+
+TEST(TimeSeriesTest, BucketsAndLabels) {
+  int32_t day = daysFromCivil(2025, 3, 9);
+  EXPECT_EQ(bucketLabel(TimeBucket::Month, bucketOf(TimeBucket::Month, day)),
+            "2025-03");
+
+  // ISO weeks belong to the year of their Thursday
+  auto week = [](int year, unsigned month, unsigned dom) {
+    int32_t d = daysFromCivil(year, month, dom);
+    return bucketLabel(TimeBucket::IsoWeek, bucketOf(TimeBucket::IsoWeek, d));
+  };
+  EXPECT_EQ(week(2025, 1, 15), "2025-W03");
+  EXPECT_EQ(week(2024, 12, 30), "2025-W01");
+  EXPECT_EQ(week(2021, 1, 3), "2020-W53");
+  EXPECT_EQ(week(1969, 12, 31), "1970-W01");
+
+  // Monday to Sunday share a bucket, the next Monday does not
+  int32_t monday = daysFromCivil(2025, 1, 13);
+  EXPECT_EQ(bucketOf(TimeBucket::IsoWeek, monday),
+            bucketOf(TimeBucket::IsoWeek, monday + 6));
+  EXPECT_EQ(bucketOf(TimeBucket::IsoWeek, monday) + 1,
+            bucketOf(TimeBucket::IsoWeek, monday + 7));
+
+  TimeBucket bucket = TimeBucket::None;
+  EXPECT_TRUE(parseTimeBucket("week", bucket));
+  EXPECT_EQ(bucket, TimeBucket::IsoWeek);
+  EXPECT_FALSE(parseTimeBucket("day", bucket));
+}
+
+TEST(TimeSeriesTest, DenseSeriesFillGapsAndMerge) {
+  TimeSeriesAggregator left(TimeBucket::Month);
+  TimeSeriesAggregator right(TimeBucket::Month);
+  left.add("BMW", daysFromCivil(2025, 3, 1), 1, 1000);
+  left.add("BMW", daysFromCivil(2025, 1, 31), 1, 500); // grows downwards
+  right.add("BMW", daysFromCivil(2025, 6, 2), 2, 700);
+  right.add("Audi", daysFromCivil(2024, 12, 24), 1, 300);
+  right.add("Audi", INVALID_DAY, 1, 999);
+
+  left.merge(right);
+  EXPECT_EQ(left.undatedRows(), 1);
+
+  auto points = left.points();
+  ASSERT_EQ(points.size(), 1u + 6u); // Audi: 1 month, BMW: Jan..Jun
+  EXPECT_EQ(points[0].brand, "Audi");
+  EXPECT_EQ(points[0].label, "2024-12");
+  EXPECT_EQ(points[0].revenue_cents, 300);
+
+  EXPECT_EQ(points[1].label, "2025-01");
+  EXPECT_EQ(points[1].revenue_cents, 500);
+  EXPECT_EQ(points[2].label, "2025-02");
+  EXPECT_EQ(points[2].units, 0);
+  EXPECT_EQ(points[3].revenue_cents, 1000);
+  EXPECT_EQ(points[6].label, "2025-06");
+  EXPECT_EQ(points[6].units, 2);
+}
+
+TEST(TimeSeriesTest, AnalyzerSeriesSameForAllThreadCounts) {
+  std::string content = "header\n";
+  const char *brands[] = {"Audi", "BMW", "Ford"};
+  for (int i = 0; i < 3000; ++i) {
+    int month = 1 + i % 12;
+    int day = 1 + (i * 7) % 28;
+    char date[16];
+    std::snprintf(date, sizeof(date), "%02d-%02d-%d", day, month,
+                  2023 + i % 3);
+    content += createLine(brands[i % 3], date,
+                          std::to_string(1000 + i % 500) + ".25") +
+               "\n";
+  }
+  content += createLine("BMW", "45-01-2025", "10.00") + "\n";
+
+  std::string path = ::testing::TempDir() + "time_series.csv";
+  {
+    std::ofstream out(path);
+    out << content;
+  }
+
+  CarSalesAnalyzer sequential(100);
+  sequential.setTimeSeries(TimeBucket::IsoWeek);
+  auto expected = sequential.analyzeFile(path, false);
+  EXPECT_EQ(expected.time_bucket, TimeBucket::IsoWeek);
+  EXPECT_EQ(expected.undated_rows, 1);
+  // The undated row still counts towards the ordinary metrics
+  EXPECT_EQ(expected.total_records_processed, 3001u);
+
+  int64_t units = 0;
+  for (const auto &point : expected.time_series) {
+    units += point.units;
+  }
+  EXPECT_EQ(units, 3000);
+
+  for (size_t threads : {1u, 2u, 3u, 5u}) {
+    CarSalesAnalyzer analyzer(100);
+    analyzer.setTimeSeries(TimeBucket::IsoWeek);
+    auto result = analyzer.analyzeFile(path, true, threads);
+    ASSERT_EQ(result.time_series.size(), expected.time_series.size());
+    for (size_t i = 0; i < result.time_series.size(); ++i) {
+      EXPECT_EQ(result.time_series[i].brand, expected.time_series[i].brand);
+      EXPECT_EQ(result.time_series[i].label, expected.time_series[i].label);
+      EXPECT_EQ(result.time_series[i].units, expected.time_series[i].units);
+      EXPECT_EQ(result.time_series[i].revenue_cents,
+                expected.time_series[i].revenue_cents);
+    }
+    EXPECT_EQ(result.undated_rows, 1);
+  }
+
+  CarSalesAnalyzer plain(100);
+  EXPECT_TRUE(plain.analyzeFile(path, true, 2).time_series.empty());
+  std::remove(path.c_str());
+}